@@ -0,0 +1,472 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Benchmarks of the Delta-Notch hot paths, for catching performance regressions and for sizing jobs.
+ *
+ * Usage: MyDeltaNotchBenchmark [--sizes <W>x<H>[,<W>x<H>...]] [--end-time <time>] [--csv <file>]
+ *
+ * The benchmarks are:
+ *  - "rhs": one evaluation of the MyDeltaNotchOdeSystem RHS, and of the batched RHS per cell;
+ *  - "rk4_step": one RungeKutta4IvpOdeSolver step of one cell, and one batched RK4 step per cell;
+ *  - "update_cell_data": one call of MyDeltaNotchTrackingModifier::UpdateCellData() on a static
+ *    vertex tissue of each of the given sizes (22x15, 100x100, 316x316 and 1000x1000 by default);
+ *  - "vertex_run" and "node_run": a full simulation of the 22x15 tissue of the Delta-Notch tutorial
+ *    to the given end time (1 hour by default).
+ *
+ * Each is reported as the time per cell per step, in ns, together with the memory high-water mark
+ * of the process so far (its peak resident set size), so the benchmarks are run in order of size.
+ * The results are written to standard output and, optionally, as CSV.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+#include "PetscException.hpp"
+
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "GeneralisedLinearSpringForce.hpp"
+#include "HoneycombMeshGenerator.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchCellsGenerator.hpp"
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "NoCellCycleModel.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+/** The result of one benchmark. */
+struct BenchmarkResult
+{
+    /** The name of the benchmark. */
+    std::string name;
+
+    /** The number of cells. */
+    unsigned numCells;
+
+    /** The number of steps (or calls) timed. */
+    unsigned numSteps;
+
+    /** The wall-clock time taken, in seconds. */
+    double seconds;
+
+    /** The peak resident set size of the process after the benchmark, in MB. */
+    double peakMemory;
+};
+
+/** The results of the benchmarks run so far. */
+std::vector<BenchmarkResult> gResults;
+
+/**
+ * @return the wall-clock time in seconds since an arbitrary point.
+ */
+double GetWallTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**
+ * @return the peak resident set size of this process, in MB.
+ */
+double GetPeakMemory()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss/1024.0; // ru_maxrss is in kB on Linux
+}
+
+/**
+ * Record and print the result of a benchmark.
+ *
+ * @param rName the name of the benchmark
+ * @param numCells the number of cells
+ * @param numSteps the number of steps timed
+ * @param seconds the wall-clock time taken
+ */
+void Report(const std::string& rName, unsigned numCells, unsigned numSteps, double seconds)
+{
+    BenchmarkResult result;
+    result.name = rName;
+    result.numCells = numCells;
+    result.numSteps = numSteps;
+    result.seconds = seconds;
+    result.peakMemory = GetPeakMemory();
+    gResults.push_back(result);
+
+    std::cout << std::left << std::setw(28) << rName << std::right
+              << std::setw(10) << numCells
+              << std::setw(10) << numSteps
+              << std::setw(14) << std::fixed << std::setprecision(3) << seconds
+              << std::setw(16) << std::setprecision(2) << 1e9*seconds/(double(numCells)*numSteps)
+              << std::setw(14) << std::setprecision(1) << result.peakMemory
+              << std::endl;
+}
+
+/**
+ * Set up the singletons used by a cell-based simulation, as AbstractCellBasedTestSuite does.
+ */
+void ResetSingletons()
+{
+    SimulationTime::Destroy();
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RandomNumberGenerator::Instance()->Reseed(0);
+    CellPropertyRegistry::Instance()->Clear();
+    CellId::ResetMaxCellId();
+}
+
+/**
+ * @return some initial conditions for the Delta-Notch ODE system.
+ */
+std::vector<double> GetInitialConditions()
+{
+    std::vector<double> initial_conditions;
+    for (unsigned var=0; var<6; var++)
+    {
+        initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
+    }
+    return initial_conditions;
+}
+
+/**
+ * Create differentiated cells with Delta-Notch SRN models, whose random initial conditions
+ * are drawn in parallel by a MyDeltaNotchCellsGenerator.
+ *
+ * @param numCells the number of cells
+ * @param rCells filled in with the cells
+ */
+void CreateCells(unsigned numCells, std::vector<CellPtr>& rCells)
+{
+    MyDeltaNotchCellsGenerator cells_generator;
+    cells_generator.GenerateBasic<NoCellCycleModel, 2>(rCells, numCells);
+}
+
+/**
+ * Time evaluations of the RHS, for one cell at a time and batched.
+ */
+void BenchmarkRhs()
+{
+    ResetSingletons();
+    const unsigned num_evaluations = 1000000;
+
+    std::vector<double> y = GetInitialConditions();
+    std::vector<double> dy(6);
+    MyDeltaNotchOdeSystem ode_system(y);
+    ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.5);
+    ode_system.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, 2.0);
+    double start = GetWallTime();
+    for (unsigned i=0; i<num_evaluations; i++)
+    {
+        ode_system.EvaluateYDerivatives(0.0, y, dy);
+    }
+    Report("rhs", 1, num_evaluations, GetWallTime() - start);
+
+    const unsigned num_cells = 4096;
+    MyDeltaNotchBatchOdeSystem batch(num_cells);
+    for (unsigned i=0; i<batch.rGetStateVariables().size(); i++)
+    {
+        batch.rGetStateVariables()[i] = RandomNumberGenerator::Instance()->ranf();
+    }
+    std::fill(batch.rGetMeanDelta().begin(), batch.rGetMeanDelta().end(), 0.5);
+    std::fill(batch.rGetXDistance().begin(), batch.rGetXDistance().end(), 2.0);
+    std::vector<double> batch_dy(batch.rGetStateVariables().size());
+    const unsigned num_batch_evaluations = num_evaluations/num_cells;
+    start = GetWallTime();
+    for (unsigned i=0; i<num_batch_evaluations; i++)
+    {
+        batch.EvaluateYDerivatives(0.0, batch.rGetStateVariables(), batch_dy);
+    }
+    Report("rhs_batch", num_cells, num_batch_evaluations, GetWallTime() - start);
+}
+
+/**
+ * Time RK4 steps, for one cell at a time and batched.
+ */
+void BenchmarkRungeKutta4Step()
+{
+    ResetSingletons();
+    const unsigned num_steps = 100000;
+    const double dt = 1e-4;
+
+    MyDeltaNotchOdeSystem ode_system(GetInitialConditions());
+    ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.5);
+    ode_system.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, 2.0);
+    RungeKutta4IvpOdeSolver solver;
+    double start = GetWallTime();
+    solver.SolveAndUpdateStateVariable(&ode_system, 0.0, num_steps*dt, dt);
+    Report("rk4_step", 1, num_steps, GetWallTime() - start);
+
+    const unsigned num_cells = 4096;
+    MyDeltaNotchBatchOdeSystem batch(num_cells);
+    for (unsigned i=0; i<batch.rGetStateVariables().size(); i++)
+    {
+        batch.rGetStateVariables()[i] = RandomNumberGenerator::Instance()->ranf();
+    }
+    std::fill(batch.rGetMeanDelta().begin(), batch.rGetMeanDelta().end(), 0.5);
+    std::fill(batch.rGetXDistance().begin(), batch.rGetXDistance().end(), 2.0);
+    MyDeltaNotchBatchRungeKutta4Solver batch_solver;
+    const unsigned num_batch_steps = num_steps/num_cells;
+    start = GetWallTime();
+    batch_solver.Solve(batch, 0.0, num_batch_steps*dt, dt);
+    Report("rk4_step_batch", num_cells, num_batch_steps, GetWallTime() - start);
+}
+
+/**
+ * Time calls to MyDeltaNotchTrackingModifier::UpdateCellData() on a static vertex tissue.
+ *
+ * @param width the number of cells across the tissue
+ * @param height the number of cells up the tissue
+ */
+void BenchmarkUpdateCellData(unsigned width, unsigned height)
+{
+    ResetSingletons();
+    SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+    HoneycombVertexMeshGenerator generator(width, height);
+    MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+    std::vector<CellPtr> cells;
+    CreateCells(p_mesh->GetNumElements(), cells);
+    VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+    // The first call builds the neighbour graph, so is not timed
+    MyDeltaNotchTrackingModifier<2> modifier;
+    modifier.SetupSolve(cell_population, "unused");
+
+    const unsigned num_cells = cell_population.GetNumRealCells();
+    const unsigned num_calls = std::max(1u, 1000000u/num_cells);
+    double start = GetWallTime();
+    for (unsigned i=0; i<num_calls; i++)
+    {
+        modifier.UpdateCellData(cell_population);
+    }
+    std::stringstream name;
+    name << "update_cell_data_" << width << "x" << height;
+    Report(name.str(), num_cells, num_calls, GetWallTime() - start);
+}
+
+/**
+ * Time a full simulation of the 22x15 tissue of the Delta-Notch tutorial.
+ *
+ * @param vertexBased whether to use a vertex-based population, rather than a node-based one
+ * @param endTime the end time of the simulation
+ */
+void BenchmarkFullRun(bool vertexBased, double endTime)
+{
+    ResetSingletons();
+
+    double start;
+    unsigned num_cells;
+    unsigned num_steps;
+    if (vertexBased)
+    {
+        HoneycombVertexMeshGenerator generator(22, 15);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        CreateCells(p_mesh->GetNumElements(), cells);
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("MyDeltaNotchBenchmark/vertex_run");
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
+        simulator.SetEndTime(endTime);
+        MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+
+        start = GetWallTime();
+        simulator.Solve();
+        num_cells = cell_population.GetNumRealCells();
+        num_steps = SimulationTime::Instance()->GetTimeStepsElapsed();
+    }
+    else
+    {
+        HoneycombMeshGenerator generator(22, 15);
+        MutableMesh<2,2>* p_generating_mesh = generator.GetMesh();
+        NodesOnlyMesh<2> mesh;
+        mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
+        std::vector<CellPtr> cells;
+        CreateCells(mesh.GetNumNodes(), cells);
+        NodeBasedCellPopulation<2> cell_population(mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("MyDeltaNotchBenchmark/node_run");
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
+        simulator.SetEndTime(endTime);
+        MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+        MAKE_PTR(GeneralisedLinearSpringForce<2>, p_force);
+        p_force->SetCutOffLength(1.5);
+        simulator.AddForce(p_force);
+
+        start = GetWallTime();
+        simulator.Solve();
+        num_cells = cell_population.GetNumRealCells();
+        num_steps = SimulationTime::Instance()->GetTimeStepsElapsed();
+    }
+    Report(vertexBased ? "vertex_run" : "node_run", num_cells, num_steps, GetWallTime() - start);
+}
+
+/**
+ * Parse a comma-separated list of tissue sizes.
+ *
+ * @param rSizes the sizes, for example "22x15,100x100"
+ * @return the width and height of each size.
+ */
+std::vector<std::pair<unsigned, unsigned> > ParseSizes(const std::string& rSizes)
+{
+    std::vector<std::pair<unsigned, unsigned> > sizes;
+    std::stringstream sizes_stream(rSizes);
+    std::string size;
+    while (std::getline(sizes_stream, size, ','))
+    {
+        std::stringstream size_stream(size);
+        unsigned width = 0;
+        unsigned height = 0;
+        char separator = 0;
+        if (!(size_stream >> width >> separator >> height) || separator != 'x' || width == 0 || height == 0)
+        {
+            EXCEPTION("Tissue sizes must be given as <width>x<height>, not '" << size << "'.");
+        }
+        sizes.push_back(std::make_pair(width, height));
+    }
+    return sizes;
+}
+
+int main(int argc, char *argv[])
+{
+    // This sets up PETSc and prints out copyright information, etc.
+    ExecutableSupport::StandardStartup(&argc, &argv);
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        std::vector<std::pair<unsigned, unsigned> > sizes = ParseSizes("22x15,100x100,316x316,1000x1000");
+        double end_time = 1.0;
+        std::string csv_file;
+        bool bad_arguments = false;
+        for (int i=1; i<argc; i++)
+        {
+            std::string arg(argv[i]);
+            if (arg == "--sizes" && i+1 < argc)
+            {
+                sizes = ParseSizes(argv[++i]);
+            }
+            else if (arg == "--end-time" && i+1 < argc)
+            {
+                std::stringstream end_time_stream(argv[++i]);
+                bad_arguments |= !(end_time_stream >> end_time) || end_time <= 0.0;
+            }
+            else if (arg == "--csv" && i+1 < argc)
+            {
+                csv_file = argv[++i];
+            }
+            else
+            {
+                bad_arguments = true;
+            }
+        }
+
+        if (bad_arguments)
+        {
+            ExecutableSupport::PrintError("Usage: MyDeltaNotchBenchmark [--sizes <W>x<H>[,<W>x<H>...]] [--end-time <time>] [--csv <file>]", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else if (PetscTools::AmMaster())
+        {
+            std::cout << std::left << std::setw(28) << "benchmark" << std::right
+                      << std::setw(10) << "cells" << std::setw(10) << "steps" << std::setw(14) << "seconds"
+                      << std::setw(16) << "ns/cell/step" << std::setw(14) << "peak MB" << std::endl;
+
+            BenchmarkRhs();
+            BenchmarkRungeKutta4Step();
+            std::sort(sizes.begin(), sizes.end());
+            for (unsigned i=0; i<sizes.size(); i++)
+            {
+                BenchmarkUpdateCellData(sizes[i].first, sizes[i].second);
+            }
+            BenchmarkFullRun(false, end_time);
+            BenchmarkFullRun(true, end_time);
+
+            if (!csv_file.empty())
+            {
+                std::ofstream csv(csv_file.c_str());
+                if (!csv.is_open())
+                {
+                    EXCEPTION("Could not open " << csv_file);
+                }
+                csv << "benchmark,cells,steps,seconds,ns_per_cell_step,peak_memory_mb\n";
+                for (unsigned i=0; i<gResults.size(); i++)
+                {
+                    const BenchmarkResult& r_result = gResults[i];
+                    csv << r_result.name << "," << r_result.numCells << "," << r_result.numSteps << ","
+                        << r_result.seconds << "," << 1e9*r_result.seconds/(double(r_result.numCells)*r_result.numSteps)
+                        << "," << r_result.peakMemory << "\n";
+                }
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    // End by finalizing PETSc, and returning a suitable exit code.
+    ExecutableSupport::FinalizePetsc();
+    return exit_code;
+}
@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/**
+ * @file
+ *
+ * Runs a sweep of independent Delta-Notch simulations over seeds, tissue sizes and kinetic
+ * parameters, several at a time, and writes one summary line per run.
+ *
+ * Usage: MyDeltaNotchSweep <specification file> <summary file> [number of processes]
+ *
+ * See MyDeltaNotchSweepSpecification for the format of the specification. By default one
+ * simulation is run per available core, each in a process forked from this one (see
+ * MyDeltaNotchProcessPool). Since MPI does not support forking, PETSc is never initialised:
+ * each simulation runs sequentially, and the program must not be launched with mpirun. The
+ * summary is a CSV file
+ * whose columns are described in MyDeltaNotchSweepSimulation; runs that fail are reported on
+ * standard error and have no line.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "ExecutableSupport.hpp"
+#include "Exception.hpp"
+
+#include "MyDeltaNotchProcessPool.hpp"
+#include "MyDeltaNotchSweepSimulation.hpp"
+#include "MyDeltaNotchSweepSpecification.hpp"
+
+/**
+ * @return whether this process appears to have been launched by an MPI process manager,
+ * judging by the environment variables that common implementations set.
+ */
+bool IsLaunchedUnderMpi()
+{
+    return std::getenv("OMPI_COMM_WORLD_SIZE") != NULL
+           || std::getenv("PMI_SIZE") != NULL
+           || std::getenv("PMIX_RANK") != NULL;
+}
+
+/**
+ * Run one simulation of the sweep.
+ *
+ * @param pSpecification the sweep
+ * @param index the index of the run
+ * @return the summary line of the run.
+ */
+std::string RunSweepSimulation(const MyDeltaNotchSweepSpecification* pSpecification, unsigned index)
+{
+    return MyDeltaNotchSweepSimulation::Run(pSpecification->GetRun(index), "MyDeltaNotchSweep");
+}
+
+int main(int argc, char *argv[])
+{
+    // PETSc (and so MPI) is deliberately not started, since the simulations are run in forked processes
+    ExecutableSupport::ShowCopyright();
+
+    int exit_code = ExecutableSupport::EXIT_OK;
+
+    try
+    {
+        if (argc < 3 || argc > 4)
+        {
+            ExecutableSupport::PrintError("Usage: MyDeltaNotchSweep <specification file> <summary file> [number of processes]", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else if (IsLaunchedUnderMpi())
+        {
+            ExecutableSupport::PrintError("MyDeltaNotchSweep runs its own pool of processes, so must not be run under MPI.", true);
+            exit_code = ExecutableSupport::EXIT_BAD_ARGUMENTS;
+        }
+        else
+        {
+            MyDeltaNotchSweepSpecification specification((std::string(argv[1])));
+
+            unsigned num_processes = 0;
+            if (argc == 4)
+            {
+                std::istringstream num_processes_stream(argv[3]);
+                if (!(num_processes_stream >> num_processes))
+                {
+                    EXCEPTION("The number of processes must be a non-negative integer.");
+                }
+            }
+            MyDeltaNotchProcessPool pool(num_processes);
+
+            std::ofstream summary(argv[2]);
+            if (!summary.is_open())
+            {
+                EXCEPTION("Could not open the summary file " << argv[2]);
+            }
+            summary << MyDeltaNotchSweepSimulation::GetSummaryHeader(specification.rGetParameterNames()) << "\n";
+
+            std::cout << "Running " << specification.GetNumRuns() << " simulations on "
+                      << pool.GetNumProcesses() << " processes" << std::endl;
+            pool.Run(specification.GetNumRuns(),
+                     std::bind(&RunSweepSimulation, &specification, std::placeholders::_1),
+                     summary);
+
+            const std::vector<std::pair<unsigned, std::string> >& r_failed_jobs = pool.rGetFailedJobs();
+            for (unsigned i=0; i<r_failed_jobs.size(); i++)
+            {
+                std::stringstream message;
+                message << "Run " << r_failed_jobs[i].first << " failed: " << r_failed_jobs[i].second;
+                ExecutableSupport::PrintError(message.str());
+            }
+            if (!r_failed_jobs.empty())
+            {
+                exit_code = ExecutableSupport::EXIT_ERROR;
+            }
+        }
+    }
+    catch (const Exception& e)
+    {
+        ExecutableSupport::PrintError(e.GetMessage());
+        exit_code = ExecutableSupport::EXIT_ERROR;
+    }
+
+    return exit_code;
+}
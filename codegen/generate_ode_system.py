@@ -0,0 +1,865 @@
+"""Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+Generate a Chaste ODE system class from a reaction description.
+
+Usage: generate_ode_system.py <description> <output directory>
+
+The class is named after the description file, so models/MyShimizuOdeSystem.ode gives
+MyShimizuOdeSystem.hpp and MyShimizuOdeSystem.cpp. A description is a list of declarations,
+one per line, with # starting a comment:
+
+    state <name> "<display name>" <units> = <default initial condition>
+    parameter <name> "<display name>" <units> = <default value>
+    constant <name> = <value>
+    define <name> = <expression>
+    flux <name>: <reactants> -> <products> = <rate expression>
+
+State variables and parameters are numbered in the order they are declared; parameters can be
+changed at run time with SetParameter(), while constants are compiled into the kernels. Defines
+name intermediate expressions. Each flux converts its reactants to its products at the given rate;
+either side may be empty, and a species may be preceded by an integer stoichiometry, as in
+"2 a + b -> c". The rate of change of each state variable is assembled from the fluxes, and the
+analytic Jacobian is found by differentiating each define and flux with respect to the state
+variables, keeping the intermediate names so that the generated code shares subexpressions as
+hand-written code would.
+
+Expressions use Python syntax: + - * / **, unary minus, the functions exp, log, sqrt, pow, fabs,
+min and max, comparisons combined with and/or/not, and conditional expressions
+"a if condition else b", which become selects in C++.
+"""
+
+import ast
+import os
+import re
+import sys
+
+
+class DescriptionError(Exception):
+    """An error in a reaction description, with the line on which it was found."""
+
+    def __init__(self, line_number, message):
+        Exception.__init__(self, 'line %d: %s' % (line_number, message))
+
+
+# Expressions are tuples: ('num', value), ('sym', name), ('neg', a), ('+', a, b), ('-', a, b),
+# ('*', a, b), ('/', a, b), ('call', function, [arguments]), ('if', condition, a, b), and for
+# conditions ('cmp', operator, a, b), ('and', a, b), ('or', a, b) and ('not', a).
+
+ZERO = ('num', 0.0)
+ONE = ('num', 1.0)
+
+FUNCTIONS = {'exp': 1, 'log': 1, 'sqrt': 1, 'pow': 2, 'fabs': 1, 'min': 2, 'max': 2}
+
+
+def is_num(expr, value=None):
+    return expr[0] == 'num' and (value is None or expr[1] == value)
+
+
+def neg(a):
+    if is_num(a):
+        return ('num', -a[1])
+    if a[0] == 'neg':
+        return a[1]
+    return ('neg', a)
+
+
+def add(a, b):
+    if is_num(a, 0.0):
+        return b
+    if is_num(b, 0.0):
+        return a
+    if is_num(a) and is_num(b):
+        return ('num', a[1] + b[1])
+    if b[0] == 'neg':
+        return sub(a, b[1])
+    return ('+', a, b)
+
+
+def sub(a, b):
+    if is_num(b, 0.0):
+        return a
+    if is_num(a, 0.0):
+        return neg(b)
+    if is_num(a) and is_num(b):
+        return ('num', a[1] - b[1])
+    if b[0] == 'neg':
+        return add(a, b[1])
+    return ('-', a, b)
+
+
+def mul(a, b):
+    if is_num(a, 0.0) or is_num(b, 0.0):
+        return ZERO
+    if is_num(a, 1.0):
+        return b
+    if is_num(b, 1.0):
+        return a
+    if is_num(a, -1.0):
+        return neg(b)
+    if is_num(b, -1.0):
+        return neg(a)
+    if is_num(a) and is_num(b):
+        return ('num', a[1] * b[1])
+    if a[0] == 'neg':
+        return neg(mul(a[1], b))
+    if b[0] == 'neg':
+        return neg(mul(a, b[1]))
+    return ('*', a, b)
+
+
+def div(a, b):
+    if is_num(a, 0.0):
+        return ZERO
+    if is_num(b, 1.0):
+        return a
+    if is_num(a) and is_num(b) and b[1] != 0.0:
+        return ('num', a[1] / b[1])
+    if a[0] == 'neg':
+        return neg(div(a[1], b))
+    return ('/', a, b)
+
+
+def select(condition, a, b):
+    if a == b:
+        return a
+    return ('if', condition, a, b)
+
+
+def call(function, arguments):
+    return ('call', function, arguments)
+
+
+def derivative(expr, variable, rDerivativeOf):
+    """
+    Differentiate an expression with respect to a state variable.
+
+    :param expr: the expression
+    :param variable: the name of the state variable
+    :param rDerivativeOf: a function giving the derivative of a symbol, which for a define
+        is the symbol of its own (already computed) derivative
+    """
+    kind = expr[0]
+    if kind == 'num':
+        return ZERO
+    if kind == 'sym':
+        return rDerivativeOf(expr[1], variable)
+    if kind == 'neg':
+        return neg(derivative(expr[1], variable, rDerivativeOf))
+    if kind in ('+', '-'):
+        da = derivative(expr[1], variable, rDerivativeOf)
+        db = derivative(expr[2], variable, rDerivativeOf)
+        return add(da, db) if kind == '+' else sub(da, db)
+    if kind == '*':
+        a, b = expr[1], expr[2]
+        return add(mul(derivative(a, variable, rDerivativeOf), b), mul(a, derivative(b, variable, rDerivativeOf)))
+    if kind == '/':
+        a, b = expr[1], expr[2]
+        da = derivative(a, variable, rDerivativeOf)
+        db = derivative(b, variable, rDerivativeOf)
+        if is_num(db, 0.0):
+            return div(da, b)
+        return div(sub(mul(da, b), mul(a, db)), mul(b, b))
+    if kind == 'if':
+        return select(expr[1], derivative(expr[2], variable, rDerivativeOf),
+                      derivative(expr[3], variable, rDerivativeOf))
+    if kind == 'call':
+        function, arguments = expr[1], expr[2]
+        du = derivative(arguments[0], variable, rDerivativeOf)
+        u = arguments[0]
+        if function == 'exp':
+            return mul(expr, du)
+        if function == 'log':
+            return div(du, u)
+        if function == 'sqrt':
+            return div(du, mul(('num', 2.0), expr))
+        if function == 'fabs':
+            return select(('cmp', '>=', u, ZERO), du, neg(du))
+        if function in ('min', 'max'):
+            dv = derivative(arguments[1], variable, rDerivativeOf)
+            return select(('cmp', '<=' if function == 'min' else '>=', u, arguments[1]), du, dv)
+        if function == 'pow':
+            v = arguments[1]
+            dv = derivative(v, variable, rDerivativeOf)
+            if is_num(dv, 0.0):
+                if is_num(v):
+                    return mul(mul(v, call('pow', [u, ('num', v[1] - 1.0)])), du)
+                return mul(mul(v, call('pow', [u, sub(v, ONE)])), du)
+            return mul(expr, add(mul(dv, call('log', [u])), div(mul(v, du), u)))
+    raise ValueError('cannot differentiate %r' % (expr,))
+
+
+def convert(node, line_number):
+    """Convert a Python AST node to an expression."""
+    if isinstance(node, ast.Constant) and isinstance(node.value, (int, float)) and not isinstance(node.value, bool):
+        return ('num', float(node.value))
+    if isinstance(node, ast.Name):
+        return ('sym', node.id)
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.USub):
+        return neg(convert(node.operand, line_number))
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.UAdd):
+        return convert(node.operand, line_number)
+    if isinstance(node, ast.UnaryOp) and isinstance(node.op, ast.Not):
+        return ('not', convert(node.operand, line_number))
+    if isinstance(node, ast.BinOp):
+        a = convert(node.left, line_number)
+        b = convert(node.right, line_number)
+        operators = {ast.Add: add, ast.Sub: sub, ast.Mult: mul, ast.Div: div}
+        for operator_type, build in operators.items():
+            if isinstance(node.op, operator_type):
+                return build(a, b)
+        if isinstance(node.op, ast.Pow):
+            return call('pow', [a, b])
+    if isinstance(node, ast.IfExp):
+        return select(convert(node.test, line_number), convert(node.body, line_number),
+                      convert(node.orelse, line_number))
+    if isinstance(node, ast.Compare) and len(node.ops) == 1:
+        symbols = {ast.Lt: '<', ast.LtE: '<=', ast.Gt: '>', ast.GtE: '>=', ast.Eq: '==', ast.NotEq: '!='}
+        for operator_type, symbol in symbols.items():
+            if isinstance(node.ops[0], operator_type):
+                return ('cmp', symbol, convert(node.left, line_number), convert(node.comparators[0], line_number))
+    if isinstance(node, ast.BoolOp):
+        kind = 'and' if isinstance(node.op, ast.And) else 'or'
+        result = convert(node.values[0], line_number)
+        for value in node.values[1:]:
+            result = (kind, result, convert(value, line_number))
+        return result
+    if isinstance(node, ast.Call) and isinstance(node.func, ast.Name) and not node.keywords:
+        function = node.func.id
+        if function not in FUNCTIONS:
+            raise DescriptionError(line_number, 'unknown function "%s"' % function)
+        if len(node.args) != FUNCTIONS[function]:
+            raise DescriptionError(line_number, '%s() takes %d arguments' % (function, FUNCTIONS[function]))
+        return call(function, [convert(argument, line_number) for argument in node.args])
+    raise DescriptionError(line_number, 'unsupported expression "%s"' % ast.dump(node))
+
+
+def parse_expression(text, line_number):
+    try:
+        tree = ast.parse(text.strip(), mode='eval')
+    except SyntaxError:
+        raise DescriptionError(line_number, 'cannot parse expression "%s"' % text.strip())
+    return convert(tree.body, line_number)
+
+
+def symbols_in(expr, rSymbols):
+    """Add the names of the symbols in an expression to a set."""
+    if expr[0] == 'sym':
+        rSymbols.add(expr[1])
+    elif expr[0] == 'num':
+        pass
+    elif expr[0] in ('cmp',):
+        symbols_in(expr[2], rSymbols)
+        symbols_in(expr[3], rSymbols)
+    elif expr[0] == 'call':
+        for argument in expr[2]:
+            symbols_in(argument, rSymbols)
+    else:
+        for child in expr[1:]:
+            symbols_in(child, rSymbols)
+
+
+PRECEDENCE = {'if': 1, 'or': 2, 'and': 3, 'cmp': 4, '+': 5, '-': 5, '*': 6, '/': 6, 'neg': 7, 'not': 7,
+              'num': 8, 'sym': 8, 'call': 8}
+
+
+def to_cpp(expr, parent_precedence=0, right_operand=False):
+    """Print an expression as C++, with only the parentheses that are needed."""
+    kind = expr[0]
+    precedence = PRECEDENCE[kind]
+    if kind == 'num':
+        text = repr(expr[1])
+        if 'e' not in text and '.' not in text and 'inf' not in text:
+            text += '.0'
+        if expr[1] < 0.0:
+            precedence = PRECEDENCE['neg']
+    elif kind == 'sym':
+        text = expr[1]
+    elif kind == 'neg':
+        text = '-' + to_cpp(expr[1], precedence)
+    elif kind == 'not':
+        text = '!' + to_cpp(expr[1], precedence)
+    elif kind in ('+', '-', '*', '/'):
+        text = '%s %s %s' % (to_cpp(expr[1], precedence), kind, to_cpp(expr[2], precedence, True))
+        if kind in ('*', '/'):
+            text = '%s%s%s' % (to_cpp(expr[1], precedence), kind, to_cpp(expr[2], precedence, True))
+    elif kind in ('and', 'or'):
+        text = '%s %s %s' % (to_cpp(expr[1], precedence), '&&' if kind == 'and' else '||',
+                             to_cpp(expr[2], precedence, True))
+    elif kind == 'cmp':
+        text = '%s %s %s' % (to_cpp(expr[2], precedence + 1), expr[1], to_cpp(expr[3], precedence + 1))
+    elif kind == 'call':
+        function = {'min': 'std::min', 'max': 'std::max'}.get(expr[1], expr[1])
+        text = '%s(%s)' % (function, ', '.join(to_cpp(argument) for argument in expr[2]))
+    elif kind == 'if':
+        text = '(%s) ? %s : %s' % (to_cpp(expr[1]), to_cpp(expr[2], precedence + 1), to_cpp(expr[3], precedence))
+    else:
+        raise ValueError('cannot print %r' % (expr,))
+    # Operators of equal precedence associate to the left, so a right operand needs parentheses
+    if precedence < parent_precedence or (right_operand and precedence == parent_precedence and precedence < 8):
+        text = '(' + text + ')'
+    return text
+
+
+class Model(object):
+    """A parsed reaction description."""
+
+    def __init__(self, class_name):
+        self.class_name = class_name
+        self.states = []          # (name, display name, units, initial condition)
+        self.parameters = []      # (name, display name, units, default value)
+        self.constants = []       # (name, value)
+        self.defines = []         # (name, expression), including the flux rates, in order
+        self.fluxes = []          # (name, {species: stoichiometry change})
+        self.comments = []        # leading comment lines, used to document the class
+
+    def names(self):
+        return ([state[0] for state in self.states] + [parameter[0] for parameter in self.parameters]
+                + [constant[0] for constant in self.constants] + [define[0] for define in self.defines])
+
+
+IDENTIFIER = r'[A-Za-z_][A-Za-z0-9_]*'
+CPP_RESERVED = {'double', 'int', 'unsigned', 'const', 'return', 'if', 'else', 'for', 'while', 'class', 'new',
+                'delete', 'this', 'time', 'pY', 'pDY', 'pParameters', 'pJacobian', 'std'}
+
+
+def parse_species(text, line_number, state_names):
+    """Parse one side of a flux, such as "2 a + b", into a list of (species, stoichiometry)."""
+    result = []
+    if not text.strip():
+        return result
+    for term in text.split('+'):
+        match = re.match(r'^\s*(\d+)?\s*(%s)\s*$' % IDENTIFIER, term)
+        if not match:
+            raise DescriptionError(line_number, 'cannot parse species "%s"' % term.strip())
+        name = match.group(2)
+        if name not in state_names:
+            raise DescriptionError(line_number, '"%s" is not a state variable' % name)
+        result.append((name, int(match.group(1) or 1)))
+    return result
+
+
+def parse_description(path):
+    class_name = os.path.splitext(os.path.basename(path))[0]
+    if not re.match('^%s$' % IDENTIFIER, class_name):
+        raise DescriptionError(0, 'the file name "%s" is not a valid class name' % class_name)
+    model = Model(class_name)
+    declared = set()
+
+    def declare(name, line_number):
+        if name in declared:
+            raise DescriptionError(line_number, '"%s" is declared twice' % name)
+        if name in CPP_RESERVED or name in FUNCTIONS:
+            raise DescriptionError(line_number, '"%s" is a reserved name' % name)
+        declared.add(name)
+
+    def check_defined(expr, line_number):
+        used = set()
+        symbols_in(expr, used)
+        for name in sorted(used - declared):
+            raise DescriptionError(line_number, '"%s" is used before it is declared' % name)
+
+    seen_declaration = False
+    with open(path) as description:
+        for line_number, line in enumerate(description, 1):
+            if line.lstrip().startswith('#') and not seen_declaration:
+                model.comments.append(line.lstrip()[1:].strip())
+            line = line.split('#', 1)[0].strip()
+            if not line:
+                continue
+            seen_declaration = True
+
+            match = re.match(r'^(state|parameter)\s+(%s)\s+"([^"]*)"\s+(\S+)\s*=\s*(.+)$' % IDENTIFIER, line)
+            if match:
+                kind, name, display_name, units, value = match.groups()
+                declare(name, line_number)
+                value_expr = parse_expression(value, line_number)
+                if not is_num(value_expr):
+                    raise DescriptionError(line_number, 'the default value of "%s" must be a number' % name)
+                entry = (name, display_name, units, value_expr[1])
+                if kind == 'state':
+                    if model.parameters or model.constants or model.defines:
+                        raise DescriptionError(line_number, 'state variables must be declared first')
+                    model.states.append(entry)
+                else:
+                    model.parameters.append(entry)
+                continue
+
+            match = re.match(r'^(constant|define)\s+(%s)\s*=\s*(.+)$' % IDENTIFIER, line)
+            if match:
+                kind, name, text = match.groups()
+                expr = parse_expression(text, line_number)
+                check_defined(expr, line_number)
+                declare(name, line_number)
+                if kind == 'constant':
+                    if not is_num(expr):
+                        raise DescriptionError(line_number, 'the value of constant "%s" must be a number' % name)
+                    model.constants.append((name, expr[1]))
+                else:
+                    model.defines.append((name, expr))
+                continue
+
+            match = re.match(r'^flux\s+(%s)\s*:\s*([^=]*?)\s*->\s*([^=]*?)\s*=\s*(.+)$' % IDENTIFIER, line)
+            if match:
+                name, reactants, products, text = match.groups()
+                state_names = [state[0] for state in model.states]
+                expr = parse_expression(text, line_number)
+                check_defined(expr, line_number)
+                declare(name, line_number)
+                changes = {}
+                for species, stoichiometry in parse_species(reactants, line_number, state_names):
+                    changes[species] = changes.get(species, 0) - stoichiometry
+                for species, stoichiometry in parse_species(products, line_number, state_names):
+                    changes[species] = changes.get(species, 0) + stoichiometry
+                model.defines.append((name, expr))
+                model.fluxes.append((name, changes))
+                continue
+
+            raise DescriptionError(line_number, 'cannot parse "%s"' % line)
+
+    if not model.states:
+        raise DescriptionError(0, 'there are no state variables')
+    return model
+
+
+class Kernel(object):
+    """The statements of a generated function: named intermediate values, then outputs."""
+
+    def __init__(self):
+        self.locals = []     # (name, expression, comment)
+        self.outputs = []    # (target, expression, comment)
+
+    def emit(self, model, parameters_pointer):
+        """
+        :return: the body of the function, declaring only the inputs and intermediates that are used
+        """
+        needed = set()
+        for _, expr, _ in self.outputs:
+            symbols_in(expr, needed)
+        # Walk the intermediates backwards to find those that are used
+        used_locals = []
+        for name, expr, comment in reversed(self.locals):
+            if name in needed:
+                symbols_in(expr, needed)
+                used_locals.append((name, expr, comment))
+        used_locals.reverse()
+
+        lines = []
+        for index, state in enumerate(model.states):
+            if state[0] in needed:
+                lines.append('    const double %s = pY[%d];' % (state[0], index))
+        for index, parameter in enumerate(model.parameters):
+            if parameter[0] in needed:
+                lines.append('    const double %s = %s[%d];' % (parameter[0], parameters_pointer, index))
+        for name, value in model.constants:
+            if name in needed:
+                lines.append('    const double %s = %s;' % (name, to_cpp(('num', value))))
+        lines.append('')
+        for name, expr, comment in used_locals:
+            if comment:
+                lines.append('    // %s' % comment)
+            lines.append('    const double %s = %s;' % (name, to_cpp(expr)))
+        lines.append('')
+        for target, expr, comment in self.outputs:
+            if comment:
+                lines.append('    // %s' % comment)
+            lines.append('    %s = %s;' % (target, to_cpp(expr)))
+        while lines and lines[0] == '':
+            lines.pop(0)
+        return '\n'.join(line for index, line in enumerate(lines)
+                         if line != '' or (index > 0 and lines[index - 1] != ''))
+
+
+def rate_expressions(model):
+    """:return: for each state variable, its rate as a sum of flux symbols, with a description."""
+    rates = []
+    for state in model.states:
+        expr = ZERO
+        terms = []
+        for flux_name, changes in model.fluxes:
+            change = changes.get(state[0], 0)
+            if change:
+                term = ('sym', flux_name) if abs(change) == 1 else mul(('num', float(abs(change))), ('sym', flux_name))
+                expr = add(expr, term) if change > 0 else sub(expr, term)
+                terms.append('%s%s%s' % ('+' if change > 0 else '-', '' if abs(change) == 1 else '%d*' % abs(change),
+                                          flux_name))
+        description = ' '.join(terms).lstrip('+') if terms else '0'
+        rates.append((expr, 'd[%s]/dt = %s' % (state[1], description.replace('-', '- ').replace('+', '+ '))))
+    return rates
+
+
+def build_rhs_kernel(model):
+    kernel = Kernel()
+    flux_names = set(flux[0] for flux in model.fluxes)
+    for name, expr in model.defines:
+        kernel.locals.append((name, expr, ''))
+    for index, (expr, comment) in enumerate(rate_expressions(model)):
+        kernel.outputs.append(('pDY[%d]' % index, expr, comment))
+    return kernel
+
+
+def build_jacobian_kernel(model):
+    """Differentiate every define and flux with respect to every state variable, by the chain rule."""
+    kernel = Kernel()
+    state_names = [state[0] for state in model.states]
+    derivative_symbols = {}
+
+    def derivative_of(name, variable):
+        if name == variable:
+            return ONE
+        return derivative_symbols.get((name, variable), ZERO)
+
+    for name, expr in model.defines:
+        kernel.locals.append((name, expr, ''))
+        for variable in state_names:
+            d_expr = derivative(expr, variable, derivative_of)
+            if is_num(d_expr) or d_expr[0] == 'sym' or (d_expr[0] == 'neg' and d_expr[1][0] == 'sym'):
+                # Cheap enough to substitute where it is used
+                if not is_num(d_expr, 0.0):
+                    derivative_symbols[(name, variable)] = d_expr
+            else:
+                local_name = 'd%s_d%s' % (name, variable)
+                kernel.locals.append((local_name, d_expr, ''))
+                derivative_symbols[(name, variable)] = ('sym', local_name)
+
+    size = len(model.states)
+    for row, (rate, comment) in enumerate(rate_expressions(model)):
+        first = True
+        for column, variable in enumerate(state_names):
+            entry = derivative(rate, variable, derivative_of)
+            if not is_num(entry, 0.0):
+                kernel.outputs.append(('pJacobian[%d]' % (row*size + column), entry, comment if first else ''))
+                first = False
+    return kernel
+
+
+def constant_name(name):
+    return re.sub('[^A-Z0-9]+', '_', name.upper()).strip('_')
+
+
+LICENCE = '/*\n\n' + __doc__[:__doc__.index('DAMAGE.') + len('DAMAGE.')] + '\n\n*/\n'
+
+HEADER_TEMPLATE = '''{licence}
+// Generated by codegen/generate_ode_system.py from {description}; edit that instead.
+
+#ifndef {guard}_HPP_
+#define {guard}_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include <array>
+#include <vector>
+
+#include "AbstractOdeSystemWithAnalyticJacobian.hpp"
+#include "MyFixedSizeOdeSystem.hpp"
+
+/**
+{class_comment}
+ *
+ * The RHS and analytic Jacobian are generated from the reaction description {description}.
+ * All instances share one system information object.
+ */
+class {name} : public AbstractOdeSystemWithAnalyticJacobian, public MyFixedSizeOdeSystem<{size}>
+{{
+private:
+
+    friend class boost::serialization::access;
+    /**
+     * Serialize the object and its member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {{
+        archive & boost::serialization::base_object<AbstractOdeSystemWithAnalyticJacobian>(*this);
+    }}
+
+public:
+
+    /** The number of state variables. */
+    static const unsigned NUM_STATE_VARIABLES = {size};
+
+    /** The number of parameters. */
+    static const unsigned NUM_PARAMETERS = {num_parameters};
+{parameter_indices}
+    /**
+     * Default constructor.
+     *
+     * @param stateVariables optional initial conditions for state variables (the defaults are used if empty)
+     */
+    {name}(std::vector<double> stateVariables=std::vector<double>());
+
+    /**
+     * Destructor.
+     */
+    ~{name}();
+
+    /**
+     * Compute the RHS of the ODE system.
+     *
+     * @param time used to evaluate the RHS.
+     * @param rY value of the solution vector used to evaluate the RHS.
+     * @param rDY filled in with the resulting derivatives.
+     */
+    void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY);
+
+    /**
+     * Compute the RHS of the system on fixed-size arrays, as EvaluateYDerivatives() does.
+     *
+     * @param time used to evaluate the RHS.
+     * @param rY value of the solution vector used to evaluate the RHS.
+     * @param rDY filled in with the resulting derivatives.
+     */
+    void EvaluateFixedSizeYDerivatives(double time, const std::array<double, {size}>& rY, std::array<double, {size}>& rDY);
+
+    /**
+     * Compute the matrix I - timeStep*J, where J is the analytic Jacobian of the
+     * RHS with respect to the state variables. This is the form expected by
+     * Chaste's implicit solvers.
+     *
+     * @param rSolutionGuess the state variables at which to evaluate the Jacobian
+     * @param jacobian filled in with the matrix I - timeStep*J
+     * @param time the current time
+     * @param timeStep the multiple of J to subtract from the identity
+     */
+    void AnalyticJacobian(const std::vector<double>& rSolutionGuess, double** jacobian, double time, double timeStep);
+
+    /**
+     * Compute the RHS of the system.
+     *
+     * @param pY pointer to the {size} state variables
+     * @param pParameters pointer to the {num_parameters} parameters
+     * @param pDY filled in with the {size} resulting derivatives
+     */
+    static void EvaluateRhs(const double* pY, const double* pParameters, double* pDY);
+
+    /**
+     * Compute the Jacobian of the RHS with respect to the state variables.
+     *
+     * @param pY pointer to the {size} state variables
+     * @param pParameters pointer to the {num_parameters} parameters
+     * @param pJacobian filled in with the {size}x{size} Jacobian, in row-major order
+     */
+    static void EvaluateJacobian(const double* pY, const double* pParameters, double* pJacobian);
+}};
+
+// Declare identifier for the serializer
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT({name})
+
+namespace boost
+{{
+namespace serialization
+{{
+/**
+ * Serialize information required to construct a {name}.
+ */
+template<class Archive>
+inline void save_construct_data(
+    Archive & ar, const {name} * t, const unsigned int file_version)
+{{
+    const std::vector<double>& state_variables = t->rGetConstStateVariables();
+    ar & state_variables;
+}}
+
+/**
+ * De-serialize constructor parameters and initialise a {name}.
+ */
+template<class Archive>
+inline void load_construct_data(
+    Archive & ar, {name} * t, const unsigned int file_version)
+{{
+    std::vector<double> state_variables;
+    ar & state_variables;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t){name}(state_variables);
+}}
+}}
+}} // namespace ...
+
+#endif /*{guard}_HPP_*/
+'''
+
+SOURCE_TEMPLATE = '''{licence}
+// Generated by codegen/generate_ode_system.py from {description}; edit that instead.
+
+#include <algorithm>
+#include <cmath>
+
+#include "{name}.hpp"
+#include "CellwiseOdeSystemInformation.hpp"
+
+const unsigned {name}::NUM_STATE_VARIABLES;
+const unsigned {name}::NUM_PARAMETERS;
+{parameter_definitions}
+{name}::{name}(std::vector<double> stateVariables)
+    : AbstractOdeSystemWithAnalyticJacobian({size})
+{{
+    // Every instance has the same names, units and default initial conditions, so they share one object
+    static const boost::shared_ptr<AbstractOdeSystemInformation> p_shared_system_info(new CellwiseOdeSystemInformation<{name}>);
+    mpSystemInfo = p_shared_system_info;
+
+    this->mParameters.reserve(NUM_PARAMETERS);
+{parameter_defaults}
+    SetStateVariables(stateVariables.empty() ? GetInitialConditions() : stateVariables);
+}}
+
+{name}::~{name}()
+{{
+}}
+
+void {name}::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
+{{
+    EvaluateRhs(&rY[0], this->mParameters.data(), &rDY[0]);
+}}
+
+void {name}::EvaluateFixedSizeYDerivatives(double time, const std::array<double, {size}>& rY, std::array<double, {size}>& rDY)
+{{
+    EvaluateRhs(rY.data(), this->mParameters.data(), rDY.data());
+}}
+
+void {name}::AnalyticJacobian(const std::vector<double>& rSolutionGuess, double** jacobian, double time, double timeStep)
+{{
+    double rhs_jacobian[{size}*{size}];
+    EvaluateJacobian(&rSolutionGuess[0], this->mParameters.data(), rhs_jacobian);
+
+    for (unsigned i=0; i<{size}; i++)
+    {{
+        for (unsigned j=0; j<{size}; j++)
+        {{
+            jacobian[i][j] = (i == j ? 1.0 : 0.0) - timeStep*rhs_jacobian[{size}*i + j];
+        }}
+    }}
+}}
+
+void {name}::EvaluateRhs(const double* pY, const double* pParameters, double* pDY)
+{{
+{rhs_body}
+}}
+
+void {name}::EvaluateJacobian(const double* pY, const double* pParameters, double* pJacobian)
+{{
+    for (unsigned i=0; i<{size}*{size}; i++)
+    {{
+        pJacobian[i] = 0.0;
+    }}
+
+{jacobian_body}
+}}
+
+template<>
+void CellwiseOdeSystemInformation<{name}>::Initialise()
+{{
+{system_information}
+    this->mInitialised = true;
+}}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT({name})
+'''
+
+
+def generate(model, description_name):
+    """:return: the text of the header and source files for a model."""
+    class_comment = '\n'.join((' * ' + line).rstrip() for line in model.comments) or \
+        ' * An ODE system generated from a reaction description.'
+
+    parameter_indices = ''
+    parameter_definitions = ''
+    parameter_defaults = []
+    for index, (name, display_name, units, value) in enumerate(model.parameters):
+        parameter_indices += ('\n    /** The index of the "%s" parameter, for use with SetParameter() and GetParameter(). */\n'
+                              '    static const unsigned %s = %d;\n' % (display_name, constant_name(name), index))
+        parameter_definitions += 'const unsigned %s::%s;\n' % (model.class_name, constant_name(name))
+        parameter_defaults.append('    this->mParameters.push_back(%s); // %s' % (to_cpp(('num', value)), display_name))
+
+    system_information = []
+    for name, display_name, units, value in model.states:
+        system_information += ['    this->mVariableNames.push_back("%s");' % display_name,
+                               '    this->mVariableUnits.push_back("%s");' % units,
+                               '    this->mInitialConditions.push_back(%s);' % to_cpp(('num', value)), '']
+    for name, display_name, units, value in model.parameters:
+        system_information += ['    this->mParameterNames.push_back("%s");' % display_name,
+                               '    this->mParameterUnits.push_back("%s");' % units, '']
+
+    fields = dict(
+        licence=LICENCE,
+        description=description_name,
+        name=model.class_name,
+        guard=model.class_name.upper(),
+        class_comment=class_comment,
+        size=len(model.states),
+        num_parameters=len(model.parameters),
+        parameter_indices=parameter_indices,
+        parameter_definitions=parameter_definitions,
+        parameter_defaults='\n'.join(parameter_defaults),
+        rhs_body=build_rhs_kernel(model).emit(model, 'pParameters'),
+        jacobian_body=build_jacobian_kernel(model).emit(model, 'pParameters'),
+        system_information='\n'.join(system_information))
+    return HEADER_TEMPLATE.format(**fields), SOURCE_TEMPLATE.format(**fields)
+
+
+def write_if_changed(path, text):
+    """Write a file only if its contents change, so that dependent objects are not rebuilt needlessly."""
+    if os.path.exists(path):
+        with open(path) as existing:
+            if existing.read() == text:
+                return
+    with open(path, 'w') as output:
+        output.write(text)
+
+
+def main(argv):
+    if len(argv) != 3:
+        sys.stderr.write('Usage: %s <description> <output directory>\n' % argv[0])
+        return 1
+    description_path, output_directory = argv[1], argv[2]
+    try:
+        model = parse_description(description_path)
+    except DescriptionError as error:
+        sys.stderr.write('%s: %s\n' % (description_path, error))
+        return 1
+
+    if not os.path.isdir(output_directory):
+        os.makedirs(output_directory)
+    header, source = generate(model, os.path.basename(description_path))
+    write_if_changed(os.path.join(output_directory, model.class_name + '.hpp'), header)
+    write_if_changed(os.path.join(output_directory, model.class_name + '.cpp'), source)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
@@ -0,0 +1,209 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyAdaptiveStepState.hpp"
+#include "Exception.hpp"
+
+const double MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE = 1e-4;
+const double MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE = 1e-6;
+
+MyAdaptiveStepState::MyAdaptiveStepState()
+    : mRelativeTolerance(DEFAULT_RELATIVE_TOLERANCE),
+      mAbsoluteTolerance(DEFAULT_ABSOLUTE_TOLERANCE),
+      mNextStepSize(0.0),
+      mNumAcceptedSteps(0),
+      mNumRejectedSteps(0)
+{
+}
+
+void MyAdaptiveStepState::SetTolerances(double relTol, double absTol)
+{
+    if (relTol <= 0.0 || absTol <= 0.0)
+    {
+        EXCEPTION("The adaptive step tolerances must be positive.");
+    }
+    mRelativeTolerance = relTol;
+    mAbsoluteTolerance = absTol;
+}
+
+double MyAdaptiveStepState::GetRelativeTolerance() const
+{
+    return mRelativeTolerance;
+}
+
+double MyAdaptiveStepState::GetAbsoluteTolerance() const
+{
+    return mAbsoluteTolerance;
+}
+
+void MyAdaptiveStepState::SetNextStepSize(double nextStepSize)
+{
+    mNextStepSize = nextStepSize;
+}
+
+double MyAdaptiveStepState::GetNextStepSize() const
+{
+    return mNextStepSize;
+}
+
+unsigned MyAdaptiveStepState::GetNumAcceptedSteps() const
+{
+    return mNumAcceptedSteps;
+}
+
+unsigned MyAdaptiveStepState::GetNumRejectedSteps() const
+{
+    return mNumRejectedSteps;
+}
+
+void MyAdaptiveStepState::RecordAcceptedStep()
+{
+    mNumAcceptedSteps++;
+}
+
+void MyAdaptiveStepState::RecordRejectedStep()
+{
+    mNumRejectedSteps++;
+}
+
+void MyAdaptiveStepState::ResetStepCounters()
+{
+    mNumAcceptedSteps = 0;
+    mNumRejectedSteps = 0;
+}
+
+void MyAdaptiveStepState::SetStepCounters(unsigned numAcceptedSteps, unsigned numRejectedSteps)
+{
+    mNumAcceptedSteps = numAcceptedSteps;
+    mNumRejectedSteps = numRejectedSteps;
+}
+
+MyAdaptiveStepStateHolder::MyAdaptiveStepStateHolder()
+    : mpAdaptiveStepState(nullptr)
+{
+}
+
+MyAdaptiveStepStateHolder::MyAdaptiveStepStateHolder(const MyAdaptiveStepStateHolder& rOther)
+    : mpAdaptiveStepState(rOther.mpAdaptiveStepState ? new MyAdaptiveStepState(*rOther.mpAdaptiveStepState) : nullptr)
+{
+}
+
+MyAdaptiveStepStateHolder& MyAdaptiveStepStateHolder::operator=(const MyAdaptiveStepStateHolder& rOther)
+{
+    if (this != &rOther)
+    {
+        delete mpAdaptiveStepState;
+        mpAdaptiveStepState = rOther.mpAdaptiveStepState ? new MyAdaptiveStepState(*rOther.mpAdaptiveStepState) : nullptr;
+    }
+    return *this;
+}
+
+MyAdaptiveStepStateHolder::~MyAdaptiveStepStateHolder()
+{
+    delete mpAdaptiveStepState;
+}
+
+MyAdaptiveStepState& MyAdaptiveStepStateHolder::rGetAdaptiveStepState()
+{
+    if (!mpAdaptiveStepState)
+    {
+        mpAdaptiveStepState = new MyAdaptiveStepState;
+    }
+    return *mpAdaptiveStepState;
+}
+
+const MyAdaptiveStepState* MyAdaptiveStepStateHolder::GetAdaptiveStepState() const
+{
+    return mpAdaptiveStepState;
+}
+
+void MyAdaptiveStepStateHolder::SetTolerances(double relTol, double absTol)
+{
+    if (mpAdaptiveStepState
+        || relTol != MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE
+        || absTol != MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE)
+    {
+        rGetAdaptiveStepState().SetTolerances(relTol, absTol);
+    }
+}
+
+double MyAdaptiveStepStateHolder::GetRelativeTolerance() const
+{
+    return mpAdaptiveStepState ? mpAdaptiveStepState->GetRelativeTolerance() : MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE;
+}
+
+double MyAdaptiveStepStateHolder::GetAbsoluteTolerance() const
+{
+    return mpAdaptiveStepState ? mpAdaptiveStepState->GetAbsoluteTolerance() : MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE;
+}
+
+void MyAdaptiveStepStateHolder::SetNextStepSize(double nextStepSize)
+{
+    if (mpAdaptiveStepState || nextStepSize != 0.0)
+    {
+        rGetAdaptiveStepState().SetNextStepSize(nextStepSize);
+    }
+}
+
+double MyAdaptiveStepStateHolder::GetNextStepSize() const
+{
+    return mpAdaptiveStepState ? mpAdaptiveStepState->GetNextStepSize() : 0.0;
+}
+
+unsigned MyAdaptiveStepStateHolder::GetNumAcceptedSteps() const
+{
+    return mpAdaptiveStepState ? mpAdaptiveStepState->GetNumAcceptedSteps() : 0u;
+}
+
+unsigned MyAdaptiveStepStateHolder::GetNumRejectedSteps() const
+{
+    return mpAdaptiveStepState ? mpAdaptiveStepState->GetNumRejectedSteps() : 0u;
+}
+
+void MyAdaptiveStepStateHolder::ResetStepCounters()
+{
+    if (mpAdaptiveStepState)
+    {
+        mpAdaptiveStepState->ResetStepCounters();
+    }
+}
+
+void MyAdaptiveStepStateHolder::SetStepCounters(unsigned numAcceptedSteps, unsigned numRejectedSteps)
+{
+    if (mpAdaptiveStepState || numAcceptedSteps != 0u || numRejectedSteps != 0u)
+    {
+        rGetAdaptiveStepState().SetStepCounters(numAcceptedSteps, numRejectedSteps);
+    }
+}
@@ -0,0 +1,291 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYADAPTIVESTEPSTATE_HPP_
+#define MYADAPTIVESTEPSTATE_HPP_
+
+#include "ChasteSerialization.hpp"
+
+/**
+ * The per-system state of an adaptive ODE solver: the error tolerances, the
+ * step size to try next, and counters of accepted and rejected steps.
+ *
+ * Adaptive solvers such as MyDormandPrinceIvpOdeSolver are shared between
+ * all cells through a CellCycleModelOdeSolver singleton, so they cannot keep
+ * this state themselves. Instead an ODE system inherits from
+ * MyAdaptiveStepStateHolder, which owns one of these objects, and the solver
+ * finds it with a dynamic_cast. This lets each cell carry its own step size
+ * from one SimulateToCurrentTime() call to the next.
+ */
+class MyAdaptiveStepState
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mRelativeTolerance;
+        archive & mAbsoluteTolerance;
+        archive & mNextStepSize;
+        archive & mNumAcceptedSteps;
+        archive & mNumRejectedSteps;
+    }
+
+    /** The relative error tolerance. */
+    double mRelativeTolerance;
+
+    /** The absolute error tolerance. */
+    double mAbsoluteTolerance;
+
+    /** The step size to try first on the next solve, or 0 if the solver should choose one. */
+    double mNextStepSize;
+
+    /** The number of steps accepted since the counters were last reset. */
+    unsigned mNumAcceptedSteps;
+
+    /** The number of steps rejected since the counters were last reset. */
+    unsigned mNumRejectedSteps;
+
+public:
+
+    /** The default relative error tolerance, 1e-4. */
+    static const double DEFAULT_RELATIVE_TOLERANCE;
+
+    /** The default absolute error tolerance, 1e-6. */
+    static const double DEFAULT_ABSOLUTE_TOLERANCE;
+
+    /**
+     * Default constructor.
+     */
+    MyAdaptiveStepState();
+
+
+    /**
+     * Set the error tolerances. A step is accepted if the estimated error in each
+     * state variable y_i is less than absTol + relTol*|y_i|.
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetTolerances(double relTol, double absTol);
+
+    /**
+     * @return the relative error tolerance.
+     */
+    double GetRelativeTolerance() const;
+
+    /**
+     * @return the absolute error tolerance.
+     */
+    double GetAbsoluteTolerance() const;
+
+    /**
+     * Set the step size to try first on the next solve.
+     *
+     * @param nextStepSize the step size, or 0 to let the solver choose one
+     */
+    void SetNextStepSize(double nextStepSize);
+
+    /**
+     * @return the step size to try first on the next solve, or 0 if the solver should choose one.
+     */
+    double GetNextStepSize() const;
+
+    /**
+     * @return the number of steps accepted since the counters were last reset.
+     */
+    unsigned GetNumAcceptedSteps() const;
+
+    /**
+     * @return the number of steps rejected since the counters were last reset.
+     */
+    unsigned GetNumRejectedSteps() const;
+
+    /**
+     * Record that the solver has accepted a step.
+     */
+    void RecordAcceptedStep();
+
+    /**
+     * Record that the solver has rejected a step.
+     */
+    void RecordRejectedStep();
+
+    /**
+     * Reset the accepted and rejected step counters to zero.
+     */
+    void ResetStepCounters();
+
+    /**
+     * Set the accepted and rejected step counters, for example when restoring a checkpoint.
+     *
+     * @param numAcceptedSteps the number of steps accepted
+     * @param numRejectedSteps the number of steps rejected
+     */
+    void SetStepCounters(unsigned numAcceptedSteps, unsigned numRejectedSteps);
+};
+
+/**
+ * A base class for ODE systems that may be solved by an adaptive solver, holding the
+ * system's MyAdaptiveStepState.
+ *
+ * The state is only allocated when an adaptive solver first solves the system, or when
+ * it is given a value other than the default, so a system that is only ever solved with
+ * a fixed-step solver carries a single null pointer. Until then the getters report the
+ * default state: the default tolerances, no remembered step size and no steps taken.
+ */
+class MyAdaptiveStepStateHolder
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the member variables.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & mpAdaptiveStepState;
+    }
+
+    /** The adaptive step state, or NULL if it has not been needed yet. */
+    MyAdaptiveStepState* mpAdaptiveStepState;
+
+protected:
+
+    /**
+     * Default constructor, which does not allocate the state.
+     */
+    MyAdaptiveStepStateHolder();
+
+    /**
+     * Copy constructor, which copies the state if the other holder has one.
+     *
+     * @param rOther the holder to copy
+     */
+    MyAdaptiveStepStateHolder(const MyAdaptiveStepStateHolder& rOther);
+
+    /**
+     * Assignment operator, which copies the state if the other holder has one.
+     *
+     * @param rOther the holder to copy
+     * @return this holder
+     */
+    MyAdaptiveStepStateHolder& operator=(const MyAdaptiveStepStateHolder& rOther);
+
+    /**
+     * Destructor. Not virtual, since holders are never deleted through a pointer to this class.
+     */
+    ~MyAdaptiveStepStateHolder();
+
+public:
+
+    /**
+     * @return the adaptive step state, allocating it if need be.
+     */
+    MyAdaptiveStepState& rGetAdaptiveStepState();
+
+    /**
+     * @return the adaptive step state, or NULL if it has not been allocated.
+     */
+    const MyAdaptiveStepState* GetAdaptiveStepState() const;
+
+    /**
+     * Set the error tolerances (see MyAdaptiveStepState::SetTolerances()).
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetTolerances(double relTol, double absTol);
+
+    /**
+     * @return the relative error tolerance.
+     */
+    double GetRelativeTolerance() const;
+
+    /**
+     * @return the absolute error tolerance.
+     */
+    double GetAbsoluteTolerance() const;
+
+    /**
+     * Set the step size to try first on the next solve.
+     *
+     * @param nextStepSize the step size, or 0 to let the solver choose one
+     */
+    void SetNextStepSize(double nextStepSize);
+
+    /**
+     * @return the step size to try first on the next solve, or 0 if the solver should choose one.
+     */
+    double GetNextStepSize() const;
+
+    /**
+     * @return the number of steps accepted since the counters were last reset.
+     */
+    unsigned GetNumAcceptedSteps() const;
+
+    /**
+     * @return the number of steps rejected since the counters were last reset.
+     */
+    unsigned GetNumRejectedSteps() const;
+
+    /**
+     * Reset the accepted and rejected step counters to zero.
+     */
+    void ResetStepCounters();
+
+    /**
+     * Set the accepted and rejected step counters, for example when restoring a checkpoint.
+     *
+     * @param numAcceptedSteps the number of steps accepted
+     * @param numRejectedSteps the number of steps rejected
+     */
+    void SetStepCounters(unsigned numAcceptedSteps, unsigned numRejectedSteps);
+};
+
+#endif /*MYADAPTIVESTEPSTATE_HPP_*/
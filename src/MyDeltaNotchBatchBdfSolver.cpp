@@ -0,0 +1,600 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+constexpr double MyDeltaNotchBatchBdfSolver::MAX_STEP_RATIO;
+
+MyDeltaNotchBatchBdfSolver::MyDeltaNotchBatchBdfSolver()
+    : mpNeighbourGraph(nullptr),
+      mNewtonTolerance(1e-10),
+      mMaxNewtonIterations(10),
+      mLinearTolerance(1e-8),
+      mKrylovDimension(30),
+      mMaxLinearIterations(300),
+      mNumSteps(0),
+      mNumRejectedSteps(0),
+      mNumNewtonIterations(0),
+      mNumLinearIterations(0),
+      mMaxStepRatio(0.0),
+      mLastTimeStep(0.0),
+      mLastNextTimeStep(0.0),
+      mLastEndTime(0.0),
+      mpLastNeighbourGraph(nullptr),
+      mLastNumRebuilds(0)
+{
+}
+
+void MyDeltaNotchBatchBdfSolver::SetNeighbourGraph(const MyDeltaNotchNeighbourGraph* pNeighbourGraph)
+{
+    mpNeighbourGraph = pNeighbourGraph;
+}
+
+void MyDeltaNotchBatchBdfSolver::SetNewtonTolerance(double newtonTolerance)
+{
+    if (newtonTolerance <= 0.0)
+    {
+        EXCEPTION("The Newton tolerance must be positive.");
+    }
+    mNewtonTolerance = newtonTolerance;
+}
+
+double MyDeltaNotchBatchBdfSolver::GetNewtonTolerance() const
+{
+    return mNewtonTolerance;
+}
+
+void MyDeltaNotchBatchBdfSolver::SetLinearTolerance(double linearTolerance)
+{
+    if (linearTolerance <= 0.0)
+    {
+        EXCEPTION("The linear solver tolerance must be positive.");
+    }
+    mLinearTolerance = linearTolerance;
+}
+
+double MyDeltaNotchBatchBdfSolver::GetLinearTolerance() const
+{
+    return mLinearTolerance;
+}
+
+unsigned MyDeltaNotchBatchBdfSolver::GetNumSteps() const
+{
+    return mNumSteps;
+}
+
+unsigned MyDeltaNotchBatchBdfSolver::GetNumRejectedSteps() const
+{
+    return mNumRejectedSteps;
+}
+
+unsigned MyDeltaNotchBatchBdfSolver::GetNumNewtonIterations() const
+{
+    return mNumNewtonIterations;
+}
+
+unsigned MyDeltaNotchBatchBdfSolver::GetNumLinearIterations() const
+{
+    return mNumLinearIterations;
+}
+
+double MyDeltaNotchBatchBdfSolver::GetMaxStepRatio() const
+{
+    return mMaxStepRatio;
+}
+
+void MyDeltaNotchBatchBdfSolver::ResizeWorkingMemory(const MyDeltaNotchBatchOdeSystem& rSystem)
+{
+    const unsigned num_cells = rSystem.GetNumCells();
+    const unsigned size = MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES*num_cells;
+
+    mYPrevious.resize(size);
+    mYStart.resize(size);
+    mHistory.resize(size);
+    mRhs.resize(size);
+    mResidual.resize(size);
+    mUpdate.resize(size);
+    mJacobianBlocks.resize(36*num_cells);
+    mMeanDeltaDerivatives.resize(6*num_cells);
+    mPreconditionerBlocks.resize(36*num_cells);
+    mPreconditionerPivots.resize(6*num_cells);
+    mKrylovBasis.resize((mKrylovDimension + 1)*size);
+    mHessenberg.resize((mKrylovDimension + 1)*mKrylovDimension);
+    mGivensCosines.resize(mKrylovDimension);
+    mGivensSines.resize(mKrylovDimension);
+    mLeastSquaresRhs.resize(mKrylovDimension + 1);
+    mPreconditioned.resize(size);
+    mProduct.resize(size);
+    mNeighbourMeans.resize(num_cells);
+}
+
+void MyDeltaNotchBatchBdfSolver::Solve(MyDeltaNotchBatchOdeSystem& rSystem,
+                                       double startTime,
+                                       double endTime,
+                                       double timeStep)
+{
+    std::vector<double>& r_y = rSystem.rGetStateVariables();
+    ResizeWorkingMemory(rSystem);
+
+    /*
+     * The history of the previous solve may only be used if this one continues it: from the same state and
+     * time, with the same neighbours. Without a neighbour graph the caller may have changed the mean levels
+     * of Delta in between, and a rebuilt graph may have reordered, added or removed cells. If the Newton
+     * iteration fails, the step is halved until it succeeds, and is then doubled back up to the requested
+     * timestep; a solve that continues the previous one carries on from the timestep it reached. Stretching
+     * the last step of an interval to reach its end could then give a step three times the one before, so
+     * every step is also cut to MAX_STEP_RATIO times the previous one, within the range for which variable
+     * step BDF2 is stable.
+     */
+    const bool continues_last_solve = (mLastTimeStep > 0.0)
+                                      && (mpNeighbourGraph != nullptr)
+                                      && (mpNeighbourGraph == mpLastNeighbourGraph)
+                                      && (mpNeighbourGraph->GetNumRebuilds() == mLastNumRebuilds)
+                                      && (startTime == mLastEndTime)
+                                      && (r_y == mYLast);
+    double time = startTime;
+    double previous_time_step = continues_last_solve ? mLastTimeStep : 0.0;
+    double step = continues_last_solve ? std::min(timeStep, mLastNextTimeStep) : timeStep;
+
+    // If this solve fails, its history is not used
+    mLastTimeStep = 0.0;
+    TimeStepper stepper(startTime, endTime, timeStep);
+    while (!stepper.IsTimeAtEnd())
+    {
+        const double next_time = stepper.GetNextTime();
+        step = std::min(step, stepper.GetNextTimeStep());
+        while (time < next_time)
+        {
+            double this_step = (next_time - time < 1.5*step) ? next_time - time : step;
+            if (previous_time_step > 0.0 && this_step > MAX_STEP_RATIO*previous_time_step)
+            {
+                // Split what is left in two rather than leave a much shorter step to reach the end of the interval
+                this_step = MAX_STEP_RATIO*previous_time_step;
+                if (next_time - time < 1.5*this_step)
+                {
+                    this_step = 0.5*(next_time - time);
+                }
+            }
+            if (CalculateNextYValue(rSystem, this_step, previous_time_step, time, r_y))
+            {
+                time += this_step;
+                previous_time_step = this_step;
+                step = std::min(2.0*step, timeStep);
+            }
+            else
+            {
+                mNumRejectedSteps++;
+                step *= 0.5;
+                if (step < 1e-6*timeStep)
+                {
+                    EXCEPTION("The Newton iteration of MyDeltaNotchBatchBdfSolver did not converge in the step from time "
+                              << time << ", even with a timestep of " << 2.0*step << ".");
+                }
+            }
+        }
+        time = next_time;
+        stepper.AdvanceOneTimeStep();
+    }
+
+    if (mpNeighbourGraph != nullptr)
+    {
+        mLastTimeStep = previous_time_step;
+        mLastNextTimeStep = step;
+        mLastEndTime = endTime;
+        mpLastNeighbourGraph = mpNeighbourGraph;
+        mLastNumRebuilds = mpNeighbourGraph->GetNumRebuilds();
+        mYLast = r_y;
+    }
+}
+
+void MyDeltaNotchBatchBdfSolver::EvaluateYDerivatives(MyDeltaNotchBatchOdeSystem& rSystem,
+                                                      double time,
+                                                      const std::vector<double>& rY,
+                                                      std::vector<double>& rDY)
+{
+    if (mpNeighbourGraph)
+    {
+        // Delta is the last state variable, so its values for every cell are at the end of rY
+        const unsigned num_cells = rSystem.GetNumCells();
+        assert(mpNeighbourGraph->GetNumCells() == num_cells);
+        const unsigned delta_offset = (MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES - 1)*num_cells;
+        mDelta.assign(rY.begin() + delta_offset, rY.begin() + delta_offset + num_cells);
+        mpNeighbourGraph->ComputeNeighbourMeans(mDelta, rSystem.rGetMeanDelta());
+    }
+    rSystem.EvaluateYDerivatives(time, rY, rDY);
+}
+
+void MyDeltaNotchBatchBdfSolver::SetUpNewtonMatrix(MyDeltaNotchBatchOdeSystem& rSystem,
+                                                   const std::vector<double>& rY,
+                                                   double gamma)
+{
+    const unsigned num_cells = rSystem.GetNumCells();
+    const MyDeltaNotchParameters& r_parameters = rSystem.GetKineticParameters() ? *rSystem.GetKineticParameters()
+                                                                                : DEFAULT_MY_DELTA_NOTCH_PARAMETERS;
+    const std::vector<double>& r_mean_delta = rSystem.rGetMeanDelta();
+    const std::vector<double>& r_x_distance = rSystem.rGetXDistance();
+
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        double y[6];
+        for (unsigned var=0; var<6; var++)
+        {
+            y[var] = rY[var*num_cells + cell_index];
+        }
+        double* p_jacobian = &mJacobianBlocks[36*cell_index];
+        MyDeltaNotchOdeSystem::EvaluateShimizuJacobian(r_parameters, y, r_mean_delta[cell_index], r_x_distance[cell_index],
+                                                       p_jacobian, &mMeanDeltaDerivatives[6*cell_index]);
+
+        // Form the diagonal block I - gamma*J of the Newton matrix, and replace it with its LU factorisation in place
+        double* p_block = &mPreconditionerBlocks[36*cell_index];
+        unsigned* p_pivots = &mPreconditionerPivots[6*cell_index];
+        for (unsigned i=0; i<36; i++)
+        {
+            p_block[i] = -gamma*p_jacobian[i];
+        }
+        for (unsigned i=0; i<6; i++)
+        {
+            p_block[7*i] += 1.0;
+        }
+        for (unsigned col=0; col<6; col++)
+        {
+            unsigned pivot_row = col;
+            for (unsigned row=col+1; row<6; row++)
+            {
+                if (fabs(p_block[6*row + col]) > fabs(p_block[6*pivot_row + col]))
+                {
+                    pivot_row = row;
+                }
+            }
+            if (p_block[6*pivot_row + col] == 0.0)
+            {
+                EXCEPTION("The Newton matrix of MyDeltaNotchBatchBdfSolver is singular; try a smaller timestep.");
+            }
+            p_pivots[col] = pivot_row;
+            if (pivot_row != col)
+            {
+                for (unsigned j=0; j<6; j++)
+                {
+                    std::swap(p_block[6*col + j], p_block[6*pivot_row + j]);
+                }
+            }
+            for (unsigned row=col+1; row<6; row++)
+            {
+                double multiplier = p_block[6*row + col]/p_block[7*col];
+                p_block[6*row + col] = multiplier;
+                for (unsigned j=col+1; j<6; j++)
+                {
+                    p_block[6*row + j] -= multiplier*p_block[6*col + j];
+                }
+            }
+        }
+    }
+}
+
+void MyDeltaNotchBatchBdfSolver::MultiplyNewtonMatrix(const double* pX, double gamma, double* pResult)
+{
+    const unsigned num_cells = mNeighbourMeans.size();
+
+    // The coupling term only involves the Delta components, through their mean over each cell's neighbours
+    if (mpNeighbourGraph)
+    {
+        const double* p_delta = pX + (MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES - 1)*num_cells;
+        mDelta.assign(p_delta, p_delta + num_cells);
+        mpNeighbourGraph->ComputeNeighbourMeans(mDelta, mNeighbourMeans);
+    }
+
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        const double* p_jacobian = &mJacobianBlocks[36*cell_index];
+        for (unsigned row=0; row<6; row++)
+        {
+            double sum = 0.0;
+            for (unsigned j=0; j<6; j++)
+            {
+                sum += p_jacobian[6*row + j]*pX[j*num_cells + cell_index];
+            }
+            if (mpNeighbourGraph)
+            {
+                sum += mMeanDeltaDerivatives[6*cell_index + row]*mNeighbourMeans[cell_index];
+            }
+            pResult[row*num_cells + cell_index] = pX[row*num_cells + cell_index] - gamma*sum;
+        }
+    }
+}
+
+void MyDeltaNotchBatchBdfSolver::ApplyPreconditioner(double* pX)
+{
+    const unsigned num_cells = mNeighbourMeans.size();
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        const double* p_block = &mPreconditionerBlocks[36*cell_index];
+        const unsigned* p_pivots = &mPreconditionerPivots[6*cell_index];
+        double x[6];
+        for (unsigned var=0; var<6; var++)
+        {
+            x[var] = pX[var*num_cells + cell_index];
+        }
+
+        // Forward substitution with the unit lower triangle, applying the row swaps as we go
+        for (unsigned i=0; i<6; i++)
+        {
+            std::swap(x[i], x[p_pivots[i]]);
+            for (unsigned j=0; j<i; j++)
+            {
+                x[i] -= p_block[6*i + j]*x[j];
+            }
+        }
+
+        // Back substitution with the upper triangle
+        for (unsigned i=6; i-- > 0; )
+        {
+            for (unsigned j=i+1; j<6; j++)
+            {
+                x[i] -= p_block[6*i + j]*x[j];
+            }
+            x[i] /= p_block[7*i];
+        }
+
+        for (unsigned var=0; var<6; var++)
+        {
+            pX[var*num_cells + cell_index] = x[var];
+        }
+    }
+}
+
+void MyDeltaNotchBatchBdfSolver::SolveNewtonSystem(const std::vector<double>& rB, double gamma, std::vector<double>& rX)
+{
+    const unsigned size = rB.size();
+    const unsigned max_dimension = mKrylovDimension;
+    rX.assign(size, 0.0);
+
+    double b_norm = 0.0;
+    for (unsigned i=0; i<size; i++)
+    {
+        b_norm += rB[i]*rB[i];
+    }
+    b_norm = sqrt(b_norm);
+    const double target = mLinearTolerance*b_norm;
+
+    // Restarted GMRES with right preconditioning, so that the residual it minimises is that of the Newton system
+    unsigned num_iterations = 0;
+    double residual_norm = b_norm;
+    while (residual_norm > target && num_iterations < mMaxLinearIterations)
+    {
+        // The first basis vector is the normalised residual b - A x
+        double* p_v0 = &mKrylovBasis[0];
+        MultiplyNewtonMatrix(&rX[0], gamma, &mProduct[0]);
+        double beta = 0.0;
+        for (unsigned i=0; i<size; i++)
+        {
+            p_v0[i] = rB[i] - mProduct[i];
+            beta += p_v0[i]*p_v0[i];
+        }
+        beta = sqrt(beta);
+        if (beta <= target)
+        {
+            break;
+        }
+        for (unsigned i=0; i<size; i++)
+        {
+            p_v0[i] /= beta;
+        }
+        mLeastSquaresRhs.assign(max_dimension + 1, 0.0);
+        mLeastSquaresRhs[0] = beta;
+
+        unsigned dimension = 0;
+        while (dimension < max_dimension)
+        {
+            const unsigned j = dimension;
+            double* p_column = &mHessenberg[j*(max_dimension + 1)];
+            double* p_w = &mKrylovBasis[(j + 1)*size];
+
+            // w = A M^{-1} v_j, orthogonalised against the basis by modified Gram-Schmidt
+            const double* p_vj = &mKrylovBasis[j*size];
+            mPreconditioned.assign(p_vj, p_vj + size);
+            ApplyPreconditioner(&mPreconditioned[0]);
+            MultiplyNewtonMatrix(&mPreconditioned[0], gamma, p_w);
+            for (unsigned i=0; i<=j; i++)
+            {
+                const double* p_vi = &mKrylovBasis[i*size];
+                double dot = 0.0;
+                for (unsigned k=0; k<size; k++)
+                {
+                    dot += p_w[k]*p_vi[k];
+                }
+                for (unsigned k=0; k<size; k++)
+                {
+                    p_w[k] -= dot*p_vi[k];
+                }
+                p_column[i] = dot;
+            }
+            double w_norm = 0.0;
+            for (unsigned k=0; k<size; k++)
+            {
+                w_norm += p_w[k]*p_w[k];
+            }
+            w_norm = sqrt(w_norm);
+            p_column[j + 1] = w_norm;
+            if (w_norm > 0.0)
+            {
+                for (unsigned k=0; k<size; k++)
+                {
+                    p_w[k] /= w_norm;
+                }
+            }
+
+            // Reduce the new column to upper triangular form with the previous Givens rotations and a new one
+            for (unsigned i=0; i<j; i++)
+            {
+                double temp = mGivensCosines[i]*p_column[i] + mGivensSines[i]*p_column[i + 1];
+                p_column[i + 1] = -mGivensSines[i]*p_column[i] + mGivensCosines[i]*p_column[i + 1];
+                p_column[i] = temp;
+            }
+            double hypotenuse = sqrt(p_column[j]*p_column[j] + p_column[j + 1]*p_column[j + 1]);
+            mGivensCosines[j] = p_column[j]/hypotenuse;
+            mGivensSines[j] = p_column[j + 1]/hypotenuse;
+            p_column[j] = hypotenuse;
+            p_column[j + 1] = 0.0;
+            mLeastSquaresRhs[j + 1] = -mGivensSines[j]*mLeastSquaresRhs[j];
+            mLeastSquaresRhs[j] *= mGivensCosines[j];
+
+            dimension++;
+            num_iterations++;
+            mNumLinearIterations++;
+            residual_norm = fabs(mLeastSquaresRhs[j + 1]);
+            if (residual_norm <= target || num_iterations >= mMaxLinearIterations || w_norm == 0.0)
+            {
+                break;
+            }
+        }
+
+        // Solve the triangular least-squares system for the coefficients of the basis, overwriting the rotated RHS
+        for (unsigned i=dimension; i-- > 0; )
+        {
+            for (unsigned j=i+1; j<dimension; j++)
+            {
+                mLeastSquaresRhs[i] -= mHessenberg[j*(max_dimension + 1) + i]*mLeastSquaresRhs[j];
+            }
+            mLeastSquaresRhs[i] /= mHessenberg[i*(max_dimension + 1) + i];
+        }
+
+        // x += M^{-1} V y
+        mPreconditioned.assign(size, 0.0);
+        for (unsigned j=0; j<dimension; j++)
+        {
+            const double* p_vj = &mKrylovBasis[j*size];
+            for (unsigned k=0; k<size; k++)
+            {
+                mPreconditioned[k] += mLeastSquaresRhs[j]*p_vj[k];
+            }
+        }
+        ApplyPreconditioner(&mPreconditioned[0]);
+        for (unsigned k=0; k<size; k++)
+        {
+            rX[k] += mPreconditioned[k];
+        }
+    }
+}
+
+bool MyDeltaNotchBatchBdfSolver::CalculateNextYValue(MyDeltaNotchBatchOdeSystem& rSystem,
+                                                     double timeStep,
+                                                     double previousTimeStep,
+                                                     double time,
+                                                     std::vector<double>& rY)
+{
+    const unsigned size = rY.size();
+
+    /*
+     * Write the step as y_{n+1} = history + gamma*f(t_{n+1}, y_{n+1}). For BDF2 with step ratio
+     * w = h_n/h_{n-1}, history = ((1+w)^2 y_n - w^2 y_{n-1})/(1+2w) and gamma = h_n (1+w)/(1+2w).
+     * Backward Euler has history = y_n and gamma = h_n.
+     */
+    double gamma = timeStep;
+    if (previousTimeStep > 0.0)
+    {
+        const double ratio = timeStep/previousTimeStep;
+        mMaxStepRatio = std::max(mMaxStepRatio, ratio);
+        const double denominator = 1.0 + 2.0*ratio;
+        const double current_weight = (1.0 + ratio)*(1.0 + ratio)/denominator;
+        const double previous_weight = ratio*ratio/denominator;
+        gamma = timeStep*(1.0 + ratio)/denominator;
+        for (unsigned i=0; i<size; i++)
+        {
+            mHistory[i] = current_weight*rY[i] - previous_weight*mYPrevious[i];
+        }
+    }
+    else
+    {
+        mHistory = rY;
+    }
+    mYStart = rY;
+
+    // Newton's method, starting from the current state
+    for (unsigned iteration=0; iteration<mMaxNewtonIterations; iteration++)
+    {
+        EvaluateYDerivatives(rSystem, time + timeStep, rY, mRhs);
+        for (unsigned i=0; i<size; i++)
+        {
+            mResidual[i] = mHistory[i] + gamma*mRhs[i] - rY[i];
+        }
+        SetUpNewtonMatrix(rSystem, rY, gamma);
+        SolveNewtonSystem(mResidual, gamma, mUpdate);
+        mNumNewtonIterations++;
+
+        bool converged = true;
+        bool finite = true;
+        bool non_negative = true;
+        for (unsigned i=0; i<size; i++)
+        {
+            rY[i] += mUpdate[i];
+            if (!(fabs(mUpdate[i]) <= mNewtonTolerance*(1.0 + fabs(rY[i]))))
+            {
+                converged = false;
+                finite = finite && std::isfinite(rY[i]);
+            }
+            non_negative = non_negative && (rY[i] >= -mNewtonTolerance);
+        }
+        if (converged)
+        {
+            /*
+             * The Michaelis-Menten term in r_8 has a pole just below zero, beyond which the implicit equations
+             * have spurious roots with negative concentrations. A large step can converge to one of these.
+             */
+            if (!non_negative)
+            {
+                break;
+            }
+            mYPrevious = mYStart;
+            mNumSteps++;
+            return true;
+        }
+        if (!finite)
+        {
+            break;
+        }
+    }
+
+    // Leave the state as it was, so that the step can be retried
+    rY = mYStart;
+    return false;
+}
@@ -0,0 +1,349 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHBATCHBDFSOLVER_HPP_
+#define MYDELTANOTCHBATCHBDFSOLVER_HPP_
+
+#include <vector>
+
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+
+class MyDeltaNotchNeighbourGraph;
+
+/**
+ * An implicit solver that advances every cell of a MyDeltaNotchBatchOdeSystem together,
+ * treating the coupling between neighbouring cells implicitly as well as the kinetics.
+ *
+ * Each step uses the second-order backward differentiation formula (BDF2), in its variable
+ * step form so that the final step of a solve may be shorter. The first step has no history, so
+ * uses backward Euler. If the cells are coupled by a neighbour graph, the history is kept from
+ * one solve to the next, so that a tissue advanced one short solve at a time is still solved to
+ * second order, provided that each solve starts where the last ended, from the state it left,
+ * and the graph has not been rebuilt since. Otherwise the history is discarded. The nonlinear system of each step is solved by Newton's
+ * method with the analytic Jacobian of the whole tissue. This has the 6x6 blocks of
+ * MyDeltaNotchOdeSystem::EvaluateShimizuJacobian() on its diagonal and, if the cells are
+ * coupled by a neighbour graph (see SetNeighbourGraph()), the derivative of each cell's RHS
+ * with respect to the level of Delta in each of its neighbours off the diagonal. This matrix
+ * is never assembled: each Newton update is found by restarted GMRES, which only needs its
+ * product with a vector. The product is a sweep over the diagonal blocks plus one neighbour
+ * average. GMRES is right-preconditioned by the LU factorisations of the diagonal blocks
+ * (block Jacobi), so it converges in a few iterations unless the coupling is strong. If the
+ * Newton iteration does not converge, the step is retried with half the timestep, and the
+ * timestep is then doubled back up on success.
+ *
+ * Unlike MyDeltaNotchBatchRungeKutta4Solver, which is explicit, this is stable for timesteps
+ * much larger than the fastest time scale of the kinetics or of the coupling, so the timestep
+ * may be chosen for accuracy alone. The working memory is kept between solves, so once the
+ * batch has reached its largest size no memory is allocated while stepping.
+ */
+class MyDeltaNotchBatchBdfSolver
+{
+private:
+
+    /** The neighbour relation that couples the cells, whose rows are the cells of the batch; may be null. */
+    const MyDeltaNotchNeighbourGraph* mpNeighbourGraph;
+
+    /** The tolerance on each Newton update, relative to 1 + |y|. */
+    double mNewtonTolerance;
+
+    /** The maximum number of Newton iterations per step. */
+    unsigned mMaxNewtonIterations;
+
+    /** The tolerance on the GMRES residual, relative to the norm of the Newton residual. */
+    double mLinearTolerance;
+
+    /** The number of GMRES iterations between restarts. */
+    unsigned mKrylovDimension;
+
+    /** The maximum number of GMRES iterations per Newton iteration. */
+    unsigned mMaxLinearIterations;
+
+    /** The total number of steps taken. */
+    unsigned mNumSteps;
+
+    /** The total number of steps that were rejected because the Newton iteration failed. */
+    unsigned mNumRejectedSteps;
+
+    /** The total number of Newton iterations. */
+    unsigned mNumNewtonIterations;
+
+    /** The total number of GMRES iterations. */
+    unsigned mNumLinearIterations;
+
+    /** The largest ratio of a BDF2 step to the step before it. */
+    double mMaxStepRatio;
+
+    /** The state at the previous step, used by BDF2. */
+    std::vector<double> mYPrevious;
+
+    /** The last timestep of the previous solve, or 0 if its history may not be used by the next. */
+    double mLastTimeStep;
+
+    /** The timestep that the previous solve would have tried next. */
+    double mLastNextTimeStep;
+
+    /** The end time of the previous solve. */
+    double mLastEndTime;
+
+    /** The neighbour graph used by the previous solve. */
+    const MyDeltaNotchNeighbourGraph* mpLastNeighbourGraph;
+
+    /** The number of times that graph had been rebuilt at the end of the previous solve. */
+    unsigned mLastNumRebuilds;
+
+    /** The state at the end of the previous solve. */
+    std::vector<double> mYLast;
+
+    /** The state at the start of the current step. */
+    std::vector<double> mYStart;
+
+    /** The part of the BDF formula that depends on the known states. */
+    std::vector<double> mHistory;
+
+    /** Working memory for the RHS. */
+    std::vector<double> mRhs;
+
+    /** Working memory for the Newton residual. */
+    std::vector<double> mResidual;
+
+    /** Working memory for the Newton update. */
+    std::vector<double> mUpdate;
+
+    /** The 6x6 Jacobian of each cell's RHS with respect to its own state, in row-major order. */
+    std::vector<double> mJacobianBlocks;
+
+    /** The derivative of each cell's RHS with respect to the mean level of Delta in its neighbours. */
+    std::vector<double> mMeanDeltaDerivatives;
+
+    /** The LU factorisation of each diagonal block of the Newton matrix, in row-major order. */
+    std::vector<double> mPreconditionerBlocks;
+
+    /** The row permutation of each factorisation in mPreconditionerBlocks. */
+    std::vector<unsigned> mPreconditionerPivots;
+
+    /** The GMRES basis vectors, one after another. */
+    std::vector<double> mKrylovBasis;
+
+    /** The Hessenberg matrix of the Arnoldi process, in column-major order. */
+    std::vector<double> mHessenberg;
+
+    /** The cosines of the Givens rotations. */
+    std::vector<double> mGivensCosines;
+
+    /** The sines of the Givens rotations. */
+    std::vector<double> mGivensSines;
+
+    /** The rotated right-hand side of the GMRES least-squares problem. */
+    std::vector<double> mLeastSquaresRhs;
+
+    /** Working memory for the preconditioned vector passed to the matrix. */
+    std::vector<double> mPreconditioned;
+
+    /** Working memory for the product of the matrix with a vector. */
+    std::vector<double> mProduct;
+
+    /** Working memory for the level of Delta in each cell. */
+    std::vector<double> mDelta;
+
+    /** Working memory for the mean over each cell's neighbours of a perturbation of Delta. */
+    std::vector<double> mNeighbourMeans;
+
+    /**
+     * Try to advance the state variables of the batch by a single timestep.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @param timeStep the timestep
+     * @param previousTimeStep the previous timestep, or 0 if there is no previous state, when backward Euler is used
+     * @param time the current time
+     * @param rY the state variables of all cells, updated in place if the step succeeds
+     * @return whether the Newton iteration converged; if not, rY is unchanged
+     */
+    bool CalculateNextYValue(MyDeltaNotchBatchOdeSystem& rSystem,
+                             double timeStep,
+                             double previousTimeStep,
+                             double time,
+                             std::vector<double>& rY);
+
+protected:
+
+    /**
+     * Size the working memory for a batch.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     */
+    void ResizeWorkingMemory(const MyDeltaNotchBatchOdeSystem& rSystem);
+
+    /**
+     * Compute the RHS of every cell in the batch, first recomputing the mean level of
+     * Delta in each cell's neighbours from rY if the cells are coupled.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @param time the time at which to evaluate the RHS
+     * @param rY the state variables of all cells
+     * @param rDY filled in with the derivatives of all cells
+     */
+    void EvaluateYDerivatives(MyDeltaNotchBatchOdeSystem& rSystem,
+                              double time,
+                              const std::vector<double>& rY,
+                              std::vector<double>& rDY);
+
+    /**
+     * Evaluate the Jacobian blocks at rY, for the inputs last used by EvaluateYDerivatives() (which
+     * must have been called with the same rY), and factorise the diagonal blocks of the Newton
+     * matrix I - gamma*J.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @param rY the state variables of all cells
+     * @param gamma the multiple of the Jacobian in the Newton matrix
+     */
+    void SetUpNewtonMatrix(MyDeltaNotchBatchOdeSystem& rSystem, const std::vector<double>& rY, double gamma);
+
+    /**
+     * Compute the product of the Newton matrix I - gamma*J with a vector.
+     *
+     * @param pX the vector, in the layout of the state variables
+     * @param gamma the multiple of the Jacobian in the Newton matrix
+     * @param pResult filled in with the product
+     */
+    void MultiplyNewtonMatrix(const double* pX, double gamma, double* pResult);
+
+    /**
+     * Apply the block Jacobi preconditioner in place.
+     *
+     * @param pX the vector, in the layout of the state variables, overwritten with the result
+     */
+    void ApplyPreconditioner(double* pX);
+
+    /**
+     * Solve the Newton system (I - gamma*J) x = b approximately by restarted GMRES.
+     *
+     * @param rB the right-hand side b
+     * @param gamma the multiple of the Jacobian in the Newton matrix
+     * @param rX filled in with the solution x
+     */
+    void SolveNewtonSystem(const std::vector<double>& rB, double gamma, std::vector<double>& rX);
+
+public:
+
+    /**
+     * The largest ratio of a step to the one before it. Variable step BDF2 is only zero-stable
+     * for ratios below 1 + sqrt(2), so longer steps are cut to this multiple of the previous one.
+     */
+    static constexpr double MAX_STEP_RATIO = 2.0;
+
+    /**
+     * Constructor.
+     */
+    MyDeltaNotchBatchBdfSolver();
+
+    /**
+     * Couple the cells of the batch through their neighbours' levels of Delta while solving.
+     * The graph must outlive its use by this solver.
+     *
+     * @param pNeighbourGraph the neighbour relation, whose rows are the cells of the batch,
+     *     or null (the default) to hold the mean levels of Delta fixed
+     */
+    void SetNeighbourGraph(const MyDeltaNotchNeighbourGraph* pNeighbourGraph);
+
+    /**
+     * Set the tolerance of the Newton iteration. The iteration stops once every component of
+     * the update is smaller than the tolerance times 1 + |y|.
+     *
+     * @param newtonTolerance the tolerance (defaults to 1e-10)
+     */
+    void SetNewtonTolerance(double newtonTolerance);
+
+    /**
+     * @return the tolerance of the Newton iteration.
+     */
+    double GetNewtonTolerance() const;
+
+    /**
+     * Set the tolerance of GMRES, relative to the norm of the Newton residual.
+     *
+     * @param linearTolerance the tolerance (defaults to 1e-8)
+     */
+    void SetLinearTolerance(double linearTolerance);
+
+    /**
+     * @return the tolerance of GMRES, relative to the norm of the Newton residual.
+     */
+    double GetLinearTolerance() const;
+
+    /**
+     * @return the total number of steps taken by this solver.
+     */
+    unsigned GetNumSteps() const;
+
+    /**
+     * @return the total number of steps that this solver rejected, and retried with half the
+     *     timestep, because the Newton iteration failed to converge.
+     */
+    unsigned GetNumRejectedSteps() const;
+
+    /**
+     * @return the total number of Newton iterations taken by this solver.
+     */
+    unsigned GetNumNewtonIterations() const;
+
+    /**
+     * @return the total number of GMRES iterations taken by this solver.
+     */
+    unsigned GetNumLinearIterations() const;
+
+    /**
+     * @return the largest ratio of a BDF2 step attempted by this solver to the step before it
+     *     (0 if no BDF2 step has been taken). This never exceeds MAX_STEP_RATIO.
+     */
+    double GetMaxStepRatio() const;
+
+    /**
+     * Advance the state variables of every cell in the batch from startTime to endTime,
+     * using steps of size timeStep (the final step may be shorter to hit endTime exactly, and
+     * steps are halved if the Newton iteration fails).
+     * Unless the cells are coupled by a neighbour graph, the per-cell inputs are held fixed
+     * over the interval. If they are coupled, and this solve continues the previous one from
+     * the state it left with the same, unrebuilt, graph, the first step uses the history of the
+     * previous solve rather than backward Euler.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems, whose state variables are updated
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the timestep
+     */
+    void Solve(MyDeltaNotchBatchOdeSystem& rSystem, double startTime, double endTime, double timeStep);
+};
+
+#endif /*MYDELTANOTCHBATCHBDFSOLVER_HPP_*/
@@ -0,0 +1,137 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <cassert>
+
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "Exception.hpp"
+
+template<typename REAL>
+const unsigned MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::NUM_STATE_VARIABLES;
+
+template<typename REAL>
+MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::MyDeltaNotchBatchOdeSystemWithPrecision(unsigned numCells)
+    : mNumCells(0),
+      mKernelType(MyDeltaNotchSimdKernels::GetBestAvailableKernelType())
+{
+    Resize(numCells);
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::Resize(unsigned numCells)
+{
+    mNumCells = numCells;
+    mStateVariables.resize(NUM_STATE_VARIABLES*numCells);
+    mMeanDelta.resize(numCells);
+    mXDistance.resize(numCells);
+}
+
+template<typename REAL>
+unsigned MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::GetNumCells() const
+{
+    return mNumCells;
+}
+
+template<typename REAL>
+std::vector<REAL>& MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::rGetStateVariables()
+{
+    return mStateVariables;
+}
+
+template<typename REAL>
+std::vector<REAL>& MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::rGetMeanDelta()
+{
+    return mMeanDelta;
+}
+
+template<typename REAL>
+std::vector<REAL>& MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::rGetXDistance()
+{
+    return mXDistance;
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters)
+{
+    mpKineticParameters = pKineticParameters;
+}
+
+template<typename REAL>
+boost::shared_ptr<MyDeltaNotchParameters> MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::GetKineticParameters() const
+{
+    return mpKineticParameters;
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::SetKernelType(MyDeltaNotchSimdKernels::KernelType kernelType)
+{
+    if (!MyDeltaNotchSimdKernels::IsAvailable(kernelType))
+    {
+        EXCEPTION("The " << MyDeltaNotchSimdKernels::GetKernelName(kernelType) << " Delta-Notch kernel is not available on this machine.");
+    }
+    mKernelType = kernelType;
+}
+
+template<typename REAL>
+MyDeltaNotchSimdKernels::KernelType MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::GetKernelType() const
+{
+    return mKernelType;
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::EvaluateYDerivatives(double time, const std::vector<REAL>& rY, std::vector<REAL>& rDY) const
+{
+    assert(rY.size() == NUM_STATE_VARIABLES*mNumCells);
+    assert(rDY.size() == NUM_STATE_VARIABLES*mNumCells);
+
+    if (mNumCells > 0)
+    {
+        if (mpKineticParameters)
+        {
+            MyDeltaNotchSimdKernels::EvaluateYDerivatives(mKernelType, *mpKineticParameters, mNumCells,
+                                                          &rY[0], &mMeanDelta[0], &mXDistance[0], &rDY[0]);
+        }
+        else
+        {
+            // The default parameters are compile-time constants in these kernels
+            MyDeltaNotchSimdKernels::EvaluateYDerivatives(mKernelType, mNumCells,
+                                                          &rY[0], &mMeanDelta[0], &mXDistance[0], &rDY[0]);
+        }
+    }
+}
+
+// Explicit instantiation
+template class MyDeltaNotchBatchOdeSystemWithPrecision<double>;
+template class MyDeltaNotchBatchOdeSystemWithPrecision<float>;
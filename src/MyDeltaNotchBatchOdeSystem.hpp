@@ -0,0 +1,173 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHBATCHODESYSTEM_HPP_
+#define MYDELTANOTCHBATCHODESYSTEM_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchSimdKernels.hpp"
+
+/**
+ * The Delta-Notch ODE system of MyDeltaNotchOdeSystem, stored for a whole
+ * population of cells at once.
+ *
+ * The state variables are stored as a structure of arrays: all cells' values
+ * of state variable 0 are contiguous, followed by all cells' values of state
+ * variable 1, and so on. The per-cell inputs "mean delta" and "x distance" are
+ * stored in their own contiguous arrays. This allows the whole tissue to be
+ * advanced in a single pass per timestep by MyDeltaNotchBatchRungeKutta4Solver,
+ * without per-cell virtual dispatch or heap traffic, and lets the RHS be
+ * evaluated for several cells per instruction (see MyDeltaNotchSimdKernels).
+ *
+ * REAL is the precision in which the state variables and inputs are stored and
+ * the RHS is evaluated. The project works in double precision (see the
+ * MyDeltaNotchBatchOdeSystem typedef below). Single precision
+ * (MyDeltaNotchSinglePrecisionBatchOdeSystem) halves the memory and bandwidth
+ * used by large tissues and doubles the number of cells dealt with per SIMD
+ * instruction, at the cost of accuracy; MyDeltaNotchBatchRungeKutta4SolverWithPrecision
+ * can measure how much accuracy is lost.
+ */
+template<typename REAL>
+class MyDeltaNotchBatchOdeSystemWithPrecision
+{
+private:
+
+    /** The number of cells in the batch. */
+    unsigned mNumCells;
+
+    /** The state variables of all cells, stored variable by variable. */
+    std::vector<REAL> mStateVariables;
+
+    /** The mean level of Delta in each cell's neighbours. */
+    std::vector<REAL> mMeanDelta;
+
+    /** The distance of each cell from the tissue centroid along the x axis. */
+    std::vector<REAL> mXDistance;
+
+    /**
+     * The kinetic parameters shared by every cell in the batch. If this is not set,
+     * the compile-time DEFAULT_MY_DELTA_NOTCH_PARAMETERS are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> mpKineticParameters;
+
+    /** The implementation of the RHS used by EvaluateYDerivatives(). */
+    MyDeltaNotchSimdKernels::KernelType mKernelType;
+
+public:
+
+    /** The number of state variables per cell. */
+    static const unsigned NUM_STATE_VARIABLES = 6;
+
+    /**
+     * Constructor.
+     *
+     * @param numCells the number of cells in the batch (defaults to 0)
+     */
+    MyDeltaNotchBatchOdeSystemWithPrecision(unsigned numCells=0);
+
+    /**
+     * Change the number of cells in the batch. Existing values are not preserved.
+     * Storage is only reallocated if the batch grows beyond its previous capacity.
+     *
+     * @param numCells the new number of cells
+     */
+    void Resize(unsigned numCells);
+
+    /**
+     * @return the number of cells in the batch.
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return the state variables of all cells, stored variable by variable,
+     *     so that state variable i of cell j is at index i*GetNumCells()+j.
+     */
+    std::vector<REAL>& rGetStateVariables();
+
+    /**
+     * @return the mean level of Delta in each cell's neighbours.
+     */
+    std::vector<REAL>& rGetMeanDelta();
+
+    /**
+     * @return the distance of each cell from the tissue centroid along the x axis.
+     */
+    std::vector<REAL>& rGetXDistance();
+
+    /**
+     * Set the kinetic parameters shared by every cell in the batch.
+     *
+     * @param pKineticParameters the parameter set, or an empty pointer to use the defaults
+     */
+    void SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters);
+
+    /**
+     * @return the kinetic parameters shared by every cell in the batch, or an empty pointer if the defaults are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> GetKineticParameters() const;
+
+    /**
+     * Set the implementation of the RHS to use. By default, the fastest kernel
+     * supported by the processor is used.
+     *
+     * @param kernelType the kernel, which must be available on this processor
+     */
+    void SetKernelType(MyDeltaNotchSimdKernels::KernelType kernelType);
+
+    /**
+     * @return the implementation of the RHS used by EvaluateYDerivatives().
+     */
+    MyDeltaNotchSimdKernels::KernelType GetKernelType() const;
+
+    /**
+     * Compute the RHS of the Delta-Notch ODEs for every cell in the batch.
+     *
+     * @param time the time at which to evaluate the RHS
+     * @param rY the state variables of all cells, laid out as in rGetStateVariables()
+     * @param rDY filled in with the derivatives of all cells, in the same layout
+     */
+    void EvaluateYDerivatives(double time, const std::vector<REAL>& rY, std::vector<REAL>& rDY) const;
+};
+
+/** The batch in double precision, as used throughout the project. */
+typedef MyDeltaNotchBatchOdeSystemWithPrecision<double> MyDeltaNotchBatchOdeSystem;
+
+/** The batch in single precision. */
+typedef MyDeltaNotchBatchOdeSystemWithPrecision<float> MyDeltaNotchSinglePrecisionBatchOdeSystem;
+
+#endif /*MYDELTANOTCHBATCHODESYSTEM_HPP_*/
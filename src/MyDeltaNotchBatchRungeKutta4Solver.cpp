@@ -0,0 +1,298 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+namespace
+{
+
+/**
+ * Finish a stage of a Runge-Kutta step, once the derivatives have been computed: scale them by the
+ * timestep and either form the state passed to the next stage or, after the last stage, advance the state.
+ *
+ * @param stage the stage (0 to 3)
+ * @param timeStep the timestep
+ * @param rY the state variables, advanced in place after the last stage
+ * @param pK the working memory for the four stages, the current one holding the derivatives
+ * @param rYki filled in with the state passed to the next stage
+ */
+template<typename REAL>
+void FinishStage(unsigned stage, REAL timeStep, std::vector<REAL>& rY, std::vector<REAL>* pK, std::vector<REAL>& rYki)
+{
+    const unsigned size = rY.size();
+    std::vector<REAL>& r_k = pK[stage];
+    for (unsigned i=0; i<size; i++)
+    {
+        r_k[i] *= timeStep;
+    }
+
+    if (stage < 2)
+    {
+        for (unsigned i=0; i<size; i++)
+        {
+            rYki[i] = rY[i] + REAL(0.5)*r_k[i];
+        }
+    }
+    else if (stage == 2)
+    {
+        for (unsigned i=0; i<size; i++)
+        {
+            rYki[i] = rY[i] + r_k[i];
+        }
+    }
+    else
+    {
+        for (unsigned i=0; i<size; i++)
+        {
+            rY[i] += (pK[0][i] + REAL(2.0)*pK[1][i] + REAL(2.0)*pK[2][i] + pK[3][i])/REAL(6.0);
+        }
+    }
+}
+
+} // anonymous namespace
+
+template<typename REAL>
+MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::MyDeltaNotchBatchRungeKutta4SolverWithPrecision()
+    : mpNeighbourGraph(nullptr),
+      mNumSampleCells(0),
+      mCheckInterval(1),
+      mNumSolves(0),
+      mCheckingPrecision(false),
+      mNumPrecisionChecks(0),
+      mLastDeviation(0.0),
+      mMaxDeviation(0.0)
+{
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::SetNeighbourGraph(const MyDeltaNotchNeighbourGraph* pNeighbourGraph)
+{
+    mpNeighbourGraph = pNeighbourGraph;
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::SetPrecisionCheck(unsigned numSampleCells, unsigned checkInterval)
+{
+    if (checkInterval == 0)
+    {
+        EXCEPTION("The precision check interval must be positive.");
+    }
+    mNumSampleCells = numSampleCells;
+    mCheckInterval = checkInterval;
+    mNumSolves = 0;
+    mNumPrecisionChecks = 0;
+    mLastDeviation = 0.0;
+    mMaxDeviation = 0.0;
+}
+
+template<typename REAL>
+unsigned MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::GetNumPrecisionChecks() const
+{
+    return mNumPrecisionChecks;
+}
+
+template<typename REAL>
+double MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::GetLastDeviation() const
+{
+    return mLastDeviation;
+}
+
+template<typename REAL>
+double MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::GetMaxDeviation() const
+{
+    return mMaxDeviation;
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::Solve(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem,
+                                                                  double startTime,
+                                                                  double endTime,
+                                                                  double timeStep)
+{
+    std::vector<REAL>& r_y = rSystem.rGetStateVariables();
+    const unsigned size = r_y.size();
+
+    for (unsigned stage=0; stage<4; stage++)
+    {
+        mK[stage].resize(size);
+    }
+    mYki.resize(size);
+
+    mCheckingPrecision = (mNumSampleCells > 0) && (rSystem.GetNumCells() > 0) && (mNumSolves%mCheckInterval == 0);
+    mNumSolves++;
+    if (mCheckingPrecision)
+    {
+        StartPrecisionCheck(rSystem);
+    }
+
+    TimeStepper stepper(startTime, endTime, timeStep);
+    while (!stepper.IsTimeAtEnd())
+    {
+        CalculateNextYValue(rSystem, stepper.GetNextTimeStep(), stepper.GetTime(), r_y);
+        stepper.AdvanceOneTimeStep();
+    }
+
+    if (mCheckingPrecision)
+    {
+        FinishPrecisionCheck(rSystem);
+        mCheckingPrecision = false;
+    }
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::EvaluateYDerivatives(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem,
+                                                                                 double time,
+                                                                                 const std::vector<REAL>& rY,
+                                                                                 std::vector<REAL>& rDY)
+{
+    if (mpNeighbourGraph)
+    {
+        // Delta is the last state variable, so its values for every cell are at the end of rY
+        const unsigned num_cells = rSystem.GetNumCells();
+        assert(mpNeighbourGraph->GetNumCells() == num_cells);
+        const unsigned delta_offset = (MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::NUM_STATE_VARIABLES - 1)*num_cells;
+        mDelta.assign(rY.begin() + delta_offset, rY.begin() + delta_offset + num_cells);
+        mpNeighbourGraph->ComputeNeighbourMeans(mDelta, rSystem.rGetMeanDelta());
+    }
+    rSystem.EvaluateYDerivatives(time, rY, rDY);
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::StartPrecisionCheck(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem)
+{
+    const unsigned num_cells = rSystem.GetNumCells();
+    const unsigned num_samples = std::min(mNumSampleCells, num_cells);
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::NUM_STATE_VARIABLES;
+
+    // Spread the sample evenly through the batch
+    mSampleCells.resize(num_samples);
+    for (unsigned sample=0; sample<num_samples; sample++)
+    {
+        mSampleCells[sample] = (static_cast<unsigned long long>(sample)*num_cells)/num_samples;
+    }
+
+    mReferenceSystem.Resize(num_samples);
+    mReferenceSystem.SetKineticParameters(rSystem.GetKineticParameters());
+    std::vector<double>& r_reference_y = mReferenceSystem.rGetStateVariables();
+    for (unsigned sample=0; sample<num_samples; sample++)
+    {
+        const unsigned cell_index = mSampleCells[sample];
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_reference_y[var*num_samples + sample] = rSystem.rGetStateVariables()[var*num_cells + cell_index];
+        }
+        mReferenceSystem.rGetXDistance()[sample] = rSystem.rGetXDistance()[cell_index];
+    }
+
+    for (unsigned stage=0; stage<4; stage++)
+    {
+        mReferenceK[stage].resize(r_reference_y.size());
+    }
+    mReferenceYki.resize(r_reference_y.size());
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::FinishPrecisionCheck(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem)
+{
+    const unsigned num_cells = rSystem.GetNumCells();
+    const unsigned num_samples = mSampleCells.size();
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::NUM_STATE_VARIABLES;
+
+    const std::vector<double>& r_reference_y = mReferenceSystem.rGetStateVariables();
+    double deviation = 0.0;
+    for (unsigned sample=0; sample<num_samples; sample++)
+    {
+        const unsigned cell_index = mSampleCells[sample];
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            const double reference = r_reference_y[var*num_samples + sample];
+            const double value = rSystem.rGetStateVariables()[var*num_cells + cell_index];
+            const double cell_deviation = fabs(value - reference)/(1.0 + fabs(reference));
+
+            // A solution that has blown up gives a NaN deviation, which must not be lost by the comparison
+            if (!std::isnan(deviation) && (std::isnan(cell_deviation) || (cell_deviation > deviation)))
+            {
+                deviation = cell_deviation;
+            }
+        }
+    }
+
+    mNumPrecisionChecks++;
+    mLastDeviation = deviation;
+    if (!std::isnan(mMaxDeviation) && (std::isnan(deviation) || (deviation > mMaxDeviation)))
+    {
+        mMaxDeviation = deviation;
+    }
+}
+
+template<typename REAL>
+void MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>::CalculateNextYValue(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem,
+                                                                                double timeStep,
+                                                                                double time,
+                                                                                std::vector<REAL>& rY)
+{
+    const double stage_times[4] = {time, time + 0.5*timeStep, time + 0.5*timeStep, time + timeStep};
+    const unsigned num_samples = mSampleCells.size();
+
+    for (unsigned stage=0; stage<4; stage++)
+    {
+        EvaluateYDerivatives(rSystem, stage_times[stage], (stage == 0) ? rY : mYki, mK[stage]);
+
+        if (mCheckingPrecision)
+        {
+            // The sample cells see the same mean levels of Delta as in the batch, so differ from it only through rounding
+            std::vector<double>& r_reference_y = mReferenceSystem.rGetStateVariables();
+            for (unsigned sample=0; sample<num_samples; sample++)
+            {
+                mReferenceSystem.rGetMeanDelta()[sample] = rSystem.rGetMeanDelta()[mSampleCells[sample]];
+            }
+            mReferenceSystem.EvaluateYDerivatives(stage_times[stage], (stage == 0) ? r_reference_y : mReferenceYki, mReferenceK[stage]);
+            FinishStage<double>(stage, timeStep, r_reference_y, mReferenceK, mReferenceYki);
+        }
+
+        FinishStage<REAL>(stage, timeStep, rY, mK, mYki);
+    }
+}
+
+// Explicit instantiation
+template class MyDeltaNotchBatchRungeKutta4SolverWithPrecision<double>;
+template class MyDeltaNotchBatchRungeKutta4SolverWithPrecision<float>;
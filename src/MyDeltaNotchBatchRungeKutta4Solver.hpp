@@ -0,0 +1,219 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHBATCHRUNGEKUTTA4SOLVER_HPP_
+#define MYDELTANOTCHBATCHRUNGEKUTTA4SOLVER_HPP_
+
+#include <vector>
+
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+
+class MyDeltaNotchNeighbourGraph;
+
+/**
+ * A fourth-order Runge-Kutta solver that advances every cell of a
+ * MyDeltaNotchBatchOdeSystemWithPrecision together.
+ *
+ * This performs the same arithmetic as RungeKutta4IvpOdeSolver applied to each
+ * cell's MyDeltaNotchOdeSystem in turn, but each stage is a single sweep over
+ * contiguous arrays. The stage buffers are members, so that once the batch has
+ * reached its largest size no memory is allocated while stepping.
+ *
+ * By default the per-cell inputs are held fixed while solving. If a neighbour graph
+ * is given (see SetNeighbourGraph()), the mean level of Delta in each cell's neighbours
+ * is instead recomputed from the stage values before every evaluation of the RHS, so
+ * that the whole tissue is solved as a single coupled ODE system.
+ *
+ * REAL is the precision of the batch, and of the arithmetic. When working in single
+ * precision, the loss of accuracy can be monitored with SetPrecisionCheck().
+ */
+template<typename REAL>
+class MyDeltaNotchBatchRungeKutta4SolverWithPrecision
+{
+private:
+
+    /** Working memory for the four stages. */
+    std::vector<REAL> mK[4];
+
+    /** Working memory for the intermediate state passed to each stage. */
+    std::vector<REAL> mYki;
+
+    /** The neighbour relation that couples the cells, whose rows are the cells of the batch; may be null. */
+    const MyDeltaNotchNeighbourGraph* mpNeighbourGraph;
+
+    /** Working memory for the level of Delta in each cell, when the cells are coupled. */
+    std::vector<REAL> mDelta;
+
+    /** The number of cells advanced in double precision by each precision check, or 0 if there are no checks. */
+    unsigned mNumSampleCells;
+
+    /** The number of calls to Solve() per precision check. */
+    unsigned mCheckInterval;
+
+    /** The number of calls to Solve() since the precision check was set. */
+    unsigned mNumSolves;
+
+    /** Whether the current call to Solve() is checking the precision. */
+    bool mCheckingPrecision;
+
+    /** The cells of the batch that are being advanced in double precision. */
+    std::vector<unsigned> mSampleCells;
+
+    /** The sample cells, advanced in double precision. */
+    MyDeltaNotchBatchOdeSystemWithPrecision<double> mReferenceSystem;
+
+    /** Working memory for the four stages of the sample cells. */
+    std::vector<double> mReferenceK[4];
+
+    /** Working memory for the intermediate state of the sample cells passed to each stage. */
+    std::vector<double> mReferenceYki;
+
+    /** The number of precision checks made. */
+    unsigned mNumPrecisionChecks;
+
+    /** The deviation found by the latest precision check. */
+    double mLastDeviation;
+
+    /** The largest deviation found by any precision check. */
+    double mMaxDeviation;
+
+    /**
+     * Compute the RHS of every cell in the batch, first recomputing the mean level of
+     * Delta in each cell's neighbours from rY if the cells are coupled.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @param time the time at which to evaluate the RHS
+     * @param rY the state variables of all cells
+     * @param rDY filled in with the derivatives of all cells
+     */
+    void EvaluateYDerivatives(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem,
+                              double time,
+                              const std::vector<REAL>& rY,
+                              std::vector<REAL>& rDY);
+
+    /**
+     * Copy the sample cells from the batch into mReferenceSystem, at the start of a precision check.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     */
+    void StartPrecisionCheck(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem);
+
+    /**
+     * Compare the sample cells in the batch with mReferenceSystem, at the end of a precision check.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     */
+    void FinishPrecisionCheck(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem);
+
+    /**
+     * Advance the state variables of the batch by a single timestep.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @param timeStep the timestep
+     * @param time the current time
+     * @param rY the state variables of all cells, updated in place
+     */
+    void CalculateNextYValue(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem,
+                             double timeStep,
+                             double time,
+                             std::vector<REAL>& rY);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    MyDeltaNotchBatchRungeKutta4SolverWithPrecision();
+
+    /**
+     * Couple the cells of the batch through their neighbours' levels of Delta while solving.
+     * The graph must outlive its use by this solver.
+     *
+     * @param pNeighbourGraph the neighbour relation, whose rows are the cells of the batch,
+     *     or null (the default) to hold the mean levels of Delta fixed
+     */
+    void SetNeighbourGraph(const MyDeltaNotchNeighbourGraph* pNeighbourGraph);
+
+    /**
+     * Periodically check the solution against double precision. On every checkInterval-th
+     * call to Solve(), starting with the next, a sample of cells spread evenly through the
+     * batch is also advanced in double precision, in step with the batch and with the same
+     * mean levels of Delta, and the two are compared at the end of the call. The deviation
+     * is the largest difference between them in any state variable, relative to 1 + the
+     * magnitude of the double-precision value, or NaN if either solution has blown up.
+     * This resets any previous checks.
+     *
+     * @param numSampleCells the number of cells to sample (or the whole batch, if smaller),
+     *     or 0 to stop checking
+     * @param checkInterval the number of calls to Solve() per check (defaults to 1)
+     */
+    void SetPrecisionCheck(unsigned numSampleCells, unsigned checkInterval=1);
+
+    /**
+     * @return the number of precision checks made since SetPrecisionCheck() was called.
+     */
+    unsigned GetNumPrecisionChecks() const;
+
+    /**
+     * @return the deviation found by the latest precision check (0 if there have been none).
+     */
+    double GetLastDeviation() const;
+
+    /**
+     * @return the largest deviation found by any precision check (0 if there have been none).
+     */
+    double GetMaxDeviation() const;
+
+    /**
+     * Advance the state variables of every cell in the batch from startTime to endTime,
+     * using steps of size timeStep (the final step may be shorter to hit endTime exactly).
+     * Unless the cells are coupled by a neighbour graph, the per-cell inputs are held fixed
+     * over the interval.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems, whose state variables are updated
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param timeStep the timestep
+     */
+    void Solve(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rSystem, double startTime, double endTime, double timeStep);
+};
+
+/** The solver for double-precision batches, as used throughout the project. */
+typedef MyDeltaNotchBatchRungeKutta4SolverWithPrecision<double> MyDeltaNotchBatchRungeKutta4Solver;
+
+/** The solver for single-precision batches. */
+typedef MyDeltaNotchBatchRungeKutta4SolverWithPrecision<float> MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver;
+
+#endif /*MYDELTANOTCHBATCHRUNGEKUTTA4SOLVER_HPP_*/
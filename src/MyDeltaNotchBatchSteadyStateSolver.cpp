@@ -0,0 +1,241 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include "MyDeltaNotchBatchSteadyStateSolver.hpp"
+#include "Exception.hpp"
+
+MyDeltaNotchBatchSteadyStateSolver::MyDeltaNotchBatchSteadyStateSolver()
+    : MyDeltaNotchBatchBdfSolver(),
+      mResidualTolerance(1e-8),
+      mInitialPseudoTimestep(0.01),
+      mMaxIterations(100),
+      mFallbackTimestep(0.1),
+      mFallbackInterval(1.0),
+      mMaxFallbackTime(100.0),
+      mConverged(false),
+      mNumIterations(0),
+      mResidualNorm(0.0),
+      mFallbackTime(0.0)
+{
+}
+
+void MyDeltaNotchBatchSteadyStateSolver::SetResidualTolerance(double residualTolerance)
+{
+    if (residualTolerance <= 0.0)
+    {
+        EXCEPTION("The residual tolerance must be positive.");
+    }
+    mResidualTolerance = residualTolerance;
+}
+
+double MyDeltaNotchBatchSteadyStateSolver::GetResidualTolerance() const
+{
+    return mResidualTolerance;
+}
+
+void MyDeltaNotchBatchSteadyStateSolver::SetMaxIterations(unsigned maxIterations)
+{
+    mMaxIterations = maxIterations;
+}
+
+void MyDeltaNotchBatchSteadyStateSolver::SetFallback(double timeStep, double interval, double maxTime)
+{
+    if (timeStep <= 0.0 || interval <= 0.0)
+    {
+        EXCEPTION("The fallback timestep and interval must be positive.");
+    }
+    if (maxTime < 0.0)
+    {
+        EXCEPTION("The maximum fallback time must be non-negative.");
+    }
+    mFallbackTimestep = timeStep;
+    mFallbackInterval = interval;
+    mMaxFallbackTime = maxTime;
+}
+
+double MyDeltaNotchBatchSteadyStateSolver::ComputeResidualNorm(const std::vector<double>& rY,
+                                                               const std::vector<double>& rF) const
+{
+    double norm = 0.0;
+    for (unsigned i=0; i<rY.size(); i++)
+    {
+        const double scaled = fabs(rF[i])/(1.0 + fabs(rY[i]));
+        if (!(scaled <= norm))
+        {
+            // Also propagates NaN, which compares false with everything
+            norm = scaled;
+        }
+    }
+    return norm;
+}
+
+bool MyDeltaNotchBatchSteadyStateSolver::ApplyPseudoTransientContinuation(MyDeltaNotchBatchOdeSystem& rSystem)
+{
+    std::vector<double>& r_y = rSystem.rGetStateVariables();
+    const unsigned size = r_y.size();
+    ResizeWorkingMemory(rSystem);
+    mF.resize(size);
+    mTrialF.resize(size);
+    mTrialY.resize(size);
+    mStep.resize(size);
+    mInitialY = r_y;
+
+    EvaluateYDerivatives(rSystem, 0.0, r_y, mF);
+    mResidualNorm = ComputeResidualNorm(r_y, mF);
+
+    double pseudo_timestep = mInitialPseudoTimestep;
+    for (unsigned iteration=0; iteration<mMaxIterations && mResidualNorm > mResidualTolerance; iteration++)
+    {
+        mNumIterations++;
+
+        // The linearised backward Euler step (I - h J) dy = h f(y), with the Jacobian at the current iterate
+        bool accepted = false;
+        bool have_step = true;
+        try
+        {
+            SetUpNewtonMatrix(rSystem, r_y, pseudo_timestep);
+            for (unsigned i=0; i<size; i++)
+            {
+                mTrialF[i] = pseudo_timestep*mF[i];
+            }
+            SolveNewtonSystem(mTrialF, pseudo_timestep, mStep);
+        }
+        catch (Exception&)
+        {
+            // A singular diagonal block; a shorter pseudo-timestep moves the matrix towards the identity
+            have_step = false;
+        }
+
+        /*
+         * Damp the step until the concentrations stay non-negative; beyond the pole of the Michaelis-Menten
+         * term in r_8 the RHS has spurious roots. The residual itself may grow for a while, as the
+         * iterates follow the dynamics.
+         */
+        double damping = 1.0;
+        double trial_norm = mResidualNorm;
+        for (unsigned halving=0; halving<10 && have_step && !accepted; halving++, damping *= 0.5)
+        {
+            bool admissible = true;
+            for (unsigned i=0; i<size; i++)
+            {
+                mTrialY[i] = r_y[i] + damping*mStep[i];
+                admissible = admissible && (mTrialY[i] >= 0.0) && std::isfinite(mTrialY[i]);
+            }
+            if (admissible)
+            {
+                EvaluateYDerivatives(rSystem, 0.0, mTrialY, mTrialF);
+                trial_norm = ComputeResidualNorm(mTrialY, mTrialF);
+                accepted = std::isfinite(trial_norm);
+            }
+        }
+
+        if (accepted)
+        {
+            /*
+             * Switched evolution relaxation: scale the pseudo-timestep by the fall in the residual. Near a
+             * steady state the slowest modes of the tissue (the refinement of the pattern) take thousands of
+             * time units to settle, so the residual falls slowly until the pseudo-timestep is comparable;
+             * it is therefore grown by at least a fixed factor whenever the residual falls.
+             */
+            double ratio = mResidualNorm/trial_norm;
+            if (ratio > 1.0)
+            {
+                ratio = std::max(ratio, 1.5);
+            }
+            pseudo_timestep = std::min(pseudo_timestep*std::min(ratio, 1e3), 1e12);
+            r_y.swap(mTrialY);
+            mF.swap(mTrialF);
+            mResidualNorm = trial_norm;
+        }
+        else
+        {
+            pseudo_timestep *= 0.1;
+
+            // The coupling in rSystem may have been left at a rejected trial iterate
+            EvaluateYDerivatives(rSystem, 0.0, r_y, mF);
+        }
+    }
+
+    if (mResidualNorm <= mResidualTolerance)
+    {
+        return true;
+    }
+
+    // Leave the state as it was
+    r_y = mInitialY;
+    EvaluateYDerivatives(rSystem, 0.0, r_y, mF);
+    mResidualNorm = ComputeResidualNorm(r_y, mF);
+    return false;
+}
+
+bool MyDeltaNotchBatchSteadyStateSolver::FindSteadyState(MyDeltaNotchBatchOdeSystem& rSystem)
+{
+    mNumIterations = 0;
+    mFallbackTime = 0.0;
+    mConverged = ApplyPseudoTransientContinuation(rSystem);
+
+    // Follow the dynamics towards a steady state, and try again from closer to it
+    while (!mConverged && mFallbackTime < mMaxFallbackTime)
+    {
+        const double interval = std::min(mFallbackInterval, mMaxFallbackTime - mFallbackTime);
+        Solve(rSystem, mFallbackTime, mFallbackTime + interval, mFallbackTimestep);
+        mFallbackTime += interval;
+        mConverged = ApplyPseudoTransientContinuation(rSystem);
+    }
+    return mConverged;
+}
+
+bool MyDeltaNotchBatchSteadyStateSolver::HasConverged() const
+{
+    return mConverged;
+}
+
+unsigned MyDeltaNotchBatchSteadyStateSolver::GetNumIterations() const
+{
+    return mNumIterations;
+}
+
+double MyDeltaNotchBatchSteadyStateSolver::GetResidualNorm() const
+{
+    return mResidualNorm;
+}
+
+double MyDeltaNotchBatchSteadyStateSolver::GetFallbackTime() const
+{
+    return mFallbackTime;
+}
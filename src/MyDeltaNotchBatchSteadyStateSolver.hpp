@@ -0,0 +1,189 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_
+#define MYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_
+
+#include <vector>
+
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+
+/**
+ * Finds a steady state of the Delta-Notch signalling of a whole tissue directly, rather than by
+ * integrating to a long end time.
+ *
+ * FindSteadyState() solves f(y) = 0 for the RHS f of every cell of a MyDeltaNotchBatchOdeSystem,
+ * coupled through a neighbour graph (see SetNeighbourGraph()), by pseudo-transient continuation.
+ * Each iteration takes the linearised backward Euler step (I - h J) dy = h f(y) with the matrix-free
+ * tissue Jacobian and preconditioned GMRES of MyDeltaNotchBatchBdfSolver. The pseudo-timestep h
+ * starts small, so that the first iterations follow the dynamics, and grows as the residual falls
+ * (switched evolution relaxation), so that the last iterations are Newton's method. Each update is
+ * damped as needed to keep the concentrations non-negative and the residual bounded; if no damping
+ * suffices, h is reduced.
+ *
+ * If the continuation fails, the tissue is instead integrated with the BDF solver in intervals, and
+ * the continuation is tried again after each interval, until it succeeds or a maximum time is reached.
+ */
+class MyDeltaNotchBatchSteadyStateSolver : public MyDeltaNotchBatchBdfSolver
+{
+private:
+
+    /** The tolerance on the residual, as measured by ComputeResidualNorm(). */
+    double mResidualTolerance;
+
+    /** The pseudo-timestep of the first iteration of the continuation. */
+    double mInitialPseudoTimestep;
+
+    /** The maximum number of iterations of each attempt at the continuation. */
+    unsigned mMaxIterations;
+
+    /** The timestep of the BDF solver if the continuation fails. */
+    double mFallbackTimestep;
+
+    /** The time to integrate for between attempts at the continuation, if it fails. */
+    double mFallbackInterval;
+
+    /** The maximum time to integrate for, if the continuation fails. */
+    double mMaxFallbackTime;
+
+    /** Whether the last call to FindSteadyState() converged. */
+    bool mConverged;
+
+    /** The number of iterations of the continuation in the last call to FindSteadyState(). */
+    unsigned mNumIterations;
+
+    /** The residual norm at the end of the last call to FindSteadyState(). */
+    double mResidualNorm;
+
+    /** The time integrated for by the last call to FindSteadyState(), if the continuation failed at first. */
+    double mFallbackTime;
+
+    /** Working memory for the RHS at the current iterate. */
+    std::vector<double> mF;
+
+    /** Working memory for the RHS at the trial iterate. */
+    std::vector<double> mTrialF;
+
+    /** Working memory for the trial iterate. */
+    std::vector<double> mTrialY;
+
+    /** Working memory for the undamped update. */
+    std::vector<double> mStep;
+
+    /** The state at the start of an attempt at the continuation. */
+    std::vector<double> mInitialY;
+
+    /**
+     * @param rY the state variables of all cells
+     * @param rF the RHS at rY
+     * @return the largest value of |f_i|/(1 + |y_i|).
+     */
+    double ComputeResidualNorm(const std::vector<double>& rY, const std::vector<double>& rF) const;
+
+    /**
+     * Attempt to find a steady state by pseudo-transient continuation from the current state.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems
+     * @return whether the continuation converged; if not, the state of rSystem is unchanged
+     */
+    bool ApplyPseudoTransientContinuation(MyDeltaNotchBatchOdeSystem& rSystem);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    MyDeltaNotchBatchSteadyStateSolver();
+
+    /**
+     * Set the tolerance on the residual. The solver stops once |f_i| <= tolerance*(1 + |y_i|) for every
+     * state variable.
+     *
+     * @param residualTolerance the tolerance (defaults to 1e-8)
+     */
+    void SetResidualTolerance(double residualTolerance);
+
+    /**
+     * @return the tolerance on the residual.
+     */
+    double GetResidualTolerance() const;
+
+    /**
+     * Set the maximum number of iterations of each attempt at the continuation.
+     *
+     * @param maxIterations the number of iterations (defaults to 100)
+     */
+    void SetMaxIterations(unsigned maxIterations);
+
+    /**
+     * Set how to integrate the tissue if the continuation fails.
+     *
+     * @param timeStep the timestep of the BDF solver (defaults to 0.1)
+     * @param interval the time to integrate for between attempts at the continuation (defaults to 1)
+     * @param maxTime the maximum time to integrate for, or 0 not to integrate (defaults to 100)
+     */
+    void SetFallback(double timeStep, double interval, double maxTime);
+
+    /**
+     * Find a steady state of the tissue, starting from its current state.
+     *
+     * @param rSystem the batch of Delta-Notch ODE systems, whose state variables are updated
+     * @return whether a steady state was found
+     */
+    bool FindSteadyState(MyDeltaNotchBatchOdeSystem& rSystem);
+
+    /**
+     * @return whether the last call to FindSteadyState() found a steady state.
+     */
+    bool HasConverged() const;
+
+    /**
+     * @return the number of iterations of the continuation in the last call to FindSteadyState().
+     */
+    unsigned GetNumIterations() const;
+
+    /**
+     * @return the residual norm, max |f_i|/(1 + |y_i|), at the end of the last call to FindSteadyState().
+     */
+    double GetResidualNorm() const;
+
+    /**
+     * @return the time for which the last call to FindSteadyState() integrated the tissue,
+     *     which is 0 unless the continuation failed at first.
+     */
+    double GetFallbackTime() const;
+};
+
+#endif /*MYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_*/
@@ -0,0 +1,343 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchBulkCheckpoint.hpp"
+
+#include <algorithm>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include <hdf5.h>
+
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+namespace
+{
+/** The number of columns of the "state" dataset: the SRN model's values and the parameter set index. */
+const unsigned NUM_STATE_COLUMNS = MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES + 1;
+
+/** The number of rows in each chunk of a compressed dataset. */
+const hsize_t CHUNK_ROWS = 4096;
+
+/**
+ * Write a two-dimensional dataset in one call.
+ *
+ * @param file the HDF5 file
+ * @param pName the name of the dataset
+ * @param type the HDF5 type of the values, in memory and in the file
+ * @param numRows the number of rows
+ * @param numColumns the number of columns
+ * @param compressionLevel the deflate level, or 0 for no compression
+ * @param pValues the values, row by row
+ */
+void WriteDataset(hid_t file, const char* pName, hid_t type, hsize_t numRows, hsize_t numColumns,
+                  unsigned compressionLevel, const void* pValues)
+{
+    hsize_t dims[2] = {numRows, numColumns};
+    hid_t space = H5Screate_simple(2, dims, NULL);
+
+    hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+    if (compressionLevel > 0 && numRows > 0)
+    {
+        hsize_t chunk_dims[2] = {std::min(numRows, CHUNK_ROWS), numColumns};
+        H5Pset_chunk(properties, 2, chunk_dims);
+        H5Pset_shuffle(properties);
+        H5Pset_deflate(properties, compressionLevel);
+    }
+
+    hid_t dataset = H5Dcreate2(file, pName, type, space, H5P_DEFAULT, properties, H5P_DEFAULT);
+    herr_t status = dataset;
+    if (dataset >= 0 && numRows > 0)
+    {
+        status = H5Dwrite(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, pValues);
+    }
+    if (dataset >= 0)
+    {
+        H5Dclose(dataset);
+    }
+    H5Pclose(properties);
+    H5Sclose(space);
+    if (status < 0)
+    {
+        EXCEPTION("Could not write the dataset " << pName << " of the checkpoint.");
+    }
+}
+
+/**
+ * Read a whole two-dimensional dataset in one call.
+ *
+ * @param file the HDF5 file
+ * @param pName the name of the dataset
+ * @param type the HDF5 type of the values in memory
+ * @param numColumns the number of columns the dataset should have
+ * @param rValues filled with the values, row by row
+ */
+template<typename T>
+void ReadDataset(hid_t file, const char* pName, hid_t type, hsize_t numColumns, std::vector<T>& rValues)
+{
+    hid_t dataset = -1;
+    if (H5Lexists(file, pName, H5P_DEFAULT) > 0)
+    {
+        dataset = H5Dopen2(file, pName, H5P_DEFAULT);
+    }
+    if (dataset < 0)
+    {
+        EXCEPTION("The checkpoint has no dataset " << pName << ".");
+    }
+
+    hid_t space = H5Dget_space(dataset);
+    hsize_t dims[2] = {0, 0};
+    int rank = H5Sget_simple_extent_dims(space, dims, NULL);
+    H5Sclose(space);
+    if (rank != 2 || dims[1] != numColumns)
+    {
+        H5Dclose(dataset);
+        EXCEPTION("The dataset " << pName << " of the checkpoint should have " << numColumns << " columns.");
+    }
+
+    rValues.resize(dims[0]*dims[1]);
+    herr_t status = 0;
+    if (!rValues.empty())
+    {
+        status = H5Dread(dataset, type, H5S_ALL, H5S_ALL, H5P_DEFAULT, rValues.data());
+    }
+    H5Dclose(dataset);
+    if (status < 0)
+    {
+        EXCEPTION("Could not read the dataset " << pName << " of the checkpoint.");
+    }
+}
+
+/**
+ * @param rFileName the path of a checkpoint file
+ * @return the file, opened for reading.
+ */
+hid_t OpenCheckpoint(const std::string& rFileName)
+{
+    hid_t file = H5Fopen(rFileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0)
+    {
+        EXCEPTION("Could not open the checkpoint " << rFileName << ".");
+    }
+    return file;
+}
+} // anonymous namespace
+
+template<unsigned DIM>
+void MyDeltaNotchBulkCheckpoint<DIM>::Save(AbstractCellPopulation<DIM,DIM>& rCellPopulation, const std::string& rFileName,
+                                           unsigned compressionLevel)
+{
+    if (compressionLevel > 9)
+    {
+        EXCEPTION("The compression level must be between 0 and 9.");
+    }
+
+    // Gather the state of each cell, numbering the distinct parameter sets as they are found
+    unsigned num_cells = rCellPopulation.GetNumRealCells();
+    std::vector<unsigned> cell_ids(num_cells);
+    std::vector<double> state(num_cells*NUM_STATE_COLUMNS);
+    std::map<const MyDeltaNotchParameters*, unsigned> parameter_set_indices;
+    std::vector<const MyDeltaNotchParameters*> parameter_sets;
+
+    unsigned row = 0;
+    for (typename AbstractCellPopulation<DIM,DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        MyDeltaNotchSrnModel* p_model = dynamic_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        if (p_model == nullptr)
+        {
+            EXCEPTION("Cell " << cell_iter->GetCellId() << " does not have a MyDeltaNotchSrnModel.");
+        }
+
+        double* p_row = &state[row*NUM_STATE_COLUMNS];
+        p_model->SaveCheckpointValues(p_row);
+
+        const MyDeltaNotchParameters* p_parameters = p_model->GetKineticParameters().get();
+        double parameter_set_index = -1.0;
+        if (p_parameters != nullptr)
+        {
+            std::map<const MyDeltaNotchParameters*, unsigned>::iterator it = parameter_set_indices.find(p_parameters);
+            if (it == parameter_set_indices.end())
+            {
+                it = parameter_set_indices.insert(std::make_pair(p_parameters, parameter_sets.size())).first;
+                parameter_sets.push_back(p_parameters);
+            }
+            parameter_set_index = it->second;
+        }
+        p_row[MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES] = parameter_set_index;
+
+        cell_ids[row] = cell_iter->GetCellId();
+        row++;
+    }
+
+    std::vector<std::string> parameter_names = MyDeltaNotchParameters::GetParameterNames();
+    std::vector<double> parameters;
+    parameters.reserve(parameter_sets.size()*parameter_names.size());
+    for (unsigned set=0; set<parameter_sets.size(); set++)
+    {
+        for (unsigned i=0; i<parameter_names.size(); i++)
+        {
+            parameters.push_back(parameter_sets[set]->GetParameter(parameter_names[i]));
+        }
+    }
+
+    hid_t file = H5Fcreate(rFileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (file < 0)
+    {
+        EXCEPTION("Could not create the checkpoint " << rFileName << ".");
+    }
+    try
+    {
+        WriteDataset(file, "cell_id", H5T_NATIVE_UINT, num_cells, 1, compressionLevel, cell_ids.data());
+        WriteDataset(file, "state", H5T_NATIVE_DOUBLE, num_cells, NUM_STATE_COLUMNS, compressionLevel, state.data());
+        WriteDataset(file, "parameters", H5T_NATIVE_DOUBLE, parameter_sets.size(), parameter_names.size(), 0, parameters.data());
+    }
+    catch (Exception&)
+    {
+        H5Fclose(file);
+        throw;
+    }
+
+    double time = SimulationTime::Instance()->GetTime();
+    hid_t space = H5Screate(H5S_SCALAR);
+    hid_t attribute = H5Acreate2(file, "time", H5T_NATIVE_DOUBLE, space, H5P_DEFAULT, H5P_DEFAULT);
+    H5Awrite(attribute, H5T_NATIVE_DOUBLE, &time);
+    H5Aclose(attribute);
+    H5Sclose(space);
+    H5Fclose(file);
+}
+
+template<unsigned DIM>
+void MyDeltaNotchBulkCheckpoint<DIM>::Load(AbstractCellPopulation<DIM,DIM>& rCellPopulation, const std::string& rFileName)
+{
+    std::vector<unsigned> cell_ids;
+    std::vector<double> state;
+    std::vector<double> parameters;
+    std::vector<std::string> parameter_names = MyDeltaNotchParameters::GetParameterNames();
+
+    hid_t file = OpenCheckpoint(rFileName);
+    try
+    {
+        ReadDataset(file, "cell_id", H5T_NATIVE_UINT, 1, cell_ids);
+        ReadDataset(file, "state", H5T_NATIVE_DOUBLE, NUM_STATE_COLUMNS, state);
+        ReadDataset(file, "parameters", H5T_NATIVE_DOUBLE, parameter_names.size(), parameters);
+    }
+    catch (Exception&)
+    {
+        H5Fclose(file);
+        throw;
+    }
+    H5Fclose(file);
+
+    if (state.size() != cell_ids.size()*NUM_STATE_COLUMNS)
+    {
+        EXCEPTION("The checkpoint " << rFileName << " has " << cell_ids.size() << " cell IDs but "
+                  << state.size()/NUM_STATE_COLUMNS << " rows of state.");
+    }
+
+    std::vector<boost::shared_ptr<MyDeltaNotchParameters> > parameter_sets(parameters.size()/parameter_names.size());
+    for (unsigned set=0; set<parameter_sets.size(); set++)
+    {
+        parameter_sets[set].reset(new MyDeltaNotchParameters);
+        for (unsigned i=0; i<parameter_names.size(); i++)
+        {
+            parameter_sets[set]->SetParameter(parameter_names[i], parameters[set*parameter_names.size() + i]);
+        }
+    }
+
+    std::unordered_map<unsigned, unsigned> rows;
+    rows.reserve(cell_ids.size());
+    for (unsigned row=0; row<cell_ids.size(); row++)
+    {
+        rows[cell_ids[row]] = row;
+    }
+
+    for (typename AbstractCellPopulation<DIM,DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        MyDeltaNotchSrnModel* p_model = dynamic_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        if (p_model == nullptr)
+        {
+            EXCEPTION("Cell " << cell_iter->GetCellId() << " does not have a MyDeltaNotchSrnModel.");
+        }
+        std::unordered_map<unsigned, unsigned>::const_iterator it = rows.find(cell_iter->GetCellId());
+        if (it == rows.end())
+        {
+            EXCEPTION("Cell " << cell_iter->GetCellId() << " is not in the checkpoint " << rFileName << ".");
+        }
+
+        const double* p_row = &state[it->second*NUM_STATE_COLUMNS];
+        p_model->LoadCheckpointValues(p_row);
+
+        int parameter_set_index = static_cast<int>(p_row[MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES]);
+        if (parameter_set_index >= static_cast<int>(parameter_sets.size()))
+        {
+            EXCEPTION("The checkpoint " << rFileName << " refers to a missing parameter set.");
+        }
+        p_model->SetKineticParameters(parameter_set_index < 0 ? boost::shared_ptr<MyDeltaNotchParameters>()
+                                                               : parameter_sets[parameter_set_index]);
+    }
+}
+
+template<unsigned DIM>
+double MyDeltaNotchBulkCheckpoint<DIM>::GetCheckpointTime(const std::string& rFileName)
+{
+    hid_t file = OpenCheckpoint(rFileName);
+    double time = DOUBLE_UNSET;
+    herr_t status = -1;
+    if (H5Aexists(file, "time") > 0)
+    {
+        hid_t attribute = H5Aopen(file, "time", H5P_DEFAULT);
+        status = H5Aread(attribute, H5T_NATIVE_DOUBLE, &time);
+        H5Aclose(attribute);
+    }
+    H5Fclose(file);
+    if (status < 0)
+    {
+        EXCEPTION("The checkpoint " << rFileName << " has no time.");
+    }
+    return time;
+}
+
+// Explicit instantiation
+template class MyDeltaNotchBulkCheckpoint<1>;
+template class MyDeltaNotchBulkCheckpoint<2>;
+template class MyDeltaNotchBulkCheckpoint<3>;
@@ -0,0 +1,91 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHBULKCHECKPOINT_HPP_
+#define MYDELTANOTCHBULKCHECKPOINT_HPP_
+
+#include <string>
+
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * Saves and restores the Delta-Notch state of every cell in a population as a single block,
+ * rather than through boost::serialization one object at a time.
+ *
+ * The checkpoint is an HDF5 file holding
+ *  - "cell_id", the ID of the cell in each row;
+ *  - "state", one row per cell of the values from MyDeltaNotchSrnModel::SaveCheckpointValues(),
+ *    followed by the index of the cell's kinetic parameter set, or -1 for the defaults;
+ *  - "parameters", one row per distinct parameter set, in the order of
+ *    MyDeltaNotchParameters::GetParameterNames();
+ * and the simulation time at which it was saved, as the attribute "time". The datasets may be
+ * compressed. The file is written and read with one call per dataset.
+ *
+ * The state is restored into a population with the same cell IDs (for example, one built
+ * afresh with the same geometry, or loaded from a Chaste archive whose SRN state is out of date),
+ * each of whose cells has a MyDeltaNotchSrnModel. Cells that shared a parameter set share the
+ * restored one. The SRN models' settings, such as their solver and timestep, are not saved.
+ */
+template<unsigned DIM>
+class MyDeltaNotchBulkCheckpoint
+{
+public:
+
+    /**
+     * Save the Delta-Notch state of every cell.
+     *
+     * @param rCellPopulation the cell population
+     * @param rFileName the path of the checkpoint file, which is replaced if it exists
+     * @param compressionLevel the deflate level, from 0 (no compression, the default) to 9
+     */
+    static void Save(AbstractCellPopulation<DIM,DIM>& rCellPopulation, const std::string& rFileName,
+                     unsigned compressionLevel=0);
+
+    /**
+     * Restore the Delta-Notch state of every cell. Each cell must be in the checkpoint.
+     *
+     * @param rCellPopulation the cell population
+     * @param rFileName the path of the checkpoint file
+     */
+    static void Load(AbstractCellPopulation<DIM,DIM>& rCellPopulation, const std::string& rFileName);
+
+    /**
+     * @param rFileName the path of a checkpoint file
+     * @return the simulation time at which the checkpoint was saved.
+     */
+    static double GetCheckpointTime(const std::string& rFileName);
+};
+
+#endif /*MYDELTANOTCHBULKCHECKPOINT_HPP_*/
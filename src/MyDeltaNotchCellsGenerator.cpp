@@ -0,0 +1,94 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include "MyDeltaNotchCellsGenerator.hpp"
+#include "MyDeltaNotchThreading.hpp"
+#include "Exception.hpp"
+
+const unsigned MyDeltaNotchCellsGenerator::NUM_VALUES_PER_CELL;
+
+MyDeltaNotchCellsGenerator::MyDeltaNotchCellsGenerator(uint64_t seed)
+    : mGenerator(seed),
+      mBirthTimeRange(0.0),
+      mNumThreads(0)
+{
+}
+
+void MyDeltaNotchCellsGenerator::SetBirthTimeRange(double birthTimeRange)
+{
+    if (birthTimeRange < 0.0)
+    {
+        EXCEPTION("The birth time range must be non-negative.");
+    }
+    mBirthTimeRange = birthTimeRange;
+}
+
+double MyDeltaNotchCellsGenerator::GetBirthTimeRange() const
+{
+    return mBirthTimeRange;
+}
+
+void MyDeltaNotchCellsGenerator::SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters)
+{
+    mpKineticParameters = pKineticParameters;
+}
+
+void MyDeltaNotchCellsGenerator::SetNumThreads(unsigned numThreads)
+{
+    mNumThreads = numThreads;
+}
+
+void MyDeltaNotchCellsGenerator::GenerateRandomValues(unsigned firstCellIndex,
+                                                      unsigned numCells,
+                                                      std::vector<double>& rInitialConditions,
+                                                      std::vector<double>& rBirthTimes) const
+{
+    rInitialConditions.resize(6*numCells);
+    rBirthTimes.resize(numCells);
+
+    // Each cell's values come from its own stream, so may be drawn by any thread
+    const int num_threads = ResolveMyDeltaNotchNumThreads(mNumThreads);
+    const int num_cells = numCells;
+    #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1)
+    for (int i=0; i<num_cells; i++)
+    {
+        double values[NUM_VALUES_PER_CELL];
+        mGenerator.GetUniforms(static_cast<uint64_t>(firstCellIndex) + i, NUM_VALUES_PER_CELL, values);
+        for (unsigned var=0; var<6; var++)
+        {
+            rInitialConditions[6*i + var] = values[var];
+        }
+        rBirthTimes[i] = -values[6]*mBirthTimeRange;
+    }
+}
@@ -0,0 +1,185 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef MYDELTANOTCHCELLSGENERATOR_HPP_
+#define MYDELTANOTCHCELLSGENERATOR_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "Cell.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyPhiloxRandomNumberGenerator.hpp"
+#include "SmartPointers.hpp"
+#include "WildTypeCellMutationState.hpp"
+
+/**
+ * Creates cells with MyDeltaNotchSrnModels, each with random initial conditions and,
+ * optionally, a random birth time, in the manner of CellsGenerator.
+ *
+ * The random values are drawn from a MyPhiloxRandomNumberGenerator rather than the
+ * RandomNumberGenerator singleton, with one stream per cell, so each cell's values depend
+ * only on the seed and the cell's index. They are drawn by mNumThreads OpenMP threads, and
+ * are identical for any number of threads and whatever cells are generated around them.
+ * The cells themselves are then created in order by a single thread, since creating a cell
+ * is not thread-safe (it allocates a cell ID, for example).
+ */
+class MyDeltaNotchCellsGenerator
+{
+private:
+
+    /** The source of the random values. */
+    MyPhiloxRandomNumberGenerator mGenerator;
+
+    /** Each cell's birth time is drawn uniformly from (-mBirthTimeRange, 0]; if this is 0, birth times are not set. */
+    double mBirthTimeRange;
+
+    /** The kinetic parameters given to every SRN model, or an empty pointer for the defaults. */
+    boost::shared_ptr<MyDeltaNotchParameters> mpKineticParameters;
+
+    /** The number of OpenMP threads among which the random values are drawn, or 0 for the OpenMP default. */
+    unsigned mNumThreads;
+
+public:
+
+    /** The number of random values drawn for each cell: its initial conditions and then its birth time. */
+    static const unsigned NUM_VALUES_PER_CELL = 7;
+
+    /**
+     * Constructor.
+     *
+     * @param seed the seed of the random values (defaults to 0)
+     */
+    MyDeltaNotchCellsGenerator(uint64_t seed=0);
+
+    /**
+     * Set the range of the cells' birth times, which are drawn uniformly from (-birthTimeRange, 0].
+     *
+     * @param birthTimeRange the range, or 0 (the default) to leave the birth times unset
+     */
+    void SetBirthTimeRange(double birthTimeRange);
+
+    /**
+     * @return the range of the cells' birth times (0 if they are not set).
+     */
+    double GetBirthTimeRange() const;
+
+    /**
+     * Set the kinetic parameters given to every SRN model.
+     *
+     * @param pKineticParameters the parameter set, or an empty pointer (the default) to use the defaults
+     */
+    void SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters);
+
+    /**
+     * Set the number of OpenMP threads among which the random values are drawn.
+     * This has no effect on the values themselves.
+     *
+     * @param numThreads the number of threads, or 0 (the default) for the OpenMP default
+     */
+    void SetNumThreads(unsigned numThreads);
+
+    /**
+     * Draw the random values of a range of cells: the initial conditions of each cell's
+     * SRN model, uniformly distributed on [0,1), and its birth time.
+     *
+     * @param firstCellIndex the index of the first cell
+     * @param numCells the number of cells
+     * @param rInitialConditions filled in with the initial conditions, cell by cell, so that those
+     *     of cell firstCellIndex+i start at index 6*i
+     * @param rBirthTimes filled in with the birth time of each cell (0 if the birth time range is 0)
+     */
+    void GenerateRandomValues(unsigned firstCellIndex,
+                              unsigned numCells,
+                              std::vector<double>& rInitialConditions,
+                              std::vector<double>& rBirthTimes) const;
+
+    /**
+     * Create cells with MyDeltaNotchSrnModels and the given cell-cycle model, whose initial
+     * conditions and birth times are drawn by GenerateRandomValues().
+     *
+     * @param rCells filled in with the cells
+     * @param numCells the number of cells
+     * @param pCellProliferativeType the proliferative type of every cell, or an empty pointer
+     *     (the default) for DifferentiatedCellProliferativeType
+     */
+    template<class CELL_CYCLE_MODEL, unsigned DIM>
+    void GenerateBasic(std::vector<CellPtr>& rCells,
+                       unsigned numCells,
+                       boost::shared_ptr<AbstractCellProperty> pCellProliferativeType=boost::shared_ptr<AbstractCellProperty>()) const;
+};
+
+template<class CELL_CYCLE_MODEL, unsigned DIM>
+void MyDeltaNotchCellsGenerator::GenerateBasic(std::vector<CellPtr>& rCells,
+                                               unsigned numCells,
+                                               boost::shared_ptr<AbstractCellProperty> pCellProliferativeType) const
+{
+    std::vector<double> initial_conditions;
+    std::vector<double> birth_times;
+    GenerateRandomValues(0, numCells, initial_conditions, birth_times);
+
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    if (!pCellProliferativeType)
+    {
+        pCellProliferativeType.reset(new DifferentiatedCellProliferativeType);
+    }
+
+    rCells.clear();
+    rCells.reserve(numCells);
+    for (unsigned cell_index=0; cell_index<numCells; cell_index++)
+    {
+        CELL_CYCLE_MODEL* p_cell_cycle_model = new CELL_CYCLE_MODEL;
+        p_cell_cycle_model->SetDimension(DIM);
+
+        MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel();
+        p_srn_model->SetInitialConditions(std::vector<double>(initial_conditions.begin() + 6*cell_index,
+                                                              initial_conditions.begin() + 6*(cell_index + 1)));
+        if (mpKineticParameters)
+        {
+            p_srn_model->SetKineticParameters(mpKineticParameters);
+        }
+
+        CellPtr p_cell(new Cell(p_state, p_cell_cycle_model, p_srn_model));
+        p_cell->SetCellProliferativeType(pCellProliferativeType);
+        if (mBirthTimeRange > 0.0)
+        {
+            p_cell->SetBirthTime(birth_times[cell_index]);
+        }
+        rCells.push_back(p_cell);
+    }
+}
+
+#endif /*MYDELTANOTCHCELLSGENERATOR_HPP_*/
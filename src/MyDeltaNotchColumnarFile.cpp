@@ -0,0 +1,294 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchColumnarFile.hpp"
+
+#include <cassert>
+
+#include "Exception.hpp"
+
+/** The chunk size of the per-sample datasets, which are much shorter than the per-cell ones. */
+static const hsize_t SAMPLE_CHUNK_SIZE = 1024;
+
+MyDeltaNotchColumnarFile::MyDeltaNotchColumnarFile(const std::string& rFileName, unsigned compressionLevel, unsigned chunkSize)
+    : mFileId(-1),
+      mLocationIndexDataset(-1),
+      mTimeDataset(-1),
+      mSampleStartDataset(-1),
+      mChunkSize(chunkSize),
+      mNumRowsWritten(0),
+      mNumSamplesWritten(0),
+      mNumRows(0)
+{
+    if (compressionLevel > 9)
+    {
+        EXCEPTION("The compression level must be between 0 and 9.");
+    }
+    if (chunkSize == 0)
+    {
+        EXCEPTION("The chunk size must be positive.");
+    }
+    if (compressionLevel > 0 && H5Zfilter_avail(H5Z_FILTER_DEFLATE) <= 0)
+    {
+        EXCEPTION("This HDF5 library does not support deflate compression.");
+    }
+
+    mFileId = H5Fcreate(rFileName.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
+    if (mFileId < 0)
+    {
+        EXCEPTION("Could not create the HDF5 file " << rFileName << ".");
+    }
+
+    for (unsigned field=0; field<NUM_FIELDS; field++)
+    {
+        mFieldDatasets[field] = CreateDataset(GetFieldName(field), H5T_NATIVE_DOUBLE, compressionLevel, chunkSize);
+        mFieldBuffers[field].reserve(chunkSize);
+    }
+    mLocationIndexDataset = CreateDataset("location_index", H5T_NATIVE_UINT, compressionLevel, chunkSize);
+    mTimeDataset = CreateDataset("time", H5T_NATIVE_DOUBLE, compressionLevel, SAMPLE_CHUNK_SIZE);
+    mSampleStartDataset = CreateDataset("sample_start", H5T_NATIVE_ULONG, compressionLevel, SAMPLE_CHUNK_SIZE);
+    mLocationIndexBuffer.reserve(chunkSize);
+}
+
+MyDeltaNotchColumnarFile::~MyDeltaNotchColumnarFile()
+{
+    if (IsOpen())
+    {
+        try
+        {
+            Close();
+        }
+        catch (Exception&)
+        {
+            // Destructors must not throw
+        }
+    }
+}
+
+hid_t MyDeltaNotchColumnarFile::CreateDataset(const std::string& rName, hid_t type, unsigned compressionLevel, hsize_t chunkSize)
+{
+    hsize_t dims = 0;
+    hsize_t max_dims = H5S_UNLIMITED;
+    hid_t space = H5Screate_simple(1, &dims, &max_dims);
+
+    hid_t properties = H5Pcreate(H5P_DATASET_CREATE);
+    H5Pset_chunk(properties, 1, &chunkSize);
+    if (compressionLevel > 0)
+    {
+        // Shuffling the bytes of neighbouring values first makes smooth fields compress much better
+        H5Pset_shuffle(properties);
+        H5Pset_deflate(properties, compressionLevel);
+    }
+
+    hid_t dataset = H5Dcreate2(mFileId, rName.c_str(), type, space, H5P_DEFAULT, properties, H5P_DEFAULT);
+    H5Pclose(properties);
+    H5Sclose(space);
+    if (dataset < 0)
+    {
+        EXCEPTION("Could not create the HDF5 dataset " << rName << ".");
+    }
+    return dataset;
+}
+
+void MyDeltaNotchColumnarFile::AppendToDataset(hid_t dataset, hid_t memoryType, unsigned long numValuesWritten,
+                                               unsigned long numValues, const void* pValues)
+{
+    if (numValues == 0)
+    {
+        return;
+    }
+
+    hsize_t start = numValuesWritten;
+    hsize_t count = numValues;
+    hsize_t new_size = start + count;
+    herr_t status = H5Dset_extent(dataset, &new_size);
+
+    hid_t file_space = H5Dget_space(dataset);
+    H5Sselect_hyperslab(file_space, H5S_SELECT_SET, &start, NULL, &count, NULL);
+    hid_t memory_space = H5Screate_simple(1, &count, NULL);
+    if (status >= 0)
+    {
+        status = H5Dwrite(dataset, memoryType, memory_space, file_space, H5P_DEFAULT, pValues);
+    }
+    H5Sclose(memory_space);
+    H5Sclose(file_space);
+    if (status < 0)
+    {
+        EXCEPTION("Could not write to the HDF5 file.");
+    }
+}
+
+void MyDeltaNotchColumnarFile::Flush()
+{
+    unsigned long num_rows = mLocationIndexBuffer.size();
+    for (unsigned field=0; field<NUM_FIELDS; field++)
+    {
+        AppendToDataset(mFieldDatasets[field], H5T_NATIVE_DOUBLE, mNumRowsWritten, num_rows, mFieldBuffers[field].data());
+        mFieldBuffers[field].clear();
+    }
+    AppendToDataset(mLocationIndexDataset, H5T_NATIVE_UINT, mNumRowsWritten, num_rows, mLocationIndexBuffer.data());
+    mLocationIndexBuffer.clear();
+    mNumRowsWritten += num_rows;
+
+    unsigned long num_samples = mTimeBuffer.size();
+    AppendToDataset(mTimeDataset, H5T_NATIVE_DOUBLE, mNumSamplesWritten, num_samples, mTimeBuffer.data());
+    AppendToDataset(mSampleStartDataset, H5T_NATIVE_ULONG, mNumSamplesWritten, num_samples, mSampleStartBuffer.data());
+    mTimeBuffer.clear();
+    mSampleStartBuffer.clear();
+    mNumSamplesWritten += num_samples;
+}
+
+void MyDeltaNotchColumnarFile::AppendSample(double time, const std::vector<unsigned>& rLocationIndices, const std::vector<double>& rFields)
+{
+    if (!IsOpen())
+    {
+        EXCEPTION("Cannot append a sample to a closed file.");
+    }
+    unsigned num_cells = rLocationIndices.size();
+    if (rFields.size() != NUM_FIELDS*num_cells)
+    {
+        EXCEPTION("There should be " << NUM_FIELDS << " fields for each of the " << num_cells << " cells.");
+    }
+
+    mTimeBuffer.push_back(time);
+    mSampleStartBuffer.push_back(mNumRows);
+    mLocationIndexBuffer.insert(mLocationIndexBuffer.end(), rLocationIndices.begin(), rLocationIndices.end());
+    for (unsigned field=0; field<NUM_FIELDS; field++)
+    {
+        std::vector<double>::const_iterator field_begin = rFields.begin() + field*num_cells;
+        mFieldBuffers[field].insert(mFieldBuffers[field].end(), field_begin, field_begin + num_cells);
+    }
+    mNumRows += num_cells;
+
+    if (mLocationIndexBuffer.size() >= mChunkSize || mTimeBuffer.size() >= SAMPLE_CHUNK_SIZE)
+    {
+        Flush();
+    }
+}
+
+void MyDeltaNotchColumnarFile::Close()
+{
+    if (!IsOpen())
+    {
+        return;
+    }
+    Flush();
+
+    for (unsigned field=0; field<NUM_FIELDS; field++)
+    {
+        H5Dclose(mFieldDatasets[field]);
+    }
+    H5Dclose(mLocationIndexDataset);
+    H5Dclose(mTimeDataset);
+    H5Dclose(mSampleStartDataset);
+    H5Fclose(mFileId);
+    mFileId = -1;
+}
+
+bool MyDeltaNotchColumnarFile::IsOpen() const
+{
+    return mFileId >= 0;
+}
+
+unsigned long MyDeltaNotchColumnarFile::GetNumSamples() const
+{
+    return mNumSamplesWritten + mTimeBuffer.size();
+}
+
+const char* MyDeltaNotchColumnarFile::GetFieldName(unsigned field)
+{
+    static const char* field_names[NUM_FIELDS] = {"cell_surface_notch",
+                                                  "sudx_dependent_notch",
+                                                  "dx_dependent_early_endosome_notch",
+                                                  "dx_dependent_late_endosome_notch",
+                                                  "notch_intracellular_domain",
+                                                  "delta",
+                                                  "total_notch",
+                                                  "mean_delta",
+                                                  "x_distance"};
+    assert(field < NUM_FIELDS);
+    return field_names[field];
+}
+
+template<typename T>
+void MyDeltaNotchColumnarFile::ReadDataset(const std::string& rFileName, const std::string& rName, hid_t memoryType,
+                                           std::vector<T>& rValues)
+{
+    hid_t file = H5Fopen(rFileName.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT);
+    if (file < 0)
+    {
+        EXCEPTION("Could not open the HDF5 file " << rFileName << ".");
+    }
+    hid_t dataset = -1;
+    if (H5Lexists(file, rName.c_str(), H5P_DEFAULT) > 0)
+    {
+        dataset = H5Dopen2(file, rName.c_str(), H5P_DEFAULT);
+    }
+    if (dataset < 0)
+    {
+        H5Fclose(file);
+        EXCEPTION("The HDF5 file " << rFileName << " has no dataset " << rName << ".");
+    }
+
+    hid_t space = H5Dget_space(dataset);
+    hsize_t size = H5Sget_simple_extent_npoints(space);
+    rValues.resize(size);
+    herr_t status = 0;
+    if (size > 0)
+    {
+        status = H5Dread(dataset, memoryType, H5S_ALL, H5S_ALL, H5P_DEFAULT, rValues.data());
+    }
+    H5Sclose(space);
+    H5Dclose(dataset);
+    H5Fclose(file);
+    if (status < 0)
+    {
+        EXCEPTION("Could not read the dataset " << rName << " of the HDF5 file " << rFileName << ".");
+    }
+}
+
+std::vector<double> MyDeltaNotchColumnarFile::ReadDoubleColumn(const std::string& rFileName, const std::string& rName)
+{
+    std::vector<double> values;
+    ReadDataset(rFileName, rName, H5T_NATIVE_DOUBLE, values);
+    return values;
+}
+
+std::vector<unsigned long> MyDeltaNotchColumnarFile::ReadIndexColumn(const std::string& rFileName, const std::string& rName)
+{
+    std::vector<unsigned long> values;
+    ReadDataset(rFileName, rName, H5T_NATIVE_ULONG, values);
+    return values;
+}
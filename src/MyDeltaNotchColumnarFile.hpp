@@ -0,0 +1,216 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHCOLUMNARFILE_HPP_
+#define MYDELTANOTCHCOLUMNARFILE_HPP_
+
+#include <string>
+#include <vector>
+
+#include <hdf5.h>
+
+/**
+ * A compressed, column-oriented HDF5 file of the Delta-Notch fields of every cell at a series of
+ * sampling times.
+ *
+ * Each field is a separate one-dimensional dataset, in which the values of all the cells at the
+ * first sample are followed by those at the second sample, and so on, so reading one field over
+ * the whole simulation is a single sequential read. The fields are the six state variables of
+ * MyDeltaNotchOdeSystem, named as in GetFieldName(), followed by "total_notch", "mean_delta" and
+ * "x_distance". The file also holds
+ *  - "location_index", the location index of the cell in each row;
+ *  - "time", the time of each sample;
+ *  - "sample_start", the first row of each sample, since the number of cells may change.
+ *
+ * The datasets are chunked and, unless the compression level is zero, shuffled and deflated.
+ * Rows are buffered in memory and written a chunk at a time, so the file is only complete
+ * once Close() has been called.
+ */
+class MyDeltaNotchColumnarFile
+{
+public:
+
+    /** The number of fields stored for each cell. */
+    static const unsigned NUM_FIELDS = 9;
+
+private:
+
+    /** The HDF5 file. */
+    hid_t mFileId;
+
+    /** The dataset of each field. */
+    hid_t mFieldDatasets[NUM_FIELDS];
+
+    /** The dataset of location indices. */
+    hid_t mLocationIndexDataset;
+
+    /** The dataset of sample times. */
+    hid_t mTimeDataset;
+
+    /** The dataset of the first row of each sample. */
+    hid_t mSampleStartDataset;
+
+    /** The number of rows to write at a time, which is also the chunk size of the per-cell datasets. */
+    unsigned mChunkSize;
+
+    /** The number of rows written to the file. */
+    unsigned long mNumRowsWritten;
+
+    /** The number of samples written to the file. */
+    unsigned long mNumSamplesWritten;
+
+    /** The number of rows appended, including those not yet written. */
+    unsigned long mNumRows;
+
+    /** The values of each field appended but not yet written. */
+    std::vector<double> mFieldBuffers[NUM_FIELDS];
+
+    /** The location indices appended but not yet written. */
+    std::vector<unsigned> mLocationIndexBuffer;
+
+    /** The sample times appended but not yet written. */
+    std::vector<double> mTimeBuffer;
+
+    /** The first row of each sample appended but not yet written. */
+    std::vector<unsigned long> mSampleStartBuffer;
+
+    /**
+     * Create an extendible, chunked one-dimensional dataset.
+     *
+     * @param rName the name of the dataset
+     * @param type the HDF5 type of the values stored
+     * @param compressionLevel the deflate level, or 0 for no compression
+     * @param chunkSize the number of values in each chunk
+     * @return the dataset.
+     */
+    hid_t CreateDataset(const std::string& rName, hid_t type, unsigned compressionLevel, hsize_t chunkSize);
+
+    /**
+     * Append values to the end of a dataset.
+     *
+     * @param dataset the dataset
+     * @param memoryType the HDF5 type of the values in memory
+     * @param numValuesWritten the number of values already in the dataset
+     * @param numValues the number of values to append
+     * @param pValues the values
+     */
+    void AppendToDataset(hid_t dataset, hid_t memoryType, unsigned long numValuesWritten,
+                         unsigned long numValues, const void* pValues);
+
+    /**
+     * Write the buffered rows and samples to the file.
+     */
+    void Flush();
+
+    /**
+     * Read a whole dataset.
+     *
+     * @param rFileName the path of the file
+     * @param rName the name of the dataset
+     * @param memoryType the HDF5 type of the values in memory
+     * @param rValues filled with the values, which must be of the given type
+     */
+    template<typename T>
+    static void ReadDataset(const std::string& rFileName, const std::string& rName, hid_t memoryType,
+                            std::vector<T>& rValues);
+
+public:
+
+    /**
+     * Constructor, which creates the file, replacing any existing file.
+     *
+     * @param rFileName the path of the file
+     * @param compressionLevel the deflate level, from 0 (no compression) to 9 (defaults to 1)
+     * @param chunkSize the number of values in each chunk of each dataset (defaults to 65536)
+     */
+    MyDeltaNotchColumnarFile(const std::string& rFileName, unsigned compressionLevel=1, unsigned chunkSize=65536);
+
+    /**
+     * Destructor, which closes the file if this has not been done.
+     */
+    ~MyDeltaNotchColumnarFile();
+
+    /**
+     * Append a sample.
+     *
+     * @param time the time of the sample
+     * @param rLocationIndices the location index of each cell
+     * @param rFields the values of each field, in the order given by GetFieldName(), for each cell
+     *     in the same order as rLocationIndices; so the value of field i for cell j is
+     *     rFields[i*rLocationIndices.size() + j]
+     */
+    void AppendSample(double time, const std::vector<unsigned>& rLocationIndices, const std::vector<double>& rFields);
+
+    /**
+     * Write any buffered data and close the file. Further samples may not be appended.
+     */
+    void Close();
+
+    /**
+     * @return whether the file is open.
+     */
+    bool IsOpen() const;
+
+    /**
+     * @return the number of samples appended.
+     */
+    unsigned long GetNumSamples() const;
+
+    /**
+     * @param field the index of a field, less than NUM_FIELDS
+     * @return the name of the dataset of the field.
+     */
+    static const char* GetFieldName(unsigned field);
+
+    /**
+     * Read a field, or the sample times, from a file.
+     *
+     * @param rFileName the path of the file
+     * @param rName the name of the dataset, which is a field name or "time"
+     * @return the values.
+     */
+    static std::vector<double> ReadDoubleColumn(const std::string& rFileName, const std::string& rName);
+
+    /**
+     * Read the location indices, or the first row of each sample, from a file.
+     *
+     * @param rFileName the path of the file
+     * @param rName the name of the dataset, which is "location_index" or "sample_start"
+     * @return the values.
+     */
+    static std::vector<unsigned long> ReadIndexColumn(const std::string& rFileName, const std::string& rName);
+};
+
+#endif /*MYDELTANOTCHCOLUMNARFILE_HPP_*/
@@ -0,0 +1,174 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchColumnarOutputModifier.hpp"
+
+#include <cassert>
+
+#include "MyDeltaNotchSrnModel.hpp"
+#include "OutputFileHandler.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+template<unsigned DIM>
+MyDeltaNotchColumnarOutputModifier<DIM>::MyDeltaNotchColumnarOutputModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mCompressionLevel(1),
+      mLastOutputTime(DOUBLE_UNSET)
+{
+}
+
+template<unsigned DIM>
+MyDeltaNotchColumnarOutputModifier<DIM>::~MyDeltaNotchColumnarOutputModifier()
+{
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::WriteSample(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    double time = SimulationTime::Instance()->GetTime();
+    if (!mpFile || time == mLastOutputTime)
+    {
+        return;
+    }
+    mLastOutputTime = time;
+
+    unsigned num_cells = rCellPopulation.GetNumRealCells();
+    mLocationIndices.resize(num_cells);
+    mFields.resize(MyDeltaNotchColumnarFile::NUM_FIELDS*num_cells);
+
+    unsigned cell_index = 0;
+    for (typename AbstractCellPopulation<DIM,DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        const std::vector<double>& r_state = p_model->rGetStateVariables();
+        double total_notch = 0.0;
+        for (unsigned var=0; var<6; var++)
+        {
+            mFields[var*num_cells + cell_index] = r_state[var];
+            if (var < 5)
+            {
+                total_notch += r_state[var];
+            }
+        }
+
+        // As in MyDeltaNotchStateWriter, use the latest inputs from the state store if there is one
+        double mean_delta = p_model->GetMeanNeighbouringDelta();
+        double x_distance = p_model->GetXDistance();
+        boost::shared_ptr<MyDeltaNotchStateStore> p_state_store = p_model->GetStateStore();
+        if (p_state_store)
+        {
+            mean_delta = p_state_store->rGetMeanDelta()[p_model->GetStateStoreIndex()];
+            x_distance = p_state_store->rGetXDistance()[p_model->GetStateStoreIndex()];
+        }
+        mFields[6*num_cells + cell_index] = total_notch;
+        mFields[7*num_cells + cell_index] = mean_delta;
+        mFields[8*num_cells + cell_index] = x_distance;
+
+        mLocationIndices[cell_index] = rCellPopulation.GetLocationIndexUsingCell(*cell_iter);
+        cell_index++;
+    }
+    assert(cell_index == num_cells);
+
+    mpFile->AppendSample(time, mLocationIndices, mFields);
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    OutputFileHandler output_file_handler(outputDirectory + "/", false);
+    mpFile.reset(new MyDeltaNotchColumnarFile(output_file_handler.GetOutputDirectoryFullPath() + "deltanotch.h5",
+                                              mCompressionLevel));
+    mLastOutputTime = DOUBLE_UNSET;
+    WriteSample(rCellPopulation);
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    WriteSample(rCellPopulation);
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    WriteSample(rCellPopulation);
+    if (mpFile)
+    {
+        mpFile->Close();
+        mpFile.reset();
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::SetCompressionLevel(unsigned compressionLevel)
+{
+    if (compressionLevel > 9)
+    {
+        EXCEPTION("The compression level must be between 0 and 9.");
+    }
+    mCompressionLevel = compressionLevel;
+}
+
+template<unsigned DIM>
+unsigned MyDeltaNotchColumnarOutputModifier<DIM>::GetCompressionLevel() const
+{
+    return mCompressionLevel;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchColumnarOutputModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    *rParamsFile << "\t\t\t<CompressionLevel>" << mCompressionLevel << "</CompressionLevel>\n";
+
+    // Next, call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MyDeltaNotchColumnarOutputModifier<1>;
+template class MyDeltaNotchColumnarOutputModifier<2>;
+template class MyDeltaNotchColumnarOutputModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchColumnarOutputModifier)
@@ -0,0 +1,165 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHCOLUMNAROUTPUTMODIFIER_HPP_
+#define MYDELTANOTCHCOLUMNAROUTPUTMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "MyDeltaNotchColumnarFile.hpp"
+
+/**
+ * A modifier that writes the Delta-Notch fields of every cell to a MyDeltaNotchColumnarFile,
+ * deltanotch.h5 in the simulation's output directory, at the start of the simulation, at each
+ * sampling timestep and at the end of the simulation.
+ *
+ * The values are read in the same way as MyDeltaNotchStateWriter, but are written as compressed
+ * binary columns rather than text, so this is much faster to write and read for long simulations.
+ * It should be added to the simulation after MyDeltaNotchTrackingModifier, so that the mean
+ * neighbouring Delta and x distance written at the start are those computed in its SetupSolve().
+ *
+ * The file is created afresh by SetupSolve(), so a simulation loaded from a checkpoint should be
+ * given a new output directory.
+ */
+template<unsigned DIM>
+class MyDeltaNotchColumnarOutputModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        archive & mCompressionLevel;
+    }
+
+    /** The deflate level of the output file, from 0 (no compression) to 9. Defaults to 1. */
+    unsigned mCompressionLevel;
+
+    /** The output file, which is open between SetupSolve() and UpdateAtEndOfSolve(). */
+    boost::shared_ptr<MyDeltaNotchColumnarFile> mpFile;
+
+    /** The simulation time of the last sample written, so it is not repeated at the end of the simulation. */
+    double mLastOutputTime;
+
+    /** The location index of each cell in the current sample. */
+    std::vector<unsigned> mLocationIndices;
+
+    /** The fields of each cell in the current sample, laid out as for MyDeltaNotchColumnarFile::AppendSample(). */
+    std::vector<double> mFields;
+
+    /**
+     * Append the current fields of every cell to the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void WriteSample(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    MyDeltaNotchColumnarOutputModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MyDeltaNotchColumnarOutputModifier();
+
+    /**
+     * Overridden SetupSolve() method, which creates the output file and writes the initial sample.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method, which does nothing.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method, which writes a sample.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method, which writes the final sample and closes the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Set the deflate level of the output file.
+     *
+     * @param compressionLevel the level, from 0 (no compression) to 9
+     */
+    void SetCompressionLevel(unsigned compressionLevel);
+
+    /**
+     * @return the deflate level of the output file.
+     */
+    unsigned GetCompressionLevel() const;
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchColumnarOutputModifier)
+
+#endif /*MYDELTANOTCHCOLUMNAROUTPUTMODIFIER_HPP_*/
@@ -0,0 +1,253 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchFrozenTissueSimulation.hpp"
+
+#include <cmath>
+
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+template<unsigned DIM>
+MyDeltaNotchFrozenTissueSimulation<DIM>::MyDeltaNotchFrozenTissueSimulation(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+    : mTime(0.0),
+      mDt(0.0),
+      mCouplingTimestep(0.0),
+      mImplicitTimestep(0.0)
+{
+    // Extract the neighbour relation, whose rows are in the order in which the population's iterator visits cells
+    rCellPopulation.Update();
+    mNeighbourGraph.Update(rCellPopulation);
+    mpStateStore.reset(new MyDeltaNotchStateStore(mNeighbourGraph.GetNumLocations()));
+
+    boost::shared_ptr<MyDeltaNotchParameters> p_kinetic_parameters;
+    std::vector<double> cell_x;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        MyDeltaNotchSrnModel* p_model = dynamic_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        if (p_model == nullptr)
+        {
+            EXCEPTION("Every cell in a frozen tissue must have a MyDeltaNotchSrnModel.");
+        }
+        if (mSrnModels.empty())
+        {
+            mTime = p_model->GetSimulatedToTime();
+            mDt = p_model->GetDt();
+            p_kinetic_parameters = p_model->GetKineticParameters();
+        }
+        else if ((p_model->GetSimulatedToTime() != mTime)
+                 || (p_model->GetDt() != mDt)
+                 || (p_model->GetKineticParameters() != p_kinetic_parameters))
+        {
+            EXCEPTION("Every cell in a frozen tissue must have the same kinetic parameters, ODE timestep and simulated-to time.");
+        }
+        mSrnModels.push_back(p_model);
+        cell_x.push_back(rCellPopulation.GetLocationOfCellCentre(*cell_iter)[0]);
+    }
+
+    // Gather the state of each cell and its x distance, which stays fixed with the geometry
+    const unsigned num_cells = mSrnModels.size();
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES;
+    const std::vector<unsigned>& r_location_indices = mNeighbourGraph.rGetLocationIndices();
+    mBatchOdeSystem.Resize(num_cells);
+    mBatchOdeSystem.SetKineticParameters(p_kinetic_parameters);
+    std::vector<double>& r_batch_state = mBatchOdeSystem.rGetStateVariables();
+    std::vector<double>& r_x_distance = mBatchOdeSystem.rGetXDistance();
+
+    c_vector<double,DIM> population_centroid = rCellPopulation.GetCentroidOfCellPopulation();
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        MyDeltaNotchSrnModel* p_model = mSrnModels[row];
+        const std::vector<double>& r_state = p_model->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_batch_state[var*num_cells + row] = r_state[var];
+        }
+        r_x_distance[row] = fabs(cell_x[row] - population_centroid[0]);
+        p_model->SetStateStore(mpStateStore, r_location_indices[row]);
+    }
+
+    UpdateCoupling();
+    ScatterToSrnModels();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchFrozenTissueSimulation<DIM>::UpdateCoupling()
+{
+    const unsigned num_cells = mSrnModels.size();
+    const unsigned delta_offset = (MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES - 1)*num_cells;
+    const std::vector<double>& r_batch_state = mBatchOdeSystem.rGetStateVariables();
+    mDelta.assign(r_batch_state.begin() + delta_offset, r_batch_state.begin() + delta_offset + num_cells);
+    mNeighbourGraph.ComputeNeighbourMeans(mDelta, mBatchOdeSystem.rGetMeanDelta());
+}
+
+template<unsigned DIM>
+void MyDeltaNotchFrozenTissueSimulation<DIM>::ScatterToSrnModels()
+{
+    const unsigned num_cells = mSrnModels.size();
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES;
+    const std::vector<unsigned>& r_location_indices = mNeighbourGraph.rGetLocationIndices();
+    const std::vector<double>& r_batch_state = mBatchOdeSystem.rGetStateVariables();
+    std::vector<double>& r_mean_delta = mpStateStore->rGetMeanDelta();
+    std::vector<double>& r_x_distance = mpStateStore->rGetXDistance();
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        MyDeltaNotchSrnModel* p_model = mSrnModels[row];
+        std::vector<double>& r_state = p_model->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_state[var] = r_batch_state[var*num_cells + row];
+        }
+        p_model->SetSimulatedToTime(mTime);
+
+        r_mean_delta[r_location_indices[row]] = mBatchOdeSystem.rGetMeanDelta()[row];
+        r_x_distance[r_location_indices[row]] = mBatchOdeSystem.rGetXDistance()[row];
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchFrozenTissueSimulation<DIM>::SetCouplingTimestep(double couplingTimestep)
+{
+    if (couplingTimestep < 0.0)
+    {
+        EXCEPTION("The coupling timestep must be non-negative.");
+    }
+    mCouplingTimestep = couplingTimestep;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchFrozenTissueSimulation<DIM>::GetCouplingTimestep() const
+{
+    return mCouplingTimestep;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchFrozenTissueSimulation<DIM>::SetImplicitTimestep(double implicitTimestep)
+{
+    if (implicitTimestep < 0.0)
+    {
+        EXCEPTION("The implicit timestep must be non-negative.");
+    }
+    mImplicitTimestep = implicitTimestep;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchFrozenTissueSimulation<DIM>::GetImplicitTimestep() const
+{
+    return mImplicitTimestep;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchFrozenTissueSimulation<DIM>::GetTime() const
+{
+    return mTime;
+}
+
+template<unsigned DIM>
+unsigned MyDeltaNotchFrozenTissueSimulation<DIM>::GetNumCells() const
+{
+    return mSrnModels.size();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchFrozenTissueSimulation<DIM>::Solve(double endTime)
+{
+    if (endTime < mTime)
+    {
+        EXCEPTION("Cannot solve a frozen tissue back to time " << endTime << " from time " << mTime << ".");
+    }
+
+    if (mImplicitTimestep > 0.0)
+    {
+        // Solve the tissue as one coupled system, with the coupling treated implicitly
+        mImplicitSolver.SetNeighbourGraph(&mNeighbourGraph);
+        mImplicitSolver.Solve(mBatchOdeSystem, mTime, endTime, mImplicitTimestep);
+    }
+    else if (mCouplingTimestep == 0.0)
+    {
+        // Solve the tissue as one coupled system
+        mBatchSolver.SetNeighbourGraph(&mNeighbourGraph);
+        mBatchSolver.Solve(mBatchOdeSystem, mTime, endTime, mDt);
+        mBatchSolver.SetNeighbourGraph(nullptr);
+    }
+    else
+    {
+        // Hold the coupling fixed over each coupling timestep
+        TimeStepper stepper(mTime, endTime, mCouplingTimestep);
+        while (!stepper.IsTimeAtEnd())
+        {
+            UpdateCoupling();
+            mBatchSolver.Solve(mBatchOdeSystem, stepper.GetTime(), stepper.GetNextTime(), mDt);
+            stepper.AdvanceOneTimeStep();
+        }
+    }
+    mTime = endTime;
+
+    UpdateCoupling();
+    ScatterToSrnModels();
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchFrozenTissueSimulation<DIM>::SolveToSteadyState(double preIntegrationTime)
+{
+    if (preIntegrationTime < 0.0)
+    {
+        EXCEPTION("The pre-integration time must be non-negative.");
+    }
+    if (preIntegrationTime > 0.0)
+    {
+        Solve(mTime + preIntegrationTime);
+    }
+
+    mSteadyStateSolver.SetNeighbourGraph(&mNeighbourGraph);
+    bool converged = mSteadyStateSolver.FindSteadyState(mBatchOdeSystem);
+
+    UpdateCoupling();
+    ScatterToSrnModels();
+    return converged;
+}
+
+template<unsigned DIM>
+MyDeltaNotchBatchSteadyStateSolver& MyDeltaNotchFrozenTissueSimulation<DIM>::rGetSteadyStateSolver()
+{
+    return mSteadyStateSolver;
+}
+
+// Explicit instantiation
+template class MyDeltaNotchFrozenTissueSimulation<1>;
+template class MyDeltaNotchFrozenTissueSimulation<2>;
+template class MyDeltaNotchFrozenTissueSimulation<3>;
@@ -0,0 +1,199 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHFROZENTISSUESIMULATION_HPP_
+#define MYDELTANOTCHFROZENTISSUESIMULATION_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellPopulation.hpp"
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchBatchSteadyStateSolver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchStateStore.hpp"
+
+/**
+ * Solves Delta-Notch signalling on a tissue whose geometry does not change.
+ *
+ * When the cells neither move, divide nor die, the only part of a cell-based simulation that
+ * matters is the Delta-Notch system. This class extracts the neighbour relation and each cell's
+ * x distance from the population once, on construction, and gathers every cell's state into a
+ * MyDeltaNotchBatchOdeSystem. Solve() then advances the whole tissue as one ODE system with a
+ * fixed sparse coupling, without OffLatticeSimulation, forces, the population's Update() or
+ * writers, and scatters the state back into the cells' SRN models at the end. A caller wanting
+ * output at several times calls Solve() for each, then writes the population as usual.
+ *
+ * By default the coupling is refreshed at every stage of the solver, so the tissue is solved
+ * as a single coupled ODE system. With a coupling timestep (see SetCouplingTimestep()), the
+ * mean level of Delta in each cell's neighbours is instead held fixed over each coupling
+ * timestep, as MyDeltaNotchTrackingModifier does over each simulation timestep; setting it to
+ * the simulation timestep reproduces the results of a full simulation of a static tissue.
+ * With an implicit timestep (see SetImplicitTimestep()), the coupled system is instead solved
+ * with MyDeltaNotchBatchBdfSolver, whose timestep is limited only by accuracy. SolveToSteadyState()
+ * skips the dynamics altogether, and finds the pattern that the tissue settles to directly.
+ *
+ * Every cell must have a MyDeltaNotchSrnModel, and all must share the same kinetic parameters,
+ * ODE timestep and simulated-to time. SimulationTime is not used or changed.
+ */
+template<unsigned DIM>
+class MyDeltaNotchFrozenTissueSimulation
+{
+private:
+
+    /** The neighbour relation of the tissue. */
+    MyDeltaNotchNeighbourGraph mNeighbourGraph;
+
+    /** The SRN model of each cell, in the row order of mNeighbourGraph. */
+    std::vector<MyDeltaNotchSrnModel*> mSrnModels;
+
+    /** The state of every cell, with the x distance of each. */
+    MyDeltaNotchBatchOdeSystem mBatchOdeSystem;
+
+    /** The solver for mBatchOdeSystem. */
+    MyDeltaNotchBatchRungeKutta4Solver mBatchSolver;
+
+    /** The implicit solver for mBatchOdeSystem, used if mImplicitTimestep is set. */
+    MyDeltaNotchBatchBdfSolver mImplicitSolver;
+
+    /** The solver used by SolveToSteadyState(). */
+    MyDeltaNotchBatchSteadyStateSolver mSteadyStateSolver;
+
+    /** The inputs of each cell, indexed by location index, to which each SRN model is attached. */
+    boost::shared_ptr<MyDeltaNotchStateStore> mpStateStore;
+
+    /** The time that the tissue has been solved to. */
+    double mTime;
+
+    /** The timestep of the ODE solver, taken from the SRN models. */
+    double mDt;
+
+    /** The time over which the coupling is held fixed, or 0 (the default) to refresh it at every stage. */
+    double mCouplingTimestep;
+
+    /** The timestep of the implicit solver, or 0 (the default) to use the explicit solver. */
+    double mImplicitTimestep;
+
+    /** Working memory for the level of Delta in each cell. */
+    std::vector<double> mDelta;
+
+    /**
+     * Recompute the mean level of Delta in each cell's neighbours from the current state.
+     */
+    void UpdateCoupling();
+
+    /**
+     * Copy the state back into the SRN models, and the inputs into the state store.
+     */
+    void ScatterToSrnModels();
+
+public:
+
+    /**
+     * Constructor, which extracts the geometry and state of the tissue.
+     *
+     * @param rCellPopulation the cell population, which should not change while this object is used
+     */
+    MyDeltaNotchFrozenTissueSimulation(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Set the time over which the mean level of Delta in each cell's neighbours is held fixed.
+     *
+     * @param couplingTimestep the coupling timestep, or 0 to refresh the coupling at every stage
+     */
+    void SetCouplingTimestep(double couplingTimestep);
+
+    /**
+     * @return the time over which the coupling is held fixed, or 0 if it is refreshed at every stage.
+     */
+    double GetCouplingTimestep() const;
+
+    /**
+     * Set the timestep with which to solve the tissue as one coupled system with MyDeltaNotchBatchBdfSolver,
+     * rather than with MyDeltaNotchBatchRungeKutta4Solver and the SRN models' ODE timestep. If this is
+     * positive, the coupling timestep is ignored.
+     *
+     * @param implicitTimestep the timestep, or 0 to use the explicit solver
+     */
+    void SetImplicitTimestep(double implicitTimestep);
+
+    /**
+     * @return the timestep of the implicit solver, or 0 if the explicit solver is used.
+     */
+    double GetImplicitTimestep() const;
+
+    /**
+     * @return the time that the tissue has been solved to.
+     */
+    double GetTime() const;
+
+    /**
+     * @return the number of cells in the tissue.
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * Advance the tissue to a later time, then update each cell's SRN model.
+     *
+     * @param endTime the time to solve to
+     */
+    void Solve(double endTime);
+
+    /**
+     * Find a steady state of the coupled Delta-Notch system of the tissue, then update each cell's SRN
+     * model. A steady state may take thousands of time units to reach by solving the dynamics; this
+     * finds it directly with MyDeltaNotchBatchSteadyStateSolver, which falls back to integrating the
+     * tissue if need be.
+     *
+     * Apart from any pre-integration, the time of the tissue and the SRN models' simulated-to time are
+     * unchanged, even if the fallback integrated the tissue.
+     *
+     * @param preIntegrationTime the time for which to Solve() the tissue first, from which the
+     *     steady state is usually easier to find (defaults to 0)
+     * @return whether a steady state was found; if not, the tissue is left in the state that the
+     *     solver reached (see MyDeltaNotchBatchSteadyStateSolver::FindSteadyState())
+     */
+    bool SolveToSteadyState(double preIntegrationTime=0.0);
+
+    /**
+     * @return the solver used by SolveToSteadyState(), to set its tolerances and read how it converged.
+     */
+    MyDeltaNotchBatchSteadyStateSolver& rGetSteadyStateSolver();
+};
+
+#endif /*MYDELTANOTCHFROZENTISSUESIMULATION_HPP_*/
@@ -0,0 +1,250 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "CaBasedCellPopulation.hpp"
+#include "MeshBasedCellPopulation.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "MyDeltaNotchThreading.hpp"
+#include "Exception.hpp"
+
+namespace
+{
+/**
+ * Append the node lists of every element of a mesh to a topology signature.
+ *
+ * @param rMesh the mesh
+ * @param rSignature the signature to append to
+ */
+template<class MESH>
+void AppendElementNodes(MESH& rMesh, std::vector<unsigned>& rSignature)
+{
+    rSignature.push_back(rMesh.GetNumAllElements());
+    for (unsigned elem_index=0; elem_index<rMesh.GetNumAllElements(); elem_index++)
+    {
+        if (rMesh.GetElement(elem_index)->IsDeleted())
+        {
+            rSignature.push_back(UNSIGNED_UNSET);
+            continue;
+        }
+        unsigned num_nodes = rMesh.GetElement(elem_index)->GetNumNodes();
+        rSignature.push_back(num_nodes);
+        for (unsigned local_index=0; local_index<num_nodes; local_index++)
+        {
+            rSignature.push_back(rMesh.GetElement(elem_index)->GetNodeGlobalIndex(local_index));
+        }
+    }
+}
+}
+
+MyDeltaNotchNeighbourGraph::MyDeltaNotchNeighbourGraph()
+    : mNumLocations(0),
+      mRowOffsets(1, 0),
+      mIsSignatureValid(false),
+      mNumRebuilds(0)
+{
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchNeighbourGraph::ComputeTopologySignature(AbstractCellPopulation<DIM,DIM>& rCellPopulation,
+                                                          std::vector<unsigned>& rSignature) const
+{
+    rSignature.clear();
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        rSignature.push_back(cell_iter->GetCellId());
+        rSignature.push_back(rCellPopulation.GetLocationIndexUsingCell(*cell_iter));
+    }
+
+    if (VertexBasedCellPopulation<DIM>* p_vertex_population = dynamic_cast<VertexBasedCellPopulation<DIM>*>(&rCellPopulation))
+    {
+        AppendElementNodes(p_vertex_population->rGetMesh(), rSignature);
+        return true;
+    }
+    if (MeshBasedCellPopulation<DIM>* p_mesh_population = dynamic_cast<MeshBasedCellPopulation<DIM>*>(&rCellPopulation))
+    {
+        AppendElementNodes(p_mesh_population->rGetMesh(), rSignature);
+        return true;
+    }
+
+    // On a lattice with one cell per site, neighbours are determined by which sites are occupied
+    return (dynamic_cast<CaBasedCellPopulation<DIM>*>(&rCellPopulation) != nullptr);
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchNeighbourGraph::Update(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    bool is_signature_valid = ComputeTopologySignature(rCellPopulation, mCurrentTopologySignature);
+    if (mIsSignatureValid && is_signature_valid && (mCurrentTopologySignature == mTopologySignature))
+    {
+        return false;
+    }
+
+    std::vector<unsigned> location_indices;
+    std::vector<std::set<unsigned> > neighbour_location_indices;
+    for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
+         cell_iter != rCellPopulation.End();
+         ++cell_iter)
+    {
+        location_indices.push_back(rCellPopulation.GetLocationIndexUsingCell(*cell_iter));
+        neighbour_location_indices.push_back(rCellPopulation.GetNeighbouringLocationIndices(*cell_iter));
+    }
+    Build(location_indices, neighbour_location_indices);
+
+    mTopologySignature.swap(mCurrentTopologySignature);
+    mIsSignatureValid = is_signature_valid;
+    return true;
+}
+
+void MyDeltaNotchNeighbourGraph::Build(const std::vector<unsigned>& rLocationIndices,
+                                       const std::vector<std::set<unsigned> >& rNeighbourLocationIndices)
+{
+    assert(rLocationIndices.size() == rNeighbourLocationIndices.size());
+    const unsigned num_cells = rLocationIndices.size();
+
+    // Map each location index to its row
+    unsigned max_location_index = 0;
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        max_location_index = std::max(max_location_index, rLocationIndices[row]);
+    }
+    mNumLocations = (num_cells > 0) ? max_location_index + 1 : 0;
+    std::vector<unsigned> rows(mNumLocations, UNSIGNED_UNSET);
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        rows[rLocationIndices[row]] = row;
+    }
+
+    mLocationIndices = rLocationIndices;
+    mRowOffsets.assign(1, 0);
+    mNeighbours.clear();
+    mInverseDegrees.resize(num_cells);
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        const std::set<unsigned>& r_neighbours = rNeighbourLocationIndices[row];
+        for (std::set<unsigned>::const_iterator iter = r_neighbours.begin();
+             iter != r_neighbours.end();
+             ++iter)
+        {
+            if ((*iter >= rows.size()) || (rows[*iter] == UNSIGNED_UNSET))
+            {
+                EXCEPTION("Location index " << *iter << " is a neighbour of a cell but is not occupied by a cell.");
+            }
+            mNeighbours.push_back(rows[*iter]);
+        }
+        mRowOffsets.push_back(mNeighbours.size());
+        mInverseDegrees[row] = r_neighbours.empty() ? 0.0 : 1.0/r_neighbours.size();
+    }
+
+    mNumRebuilds++;
+}
+
+void MyDeltaNotchNeighbourGraph::MarkTopologyChanged()
+{
+    mIsSignatureValid = false;
+}
+
+template<typename REAL>
+void MyDeltaNotchNeighbourGraph::ComputeNeighbourMeans(const std::vector<REAL>& rValues,
+                                                       std::vector<REAL>& rMeans,
+                                                       unsigned numThreads) const
+{
+    const int num_cells = mLocationIndices.size();
+    assert(rValues.size() == mLocationIndices.size());
+    rMeans.resize(num_cells);
+
+    /*
+     * Each row is summed by a single thread, in the order in which its neighbours are stored,
+     * so the result does not depend on how the rows are shared between threads.
+     */
+    const int num_threads = ResolveMyDeltaNotchNumThreads(numThreads);
+    #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1)
+    for (int row=0; row<num_cells; row++)
+    {
+        double sum = 0.0;
+        for (unsigned k=mRowOffsets[row]; k<mRowOffsets[row+1]; k++)
+        {
+            sum += rValues[mNeighbours[k]];
+        }
+        rMeans[row] = sum*mInverseDegrees[row];
+    }
+}
+
+unsigned MyDeltaNotchNeighbourGraph::GetNumCells() const
+{
+    return mLocationIndices.size();
+}
+
+unsigned MyDeltaNotchNeighbourGraph::GetNumLocations() const
+{
+    return mNumLocations;
+}
+
+unsigned MyDeltaNotchNeighbourGraph::GetNumRebuilds() const
+{
+    return mNumRebuilds;
+}
+
+const std::vector<unsigned>& MyDeltaNotchNeighbourGraph::rGetLocationIndices() const
+{
+    return mLocationIndices;
+}
+
+const std::vector<unsigned>& MyDeltaNotchNeighbourGraph::rGetRowOffsets() const
+{
+    return mRowOffsets;
+}
+
+const std::vector<unsigned>& MyDeltaNotchNeighbourGraph::rGetNeighbours() const
+{
+    return mNeighbours;
+}
+
+const std::vector<double>& MyDeltaNotchNeighbourGraph::rGetInverseDegrees() const
+{
+    return mInverseDegrees;
+}
+
+// Explicit instantiation
+template bool MyDeltaNotchNeighbourGraph::Update(AbstractCellPopulation<1,1>&);
+template bool MyDeltaNotchNeighbourGraph::Update(AbstractCellPopulation<2,2>&);
+template bool MyDeltaNotchNeighbourGraph::Update(AbstractCellPopulation<3,3>&);
+template void MyDeltaNotchNeighbourGraph::ComputeNeighbourMeans(const std::vector<double>&, std::vector<double>&, unsigned) const;
+template void MyDeltaNotchNeighbourGraph::ComputeNeighbourMeans(const std::vector<float>&, std::vector<float>&, unsigned) const;
@@ -0,0 +1,191 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHNEIGHBOURGRAPH_HPP_
+#define MYDELTANOTCHNEIGHBOURGRAPH_HPP_
+
+#include <set>
+#include <vector>
+
+#include "AbstractCellPopulation.hpp"
+
+/**
+ * The neighbour relation of a cell population, cached in compressed sparse row (CSR) form.
+ *
+ * Each cell is given a row, in the order in which the population's iterator visits
+ * cells. The neighbours of the cell in row i are the rows
+ * rGetNeighbours()[rGetRowOffsets()[i]] to rGetNeighbours()[rGetRowOffsets()[i+1] - 1],
+ * and rGetInverseDegrees()[i] holds 1/(number of neighbours), or 0 for an isolated cell.
+ * Averaging a quantity over each cell's neighbours is then a sparse matrix-vector product
+ * over flat arrays, with no set construction or CellData lookups.
+ *
+ * The graph is rebuilt by Update() only when the population's topology may have changed.
+ * To detect this, a signature is taken each time Update() is called, made up of each
+ * cell's ID and location index (which changes on division, death or, for on-lattice
+ * populations, movement) and, for vertex-based and mesh-based populations, the nodes of
+ * every element (which changes on T1 and T2 swaps or remeshing). For node-based and
+ * Potts-based populations, where neighbours depend on cell positions or lattice site
+ * ownership, the graph is rebuilt every time.
+ */
+class MyDeltaNotchNeighbourGraph
+{
+private:
+
+    /** The location index of the cell in each row. */
+    std::vector<unsigned> mLocationIndices;
+
+    /** One more than the largest location index in the graph, or 0 if the graph is empty. */
+    unsigned mNumLocations;
+
+    /** The start of each row's neighbours in mNeighbours, with a final entry equal to the number of edges. */
+    std::vector<unsigned> mRowOffsets;
+
+    /** The rows of each cell's neighbours, sorted within each row. */
+    std::vector<unsigned> mNeighbours;
+
+    /** One over the number of neighbours of each row, or 0 for a cell with no neighbours. */
+    std::vector<double> mInverseDegrees;
+
+    /** The topology signature of the population when the graph was last built. */
+    std::vector<unsigned> mTopologySignature;
+
+    /** Working memory for the current topology signature. */
+    std::vector<unsigned> mCurrentTopologySignature;
+
+    /** Whether mTopologySignature can be used to skip rebuilding the graph. */
+    bool mIsSignatureValid;
+
+    /** The number of times the graph has been built. */
+    unsigned mNumRebuilds;
+
+    /**
+     * Compute a signature of the population's topology, which is unchanged if and only if
+     * the neighbour relation is unchanged.
+     *
+     * @param rCellPopulation the cell population
+     * @param rSignature filled in with the signature
+     * @return whether the signature captures the topology of this type of population;
+     *     if not, the graph must be rebuilt every time
+     */
+    template<unsigned DIM>
+    bool ComputeTopologySignature(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::vector<unsigned>& rSignature) const;
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    MyDeltaNotchNeighbourGraph();
+
+    /**
+     * Rebuild the graph from the population, if its topology has changed since the last call.
+     * The population should have been updated first.
+     *
+     * @param rCellPopulation the cell population
+     * @return whether the graph was rebuilt
+     */
+    template<unsigned DIM>
+    bool Update(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Build the graph from an explicit neighbour relation.
+     *
+     * @param rLocationIndices the location index of the cell in each row
+     * @param rNeighbourLocationIndices the location indices of each row's neighbours,
+     *     each of which must appear in rLocationIndices
+     */
+    void Build(const std::vector<unsigned>& rLocationIndices,
+               const std::vector<std::set<unsigned> >& rNeighbourLocationIndices);
+
+    /**
+     * Force the graph to be rebuilt on the next call to Update(), for example after
+     * changing the population in a way that the topology signature cannot detect.
+     */
+    void MarkTopologyChanged();
+
+    /**
+     * Compute the mean of a per-cell quantity over each cell's neighbours.
+     *
+     * The rows may be shared between several OpenMP threads. Each row's sum is always
+     * accumulated in the same order, so the means are bit-identical for any number of threads.
+     * REAL may be double or float; sums are always accumulated in double precision.
+     *
+     * @param rValues the value in each row
+     * @param rMeans filled in with the mean over each row's neighbours (0 for a cell with no neighbours)
+     * @param numThreads the number of threads to use, or 0 for the OpenMP default (defaults to 1)
+     */
+    template<typename REAL>
+    void ComputeNeighbourMeans(const std::vector<REAL>& rValues,
+                               std::vector<REAL>& rMeans,
+                               unsigned numThreads=1) const;
+
+    /**
+     * @return the number of cells (rows) in the graph.
+     */
+    unsigned GetNumCells() const;
+
+    /**
+     * @return one more than the largest location index in the graph, or 0 if the graph is empty.
+     *     This is the size needed for arrays indexed by location index.
+     */
+    unsigned GetNumLocations() const;
+
+    /**
+     * @return the number of times the graph has been built.
+     */
+    unsigned GetNumRebuilds() const;
+
+    /**
+     * @return the location index of the cell in each row.
+     */
+    const std::vector<unsigned>& rGetLocationIndices() const;
+
+    /**
+     * @return the start of each row's neighbours in rGetNeighbours(), with a final entry equal to the number of edges.
+     */
+    const std::vector<unsigned>& rGetRowOffsets() const;
+
+    /**
+     * @return the rows of each cell's neighbours.
+     */
+    const std::vector<unsigned>& rGetNeighbours() const;
+
+    /**
+     * @return one over the number of neighbours of each row, or 0 for a cell with no neighbours.
+     */
+    const std::vector<double>& rGetInverseDegrees() const;
+};
+
+#endif /*MYDELTANOTCHNEIGHBOURGRAPH_HPP_*/
@@ -0,0 +1,134 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchObjectPool.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <new>
+
+MyDeltaNotchObjectPool::MyDeltaNotchObjectPool(std::size_t objectSize, unsigned blocksPerSlab)
+    : mObjectSize(objectSize),
+      mBlockSize(0),
+      mBlocksPerSlab(blocksPerSlab),
+      mNumBlocksUsedInLastSlab(blocksPerSlab),
+      mpFreeList(nullptr),
+      mNumAllocated(0)
+{
+    assert(blocksPerSlab > 0);
+    const std::size_t alignment = alignof(std::max_align_t);
+    std::size_t size = std::max(objectSize, sizeof(FreeBlock));
+    mBlockSize = ((size + alignment - 1)/alignment)*alignment;
+}
+
+MyDeltaNotchObjectPool::~MyDeltaNotchObjectPool()
+{
+    for (unsigned i=0; i<mSlabs.size(); i++)
+    {
+        ::operator delete(mSlabs[i]);
+    }
+}
+
+void* MyDeltaNotchObjectPool::Allocate(std::size_t size)
+{
+    if (size != mObjectSize)
+    {
+        return ::operator new(size);
+    }
+
+    void* p_block;
+    #pragma omp critical(MyDeltaNotchObjectPool)
+    {
+        if (mpFreeList != nullptr)
+        {
+            p_block = mpFreeList;
+            mpFreeList = mpFreeList->pNext;
+        }
+        else
+        {
+            if (mNumBlocksUsedInLastSlab == mBlocksPerSlab)
+            {
+                // The global operator new returns memory aligned for any fundamental type
+                mSlabs.push_back(static_cast<char*>(::operator new(mBlockSize*mBlocksPerSlab)));
+                mNumBlocksUsedInLastSlab = 0;
+            }
+            p_block = mSlabs.back() + mBlockSize*mNumBlocksUsedInLastSlab;
+            mNumBlocksUsedInLastSlab++;
+        }
+        mNumAllocated++;
+    }
+    return p_block;
+}
+
+void MyDeltaNotchObjectPool::Deallocate(void* pObject, std::size_t size)
+{
+    if (pObject == nullptr)
+    {
+        return;
+    }
+    if (size != mObjectSize)
+    {
+        ::operator delete(pObject);
+        return;
+    }
+
+    #pragma omp critical(MyDeltaNotchObjectPool)
+    {
+        FreeBlock* p_block = static_cast<FreeBlock*>(pObject);
+        p_block->pNext = mpFreeList;
+        mpFreeList = p_block;
+        mNumAllocated--;
+    }
+}
+
+std::size_t MyDeltaNotchObjectPool::GetObjectSize() const
+{
+    return mObjectSize;
+}
+
+unsigned long MyDeltaNotchObjectPool::GetNumAllocated() const
+{
+    return mNumAllocated;
+}
+
+unsigned MyDeltaNotchObjectPool::GetNumSlabs() const
+{
+    return mSlabs.size();
+}
+
+std::size_t MyDeltaNotchObjectPool::GetCapacity() const
+{
+    return mSlabs.size()*mBlockSize*mBlocksPerSlab;
+}
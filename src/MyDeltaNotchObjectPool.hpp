@@ -0,0 +1,151 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHOBJECTPOOL_HPP_
+#define MYDELTANOTCHOBJECTPOOL_HPP_
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * A pool of fixed-size blocks of memory, used as the class-specific allocator of
+ * MyDeltaNotchSrnModel and MyDeltaNotchOdeSystem.
+ *
+ * Blocks are carved in order from large slabs, so the objects of cells created together lie
+ * next to each other in memory, and there is no per-object allocator overhead. A freed block
+ * goes on a free list and is reused by the next allocation, so once a population has reached
+ * its size, cell death and division do not allocate from the heap. Slabs are only returned
+ * when the pool is destroyed.
+ *
+ * Requests for a different size (from a subclass of the pooled class) are passed to the global
+ * operator new. Allocation and deallocation may be called from several OpenMP threads.
+ */
+class MyDeltaNotchObjectPool
+{
+private:
+
+    /** A free block, which holds the next free block. */
+    struct FreeBlock
+    {
+        /** The next free block, or NULL. */
+        FreeBlock* pNext;
+    };
+
+    /** The size of the objects the pool is for. */
+    std::size_t mObjectSize;
+
+    /** The size of each block: the object size rounded up to the largest fundamental alignment. */
+    std::size_t mBlockSize;
+
+    /** The number of blocks in each slab. */
+    unsigned mBlocksPerSlab;
+
+    /** The slabs allocated. */
+    std::vector<char*> mSlabs;
+
+    /** The number of blocks of the last slab that have been handed out at least once. */
+    unsigned mNumBlocksUsedInLastSlab;
+
+    /** The most recently freed block, or NULL. */
+    FreeBlock* mpFreeList;
+
+    /** The number of blocks currently allocated. */
+    unsigned long mNumAllocated;
+
+    /**
+     * Copying a pool would give two owners of its slabs, so it is not allowed.
+     */
+    MyDeltaNotchObjectPool(const MyDeltaNotchObjectPool&);
+
+    /**
+     * Assignment is not allowed, as for copying.
+     *
+     * @return this pool
+     */
+    MyDeltaNotchObjectPool& operator=(const MyDeltaNotchObjectPool&);
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param objectSize the size of the objects the pool is for
+     * @param blocksPerSlab the number of objects to allocate room for at a time (defaults to 1024)
+     */
+    MyDeltaNotchObjectPool(std::size_t objectSize, unsigned blocksPerSlab=1024);
+
+    /**
+     * Destructor, which frees the slabs. Any objects still in the pool must not be used afterwards.
+     */
+    ~MyDeltaNotchObjectPool();
+
+    /**
+     * Allocate memory for an object.
+     *
+     * @param size the size of the object
+     * @return the memory.
+     */
+    void* Allocate(std::size_t size);
+
+    /**
+     * Free memory returned by Allocate().
+     *
+     * @param pObject the memory, which may be NULL
+     * @param size the size passed to Allocate()
+     */
+    void Deallocate(void* pObject, std::size_t size);
+
+    /**
+     * @return the size of the objects the pool is for.
+     */
+    std::size_t GetObjectSize() const;
+
+    /**
+     * @return the number of blocks currently allocated.
+     */
+    unsigned long GetNumAllocated() const;
+
+    /**
+     * @return the number of slabs allocated.
+     */
+    unsigned GetNumSlabs() const;
+
+    /**
+     * @return the number of bytes held by the pool.
+     */
+    std::size_t GetCapacity() const;
+};
+
+#endif /*MYDELTANOTCHOBJECTPOOL_HPP_*/
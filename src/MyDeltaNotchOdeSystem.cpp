@@ -33,14 +33,23 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <algorithm>
+
 #include "MyDeltaNotchOdeSystem.hpp"
 #include "CellwiseOdeSystemInformation.hpp"
 #include "Debug.hpp"
 
-MyDeltaNotchOdeSystem::MyDeltaNotchOdeSystem(std::vector<double> stateVariables)
-    : AbstractOdeSystem(6)
+const unsigned MyDeltaNotchOdeSystem::MEAN_DELTA;
+const unsigned MyDeltaNotchOdeSystem::X_DISTANCE;
+
+namespace
 {
-    mpSystemInfo.reset(new CellwiseOdeSystemInformation<MyDeltaNotchOdeSystem>);
+/**
+ * @return a new system information object for MyDeltaNotchOdeSystem, with the default initial conditions set.
+ */
+boost::shared_ptr<AbstractOdeSystemInformation> CreateSystemInformation()
+{
+    boost::shared_ptr<AbstractOdeSystemInformation> p_system_info(new CellwiseOdeSystemInformation<MyDeltaNotchOdeSystem>);
 
     /**
      * The state variables are as follows:
@@ -51,14 +60,26 @@ MyDeltaNotchOdeSystem::MyDeltaNotchOdeSystem(std::vector<double> stateVariables)
      * We store the last state variable so that it can be written
      * to file at each time step alongside the others, and visualized.
      */
+    for (unsigned i=0; i<6; i++)
+    {
+        p_system_info->SetDefaultInitialCondition(i, 1.0); // soon overwritten
+    }
+    return p_system_info;
+}
+} // anonymous namespace
+
+MyDeltaNotchOdeSystem::MyDeltaNotchOdeSystem(std::vector<double> stateVariables)
+    : AbstractOdeSystemWithAnalyticJacobian(6),
+      mMeanDeltaRate(0.0),
+      mMeanDeltaReferenceTime(0.0)
+{
+    // Every cell has the same names, units and default initial conditions, so they share one object
+    static const boost::shared_ptr<AbstractOdeSystemInformation> p_shared_system_info = CreateSystemInformation();
+    mpSystemInfo = p_shared_system_info;
 
-    SetDefaultInitialCondition(0, 1.0); // soon overwritten
-    SetDefaultInitialCondition(1, 1.0); // soon overwritten
-    SetDefaultInitialCondition(2, 1.0); // soon overwritten
-    SetDefaultInitialCondition(4, 1.0); // soon overwritten
-    SetDefaultInitialCondition(3, 1.0); // soon overwritten
-    SetDefaultInitialCondition(5, 1.0); // soon
-    this->mParameters.push_back(0.5);
+    this->mParameters.reserve(2);
+    this->mParameters.push_back(0.5); // mean delta
+    this->mParameters.push_back(0.0); // x distance
 
     if (stateVariables != std::vector<double>())
     {
@@ -72,106 +93,187 @@ MyDeltaNotchOdeSystem::~MyDeltaNotchOdeSystem()
 
 void MyDeltaNotchOdeSystem::EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
 {
-    // first define each dynamic component of the system
-    double cell_surface_notch = rY[0];
-    double sudx_dependent_notch = rY[1];
-    double dx_dependent_early_endosome_notch = rY[2];
-    double dx_dependent_late_endosome_notch = rY[3];
-    double notch_intracellular_domain = rY[4];
-    double delta = rY[5];
-    double mean_delta = this->mParameters[0]; // Shorthand for "this->mParameter("mean delta");"
-    double x_distance = this->mParameters[1];
-
-    // define the components of the fluxes
-    double k_1 = 14.0;
-    double k_2 = 10.0;
-    double k_3 = 240.0;
-    double k_4 = 420.0;
-    double k_5 = 100.0;
-    double k_6 = 500.0;
-    double k_7 = 15.0;
-    double k_8 = 1.2;
-    double k_9 = 108.0;
-    double k_10 = 250.0;
-    double k_11 = 1.0;
-    double k_12 = 70.0;
-    double k_13 = 0.06;
-    double c_3 = 320.0;
-    double c_4 = 350.0;
-    double c_8a = 5.7;
-    double c_8b = 0.00001;
-    double c_9 = 20.0;
-    double c_10 = 50.0;
-    double beta_N = 10.0;
-    double f = 5.0;
-    double k_c = 0.001;
-    double fb_D = 10.0;
-    double fb_N = 10.0;
-    double fb_5 = 10.0;
-    double fb_10 = 10.0;
-    double f_bs = 10.0;
-    double gamma = 0.25;
-    double dx = 10.0;
-    double sudx = 10.0;
-
-    double test1 = 10.0;
-    if (x_distance >= 3.0){
-      test1 = 19.0 - 3*x_distance;
+    double mean_delta = GetMeanDeltaAtTime(time);
+    double x_distance = this->mParameters[X_DISTANCE];
+
+    if (mpKineticParameters)
+    {
+        EvaluateShimizuRhs(*mpKineticParameters, &rY[0], mean_delta, x_distance, &rDY[0]);
+    }
+    else
+    {
+        EvaluateShimizuRhs(DEFAULT_MY_DELTA_NOTCH_PARAMETERS, &rY[0], mean_delta, x_distance, &rDY[0]);
+    }
+}
+
+void MyDeltaNotchOdeSystem::EvaluateFixedSizeYDerivatives(double time, const std::array<double, 6>& rY, std::array<double, 6>& rDY)
+{
+    double mean_delta = GetMeanDeltaAtTime(time);
+    double x_distance = this->mParameters[X_DISTANCE];
+
+    if (mpKineticParameters)
+    {
+        EvaluateShimizuRhs(*mpKineticParameters, rY.data(), mean_delta, x_distance, rDY.data());
+    }
+    else
+    {
+        EvaluateShimizuRhs(DEFAULT_MY_DELTA_NOTCH_PARAMETERS, rY.data(), mean_delta, x_distance, rDY.data());
+    }
+}
+
+void MyDeltaNotchOdeSystem::AnalyticJacobian(const std::vector<double>& rSolutionGuess, double** jacobian, double time, double timeStep)
+{
+    const MyDeltaNotchParameters& r_parameters = mpKineticParameters ? *mpKineticParameters : DEFAULT_MY_DELTA_NOTCH_PARAMETERS;
+
+    double rhs_jacobian[36];
+    EvaluateShimizuJacobian(r_parameters, &rSolutionGuess[0], GetMeanDeltaAtTime(time), this->mParameters[X_DISTANCE], rhs_jacobian);
+
+    for (unsigned i=0; i<6; i++)
+    {
+        for (unsigned j=0; j<6; j++)
+        {
+            jacobian[i][j] = (i == j ? 1.0 : 0.0) - timeStep*rhs_jacobian[6*i + j];
+        }
+    }
+}
+
+void MyDeltaNotchOdeSystem::EvaluateShimizuJacobian(const MyDeltaNotchParameters& rParameters,
+                                                    const double* pY, double meanDelta, double xDistance,
+                                                    double* pJacobian, double* pMeanDeltaDerivatives)
+{
+    const double cell_surface_notch = pY[0];
+    const double sudx_dependent_notch = pY[1];
+    const double dx_dependent_early_endosome_notch = pY[2];
+    const double notch_intracellular_domain = pY[4];
+    const double delta = pY[5];
+    const MyDeltaNotchParameters& p = rParameters;
+
+    // The x distance profiles do not depend on the state variables
+    double test1 = (xDistance >= 3.0) ? 19.0 - 3*xDistance : 10.0;
+    double bs = (xDistance >= 3.0) ? 3*xDistance - 9.0 : 0.0;
+
+    // Derivatives of the nonlinear fluxes; the remaining fluxes are linear in a single state variable
+    double fb_N_term = p.fb_N + notch_intracellular_domain;
+    double dr1_dnicd = p.k_1 * (p.fb_N/(fb_N_term*fb_N_term)) * (p.f_bs/(p.f_bs + bs));
+
+    double fb_D_term = p.fb_D + notch_intracellular_domain;
+    double dbeta_dnicd = -p.beta_N * test1 * (1 - p.f/12) * p.fb_D/(fb_D_term*fb_D_term);
+
+    double a_3 = p.k_3*p.sudx + p.c_3;
+    double a_4 = p.k_4*p.dx + p.c_4;
+    double a_9 = p.k_9*p.sudx + p.c_9;
+    double a_10 = p.k_10*p.sudx + p.c_10;
+
+    double fb_5_term = p.fb_5 + delta;
+    double dr5_dn3 = p.k_5 * p.sudx * (1 - p.fb_5/fb_5_term);
+    double dr5_ddelta = p.k_5 * p.sudx * (p.fb_5/(fb_5_term*fb_5_term)) * dx_dependent_early_endosome_notch;
+
+    double dr6_dn1 = p.k_6 * meanDelta;
+
+    double c_8_term = p.c_8b + dx_dependent_early_endosome_notch;
+    double dr8_dn3 = p.k_8 + p.c_8a*p.c_8b/(c_8_term*c_8_term);
+
+    double fb_10_term = p.fb_10 + delta;
+    double dr10_dn2 = a_10 * (1 - p.fb_10/fb_10_term);
+    double dr10_ddelta = a_10 * (p.fb_10/(fb_10_term*fb_10_term)) * sudx_dependent_notch;
+
+    double drc_dn1 = delta/p.k_c;
+    double drc_ddelta = cell_surface_notch/p.k_c;
+
+    for (unsigned i=0; i<36; i++)
+    {
+        pJacobian[i] = 0.0;
+    }
+
+    // d[Notch_1]/dt = r_1 - r_2 - r_3 - r_4 - r_6 - r_c
+    pJacobian[0] = -p.k_2 - a_3 - a_4 - dr6_dn1 - drc_dn1;
+    pJacobian[4] = dr1_dnicd;
+    pJacobian[5] = -drc_ddelta;
+
+    // d[Notch_2]/dt = r_3 + r_5 - r_7 - r_10
+    pJacobian[6] = a_3;
+    pJacobian[7] = -p.k_7 - dr10_dn2;
+    pJacobian[8] = dr5_dn3;
+    pJacobian[11] = dr5_ddelta - dr10_ddelta;
+
+    // d[Notch_3]/dt = r_4 - r_5 - r_8 - r_11
+    pJacobian[12] = a_4;
+    pJacobian[14] = -dr5_dn3 - dr8_dn3 - p.k_11;
+    pJacobian[17] = -dr5_ddelta;
+
+    // d[Notch_4]/dt = r_8 - r_9 - r_12
+    pJacobian[20] = dr8_dn3;
+    pJacobian[21] = -a_9 - p.k_12;
+
+    // d[NICD]/dt = r_6 + r_7 + r_9 - r_13
+    pJacobian[24] = dr6_dn1;
+    pJacobian[25] = p.k_7;
+    pJacobian[27] = a_9;
+    pJacobian[28] = -p.k_13;
+
+    // d[Delta]/dt = beta_D - gamma*delta - r_6 - r_c
+    pJacobian[30] = -dr6_dn1 - drc_dn1;
+    pJacobian[34] = dbeta_dnicd;
+    pJacobian[35] = -p.gamma - drc_ddelta;
+
+    if (pMeanDeltaDerivatives != nullptr)
+    {
+        // Only r_6 = k_6 * mean_delta * cell_surface_notch depends on the mean delta
+        double dr6_dmean_delta = p.k_6 * cell_surface_notch;
+        pMeanDeltaDerivatives[0] = -dr6_dmean_delta;
+        pMeanDeltaDerivatives[1] = 0.0;
+        pMeanDeltaDerivatives[2] = 0.0;
+        pMeanDeltaDerivatives[3] = 0.0;
+        pMeanDeltaDerivatives[4] = dr6_dmean_delta;
+        pMeanDeltaDerivatives[5] = -dr6_dmean_delta;
     }
-    // else if ((3.0 <= x_distance) && (x_distance < 5.0)){
-    //   test1 = 2.0;
-    // }
-    // else if ((2.0 <= x_distance) && (x_distance < 3.0)){
-    //   test1 = 6.0;
-    // }
-    // else if (x_distance < 2.0){
-    //   test1 = 10.0;
-    // }
-
-    // blistered expression profile
-    double test2 = 0.0;
-    if (x_distance >= 3.0){
-      test2 = 3*x_distance - 9.0;
+}
+
+void MyDeltaNotchOdeSystem::SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters)
+{
+    mpKineticParameters = pKineticParameters;
+}
+
+boost::shared_ptr<MyDeltaNotchParameters> MyDeltaNotchOdeSystem::GetKineticParameters() const
+{
+    return mpKineticParameters;
+}
+
+void MyDeltaNotchOdeSystem::SetMeanDeltaRate(double rate, double referenceTime)
+{
+    mMeanDeltaRate = rate;
+    mMeanDeltaReferenceTime = referenceTime;
+}
+
+double MyDeltaNotchOdeSystem::GetMeanDeltaRate() const
+{
+    return mMeanDeltaRate;
+}
+
+void* MyDeltaNotchOdeSystem::operator new(std::size_t size)
+{
+    return rGetObjectPool().Allocate(size);
+}
+
+void MyDeltaNotchOdeSystem::operator delete(void* pObject, std::size_t size)
+{
+    rGetObjectPool().Deallocate(pObject, size);
+}
+
+MyDeltaNotchObjectPool& MyDeltaNotchOdeSystem::rGetObjectPool()
+{
+    // Never destroyed, since ODE systems may be deleted by other static objects during exit
+    static MyDeltaNotchObjectPool* p_pool = new MyDeltaNotchObjectPool(sizeof(MyDeltaNotchOdeSystem));
+    return *p_pool;
+}
+
+double MyDeltaNotchOdeSystem::GetMeanDeltaAtTime(double time) const
+{
+    if (mMeanDeltaRate == 0.0)
+    {
+        return this->mParameters[MEAN_DELTA];
     }
-    // if (test2 > 10.0){
-    //   test2 = 10.0;
-    // }
-    // else if ((7.0 <= x_distance) && (x_distance < 8.0)){
-    //   test2 = 6.0;
-    // }
-    // else if ((5.0 <= x_distance) && (x_distance < 7.0)){
-    //   test2 = 2.0;
-    // }
-    // else if (x_distance < 5.0){
-    //   test2 = 0.0;
-    // }
-
-    double bs = test2; //(10*pow(x_distance,2)/(1+pow(x_distance,2)));
-    double beta_D = beta_N * test1 * (1 - f/12) * (fb_D / (fb_D + notch_intracellular_domain)); // (10/(1+pow(x_distance,2)))
-
-    // define the fluxes using the above components
-    double r_1 = k_1 * (2 - (fb_N/(fb_N + notch_intracellular_domain))) * (f_bs/(f_bs + bs));
-    double r_2 = k_2 * cell_surface_notch;
-    double r_3 = ((k_3 * sudx) + c_3) * cell_surface_notch;
-    double r_4 = ((k_4 * dx) + c_4) * cell_surface_notch;
-    double r_5 = k_5 * sudx * (1 - fb_5/(fb_5 + delta)) * dx_dependent_early_endosome_notch;
-    double r_6 = k_6 * mean_delta * cell_surface_notch;
-    double r_7 = k_7 * sudx_dependent_notch;
-    double r_8 = k_8 * dx_dependent_early_endosome_notch + (c_8a * dx_dependent_early_endosome_notch) / (c_8b + dx_dependent_early_endosome_notch);
-    double r_9 = ((k_9 * sudx) + c_9) * dx_dependent_late_endosome_notch;
-    double r_10 = (k_10 * sudx + c_10) * (1 - fb_10/(fb_10 + delta)) * sudx_dependent_notch;
-    double r_11 = k_11 * dx_dependent_early_endosome_notch;
-    double r_12 = k_12 * dx_dependent_late_endosome_notch;
-    double r_13 = k_13 * notch_intracellular_domain;
-    double r_c = cell_surface_notch * delta/k_c;
-
-    // The next 6 lines define the ODE system by Shimizu et al. (2014)
-    rDY[0] = r_1 - r_2 - r_3 - r_4 - r_6 - r_c;  // d[Notch_1]/dt
-    rDY[1] = r_3 + r_5 - r_7 - r_10;  // d[Notch_2]/dt
-    rDY[2] = r_4 - r_5 - r_8 - r_11;  // d[Notch_3]/dt
-    rDY[3] = r_8 - r_9 - r_12;  // d[Notch_4]/dt
-    rDY[4] = r_6 + r_7 + r_9 - r_13;  // d[NICD]/dt
-    rDY[5] = beta_D - gamma*delta - r_6 - r_c;  // d[Delta]/dt
+    return std::max(0.0, this->mParameters[MEAN_DELTA] + mMeanDeltaRate*(time - mMeanDeltaReferenceTime));
 }
 
 template<>
@@ -201,8 +303,7 @@ void CellwiseOdeSystemInformation<MyDeltaNotchOdeSystem>::Initialise()
     this->mVariableUnits.push_back("non-dim");
     this->mInitialConditions.push_back(0.0); // will be filled in later
 
-    // If this is ever not the first parameter change the line
-    // double mean_delta = this->mParameters[0]; in EvaluateYDerivatives().
+    // The order of the parameters must match MyDeltaNotchOdeSystem::MEAN_DELTA and MyDeltaNotchOdeSystem::X_DISTANCE
     this->mParameterNames.push_back("mean delta");
     this->mParameterUnits.push_back("non-dim");
 
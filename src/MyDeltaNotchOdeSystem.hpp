@@ -38,19 +38,48 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/version.hpp>
 
 #include <cmath>
 #include <iostream>
 
-#include "AbstractOdeSystem.hpp"
+#include "AbstractOdeSystemWithAnalyticJacobian.hpp"
+#include "MyAdaptiveStepState.hpp"
+#include "MyDeltaNotchObjectPool.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyFixedSizeOdeSystem.hpp"
+
+/**
+ * The type of the numbers that make up a T, as passed to MyDeltaNotchOdeSystem::EvaluateShimizuRhs():
+ * T itself for a plain number, or the type of each lane of a SIMD vector (MyDeltaNotchSimdKernels
+ * specialises this for its vector types). The kinetic parameters are converted to this type, so that
+ * a single-precision kernel does all of its arithmetic in single precision.
+ */
+template<typename T>
+struct MyDeltaNotchLaneType
+{
+    /** The type of each lane. */
+    typedef T Type;
+};
 
 /**
  * Represents the Delta-Notch ODE system described by Collier et al,
  * "Pattern formation by lateral inhibition with feedback: a mathematical
  * model of delta-notch intercellular signalling" (Journal of Theoretical
  * Biology 183:429-446, 1996).
+ *
+ * Each instance can also hold the tolerances and step size memory used by
+ * adaptive solvers such as MyDormandPrinceIvpOdeSolver, which are only allocated
+ * if such a solver is used (see MyAdaptiveStepStateHolder),
+ * and its RHS can be evaluated on fixed-size arrays by MyFixedSizeRungeKutta4IvpOdeSolver
+ * (see MyFixedSizeOdeSystem).
+ *
+ * All instances share one system information object, so the default initial
+ * conditions should not be changed for an individual cell; set its initial
+ * conditions through its SRN model instead. Instances are allocated from a
+ * MyDeltaNotchObjectPool.
  */
-class MyDeltaNotchOdeSystem : public AbstractOdeSystem
+class MyDeltaNotchOdeSystem : public AbstractOdeSystemWithAnalyticJacobian, public MyAdaptiveStepStateHolder, public MyFixedSizeOdeSystem<6>
 {
 private:
 
@@ -58,19 +87,47 @@ private:
     /**
      * Serialize the object and its member variables.
      *
+     * Version 0 archives held only the AbstractOdeSystem base class; when loading one
+     * of these, the member variables below keep their default values.
+     *
      * @param archive the archive
      * @param version the current version of this class
      */
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
-        archive & boost::serialization::base_object<AbstractOdeSystem>(*this);
+        if (version == 0)
+        {
+            archive & boost::serialization::base_object<AbstractOdeSystem>(*this);
+            return;
+        }
+        archive & boost::serialization::base_object<AbstractOdeSystemWithAnalyticJacobian>(*this);
+        archive & boost::serialization::base_object<MyAdaptiveStepStateHolder>(*this);
+        archive & mpKineticParameters;
+        archive & mMeanDeltaRate;
+        archive & mMeanDeltaReferenceTime;
     }
 
-    ///\todo extract model parameters as member variables
+    /**
+     * The kinetic parameters of the model. If this is not set, the compile-time
+     * DEFAULT_MY_DELTA_NOTCH_PARAMETERS are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> mpKineticParameters;
+
+    /** The rate at which the mean delta input is taken to change with time (see SetMeanDeltaRate()). */
+    double mMeanDeltaRate;
+
+    /** The time at which the mean delta input takes the value of the "mean delta" parameter. */
+    double mMeanDeltaReferenceTime;
 
 public:
 
+    /** The index of the "mean delta" parameter, for use with SetParameter() and GetParameter(). */
+    static const unsigned MEAN_DELTA = 0;
+
+    /** The index of the "x distance" parameter, for use with SetParameter() and GetParameter(). */
+    static const unsigned X_DISTANCE = 1;
+
     /**
      * Default constructor.
      *
@@ -83,6 +140,27 @@ public:
      */
     ~MyDeltaNotchOdeSystem();
 
+    /**
+     * Allocate an ODE system from the pool returned by rGetObjectPool().
+     *
+     * @param size the size of the object
+     * @return the memory for the object.
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Return an ODE system's memory to the pool returned by rGetObjectPool().
+     *
+     * @param pObject the memory of the object
+     * @param size the size of the object
+     */
+    static void operator delete(void* pObject, std::size_t size);
+
+    /**
+     * @return the pool from which ODE systems are allocated.
+     */
+    static MyDeltaNotchObjectPool& rGetObjectPool();
+
     /**
      * Compute the RHS of the  Collier et al. system of ODEs.
      *
@@ -94,11 +172,213 @@ public:
      * @param rDY filled in with the resulting derivatives (using  Collier et al. system of equations).
      */
     void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY);
+
+    /**
+     * Compute the RHS of the system on fixed-size arrays, as EvaluateYDerivatives() does.
+     *
+     * @param time used to evaluate the RHS.
+     * @param rY value of the solution vector used to evaluate the RHS.
+     * @param rDY filled in with the resulting derivatives.
+     */
+    void EvaluateFixedSizeYDerivatives(double time, const std::array<double, 6>& rY, std::array<double, 6>& rDY);
+
+    /**
+     * Compute the matrix I - timeStep*J, where J is the analytic Jacobian of the
+     * RHS with respect to the state variables. This is the form expected by
+     * Chaste's implicit solvers.
+     *
+     * @param rSolutionGuess the state variables at which to evaluate the Jacobian
+     * @param jacobian filled in with the 6x6 matrix I - timeStep*J
+     * @param time the current time
+     * @param timeStep the multiple of J to subtract from the identity
+     */
+    void AnalyticJacobian(const std::vector<double>& rSolutionGuess, double** jacobian, double time, double timeStep);
+
+    /**
+     * Set the kinetic parameters of the model. The parameter set may be shared
+     * between many ODE systems.
+     *
+     * @param pKineticParameters the parameter set, or an empty pointer to use the defaults
+     */
+    void SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters);
+
+    /**
+     * @return the kinetic parameters of the model, or an empty pointer if the defaults are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> GetKineticParameters() const;
+
+    /**
+     * Let the mean delta input vary linearly with time, rather than taking the constant value of
+     * the "mean delta" parameter. This is used when the neighbour coupling is refreshed less often
+     * than the ODEs are solved (see MyDeltaNotchTrackingModifier::SetSignallingTimestep()). The
+     * input is not allowed to become negative.
+     *
+     * The analytic Jacobian is evaluated with the input at the given time, and does not
+     * include the resulting explicit dependence of the RHS on time.
+     *
+     * @param rate the rate of change of the mean delta input (0 by default)
+     * @param referenceTime the time at which the input equals the "mean delta" parameter
+     */
+    void SetMeanDeltaRate(double rate, double referenceTime);
+
+    /**
+     * @return the rate of change of the mean delta input.
+     */
+    double GetMeanDeltaRate() const;
+
+    /**
+     * @param time the time
+     * @return the mean delta input at the given time.
+     */
+    double GetMeanDeltaAtTime(double time) const;
+
+    /**
+     * Compute the RHS of the Shimizu et al. system.
+     *
+     * This is the kernel shared by EvaluateYDerivatives() and the batched
+     * integrator MyDeltaNotchBatchOdeSystem, so that both give identical results.
+     * T is either double or float, for a single cell, or a SIMD vector of doubles or
+     * floats (see MyDeltaNotchSimdKernels), in which case each lane holds a different cell.
+     * The kernel is therefore written without branches: the piecewise
+     * dependence on x distance is expressed as a select.
+     *
+     * @param rParameters the kinetic parameters
+     * @param pY pointer to the 6 state variables
+     * @param rMeanDelta the mean level of Delta in the cell's neighbours
+     * @param rXDistance the distance of the cell from the tissue centroid along the x axis
+     * @param pDY filled in with the 6 resulting derivatives
+     */
+    template<typename T>
+    static void EvaluateShimizuRhs(const MyDeltaNotchParameters& rParameters,
+                                   const T* pY, const T& rMeanDelta, const T& rXDistance, T* pDY);
+
+    /**
+     * Compute the Jacobian of the Shimizu et al. system, as derived by hand from
+     * EvaluateShimizuRhs(), together with the derivative of the RHS with respect to
+     * the mean level of Delta in the cell's neighbours (which couples the cells of
+     * a tissue together).
+     *
+     * @param rParameters the kinetic parameters
+     * @param pY pointer to the 6 state variables
+     * @param meanDelta the mean level of Delta in the cell's neighbours
+     * @param xDistance the distance of the cell from the tissue centroid along the x axis
+     * @param pJacobian filled in with the 36 entries of J in row-major order, so that
+     *     pJacobian[6*i + j] is the derivative of dy_i/dt with respect to y_j
+     * @param pMeanDeltaDerivatives if not null, filled in with the 6 derivatives of dy_i/dt
+     *     with respect to the mean delta
+     */
+    static void EvaluateShimizuJacobian(const MyDeltaNotchParameters& rParameters,
+                                        const double* pY, double meanDelta, double xDistance,
+                                        double* pJacobian, double* pMeanDeltaDerivatives=nullptr);
 };
 
+template<typename T>
+inline void MyDeltaNotchOdeSystem::EvaluateShimizuRhs(const MyDeltaNotchParameters& rParameters,
+                                                      const T* pY, const T& rMeanDelta, const T& rXDistance, T* pDY)
+{
+    // first define each dynamic component of the system
+    const T& cell_surface_notch = pY[0];
+    const T& sudx_dependent_notch = pY[1];
+    const T& dx_dependent_early_endosome_notch = pY[2];
+    const T& dx_dependent_late_endosome_notch = pY[3];
+    const T& notch_intracellular_domain = pY[4];
+    const T& delta = pY[5];
+    const T& mean_delta = rMeanDelta;
+    const T& x_distance = rXDistance;
+
+    // define the components of the fluxes from the kinetic parameters, in the precision of the state variables
+    typedef typename MyDeltaNotchLaneType<T>::Type LANE;
+    const LANE k_1 = rParameters.k_1;
+    const LANE k_2 = rParameters.k_2;
+    const LANE k_3 = rParameters.k_3;
+    const LANE k_4 = rParameters.k_4;
+    const LANE k_5 = rParameters.k_5;
+    const LANE k_6 = rParameters.k_6;
+    const LANE k_7 = rParameters.k_7;
+    const LANE k_8 = rParameters.k_8;
+    const LANE k_9 = rParameters.k_9;
+    const LANE k_10 = rParameters.k_10;
+    const LANE k_11 = rParameters.k_11;
+    const LANE k_12 = rParameters.k_12;
+    const LANE k_13 = rParameters.k_13;
+    const LANE c_3 = rParameters.c_3;
+    const LANE c_4 = rParameters.c_4;
+    const LANE c_8a = rParameters.c_8a;
+    const LANE c_8b = rParameters.c_8b;
+    const LANE c_9 = rParameters.c_9;
+    const LANE c_10 = rParameters.c_10;
+    const LANE beta_N = rParameters.beta_N;
+    const LANE f = rParameters.f;
+    const LANE k_c = rParameters.k_c;
+    const LANE fb_D = rParameters.fb_D;
+    const LANE fb_N = rParameters.fb_N;
+    const LANE fb_5 = rParameters.fb_5;
+    const LANE fb_10 = rParameters.fb_10;
+    const LANE f_bs = rParameters.f_bs;
+    const LANE gamma = rParameters.gamma;
+    const LANE dx = rParameters.dx;
+    const LANE sudx = rParameters.sudx;
+
+    T test1 = T() + 10.0; // for a SIMD vector, this copies the constant into every lane
+    test1 = (x_distance >= 3.0) ? T(19.0 - 3*x_distance) : test1;
+    // else if ((3.0 <= x_distance) && (x_distance < 5.0)){
+    //   test1 = 2.0;
+    // }
+    // else if ((2.0 <= x_distance) && (x_distance < 3.0)){
+    //   test1 = 6.0;
+    // }
+    // else if (x_distance < 2.0){
+    //   test1 = 10.0;
+    // }
+
+    // blistered expression profile
+    T test2 = T();
+    test2 = (x_distance >= 3.0) ? T(3*x_distance - 9.0) : test2;
+    // if (test2 > 10.0){
+    //   test2 = 10.0;
+    // }
+    // else if ((7.0 <= x_distance) && (x_distance < 8.0)){
+    //   test2 = 6.0;
+    // }
+    // else if ((5.0 <= x_distance) && (x_distance < 7.0)){
+    //   test2 = 2.0;
+    // }
+    // else if (x_distance < 5.0){
+    //   test2 = 0.0;
+    // }
+
+    T bs = test2; //(10*pow(x_distance,2)/(1+pow(x_distance,2)));
+    T beta_D = beta_N * test1 * (1 - f/12) * (fb_D / (fb_D + notch_intracellular_domain)); // (10/(1+pow(x_distance,2)))
+
+    // define the fluxes using the above components
+    T r_1 = k_1 * (2 - (fb_N/(fb_N + notch_intracellular_domain))) * (f_bs/(f_bs + bs));
+    T r_2 = k_2 * cell_surface_notch;
+    T r_3 = ((k_3 * sudx) + c_3) * cell_surface_notch;
+    T r_4 = ((k_4 * dx) + c_4) * cell_surface_notch;
+    T r_5 = k_5 * sudx * (1 - fb_5/(fb_5 + delta)) * dx_dependent_early_endosome_notch;
+    T r_6 = k_6 * mean_delta * cell_surface_notch;
+    T r_7 = k_7 * sudx_dependent_notch;
+    T r_8 = k_8 * dx_dependent_early_endosome_notch + (c_8a * dx_dependent_early_endosome_notch) / (c_8b + dx_dependent_early_endosome_notch);
+    T r_9 = ((k_9 * sudx) + c_9) * dx_dependent_late_endosome_notch;
+    T r_10 = (k_10 * sudx + c_10) * (1 - fb_10/(fb_10 + delta)) * sudx_dependent_notch;
+    T r_11 = k_11 * dx_dependent_early_endosome_notch;
+    T r_12 = k_12 * dx_dependent_late_endosome_notch;
+    T r_13 = k_13 * notch_intracellular_domain;
+    T r_c = cell_surface_notch * delta/k_c;
+
+    // The next 6 lines define the ODE system by Shimizu et al. (2014)
+    pDY[0] = r_1 - r_2 - r_3 - r_4 - r_6 - r_c;  // d[Notch_1]/dt
+    pDY[1] = r_3 + r_5 - r_7 - r_10;  // d[Notch_2]/dt
+    pDY[2] = r_4 - r_5 - r_8 - r_11;  // d[Notch_3]/dt
+    pDY[3] = r_8 - r_9 - r_12;  // d[Notch_4]/dt
+    pDY[4] = r_6 + r_7 + r_9 - r_13;  // d[NICD]/dt
+    pDY[5] = beta_D - gamma*delta - r_6 - r_c;  // d[Delta]/dt
+}
+
 // Declare identifier for the serializer
 #include "SerializationExportWrapper.hpp"
 CHASTE_CLASS_EXPORT(MyDeltaNotchOdeSystem)
+BOOST_CLASS_VERSION(MyDeltaNotchOdeSystem, 1)
 
 namespace boost
 {
@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchParameters.hpp"
+#include "Exception.hpp"
+
+namespace
+{
+/** The number of kinetic parameters. */
+const unsigned NUM_PARAMETERS = 30;
+
+/** The names of the kinetic parameters, in the same order as PARAMETER_MEMBERS. */
+const char* const PARAMETER_NAMES[NUM_PARAMETERS] =
+{
+    "k_1",
+    "k_2",
+    "k_3",
+    "k_4",
+    "k_5",
+    "k_6",
+    "k_7",
+    "k_8",
+    "k_9",
+    "k_10",
+    "k_11",
+    "k_12",
+    "k_13",
+    "c_3",
+    "c_4",
+    "c_8a",
+    "c_8b",
+    "c_9",
+    "c_10",
+    "beta_N",
+    "f",
+    "k_c",
+    "fb_D",
+    "fb_N",
+    "fb_5",
+    "fb_10",
+    "f_bs",
+    "gamma",
+    "dx",
+    "sudx"
+};
+
+/** Pointers to the members of MyDeltaNotchParameters, in the same order as PARAMETER_NAMES. */
+double MyDeltaNotchParameters::* const PARAMETER_MEMBERS[NUM_PARAMETERS] =
+{
+    &MyDeltaNotchParameters::k_1,
+    &MyDeltaNotchParameters::k_2,
+    &MyDeltaNotchParameters::k_3,
+    &MyDeltaNotchParameters::k_4,
+    &MyDeltaNotchParameters::k_5,
+    &MyDeltaNotchParameters::k_6,
+    &MyDeltaNotchParameters::k_7,
+    &MyDeltaNotchParameters::k_8,
+    &MyDeltaNotchParameters::k_9,
+    &MyDeltaNotchParameters::k_10,
+    &MyDeltaNotchParameters::k_11,
+    &MyDeltaNotchParameters::k_12,
+    &MyDeltaNotchParameters::k_13,
+    &MyDeltaNotchParameters::c_3,
+    &MyDeltaNotchParameters::c_4,
+    &MyDeltaNotchParameters::c_8a,
+    &MyDeltaNotchParameters::c_8b,
+    &MyDeltaNotchParameters::c_9,
+    &MyDeltaNotchParameters::c_10,
+    &MyDeltaNotchParameters::beta_N,
+    &MyDeltaNotchParameters::f,
+    &MyDeltaNotchParameters::k_c,
+    &MyDeltaNotchParameters::fb_D,
+    &MyDeltaNotchParameters::fb_N,
+    &MyDeltaNotchParameters::fb_5,
+    &MyDeltaNotchParameters::fb_10,
+    &MyDeltaNotchParameters::f_bs,
+    &MyDeltaNotchParameters::gamma,
+    &MyDeltaNotchParameters::dx,
+    &MyDeltaNotchParameters::sudx
+};
+
+/**
+ * @param rName the name of a parameter
+ * @return the index of the parameter in PARAMETER_NAMES
+ */
+unsigned GetParameterIndex(const std::string& rName)
+{
+    for (unsigned i=0; i<NUM_PARAMETERS; i++)
+    {
+        if (rName == PARAMETER_NAMES[i])
+        {
+            return i;
+        }
+    }
+    EXCEPTION("No Delta-Notch kinetic parameter named '" << rName << "'.");
+}
+} // anonymous namespace
+
+std::vector<std::string> MyDeltaNotchParameters::GetParameterNames()
+{
+    return std::vector<std::string>(PARAMETER_NAMES, PARAMETER_NAMES + NUM_PARAMETERS);
+}
+
+void MyDeltaNotchParameters::SetParameter(const std::string& rName, double value)
+{
+    this->*PARAMETER_MEMBERS[GetParameterIndex(rName)] = value;
+}
+
+double MyDeltaNotchParameters::GetParameter(const std::string& rName) const
+{
+    return this->*PARAMETER_MEMBERS[GetParameterIndex(rName)];
+}
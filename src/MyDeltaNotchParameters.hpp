@@ -0,0 +1,258 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHPARAMETERS_HPP_
+#define MYDELTANOTCHPARAMETERS_HPP_
+
+#include "ChasteSerialization.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * The kinetic parameters of the Delta-Notch ODE system of Shimizu et al. (2014),
+ * as used by MyDeltaNotchOdeSystem.
+ *
+ * The members are named after the symbols in the model. A default-constructed
+ * object holds the default parameter values. The constexpr instance
+ * DEFAULT_MY_DELTA_NOTCH_PARAMETERS is used when no parameter set is given,
+ * which allows the compiler to fold the parameter values into the RHS kernel.
+ * Otherwise a parameter set may be shared between ODE systems, and changed at
+ * runtime (for example, for parameter sweeps) either directly or by name.
+ */
+class MyDeltaNotchParameters
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the parameter set.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & k_1;
+        archive & k_2;
+        archive & k_3;
+        archive & k_4;
+        archive & k_5;
+        archive & k_6;
+        archive & k_7;
+        archive & k_8;
+        archive & k_9;
+        archive & k_10;
+        archive & k_11;
+        archive & k_12;
+        archive & k_13;
+        archive & c_3;
+        archive & c_4;
+        archive & c_8a;
+        archive & c_8b;
+        archive & c_9;
+        archive & c_10;
+        archive & beta_N;
+        archive & f;
+        archive & k_c;
+        archive & fb_D;
+        archive & fb_N;
+        archive & fb_5;
+        archive & fb_10;
+        archive & f_bs;
+        archive & gamma;
+        archive & dx;
+        archive & sudx;
+    }
+
+public:
+
+    /** Rate constant in flux r_1. */
+    double k_1;
+
+    /** Rate constant in flux r_2. */
+    double k_2;
+
+    /** Rate constant in flux r_3. */
+    double k_3;
+
+    /** Rate constant in flux r_4. */
+    double k_4;
+
+    /** Rate constant in flux r_5. */
+    double k_5;
+
+    /** Rate constant in flux r_6. */
+    double k_6;
+
+    /** Rate constant in flux r_7. */
+    double k_7;
+
+    /** Rate constant in flux r_8. */
+    double k_8;
+
+    /** Rate constant in flux r_9. */
+    double k_9;
+
+    /** Rate constant in flux r_10. */
+    double k_10;
+
+    /** Rate constant in flux r_11. */
+    double k_11;
+
+    /** Rate constant in flux r_12. */
+    double k_12;
+
+    /** Rate constant in flux r_13. */
+    double k_13;
+
+    /** Constant term in flux r_3. */
+    double c_3;
+
+    /** Constant term in flux r_4. */
+    double c_4;
+
+    /** Saturating rate in flux r_8. */
+    double c_8a;
+
+    /** Saturation constant in flux r_8. */
+    double c_8b;
+
+    /** Constant term in flux r_9. */
+    double c_9;
+
+    /** Constant term in flux r_10. */
+    double c_10;
+
+    /** Maximal rate of Delta synthesis, before scaling by the x distance profile. */
+    double beta_N;
+
+    /** Reduction in Delta synthesis, which is scaled by (1 - f/12). */
+    double f;
+
+    /** Cis-inhibition constant in flux r_c. */
+    double k_c;
+
+    /** Feedback constant of NICD on Delta synthesis. */
+    double fb_D;
+
+    /** Feedback constant of NICD on Notch synthesis (flux r_1). */
+    double fb_N;
+
+    /** Feedback constant of Delta in flux r_5. */
+    double fb_5;
+
+    /** Feedback constant of Delta in flux r_10. */
+    double fb_10;
+
+    /** Feedback constant of the blistered expression profile in flux r_1. */
+    double f_bs;
+
+    /** Rate constant of Delta degradation. */
+    double gamma;
+
+    /** Level of deltex. */
+    double dx;
+
+    /** Level of suppressor of deltex. */
+    double sudx;
+
+    /**
+     * Default constructor, which sets the default parameter values.
+     */
+    constexpr MyDeltaNotchParameters()
+        : k_1(14.0),
+          k_2(10.0),
+          k_3(240.0),
+          k_4(420.0),
+          k_5(100.0),
+          k_6(500.0),
+          k_7(15.0),
+          k_8(1.2),
+          k_9(108.0),
+          k_10(250.0),
+          k_11(1.0),
+          k_12(70.0),
+          k_13(0.06),
+          c_3(320.0),
+          c_4(350.0),
+          c_8a(5.7),
+          c_8b(0.00001),
+          c_9(20.0),
+          c_10(50.0),
+          beta_N(10.0),
+          f(5.0),
+          k_c(0.001),
+          fb_D(10.0),
+          fb_N(10.0),
+          fb_5(10.0),
+          fb_10(10.0),
+          f_bs(10.0),
+          gamma(0.25),
+          dx(10.0),
+          sudx(10.0)
+    {
+    }
+
+    /**
+     * @return the names of the parameters, which are the names of the members of this class.
+     */
+    static std::vector<std::string> GetParameterNames();
+
+    /**
+     * Set a parameter by name. This is intended for setting up parameter sweeps,
+     * not for use while solving.
+     *
+     * @param rName the name of the parameter, e.g. "k_6"
+     * @param value the new value of the parameter
+     */
+    void SetParameter(const std::string& rName, double value);
+
+    /**
+     * @param rName the name of the parameter, e.g. "k_6"
+     * @return the value of the parameter.
+     */
+    double GetParameter(const std::string& rName) const;
+};
+
+/**
+ * The default kinetic parameters. This is a compile-time constant, so any kernel that
+ * is inlined with these values has them folded in as literals.
+ */
+constexpr MyDeltaNotchParameters DEFAULT_MY_DELTA_NOTCH_PARAMETERS = MyDeltaNotchParameters();
+
+#endif /*MYDELTANOTCHPARAMETERS_HPP_*/
@@ -0,0 +1,157 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchPhaseTimerModifier.hpp"
+
+#include <chrono>
+
+#include "MyDeltaNotchPhaseTimers.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
+
+namespace
+{
+/**
+ * @return the wall-clock time in seconds since an arbitrary point.
+ */
+double GetWallTime()
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+} // anonymous namespace
+
+template<unsigned DIM>
+MyDeltaNotchPhaseTimerModifier<DIM>::MyDeltaNotchPhaseTimerModifier()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mLastWallTime(0.0),
+      mTotalTime(0.0),
+      mLastOutputTime(DOUBLE_UNSET)
+{
+}
+
+template<unsigned DIM>
+MyDeltaNotchPhaseTimerModifier<DIM>::~MyDeltaNotchPhaseTimerModifier()
+{
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory)
+{
+    MyDeltaNotchPhaseTimers::Reset();
+    mTotalTime = 0.0;
+    mLastOutputTime = DOUBLE_UNSET;
+
+    OutputFileHandler output_file_handler(outputDirectory + "/", false);
+    mpOutputFile = output_file_handler.OpenOutputFile("phase_timers.csv");
+    *mpOutputFile << "time,total";
+    for (unsigned i=0; i<MyDeltaNotchPhaseTimers::NUM_PHASES; i++)
+    {
+        const char* name = MyDeltaNotchPhaseTimers::GetPhaseName(static_cast<MyDeltaNotchPhaseTimers::Phase>(i));
+        *mpOutputFile << "," << name << "," << name << "_calls";
+    }
+    *mpOutputFile << ",other\n";
+
+    mLastWallTime = GetWallTime();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::UpdateTotalTime()
+{
+    double now = GetWallTime();
+    mTotalTime += now - mLastWallTime;
+    mLastWallTime = now;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::WriteTimes()
+{
+    double time = SimulationTime::Instance()->GetTime();
+    if (!mpOutputFile || time == mLastOutputTime)
+    {
+        return;
+    }
+    mLastOutputTime = time;
+
+    double other_time = mTotalTime;
+    *mpOutputFile << time << "," << mTotalTime;
+    for (unsigned i=0; i<MyDeltaNotchPhaseTimers::NUM_PHASES; i++)
+    {
+        MyDeltaNotchPhaseTimers::Phase phase = static_cast<MyDeltaNotchPhaseTimers::Phase>(i);
+        *mpOutputFile << "," << MyDeltaNotchPhaseTimers::GetTime(phase) << "," << MyDeltaNotchPhaseTimers::GetCount(phase);
+        other_time -= MyDeltaNotchPhaseTimers::GetTime(phase);
+    }
+    *mpOutputFile << "," << other_time << "\n";
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    UpdateTotalTime();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    UpdateTotalTime();
+    WriteTimes();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    UpdateTotalTime();
+    WriteTimes();
+    if (mpOutputFile)
+    {
+        mpOutputFile->close();
+        mpOutputFile.reset();
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchPhaseTimerModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
+{
+    // No parameters to output, so just call method on direct parent class
+    AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
+}
+
+// Explicit instantiation
+template class MyDeltaNotchPhaseTimerModifier<1>;
+template class MyDeltaNotchPhaseTimerModifier<2>;
+template class MyDeltaNotchPhaseTimerModifier<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchPhaseTimerModifier)
@@ -0,0 +1,154 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHPHASETIMERMODIFIER_HPP_
+#define MYDELTANOTCHPHASETIMERMODIFIER_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractCellBasedSimulationModifier.hpp"
+#include "OutputFileHandler.hpp"
+
+/**
+ * A modifier that writes the times accumulated by MyDeltaNotchPhaseTimers to the file
+ * phase_timers.csv in the simulation's output directory, at each sampling timestep and at the
+ * end of the simulation.
+ *
+ * Each line gives the simulation time, the total wall-clock time of the time loop so far, the
+ * time and number of calls of each phase, and the remaining time ("other"), which includes the
+ * writers, the cell cycle models and any other modifiers. All times are cumulative, in seconds.
+ * The phases are only timed if the code is compiled with MY_DELTA_NOTCH_PHASE_TIMERS defined;
+ * otherwise they are reported as zero and everything is counted as "other".
+ *
+ * The timers are reset in SetupSolve(), so only one simulation at a time should use this modifier.
+ * The total time of each step only includes the modifiers called before this one, so it should be
+ * the last modifier. MyDeltaNotchTimedOffLatticeSimulation adds one, and keeps it last, if the
+ * phases are timed.
+ */
+template<unsigned DIM>
+class MyDeltaNotchPhaseTimerModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
+{
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Boost Serialization method for archiving/checkpointing.
+     * Archives the object and its member variables.
+     *
+     * @param archive  The boost archive.
+     * @param version  The current version of this class.
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+    }
+
+    /** The output file. */
+    out_stream mpOutputFile;
+
+    /** The wall-clock time, in seconds, at which the time loop was last timed. */
+    double mLastWallTime;
+
+    /** The total wall-clock time of the time loop so far, in seconds. */
+    double mTotalTime;
+
+    /** The simulation time of the last line written, so it is not repeated at the end of the simulation. */
+    double mLastOutputTime;
+
+    /**
+     * Add the wall-clock time since the last call to the total.
+     */
+    void UpdateTotalTime();
+
+    /**
+     * Write a line of the output file.
+     */
+    void WriteTimes();
+
+public:
+
+    /**
+     * Default constructor.
+     */
+    MyDeltaNotchPhaseTimerModifier();
+
+    /**
+     * Destructor.
+     */
+    virtual ~MyDeltaNotchPhaseTimerModifier();
+
+    /**
+     * Overridden SetupSolve() method, which resets the timers and opens the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     * @param outputDirectory the output directory, relative to where Chaste output is stored
+     */
+    virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
+
+    /**
+     * Overridden UpdateAtEndOfTimeStep() method.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfOutputTimeStep() method, which writes the times.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfOutputTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden UpdateAtEndOfSolve() method, which writes the final times and closes the output file.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    virtual void UpdateAtEndOfSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Overridden OutputSimulationModifierParameters() method.
+     * Output any simulation modifier parameters to file.
+     *
+     * @param rParamsFile the file stream to which the parameters are output
+     */
+    void OutputSimulationModifierParameters(out_stream& rParamsFile);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchPhaseTimerModifier)
+
+#endif /*MYDELTANOTCHPHASETIMERMODIFIER_HPP_*/
@@ -0,0 +1,126 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchPhaseTimers.hpp"
+
+#include <cassert>
+
+#include "MyDeltaNotchThreading.hpp"
+
+double MyDeltaNotchPhaseTimers::msTimes[MyDeltaNotchPhaseTimers::NUM_PHASES] = {0.0};
+unsigned long MyDeltaNotchPhaseTimers::msCounts[MyDeltaNotchPhaseTimers::NUM_PHASES] = {0};
+MyDeltaNotchPhaseTimers::Phase MyDeltaNotchPhaseTimers::msActivePhases[MyDeltaNotchPhaseTimers::MAX_DEPTH];
+unsigned MyDeltaNotchPhaseTimers::msDepth = 0;
+MyDeltaNotchPhaseTimers::Clock::time_point MyDeltaNotchPhaseTimers::msResumeTime;
+
+void MyDeltaNotchPhaseTimers::BeginPhase(Phase phase)
+{
+    assert(msDepth < MAX_DEPTH);
+    Clock::time_point now = Clock::now();
+    if (msDepth > 0)
+    {
+        msTimes[msActivePhases[msDepth - 1]] += std::chrono::duration<double>(now - msResumeTime).count();
+    }
+    msActivePhases[msDepth++] = phase;
+    msCounts[phase]++;
+    msResumeTime = now;
+}
+
+void MyDeltaNotchPhaseTimers::EndPhase(Phase phase)
+{
+    assert(msDepth > 0 && msActivePhases[msDepth - 1] == phase);
+    Clock::time_point now = Clock::now();
+    msTimes[phase] += std::chrono::duration<double>(now - msResumeTime).count();
+    msDepth--;
+    msResumeTime = now;
+}
+
+void MyDeltaNotchPhaseTimers::Reset()
+{
+    for (unsigned i=0; i<NUM_PHASES; i++)
+    {
+        msTimes[i] = 0.0;
+        msCounts[i] = 0;
+    }
+}
+
+double MyDeltaNotchPhaseTimers::GetTime(Phase phase)
+{
+    return msTimes[phase];
+}
+
+unsigned long MyDeltaNotchPhaseTimers::GetCount(Phase phase)
+{
+    return msCounts[phase];
+}
+
+const char* MyDeltaNotchPhaseTimers::GetPhaseName(Phase phase)
+{
+    static const char* const names[NUM_PHASES] =
+    {
+        "srn_integration",
+        "tracking_modifier",
+        "population_update",
+        "forces"
+    };
+    return names[phase];
+}
+
+bool MyDeltaNotchPhaseTimers::IsEnabled()
+{
+#ifdef MY_DELTA_NOTCH_PHASE_TIMERS
+    return true;
+#else
+    return false;
+#endif
+}
+
+MyDeltaNotchScopedPhaseTimer::MyDeltaNotchScopedPhaseTimer(MyDeltaNotchPhaseTimers::Phase phase)
+    : mPhase(phase),
+      mIsTiming(!IsInMyDeltaNotchParallelRegion())
+{
+    if (mIsTiming)
+    {
+        MyDeltaNotchPhaseTimers::BeginPhase(mPhase);
+    }
+}
+
+MyDeltaNotchScopedPhaseTimer::~MyDeltaNotchScopedPhaseTimer()
+{
+    if (mIsTiming)
+    {
+        MyDeltaNotchPhaseTimers::EndPhase(mPhase);
+    }
+}
@@ -0,0 +1,174 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHPHASETIMERS_HPP_
+#define MYDELTANOTCHPHASETIMERS_HPP_
+
+#include <chrono>
+
+/**
+ * Accumulates the wall-clock time spent in, and the number of calls to, each phase of a
+ * cell-based simulation step: SRN integration, the Delta-Notch tracking modifier, the
+ * population's Update() (with any remeshing, divisions and deaths) and the forces and movement.
+ *
+ * The time is exclusive: when a phase begins inside another (for example, SRN integration
+ * inside the tracking modifier), the outer phase is paused until the inner one ends. Calls made
+ * inside an OpenMP parallel region are not timed; the callers time such regions as a whole.
+ *
+ * The classes of this project time their phases with the MY_DELTA_NOTCH_TIME_PHASE macro, which
+ * only does anything if the code is compiled with MY_DELTA_NOTCH_PHASE_TIMERS defined (see the
+ * NOTCHDELTA_PHASE_TIMERS CMake option), so there is no overhead otherwise. When enabled, each
+ * timed section costs two reads of a monotonic clock. The times are written out by
+ * MyDeltaNotchPhaseTimerModifier.
+ */
+class MyDeltaNotchPhaseTimers
+{
+public:
+
+    /** The phases of a simulation step. */
+    enum Phase
+    {
+        SRN_INTEGRATION = 0,
+        TRACKING_MODIFIER,
+        POPULATION_UPDATE,
+        FORCES,
+        NUM_PHASES
+    };
+
+private:
+
+    /** The type of the clock. */
+    typedef std::chrono::steady_clock Clock;
+
+    /** The maximum depth to which phases may be nested. */
+    static const unsigned MAX_DEPTH = 16;
+
+    /** The time spent in each phase, in seconds. */
+    static double msTimes[NUM_PHASES];
+
+    /** The number of times each phase has begun. */
+    static unsigned long msCounts[NUM_PHASES];
+
+    /** The phases that have begun but not ended, innermost last. */
+    static Phase msActivePhases[MAX_DEPTH];
+
+    /** The number of entries of msActivePhases in use. */
+    static unsigned msDepth;
+
+    /** When the innermost active phase began or resumed. */
+    static Clock::time_point msResumeTime;
+
+public:
+
+    /**
+     * Begin a phase, pausing the current innermost phase, if any.
+     *
+     * @param phase the phase
+     */
+    static void BeginPhase(Phase phase);
+
+    /**
+     * End a phase, resuming the phase within which it began, if any.
+     *
+     * @param phase the phase, which must be the innermost active phase
+     */
+    static void EndPhase(Phase phase);
+
+    /**
+     * Zero the times and counts of every phase.
+     */
+    static void Reset();
+
+    /**
+     * @param phase a phase
+     * @return the time spent in the phase, in seconds.
+     */
+    static double GetTime(Phase phase);
+
+    /**
+     * @param phase a phase
+     * @return the number of times the phase has begun.
+     */
+    static unsigned long GetCount(Phase phase);
+
+    /**
+     * @param phase a phase
+     * @return the name of the phase, as used in the output file.
+     */
+    static const char* GetPhaseName(Phase phase);
+
+    /**
+     * @return whether the phase timers were compiled in.
+     */
+    static bool IsEnabled();
+};
+
+/**
+ * Times the phase in which it is in scope, unless created inside an OpenMP parallel region.
+ */
+class MyDeltaNotchScopedPhaseTimer
+{
+private:
+
+    /** The phase. */
+    MyDeltaNotchPhaseTimers::Phase mPhase;
+
+    /** Whether the phase is being timed. */
+    bool mIsTiming;
+
+public:
+
+    /**
+     * Constructor, which begins the phase.
+     *
+     * @param phase the phase
+     */
+    MyDeltaNotchScopedPhaseTimer(MyDeltaNotchPhaseTimers::Phase phase);
+
+    /**
+     * Destructor, which ends the phase.
+     */
+    ~MyDeltaNotchScopedPhaseTimer();
+};
+
+#ifdef MY_DELTA_NOTCH_PHASE_TIMERS
+/** Time the rest of the enclosing scope as the given phase of MyDeltaNotchPhaseTimers. */
+#define MY_DELTA_NOTCH_TIME_PHASE(phase) MyDeltaNotchScopedPhaseTimer my_delta_notch_phase_timer(MyDeltaNotchPhaseTimers::phase)
+#else
+/** Phase timing is compiled out. */
+#define MY_DELTA_NOTCH_TIME_PHASE(phase)
+#endif
+
+#endif /*MYDELTANOTCHPHASETIMERS_HPP_*/
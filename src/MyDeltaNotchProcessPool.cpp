@@ -0,0 +1,307 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchProcessPool.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "Exception.hpp"
+#include "PetscTools.hpp"
+
+namespace
+{
+/** A job running in a child process. */
+struct Worker
+{
+    /** The process ID of the child. */
+    pid_t pid;
+
+    /** The read end of the pipe from the child. */
+    int fd;
+
+    /** The index of the job. */
+    unsigned job;
+
+    /** What has been read from the pipe so far. */
+    std::string buffer;
+};
+
+/**
+ * Run a job in a child process, write its outcome to a pipe and exit. The outcome is '0'
+ * followed by the line of results, or '1' followed by the reason for failure.
+ *
+ * @param job the job
+ * @param index the index of the job
+ * @param fd the write end of the pipe
+ */
+void RunJobInChild(MyDeltaNotchProcessPool::Job& job, unsigned index, int fd)
+{
+    std::string outcome;
+    try
+    {
+        outcome = "0" + job(index);
+    }
+    catch (const Exception& e)
+    {
+        outcome = "1" + e.GetShortMessage();
+    }
+    catch (const std::exception& e)
+    {
+        outcome = "1" + std::string(e.what());
+    }
+    catch (...)
+    {
+        // Nothing may propagate out of the child, or it would carry on running the parent's loop
+        outcome = "1The job threw an unknown exception.";
+    }
+    std::cout.flush();
+    std::cerr.flush();
+
+    std::size_t written = 0;
+    while (written < outcome.size())
+    {
+        ssize_t result = write(fd, outcome.data() + written, outcome.size() - written);
+        if (result < 0 && errno != EINTR)
+        {
+            _exit(1);
+        }
+        written += (result > 0) ? result : 0;
+    }
+    close(fd);
+
+    // Don't run the parent's exit handlers
+    _exit(0);
+}
+
+/**
+ * Stop the jobs that are still running, when Run() cannot carry on: kill each child,
+ * close the read end of its pipe and wait for it, so that no process or descriptor is leaked.
+ *
+ * @param rWorkers the running jobs, which is emptied
+ */
+void StopWorkers(std::vector<Worker>& rWorkers)
+{
+    for (unsigned i=0; i<rWorkers.size(); i++)
+    {
+        kill(rWorkers[i].pid, SIGKILL);
+        close(rWorkers[i].fd);
+    }
+    for (unsigned i=0; i<rWorkers.size(); i++)
+    {
+        while (waitpid(rWorkers[i].pid, nullptr, 0) < 0 && errno == EINTR)
+        {
+        }
+    }
+    rWorkers.clear();
+}
+} // anonymous namespace
+
+MyDeltaNotchProcessPool::MyDeltaNotchProcessPool(unsigned numProcesses)
+    : mNumProcesses(numProcesses == 0 ? GetNumAvailableCores() : numProcesses)
+{
+}
+
+unsigned MyDeltaNotchProcessPool::GetNumAvailableCores()
+{
+    long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return (num_cores > 0) ? num_cores : 1;
+}
+
+unsigned MyDeltaNotchProcessPool::GetNumProcesses() const
+{
+    return mNumProcesses;
+}
+
+void MyDeltaNotchProcessPool::Run(unsigned numJobs, Job job, std::ostream& rResults)
+{
+    // Forking a process in which MPI has started is not supported by MPI implementations
+    if (PetscTools::IsInitialised())
+    {
+        EXCEPTION("The worker processes must be forked before PETSc and MPI are initialised.");
+    }
+    mFailedJobs.clear();
+
+    // Otherwise anything buffered would be written by each child as well
+    std::cout.flush();
+    std::cerr.flush();
+    rResults.flush();
+
+    std::vector<Worker> workers;
+    workers.reserve(mNumProcesses); // so that recording a new child cannot throw and lose track of it
+    // The results of finished jobs that cannot be written yet, and whether each job succeeded
+    std::map<unsigned, std::pair<bool, std::string> > finished_jobs;
+    unsigned next_job = 0;
+    unsigned next_job_to_write = 0;
+
+    try
+    {
+        while (next_job < numJobs || !workers.empty())
+        {
+            // Keep the pool full
+            while (workers.size() < mNumProcesses && next_job < numJobs)
+            {
+                int fds[2];
+                if (pipe(fds) != 0)
+                {
+                    EXCEPTION("Could not create a pipe for job " << next_job << ": " << strerror(errno));
+                }
+                pid_t pid = fork();
+                if (pid < 0)
+                {
+                    close(fds[0]);
+                    close(fds[1]);
+                    EXCEPTION("Could not fork a process for job " << next_job << ": " << strerror(errno));
+                }
+                if (pid == 0)
+                {
+                    close(fds[0]);
+                    for (unsigned i=0; i<workers.size(); i++)
+                    {
+                        close(workers[i].fd);
+                    }
+                    RunJobInChild(job, next_job, fds[1]);
+                }
+                close(fds[1]);
+
+                Worker worker;
+                worker.pid = pid;
+                worker.fd = fds[0];
+                worker.job = next_job;
+                workers.push_back(worker);
+                next_job++;
+            }
+
+            // Wait until a pipe has something to read, which is also the case when its child exits
+            std::vector<pollfd> poll_fds(workers.size());
+            for (unsigned i=0; i<workers.size(); i++)
+            {
+                poll_fds[i].fd = workers[i].fd;
+                poll_fds[i].events = POLLIN;
+                poll_fds[i].revents = 0;
+            }
+            if (poll(&poll_fds[0], poll_fds.size(), -1) < 0)
+            {
+                if (errno == EINTR)
+                {
+                    continue;
+                }
+                EXCEPTION("Could not wait for the worker processes: " << strerror(errno));
+            }
+
+            for (unsigned i=workers.size(); i-- > 0; )
+            {
+                if (poll_fds[i].revents == 0)
+                {
+                    continue;
+                }
+                char chunk[4096];
+                ssize_t num_read = read(workers[i].fd, chunk, sizeof(chunk));
+                if (num_read > 0)
+                {
+                    workers[i].buffer.append(chunk, num_read);
+                    continue;
+                }
+                if (num_read < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                // The child has closed its end of the pipe, so collect its outcome
+                close(workers[i].fd);
+                int status = 0;
+                while (waitpid(workers[i].pid, &status, 0) < 0 && errno == EINTR)
+                {
+                }
+
+                const std::string& r_buffer = workers[i].buffer;
+                if (!r_buffer.empty() && r_buffer[0] == '0' && WIFEXITED(status) && WEXITSTATUS(status) == 0)
+                {
+                    finished_jobs[workers[i].job] = std::make_pair(true, r_buffer.substr(1));
+                }
+                else
+                {
+                    std::stringstream reason;
+                    if (!r_buffer.empty() && r_buffer[0] == '1')
+                    {
+                        reason << r_buffer.substr(1);
+                    }
+                    else if (WIFSIGNALED(status))
+                    {
+                        reason << "The process was killed by signal " << WTERMSIG(status) << ".";
+                    }
+                    else
+                    {
+                        reason << "The process exited without a result.";
+                    }
+                    mFailedJobs.push_back(std::make_pair(workers[i].job, reason.str()));
+                    finished_jobs[workers[i].job] = std::make_pair(false, std::string());
+                }
+                workers.erase(workers.begin() + i);
+            }
+
+            // Write the results of each job that has finished, once all earlier jobs have
+            while (!finished_jobs.empty() && finished_jobs.begin()->first == next_job_to_write)
+            {
+                if (finished_jobs.begin()->second.first)
+                {
+                    rResults << finished_jobs.begin()->second.second << "\n";
+                }
+                finished_jobs.erase(finished_jobs.begin());
+                next_job_to_write++;
+            }
+            rResults.flush();
+        }
+    }
+    catch (...)
+    {
+        StopWorkers(workers);
+        throw;
+    }
+}
+
+const std::vector<std::pair<unsigned, std::string> >& MyDeltaNotchProcessPool::rGetFailedJobs() const
+{
+    return mFailedJobs;
+}
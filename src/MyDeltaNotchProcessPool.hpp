@@ -0,0 +1,112 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHPROCESSPOOL_HPP_
+#define MYDELTANOTCHPROCESSPOOL_HPP_
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * A pool of worker processes for running many independent jobs, such as the runs of a
+ * parameter sweep, on one machine.
+ *
+ * Each job is run in a child process forked from the calling process, so the jobs share
+ * whatever setup the caller has already done, but cannot affect each other through singletons
+ * such as SimulationTime or the RandomNumberGenerator. MPI implementations do not support
+ * forking a process in which MPI has started, so Run() must be called before PETSc is
+ * initialised; the jobs then run sequentially, as in a test using FakePetscSetup. Up to
+ * GetNumProcesses() jobs run at once. Each job returns one line of results, which is passed back
+ * through a pipe; the lines are written out in job order as soon as every earlier job has
+ * finished, so the output is the same whatever the number of processes.
+ *
+ * A job that throws, or whose process dies, is recorded as failed and writes no line. If Run()
+ * itself fails (for example, if no more processes can be forked), it kills and waits for the jobs
+ * still running before throwing.
+ */
+class MyDeltaNotchProcessPool
+{
+public:
+
+    /** The type of a job, which is given the index of the job and returns a line of results. */
+    typedef std::function<std::string (unsigned)> Job;
+
+private:
+
+    /** The maximum number of jobs to run at once. */
+    unsigned mNumProcesses;
+
+    /** The indices of the jobs that failed in the last call to Run(), and why. */
+    std::vector<std::pair<unsigned, std::string> > mFailedJobs;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numProcesses the maximum number of jobs to run at once, or 0 (the default) to use
+     *     one per available core
+     */
+    MyDeltaNotchProcessPool(unsigned numProcesses=0);
+
+    /**
+     * @return the number of cores available to this process.
+     */
+    static unsigned GetNumAvailableCores();
+
+    /**
+     * @return the maximum number of jobs to run at once.
+     */
+    unsigned GetNumProcesses() const;
+
+    /**
+     * Run some jobs, and write their results. PETSc must not have been initialised.
+     *
+     * @param numJobs the number of jobs, which are given the indices 0 to numJobs-1
+     * @param job the job
+     * @param rResults the stream to which each successful job's line of results is written
+     */
+    void Run(unsigned numJobs, Job job, std::ostream& rResults);
+
+    /**
+     * @return the indices of the jobs that failed in the last call to Run(), with the reasons.
+     */
+    const std::vector<std::pair<unsigned, std::string> >& rGetFailedJobs() const;
+};
+
+#endif /*MYDELTANOTCHPROCESSPOOL_HPP_*/
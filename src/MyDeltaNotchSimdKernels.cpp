@@ -0,0 +1,408 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+/*
+ * The AVX-512 kernels, whose target implies FMA, must not fuse multiply-adds. Each kernel
+ * then performs the same IEEE operations as the scalar kernel, in the same order, and gives
+ * exactly the same derivatives. This is set here, before the RHS is included, rather than by
+ * the build system, so that it holds however the file is built.
+ */
+#if defined(__clang__)
+#pragma STDC FP_CONTRACT OFF
+#elif defined(__GNUC__)
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+#include "MyDeltaNotchSimdKernels.hpp"
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "Exception.hpp"
+
+/*
+ * The vectorised kernels rely on GCC-style vector extensions and function
+ * target attributes (also supported by clang and the Intel compiler), so that
+ * they can be compiled without enabling AVX for the rest of the project.
+ */
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define MY_DELTA_NOTCH_X86_SIMD
+#endif
+
+/*
+ * Each kernel has the RHS inlined into its loop, so that the RHS is compiled for the
+ * kernel's instruction set and, with the default kinetic parameters, the parameter
+ * values are folded into it.
+ */
+#if defined(__GNUC__) || defined(__clang__)
+#define MY_DELTA_NOTCH_INLINE_RHS __attribute__((flatten))
+#else
+#define MY_DELTA_NOTCH_INLINE_RHS
+#endif
+
+namespace
+{
+
+/**
+ * Choose the kinetic parameters of a kernel. When DEFAULT_PARAMETERS is true the kernel
+ * reads the constexpr DEFAULT_MY_DELTA_NOTCH_PARAMETERS directly, so that the compiler
+ * can fold the parameter values into the RHS, and the given parameters are ignored.
+ *
+ * @param rParameters the kinetic parameters passed to the kernel
+ * @return the kinetic parameters to use.
+ */
+template<bool DEFAULT_PARAMETERS>
+inline const MyDeltaNotchParameters& GetKernelParameters(const MyDeltaNotchParameters& rParameters)
+{
+    return DEFAULT_PARAMETERS ? DEFAULT_MY_DELTA_NOTCH_PARAMETERS : rParameters;
+}
+
+/**
+ * Evaluate the RHS for the cells [start, end) of a batch, one cell at a time,
+ * in the precision REAL of the batch.
+ *
+ * @param rParameters the kinetic parameters (ignored if DEFAULT_PARAMETERS is true)
+ * @param start the first cell
+ * @param end one past the last cell
+ * @param numCells the number of cells in the batch (the stride between state variables)
+ * @param pY the state variables
+ * @param pMeanDelta the mean level of Delta in each cell's neighbours
+ * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+ * @param pDY filled in with the derivatives
+ */
+template<bool DEFAULT_PARAMETERS, typename REAL>
+MY_DELTA_NOTCH_INLINE_RHS
+void EvaluateCellsScalar(const MyDeltaNotchParameters& rParameters, unsigned start, unsigned end, unsigned numCells,
+                         const REAL* pY, const REAL* pMeanDelta, const REAL* pXDistance, REAL* pDY)
+{
+    for (unsigned cell_index=start; cell_index<end; cell_index++)
+    {
+        REAL y[6];
+        REAL dy[6];
+        for (unsigned var=0; var<6; var++)
+        {
+            y[var] = pY[var*numCells + cell_index];
+        }
+
+        MyDeltaNotchOdeSystem::EvaluateShimizuRhs(GetKernelParameters<DEFAULT_PARAMETERS>(rParameters),
+                                                  y, pMeanDelta[cell_index], pXDistance[cell_index], dy);
+
+        for (unsigned var=0; var<6; var++)
+        {
+            pDY[var*numCells + cell_index] = dy[var];
+        }
+    }
+}
+
+#ifdef MY_DELTA_NOTCH_X86_SIMD
+
+/** Four doubles, held in one AVX2 register. */
+typedef double DoubleVector4 __attribute__((vector_size(32)));
+
+/** Eight doubles, held in one AVX-512 register. */
+typedef double DoubleVector8 __attribute__((vector_size(64)));
+
+/** Eight floats, held in one AVX2 register. */
+typedef float FloatVector8 __attribute__((vector_size(32)));
+
+/** Sixteen floats, held in one AVX-512 register. */
+typedef float FloatVector16 __attribute__((vector_size(64)));
+
+} // anonymous namespace
+
+/** Each lane of a DoubleVector4 is a double. */
+template<>
+struct MyDeltaNotchLaneType<DoubleVector4>
+{
+    /** The type of each lane. */
+    typedef double Type;
+};
+
+/** Each lane of a DoubleVector8 is a double. */
+template<>
+struct MyDeltaNotchLaneType<DoubleVector8>
+{
+    /** The type of each lane. */
+    typedef double Type;
+};
+
+/** Each lane of a FloatVector8 is a float. */
+template<>
+struct MyDeltaNotchLaneType<FloatVector8>
+{
+    /** The type of each lane. */
+    typedef float Type;
+};
+
+/** Each lane of a FloatVector16 is a float. */
+template<>
+struct MyDeltaNotchLaneType<FloatVector16>
+{
+    /** The type of each lane. */
+    typedef float Type;
+};
+
+namespace
+{
+
+/**
+ * Evaluate the RHS for as many whole SIMD vectors of cells as fit in the batch,
+ * starting at the first cell.
+ *
+ * This is always inlined into a function compiled for the matching instruction set.
+ *
+ * @param rParameters the kinetic parameters (ignored if DEFAULT_PARAMETERS is true)
+ * @param numCells the number of cells in the batch (the stride between state variables)
+ * @param pY the state variables
+ * @param pMeanDelta the mean level of Delta in each cell's neighbours
+ * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+ * @param pDY filled in with the derivatives
+ * @return the number of cells dealt with
+ */
+template<typename VECTOR, bool DEFAULT_PARAMETERS, typename REAL>
+inline __attribute__((always_inline)) unsigned EvaluateCellsVectorised(const MyDeltaNotchParameters& rParameters,
+                                                                      unsigned numCells,
+                                                                      const REAL* pY,
+                                                                      const REAL* pMeanDelta,
+                                                                      const REAL* pXDistance,
+                                                                      REAL* pDY)
+{
+    const unsigned width = sizeof(VECTOR)/sizeof(REAL);
+    const unsigned num_vectorised_cells = numCells - numCells%width;
+
+    for (unsigned cell_index=0; cell_index<num_vectorised_cells; cell_index+=width)
+    {
+        VECTOR y[6];
+        VECTOR dy[6];
+        VECTOR mean_delta;
+        VECTOR x_distance;
+
+        // Unaligned loads and stores, since the batch is not padded
+        for (unsigned var=0; var<6; var++)
+        {
+            __builtin_memcpy(&y[var], pY + var*numCells + cell_index, sizeof(VECTOR));
+        }
+        __builtin_memcpy(&mean_delta, pMeanDelta + cell_index, sizeof(VECTOR));
+        __builtin_memcpy(&x_distance, pXDistance + cell_index, sizeof(VECTOR));
+
+        MyDeltaNotchOdeSystem::EvaluateShimizuRhs(GetKernelParameters<DEFAULT_PARAMETERS>(rParameters),
+                                                  y, mean_delta, x_distance, dy);
+
+        for (unsigned var=0; var<6; var++)
+        {
+            __builtin_memcpy(pDY + var*numCells + cell_index, &dy[var], sizeof(VECTOR));
+        }
+    }
+    return num_vectorised_cells;
+}
+
+/**
+ * AVX2 kernel: evaluates the RHS for 4 cells per instruction, then finishes any remainder one cell at a time.
+ *
+ * See MyDeltaNotchSimdKernels::EvaluateYDerivatives() for the arguments.
+ */
+template<bool DEFAULT_PARAMETERS>
+__attribute__((target("avx2"), flatten))
+void EvaluateCellsAvx2(const MyDeltaNotchParameters& rParameters, unsigned numCells,
+                     const double* pY, const double* pMeanDelta, const double* pXDistance, double* pDY)
+{
+    unsigned num_done = EvaluateCellsVectorised<DoubleVector4, DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+    EvaluateCellsScalar<DEFAULT_PARAMETERS>(rParameters, num_done, numCells, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+/**
+ * Single-precision AVX2 kernel: evaluates the RHS for 8 cells per instruction.
+ *
+ * See MyDeltaNotchSimdKernels::EvaluateYDerivatives() for the arguments.
+ */
+template<bool DEFAULT_PARAMETERS>
+__attribute__((target("avx2"), flatten))
+void EvaluateCellsAvx2(const MyDeltaNotchParameters& rParameters, unsigned numCells,
+                     const float* pY, const float* pMeanDelta, const float* pXDistance, float* pDY)
+{
+    unsigned num_done = EvaluateCellsVectorised<FloatVector8, DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+    EvaluateCellsScalar<DEFAULT_PARAMETERS>(rParameters, num_done, numCells, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+/**
+ * AVX-512 kernel: evaluates the RHS for 8 cells per instruction, then finishes any remainder one cell at a time.
+ *
+ * See MyDeltaNotchSimdKernels::EvaluateYDerivatives() for the arguments.
+ */
+template<bool DEFAULT_PARAMETERS>
+__attribute__((target("avx512f"), flatten))
+void EvaluateCellsAvx512(const MyDeltaNotchParameters& rParameters, unsigned numCells,
+                       const double* pY, const double* pMeanDelta, const double* pXDistance, double* pDY)
+{
+    unsigned num_done = EvaluateCellsVectorised<DoubleVector8, DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+    EvaluateCellsScalar<DEFAULT_PARAMETERS>(rParameters, num_done, numCells, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+/**
+ * Single-precision AVX-512 kernel: evaluates the RHS for 16 cells per instruction.
+ *
+ * See MyDeltaNotchSimdKernels::EvaluateYDerivatives() for the arguments.
+ */
+template<bool DEFAULT_PARAMETERS>
+__attribute__((target("avx512f"), flatten))
+void EvaluateCellsAvx512(const MyDeltaNotchParameters& rParameters, unsigned numCells,
+                       const float* pY, const float* pMeanDelta, const float* pXDistance, float* pDY)
+{
+    unsigned num_done = EvaluateCellsVectorised<FloatVector16, DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+    EvaluateCellsScalar<DEFAULT_PARAMETERS>(rParameters, num_done, numCells, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+#endif // MY_DELTA_NOTCH_X86_SIMD
+
+/**
+ * Evaluate the RHS for a batch with the given kernel, in the precision REAL of the batch,
+ * and with either the given or the default kinetic parameters.
+ *
+ * See MyDeltaNotchSimdKernels::EvaluateYDerivatives() for the arguments.
+ */
+template<bool DEFAULT_PARAMETERS, typename REAL>
+void EvaluateCells(MyDeltaNotchSimdKernels::KernelType kernelType, const MyDeltaNotchParameters& rParameters,
+                   unsigned numCells, const REAL* pY, const REAL* pMeanDelta, const REAL* pXDistance, REAL* pDY)
+{
+    if (!MyDeltaNotchSimdKernels::IsAvailable(kernelType))
+    {
+        EXCEPTION("The " << MyDeltaNotchSimdKernels::GetKernelName(kernelType) << " Delta-Notch kernel is not available on this machine.");
+    }
+
+    switch (kernelType)
+    {
+#ifdef MY_DELTA_NOTCH_X86_SIMD
+        case MyDeltaNotchSimdKernels::AVX2:
+            EvaluateCellsAvx2<DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+            break;
+        case MyDeltaNotchSimdKernels::AVX512:
+            EvaluateCellsAvx512<DEFAULT_PARAMETERS>(rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+            break;
+#endif // MY_DELTA_NOTCH_X86_SIMD
+        default:
+            EvaluateCellsScalar<DEFAULT_PARAMETERS>(rParameters, 0, numCells, numCells, pY, pMeanDelta, pXDistance, pDY);
+    }
+}
+
+} // anonymous namespace
+
+bool MyDeltaNotchSimdKernels::IsAvailable(KernelType kernelType)
+{
+    bool is_available = (kernelType == SCALAR);
+#ifdef MY_DELTA_NOTCH_X86_SIMD
+    if (kernelType == AVX2)
+    {
+        is_available = __builtin_cpu_supports("avx2");
+    }
+    else if (kernelType == AVX512)
+    {
+        is_available = __builtin_cpu_supports("avx512f");
+    }
+#endif // MY_DELTA_NOTCH_X86_SIMD
+    return is_available;
+}
+
+MyDeltaNotchSimdKernels::KernelType MyDeltaNotchSimdKernels::GetBestAvailableKernelType()
+{
+    KernelType best_kernel_type = SCALAR;
+    if (IsAvailable(AVX512))
+    {
+        best_kernel_type = AVX512;
+    }
+    else if (IsAvailable(AVX2))
+    {
+        best_kernel_type = AVX2;
+    }
+    return best_kernel_type;
+}
+
+std::string MyDeltaNotchSimdKernels::GetKernelName(KernelType kernelType)
+{
+    std::string name;
+    switch (kernelType)
+    {
+        case SCALAR:
+            name = "scalar";
+            break;
+        case AVX2:
+            name = "AVX2";
+            break;
+        case AVX512:
+            name = "AVX-512";
+            break;
+        default:
+            NEVER_REACHED;
+    }
+    return name;
+}
+
+void MyDeltaNotchSimdKernels::EvaluateYDerivatives(KernelType kernelType,
+                                                   const MyDeltaNotchParameters& rParameters,
+                                                   unsigned numCells,
+                                                   const double* pY,
+                                                   const double* pMeanDelta,
+                                                   const double* pXDistance,
+                                                   double* pDY)
+{
+    EvaluateCells<false>(kernelType, rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+void MyDeltaNotchSimdKernels::EvaluateYDerivatives(KernelType kernelType,
+                                                   const MyDeltaNotchParameters& rParameters,
+                                                   unsigned numCells,
+                                                   const float* pY,
+                                                   const float* pMeanDelta,
+                                                   const float* pXDistance,
+                                                   float* pDY)
+{
+    EvaluateCells<false>(kernelType, rParameters, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+void MyDeltaNotchSimdKernels::EvaluateYDerivatives(KernelType kernelType,
+                                                   unsigned numCells,
+                                                   const double* pY,
+                                                   const double* pMeanDelta,
+                                                   const double* pXDistance,
+                                                   double* pDY)
+{
+    EvaluateCells<true>(kernelType, DEFAULT_MY_DELTA_NOTCH_PARAMETERS, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
+
+void MyDeltaNotchSimdKernels::EvaluateYDerivatives(KernelType kernelType,
+                                                   unsigned numCells,
+                                                   const float* pY,
+                                                   const float* pMeanDelta,
+                                                   const float* pXDistance,
+                                                   float* pDY)
+{
+    EvaluateCells<true>(kernelType, DEFAULT_MY_DELTA_NOTCH_PARAMETERS, numCells, pY, pMeanDelta, pXDistance, pDY);
+}
@@ -0,0 +1,159 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHSIMDKERNELS_HPP_
+#define MYDELTANOTCHSIMDKERNELS_HPP_
+
+#include <string>
+
+#include "MyDeltaNotchParameters.hpp"
+
+/**
+ * Implementations of the Delta-Notch RHS (MyDeltaNotchOdeSystem::EvaluateShimizuRhs())
+ * for a whole batch of cells stored as a structure of arrays, as used by
+ * MyDeltaNotchBatchOdeSystem.
+ *
+ * On x86 processors the RHS can be evaluated for 4 (AVX2) or 8 (AVX-512) cells
+ * per instruction in double precision, or twice as many in single precision. These kernels are compiled alongside a scalar fallback, and the
+ * best kernel supported by the processor is chosen at runtime, so the project does
+ * not need to be built with any special compiler flags.
+ */
+class MyDeltaNotchSimdKernels
+{
+public:
+
+    /** The available implementations of the batched RHS. */
+    enum KernelType
+    {
+        SCALAR,
+        AVX2,
+        AVX512
+    };
+
+    /**
+     * @param kernelType a kernel
+     * @return whether the given kernel was compiled in and is supported by this processor.
+     */
+    static bool IsAvailable(KernelType kernelType);
+
+    /**
+     * @return the fastest kernel that is available on this processor.
+     */
+    static KernelType GetBestAvailableKernelType();
+
+    /**
+     * @param kernelType a kernel
+     * @return a human-readable name for the given kernel.
+     */
+    static std::string GetKernelName(KernelType kernelType);
+
+    /**
+     * Compute the RHS of the Delta-Notch ODEs for a batch of cells.
+     *
+     * @param kernelType the kernel to use, which must be available
+     * @param rParameters the kinetic parameters, shared by all cells
+     * @param numCells the number of cells in the batch
+     * @param pY the state variables, stored variable by variable with stride numCells
+     * @param pMeanDelta the mean level of Delta in each cell's neighbours
+     * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+     * @param pDY filled in with the derivatives, in the same layout as pY
+     */
+    static void EvaluateYDerivatives(KernelType kernelType,
+                                     const MyDeltaNotchParameters& rParameters,
+                                     unsigned numCells,
+                                     const double* pY,
+                                     const double* pMeanDelta,
+                                     const double* pXDistance,
+                                     double* pDY);
+
+    /**
+     * Compute the RHS of the Delta-Notch ODEs for a batch of cells in single precision.
+     * Each SIMD instruction deals with twice as many cells as in double precision.
+     *
+     * @param kernelType the kernel to use, which must be available
+     * @param rParameters the kinetic parameters, shared by all cells (rounded to single precision)
+     * @param numCells the number of cells in the batch
+     * @param pY the state variables, stored variable by variable with stride numCells
+     * @param pMeanDelta the mean level of Delta in each cell's neighbours
+     * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+     * @param pDY filled in with the derivatives, in the same layout as pY
+     */
+    static void EvaluateYDerivatives(KernelType kernelType,
+                                     const MyDeltaNotchParameters& rParameters,
+                                     unsigned numCells,
+                                     const float* pY,
+                                     const float* pMeanDelta,
+                                     const float* pXDistance,
+                                     float* pDY);
+
+    /**
+     * Compute the RHS of the Delta-Notch ODEs for a batch of cells with the default kinetic
+     * parameters. The kernels read the constexpr DEFAULT_MY_DELTA_NOTCH_PARAMETERS directly,
+     * so the parameter values are compile-time constants in the hot loop.
+     *
+     * @param kernelType the kernel to use, which must be available
+     * @param numCells the number of cells in the batch
+     * @param pY the state variables, stored variable by variable with stride numCells
+     * @param pMeanDelta the mean level of Delta in each cell's neighbours
+     * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+     * @param pDY filled in with the derivatives, in the same layout as pY
+     */
+    static void EvaluateYDerivatives(KernelType kernelType,
+                                     unsigned numCells,
+                                     const double* pY,
+                                     const double* pMeanDelta,
+                                     const double* pXDistance,
+                                     double* pDY);
+
+    /**
+     * Compute the RHS of the Delta-Notch ODEs for a batch of cells in single precision,
+     * with the default kinetic parameters as compile-time constants.
+     *
+     * @param kernelType the kernel to use, which must be available
+     * @param numCells the number of cells in the batch
+     * @param pY the state variables, stored variable by variable with stride numCells
+     * @param pMeanDelta the mean level of Delta in each cell's neighbours
+     * @param pXDistance the distance of each cell from the tissue centroid along the x axis
+     * @param pDY filled in with the derivatives, in the same layout as pY
+     */
+    static void EvaluateYDerivatives(KernelType kernelType,
+                                     unsigned numCells,
+                                     const float* pY,
+                                     const float* pMeanDelta,
+                                     const float* pXDistance,
+                                     float* pDY);
+};
+
+#endif /*MYDELTANOTCHSIMDKERNELS_HPP_*/
@@ -33,10 +33,26 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <algorithm>
+#include <cmath>
+
 #include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchPhaseTimers.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
 
 MyDeltaNotchSrnModel::MyDeltaNotchSrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver)
-    : AbstractOdeSrnModel(6, pOdeSolver)
+    : AbstractOdeSrnModel(6, pOdeSolver),
+      mAdaptiveRelativeTolerance(MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE),
+      mAdaptiveAbsoluteTolerance(MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE),
+      mUseQuiescence(false),
+      mQuiescenceRhsTolerance(1e-6),
+      mQuiescenceInputTolerance(1e-6),
+      mIsQuiescent(false),
+      mReferenceMeanDelta(DOUBLE_UNSET),
+      mReferenceXDistance(DOUBLE_UNSET),
+      mStateStoreIndex(UNSIGNED_UNSET)
 {
     if (mpOdeSolver == boost::shared_ptr<AbstractCellCycleModelOdeSolver>())
     {
@@ -54,7 +70,18 @@ MyDeltaNotchSrnModel::MyDeltaNotchSrnModel(boost::shared_ptr<AbstractCellCycleMo
 }
 
 MyDeltaNotchSrnModel::MyDeltaNotchSrnModel(const MyDeltaNotchSrnModel& rModel)
-    : AbstractOdeSrnModel(rModel)
+    : AbstractOdeSrnModel(rModel),
+      mpKineticParameters(rModel.mpKineticParameters),
+      mAdaptiveRelativeTolerance(rModel.mAdaptiveRelativeTolerance),
+      mAdaptiveAbsoluteTolerance(rModel.mAdaptiveAbsoluteTolerance),
+      mUseQuiescence(rModel.mUseQuiescence),
+      mQuiescenceRhsTolerance(rModel.mQuiescenceRhsTolerance),
+      mQuiescenceInputTolerance(rModel.mQuiescenceInputTolerance),
+      mIsQuiescent(false),
+      mReferenceMeanDelta(DOUBLE_UNSET),
+      mReferenceXDistance(DOUBLE_UNSET),
+      mpStateStore(rModel.mpStateStore),
+      mStateStoreIndex(rModel.mStateStoreIndex)
 {
     /*
      * Set each member variable of the new SRN model that inherits
@@ -72,7 +99,14 @@ MyDeltaNotchSrnModel::MyDeltaNotchSrnModel(const MyDeltaNotchSrnModel& rModel)
      */
 
     assert(rModel.GetOdeSystem());
-    SetOdeSystem(new MyDeltaNotchOdeSystem(rModel.GetOdeSystem()->rGetStateVariables()));
+    MyDeltaNotchOdeSystem* p_parent_ode_system = static_cast<MyDeltaNotchOdeSystem*>(rModel.GetOdeSystem());
+    MyDeltaNotchOdeSystem* p_ode_system = new MyDeltaNotchOdeSystem(p_parent_ode_system->rGetStateVariables());
+    p_ode_system->SetKineticParameters(mpKineticParameters);
+    p_ode_system->SetTolerances(mAdaptiveRelativeTolerance, mAdaptiveAbsoluteTolerance);
+
+    // The daughter starts from the parent's adaptive step size, but counts its own steps
+    p_ode_system->SetNextStepSize(p_parent_ode_system->GetNextStepSize());
+    SetOdeSystem(p_ode_system);
 }
 
 AbstractSrnModel* MyDeltaNotchSrnModel::CreateSrnModel()
@@ -80,30 +114,177 @@ AbstractSrnModel* MyDeltaNotchSrnModel::CreateSrnModel()
     return new MyDeltaNotchSrnModel(*this);
 }
 
+void* MyDeltaNotchSrnModel::operator new(std::size_t size)
+{
+    return rGetObjectPool().Allocate(size);
+}
+
+void MyDeltaNotchSrnModel::operator delete(void* pObject, std::size_t size)
+{
+    rGetObjectPool().Deallocate(pObject, size);
+}
+
+MyDeltaNotchObjectPool& MyDeltaNotchSrnModel::rGetObjectPool()
+{
+    // Never destroyed, since SRN models may be deleted by other static objects during exit
+    static MyDeltaNotchObjectPool* p_pool = new MyDeltaNotchObjectPool(sizeof(MyDeltaNotchSrnModel));
+    return *p_pool;
+}
+
 void MyDeltaNotchSrnModel::SimulateToCurrentTime()
 {
+    MY_DELTA_NOTCH_TIME_PHASE(SRN_INTEGRATION);
+
     // Custom behaviour
     UpdateDeltaNotch();
+    double current_time = SimulationTime::Instance()->GetTime();
+    if (SkipIfQuiescent(current_time))
+    {
+        return;
+    }
 
     // Run the ODE simulation as needed
+    double start_time = mSimulatedToTime;
     AbstractOdeSrnModel::SimulateToCurrentTime();
+    if (mSimulatedToTime > start_time)
+    {
+        UpdateQuiescence(current_time);
+    }
+}
+
+void MyDeltaNotchSrnModel::SimulateToCurrentTime(AbstractIvpOdeSolver& rOdeSolver)
+{
+    SimulateToTime(SimulationTime::Instance()->GetTime(), rOdeSolver);
+}
+
+void MyDeltaNotchSrnModel::SimulateToTime(double time, AbstractIvpOdeSolver& rOdeSolver)
+{
+    MY_DELTA_NOTCH_TIME_PHASE(SRN_INTEGRATION);
+    UpdateDeltaNotch();
+
+    if (mSimulatedToTime < time && !SkipIfQuiescent(time))
+    {
+        rOdeSolver.SolveAndUpdateStateVariable(mpOdeSystem, mSimulatedToTime, time, mDt);
+        SetSimulatedToTime(time);
+        UpdateQuiescence(time);
+    }
+}
+
+bool MyDeltaNotchSrnModel::SkipIfQuiescent(double time)
+{
+    if (!mUseQuiescence || !mIsQuiescent)
+    {
+        return false;
+    }
+
+    const MyDeltaNotchOdeSystem* p_ode_system = static_cast<const MyDeltaNotchOdeSystem*>(mpOdeSystem);
+    double mean_delta = p_ode_system->GetMeanDeltaAtTime(time);
+    double x_distance = p_ode_system->GetParameter(MyDeltaNotchOdeSystem::X_DISTANCE);
+    if (fabs(mean_delta - mReferenceMeanDelta) > mQuiescenceInputTolerance
+        || fabs(x_distance - mReferenceXDistance) > mQuiescenceInputTolerance)
+    {
+        // The inputs have moved, so wake the cell
+        mIsQuiescent = false;
+        return false;
+    }
+
+    SetSimulatedToTime(time);
+    return true;
+}
+
+void MyDeltaNotchSrnModel::UpdateQuiescence(double time)
+{
+    if (!mUseQuiescence)
+    {
+        return;
+    }
+
+    const MyDeltaNotchOdeSystem* p_ode_system = static_cast<const MyDeltaNotchOdeSystem*>(mpOdeSystem);
+    double mean_delta = p_ode_system->GetMeanDeltaAtTime(time);
+    double x_distance = p_ode_system->GetParameter(MyDeltaNotchOdeSystem::X_DISTANCE);
+    bool inputs_are_steady = (fabs(mean_delta - mReferenceMeanDelta) <= mQuiescenceInputTolerance)
+                             && (fabs(x_distance - mReferenceXDistance) <= mQuiescenceInputTolerance);
+
+    double dy[6];
+    const MyDeltaNotchParameters& r_parameters = mpKineticParameters ? *mpKineticParameters : DEFAULT_MY_DELTA_NOTCH_PARAMETERS;
+    MyDeltaNotchOdeSystem::EvaluateShimizuRhs(r_parameters, &(p_ode_system->rGetConstStateVariables()[0]), mean_delta, x_distance, dy);
+    double rhs_norm = 0.0;
+    for (unsigned i=0; i<6; i++)
+    {
+        rhs_norm = std::max(rhs_norm, fabs(dy[i]));
+    }
+
+    mIsQuiescent = inputs_are_steady && (rhs_norm <= mQuiescenceRhsTolerance);
+    mReferenceMeanDelta = mean_delta;
+    mReferenceXDistance = x_distance;
+}
+
+boost::shared_ptr<AbstractCellCycleModelOdeSolver> MyDeltaNotchSrnModel::GetOdeSolver() const
+{
+    return mpOdeSolver;
+}
+
+boost::shared_ptr<AbstractIvpOdeSolver> MyDeltaNotchSrnModel::CreateUnsharedOdeSolver() const
+{
+    // The singleton's own solver is not accessible, so identify it from the type of the singleton, without creating any others
+    boost::shared_ptr<AbstractIvpOdeSolver> p_solver;
+    const AbstractCellCycleModelOdeSolver* p_shared_solver = mpOdeSolver.get();
+    if (dynamic_cast<const CellCycleModelOdeSolver<MyDeltaNotchSrnModel, RungeKutta4IvpOdeSolver>*>(p_shared_solver))
+    {
+        p_solver.reset(new RungeKutta4IvpOdeSolver);
+    }
+    else if (dynamic_cast<const CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>*>(p_shared_solver))
+    {
+        p_solver.reset(new MyRosenbrockIvpOdeSolver);
+    }
+    else if (dynamic_cast<const CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyDormandPrinceIvpOdeSolver>*>(p_shared_solver))
+    {
+        p_solver.reset(new MyDormandPrinceIvpOdeSolver);
+    }
+    else if (dynamic_cast<const CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyFixedSizeRungeKutta4IvpOdeSolver6>*>(p_shared_solver))
+    {
+        p_solver.reset(new MyFixedSizeRungeKutta4IvpOdeSolver6);
+    }
+    else
+    {
+        EXCEPTION("Only the RungeKutta4IvpOdeSolver, MyRosenbrockIvpOdeSolver, MyDormandPrinceIvpOdeSolver and "
+                  "MyFixedSizeRungeKutta4IvpOdeSolver solvers can be used to advance MyDeltaNotchSrnModels in parallel.");
+    }
+    return p_solver;
 }
 
 void MyDeltaNotchSrnModel::Initialise()
 {
-    AbstractOdeSrnModel::Initialise(new MyDeltaNotchOdeSystem);
+    MyDeltaNotchOdeSystem* p_ode_system = new MyDeltaNotchOdeSystem;
+    p_ode_system->SetKineticParameters(mpKineticParameters);
+    p_ode_system->SetTolerances(mAdaptiveRelativeTolerance, mAdaptiveAbsoluteTolerance);
+    AbstractOdeSrnModel::Initialise(p_ode_system);
 }
 
 void MyDeltaNotchSrnModel::UpdateDeltaNotch()
 {
     assert(mpOdeSystem != nullptr);
-    assert(mpCell != nullptr);
 
-    double mean_delta = mpCell->GetCellData()->GetItem("mean delta");
-    mpOdeSystem->SetParameter("mean delta", mean_delta);
+    double mean_delta;
+    double x_distance;
+    if (mpStateStore)
+    {
+        // A daughter cell shares its parent's entries until the modifier next updates the store
+        assert(mStateStoreIndex < mpStateStore->GetNumLocations());
+        mean_delta = mpStateStore->rGetMeanDelta()[mStateStoreIndex];
+        x_distance = mpStateStore->rGetXDistance()[mStateStoreIndex];
+        static_cast<MyDeltaNotchOdeSystem*>(mpOdeSystem)->SetMeanDeltaRate(mpStateStore->rGetMeanDeltaRate()[mStateStoreIndex],
+                                                                          mpStateStore->GetCouplingTime());
+    }
+    else
+    {
+        assert(mpCell != nullptr);
+        mean_delta = mpCell->GetCellData()->GetItem("mean delta");
+        x_distance = mpCell->GetCellData()->GetItem("x distance");
+    }
 
-    double x_distance = mpCell->GetCellData()->GetItem("x distance");
-    mpOdeSystem->SetParameter("x distance", x_distance);
+    mpOdeSystem->SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, mean_delta);
+    mpOdeSystem->SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, x_distance);
 }
 
 double MyDeltaNotchSrnModel::GetCellSurfaceNotch()
@@ -151,13 +332,166 @@ double MyDeltaNotchSrnModel::GetDelta()
 double MyDeltaNotchSrnModel::GetMeanNeighbouringDelta()
 {
     assert(mpOdeSystem != nullptr);
-    double mean_neighbouring_delta = mpOdeSystem->GetParameter("mean delta");
+    double mean_neighbouring_delta = mpOdeSystem->GetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA);
     return mean_neighbouring_delta;
 }
 
+double MyDeltaNotchSrnModel::GetXDistance()
+{
+    assert(mpOdeSystem != nullptr);
+    double x_distance = mpOdeSystem->GetParameter(MyDeltaNotchOdeSystem::X_DISTANCE);
+    return x_distance;
+}
+
+void MyDeltaNotchSrnModel::SetStateStore(const boost::shared_ptr<MyDeltaNotchStateStore>& rpStateStore, unsigned stateStoreIndex)
+{
+    if (mpStateStore != rpStateStore)
+    {
+        mpStateStore = rpStateStore;
+    }
+    mStateStoreIndex = stateStoreIndex;
+}
+
+boost::shared_ptr<MyDeltaNotchStateStore> MyDeltaNotchSrnModel::GetStateStore() const
+{
+    return mpStateStore;
+}
+
+unsigned MyDeltaNotchSrnModel::GetStateStoreIndex() const
+{
+    return mStateStoreIndex;
+}
+
+std::vector<double>& MyDeltaNotchSrnModel::rGetStateVariables()
+{
+    assert(mpOdeSystem != nullptr);
+    return mpOdeSystem->rGetStateVariables();
+}
+
+void MyDeltaNotchSrnModel::SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters)
+{
+    mpKineticParameters = pKineticParameters;
+    if (mpOdeSystem != nullptr)
+    {
+        static_cast<MyDeltaNotchOdeSystem*>(mpOdeSystem)->SetKineticParameters(pKineticParameters);
+    }
+}
+
+boost::shared_ptr<MyDeltaNotchParameters> MyDeltaNotchSrnModel::GetKineticParameters() const
+{
+    return mpKineticParameters;
+}
+
+void MyDeltaNotchSrnModel::SetAdaptiveTolerances(double relTol, double absTol)
+{
+    if (mpOdeSystem != nullptr)
+    {
+        static_cast<MyDeltaNotchOdeSystem*>(mpOdeSystem)->SetTolerances(relTol, absTol);
+    }
+    else
+    {
+        // Check the values even though there is no ODE system to pass them to yet
+        MyAdaptiveStepState().SetTolerances(relTol, absTol);
+    }
+    mAdaptiveRelativeTolerance = relTol;
+    mAdaptiveAbsoluteTolerance = absTol;
+}
+
+double MyDeltaNotchSrnModel::GetAdaptiveRelativeTolerance() const
+{
+    return mAdaptiveRelativeTolerance;
+}
+
+double MyDeltaNotchSrnModel::GetAdaptiveAbsoluteTolerance() const
+{
+    return mAdaptiveAbsoluteTolerance;
+}
+
+unsigned MyDeltaNotchSrnModel::GetNumAcceptedOdeSteps() const
+{
+    assert(mpOdeSystem != nullptr);
+    return static_cast<const MyDeltaNotchOdeSystem*>(mpOdeSystem)->GetNumAcceptedSteps();
+}
+
+unsigned MyDeltaNotchSrnModel::GetNumRejectedOdeSteps() const
+{
+    assert(mpOdeSystem != nullptr);
+    return static_cast<const MyDeltaNotchOdeSystem*>(mpOdeSystem)->GetNumRejectedSteps();
+}
+
+void MyDeltaNotchSrnModel::SaveCheckpointValues(double* pValues) const
+{
+    assert(mpOdeSystem != nullptr);
+    const MyDeltaNotchOdeSystem* p_ode_system = static_cast<const MyDeltaNotchOdeSystem*>(mpOdeSystem);
+    const std::vector<double>& r_state = p_ode_system->rGetConstStateVariables();
+    std::copy(r_state.begin(), r_state.end(), pValues);
+    pValues[6] = mSimulatedToTime;
+    pValues[7] = p_ode_system->GetNextStepSize();
+    pValues[8] = p_ode_system->GetNumAcceptedSteps();
+    pValues[9] = p_ode_system->GetNumRejectedSteps();
+    pValues[10] = mIsQuiescent ? 1.0 : 0.0;
+    pValues[11] = mReferenceMeanDelta;
+    pValues[12] = mReferenceXDistance;
+}
+
+void MyDeltaNotchSrnModel::LoadCheckpointValues(const double* pValues)
+{
+    assert(mpOdeSystem != nullptr);
+    MyDeltaNotchOdeSystem* p_ode_system = static_cast<MyDeltaNotchOdeSystem*>(mpOdeSystem);
+    std::copy(pValues, pValues + 6, p_ode_system->rGetStateVariables().begin());
+    SetSimulatedToTime(pValues[6]);
+    p_ode_system->SetNextStepSize(pValues[7]);
+    p_ode_system->SetStepCounters(static_cast<unsigned>(pValues[8]), static_cast<unsigned>(pValues[9]));
+    mIsQuiescent = (pValues[10] != 0.0);
+    mReferenceMeanDelta = pValues[11];
+    mReferenceXDistance = pValues[12];
+}
+
+void MyDeltaNotchSrnModel::SetUseQuiescence(bool useQuiescence)
+{
+    mUseQuiescence = useQuiescence;
+    mIsQuiescent = false;
+}
+
+bool MyDeltaNotchSrnModel::GetUseQuiescence() const
+{
+    return mUseQuiescence;
+}
+
+void MyDeltaNotchSrnModel::SetQuiescenceTolerances(double rhsTolerance, double inputTolerance)
+{
+    if (rhsTolerance < 0.0 || inputTolerance < 0.0)
+    {
+        EXCEPTION("The quiescence tolerances must be non-negative.");
+    }
+    mQuiescenceRhsTolerance = rhsTolerance;
+    mQuiescenceInputTolerance = inputTolerance;
+}
+
+double MyDeltaNotchSrnModel::GetQuiescenceRhsTolerance() const
+{
+    return mQuiescenceRhsTolerance;
+}
+
+double MyDeltaNotchSrnModel::GetQuiescenceInputTolerance() const
+{
+    return mQuiescenceInputTolerance;
+}
+
+bool MyDeltaNotchSrnModel::IsQuiescent() const
+{
+    return mIsQuiescent;
+}
+
 void MyDeltaNotchSrnModel::OutputSrnModelParameters(out_stream& rParamsFile)
 {
-    // No new parameters to output, so just call method on direct parent class
+    *rParamsFile << "\t\t\t<AdaptiveRelativeTolerance>" << mAdaptiveRelativeTolerance << "</AdaptiveRelativeTolerance>\n";
+    *rParamsFile << "\t\t\t<AdaptiveAbsoluteTolerance>" << mAdaptiveAbsoluteTolerance << "</AdaptiveAbsoluteTolerance>\n";
+    *rParamsFile << "\t\t\t<UseQuiescence>" << mUseQuiescence << "</UseQuiescence>\n";
+    *rParamsFile << "\t\t\t<QuiescenceRhsTolerance>" << mQuiescenceRhsTolerance << "</QuiescenceRhsTolerance>\n";
+    *rParamsFile << "\t\t\t<QuiescenceInputTolerance>" << mQuiescenceInputTolerance << "</QuiescenceInputTolerance>\n";
+
+    // Call method on direct parent class
     AbstractOdeSrnModel::OutputSrnModelParameters(rParamsFile);
 }
 
@@ -166,3 +500,6 @@ void MyDeltaNotchSrnModel::OutputSrnModelParameters(out_stream& rParamsFile)
 CHASTE_CLASS_EXPORT(MyDeltaNotchSrnModel)
 #include "CellCycleModelOdeSolverExportWrapper.hpp"
 EXPORT_CELL_CYCLE_MODEL_ODE_SOLVER(MyDeltaNotchSrnModel)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyRosenbrockIvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyDormandPrinceIvpOdeSolver)
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyFixedSizeRungeKutta4IvpOdeSolver6)
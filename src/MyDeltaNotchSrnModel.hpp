@@ -38,13 +38,23 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <boost/serialization/shared_ptr.hpp>
+#include <boost/serialization/version.hpp>
 
+#include "MyDeltaNotchObjectPool.hpp"
 #include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchStateStore.hpp"
+#include "MyRosenbrockIvpOdeSolver.hpp"
+#include "MyDormandPrinceIvpOdeSolver.hpp"
+#include "MyFixedSizeRungeKutta4IvpOdeSolver.hpp"
 #include "AbstractOdeSrnModel.hpp"
 
 /**
  * A subclass of AbstractOdeSrnModel that includes a Delta-Notch ODE system in the sub-cellular reaction network.
  *
+ * SRN models are allocated from a MyDeltaNotchObjectPool, as are their ODE systems, so creating
+ * cells on division does not allocate these from the heap once the pool has grown.
+ *
  * \todo #2752 document this class more thoroughly here
  */
 class MyDeltaNotchSrnModel : public AbstractOdeSrnModel
@@ -57,14 +67,69 @@ private:
      * Archive the SRN model and member variables.
      *
      * @param archive the archive
+     * Version 0 archives held only the base class; when loading one of these, the
+     * member variables below keep their default values.
+     *
+     * @param archive the archive
      * @param version the current version of this class
      */
     template<class Archive>
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractOdeSrnModel>(*this);
+        if (version > 0)
+        {
+            archive & mpKineticParameters;
+            archive & mAdaptiveRelativeTolerance;
+            archive & mAdaptiveAbsoluteTolerance;
+            archive & mUseQuiescence;
+            archive & mQuiescenceRhsTolerance;
+            archive & mQuiescenceInputTolerance;
+            archive & mIsQuiescent;
+            archive & mReferenceMeanDelta;
+            archive & mReferenceXDistance;
+        }
     }
 
+    /**
+     * The kinetic parameters passed to this cell's ODE system. Cells may share a parameter set.
+     * If this is not set, the compile-time DEFAULT_MY_DELTA_NOTCH_PARAMETERS are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> mpKineticParameters;
+
+    /** The relative error tolerance used if the ODEs are solved with an adaptive solver. */
+    double mAdaptiveRelativeTolerance;
+
+    /** The absolute error tolerance used if the ODEs are solved with an adaptive solver. */
+    double mAdaptiveAbsoluteTolerance;
+
+    /** Whether to skip integrating the ODEs while the cell is at a steady state. */
+    bool mUseQuiescence;
+
+    /** The largest RHS (in the maximum norm) at which the cell may be considered to be at a steady state. */
+    double mQuiescenceRhsTolerance;
+
+    /** The largest change in the mean delta or x distance inputs that leaves a quiescent cell quiescent. */
+    double mQuiescenceInputTolerance;
+
+    /** Whether the cell is currently quiescent, so that integration of its ODEs is skipped. */
+    bool mIsQuiescent;
+
+    /** The mean delta input when the ODEs were last integrated (or when the cell became quiescent). */
+    double mReferenceMeanDelta;
+
+    /** The x distance input when the ODEs were last integrated (or when the cell became quiescent). */
+    double mReferenceXDistance;
+
+    /**
+     * The population's store of SRN inputs, if any. This is set by MyDeltaNotchTrackingModifier
+     * every timestep, so is not archived.
+     */
+    boost::shared_ptr<MyDeltaNotchStateStore> mpStateStore;
+
+    /** The index of this cell's entries in mpStateStore, which is its location index. */
+    unsigned mStateStoreIndex;
+
 protected:
     /**
      * Protected copy-constructor for use by CreateSrnModel().  The only way for external code to create a copy of a SRN model
@@ -85,6 +150,15 @@ public:
     /**
      * Default constructor calls base class.
      *
+     * By default the ODEs are solved with RungeKutta4IvpOdeSolver. Since the system is stiff,
+     * larger stable timesteps (set with SetDt()) can be taken by passing
+     * CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance() instead.
+     * Alternatively, CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyDormandPrinceIvpOdeSolver>::Instance()
+     * chooses the step size in each cell to meet the tolerances set with SetAdaptiveTolerances(),
+     * with SetDt() giving the largest step allowed. The same method as the default, without heap
+     * allocation on each step, is given by
+     * CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyFixedSizeRungeKutta4IvpOdeSolver<6> >::Instance().
+     *
      * @param pOdeSolver An optional pointer to a cell-cycle model ODE solver object (allows the use of different ODE solvers)
      */
     MyDeltaNotchSrnModel(boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver = boost::shared_ptr<AbstractCellCycleModelOdeSolver>());
@@ -97,6 +171,27 @@ public:
      */
     AbstractSrnModel* CreateSrnModel();
 
+    /**
+     * Allocate an SRN model from the pool returned by rGetObjectPool().
+     *
+     * @param size the size of the object
+     * @return the memory for the object.
+     */
+    static void* operator new(std::size_t size);
+
+    /**
+     * Return an SRN model's memory to the pool returned by rGetObjectPool().
+     *
+     * @param pObject the memory of the object
+     * @param size the size of the object
+     */
+    static void operator delete(void* pObject, std::size_t size);
+
+    /**
+     * @return the pool from which SRN models are allocated.
+     */
+    static MyDeltaNotchObjectPool& rGetObjectPool();
+
     /**
      * Initialise the SRN model at the start of a simulation.
      *
@@ -107,16 +202,110 @@ public:
     /**
      * Overridden SimulateToTime() method for custom behaviour.
      *
-     * \todo #2752 say what it does in this class
+     * Copies the current inputs to the ODE system, then integrates it to the current time
+     * unless the cell is quiescent (see SetUseQuiescence()).
      */
     void SimulateToCurrentTime();
 
+    /**
+     * Advance the ODEs to the current time as SimulateToCurrentTime() does, but using the given solver
+     * rather than the shared solver held by this SRN model. The shared CellCycleModelOdeSolver singleton
+     * keeps working memory, so this allows SRN models to be advanced concurrently, each thread using its
+     * own solver created with CreateUnsharedOdeSolver().
+     *
+     * @param rOdeSolver the solver to use, which must not be in use by another thread
+     */
+    void SimulateToCurrentTime(AbstractIvpOdeSolver& rOdeSolver);
+
+    /**
+     * Advance the ODEs to the given time with the given solver, which must not be in use by another
+     * thread. This allows MyDeltaNotchTrackingModifier to advance the signalling of all cells in
+     * stages within a timestep (see MyDeltaNotchTrackingModifier::SetSignallingTimestep()).
+     *
+     * @param time the time to advance to, which should not be later than the current time
+     * @param rOdeSolver the solver to use
+     */
+    void SimulateToTime(double time, AbstractIvpOdeSolver& rOdeSolver);
+
+    /**
+     * If quiescence is enabled and the cell is quiescent, check whether the inputs copied to the ODE
+     * system by the last call to UpdateDeltaNotch() have moved from their values when the cell became
+     * quiescent. If they have not, mark the cell as simulated to the given time without integrating its
+     * ODEs; otherwise wake the cell.
+     *
+     * @param time the time to which the cell is to be advanced
+     * @return whether integration of the ODEs was skipped
+     */
+    bool SkipIfQuiescent(double time);
+
+    /**
+     * If quiescence is enabled, decide whether the cell is now quiescent: that is, whether the RHS of its
+     * ODEs is below the RHS tolerance and its mean delta input has changed by no more than the input
+     * tolerance since the ODEs were last integrated. Called after the ODEs have been integrated to the
+     * given time.
+     *
+     * @param time the time to which the ODEs have been integrated
+     */
+    void UpdateQuiescence(double time);
+
+    /**
+     * Set whether to skip integrating the ODEs of this cell while it is at a steady state. This is
+     * inherited by daughter cells, which always start awake. Defaults to false.
+     *
+     * @param useQuiescence whether to detect quiescence
+     */
+    void SetUseQuiescence(bool useQuiescence);
+
+    /**
+     * @return whether integration of the ODEs is skipped while the cell is at a steady state.
+     */
+    bool GetUseQuiescence() const;
+
+    /**
+     * Set the tolerances used to detect quiescence. These are inherited by daughter cells.
+     *
+     * @param rhsTolerance the largest RHS, in the maximum norm, at a steady state (defaults to 1e-6)
+     * @param inputTolerance the largest change in the mean delta or x distance inputs that leaves
+     *     a cell quiescent (defaults to 1e-6)
+     */
+    void SetQuiescenceTolerances(double rhsTolerance, double inputTolerance);
+
+    /**
+     * @return the largest RHS, in the maximum norm, at which the cell may become quiescent.
+     */
+    double GetQuiescenceRhsTolerance() const;
+
+    /**
+     * @return the largest change in the inputs that leaves a quiescent cell quiescent.
+     */
+    double GetQuiescenceInputTolerance() const;
+
+    /**
+     * @return whether the cell is currently quiescent, so that integration of its ODEs is skipped.
+     */
+    bool IsQuiescent() const;
+
+    /**
+     * @return the shared solver used by SimulateToCurrentTime().
+     */
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> GetOdeSolver() const;
+
+    /**
+     * Create a new solver of the same type as the shared solver used by this SRN model, for use with
+     * SimulateToCurrentTime(AbstractIvpOdeSolver&). This is only possible for RungeKutta4IvpOdeSolver,
+     * MyFixedSizeRungeKutta4IvpOdeSolver6, MyRosenbrockIvpOdeSolver and MyDormandPrinceIvpOdeSolver.
+     *
+     * @return the new solver
+     */
+    boost::shared_ptr<AbstractIvpOdeSolver> CreateUnsharedOdeSolver() const;
+
     /**
      * Update the current levels of Delta and Notch in the cell.
      *
      * N.B. Despite the name, this doesn't update the levels of delta or notch, or compute mean levels.
-     * It just copies the current mean delta from the CellData
-     * (set by DeltaNotchTrackingModifier) to the DeltaNotchOdeSystem.
+     * It just copies the current mean delta and x distance (set by MyDeltaNotchTrackingModifier) to the
+     * MyDeltaNotchOdeSystem, from the state store if one has been set and from the CellData otherwise.
+     * The rate at which the mean delta changes is also copied from the state store, if one has been set.
      *
      * \todo #2752 Improve the name of this method!
      */
@@ -160,6 +349,104 @@ public:
      */
     double GetMeanNeighbouringDelta();
 
+    /**
+     * @return the current distance of this cell from the tissue centroid along the x axis.
+     *
+     * N.B. This doesn't calculate anything, it just returns the parameter
+     * from the DeltaNotchOdeSystem.
+     */
+    double GetXDistance();
+
+    /**
+     * Set the store from which UpdateDeltaNotch() reads this cell's inputs.
+     *
+     * @param rpStateStore the population's state store
+     * @param stateStoreIndex the index of this cell's entries, which is its location index
+     */
+    void SetStateStore(const boost::shared_ptr<MyDeltaNotchStateStore>& rpStateStore, unsigned stateStoreIndex);
+
+    /**
+     * @return the store from which UpdateDeltaNotch() reads this cell's inputs, or an empty
+     *     pointer if they are read from the CellData.
+     */
+    boost::shared_ptr<MyDeltaNotchStateStore> GetStateStore() const;
+
+    /**
+     * @return the index of this cell's entries in the state store.
+     */
+    unsigned GetStateStoreIndex() const;
+
+    /**
+     * @return the state variables of this cell's Delta-Notch ODE system, which may be updated in place.
+     *
+     * This is used by MyDeltaNotchTrackingModifier to integrate all cells' ODE systems together.
+     */
+    std::vector<double>& rGetStateVariables();
+
+    /**
+     * Set the kinetic parameters used by this cell's ODE system. The parameter set is
+     * shared, not copied, and is inherited by daughter cells.
+     *
+     * @param pKineticParameters the parameter set, or an empty pointer to use the defaults
+     */
+    void SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters);
+
+    /**
+     * @return the kinetic parameters used by this cell's ODE system, or an empty pointer if the defaults are used.
+     */
+    boost::shared_ptr<MyDeltaNotchParameters> GetKineticParameters() const;
+
+    /**
+     * Set the error tolerances used if the ODEs are solved with an adaptive solver
+     * such as MyDormandPrinceIvpOdeSolver. These are inherited by daughter cells.
+     *
+     * @param relTol the relative tolerance
+     * @param absTol the absolute tolerance
+     */
+    void SetAdaptiveTolerances(double relTol, double absTol);
+
+    /**
+     * @return the relative error tolerance used by an adaptive solver.
+     */
+    double GetAdaptiveRelativeTolerance() const;
+
+    /**
+     * @return the absolute error tolerance used by an adaptive solver.
+     */
+    double GetAdaptiveAbsoluteTolerance() const;
+
+    /**
+     * @return the number of steps an adaptive solver has accepted for this cell since it was created.
+     */
+    unsigned GetNumAcceptedOdeSteps() const;
+
+    /**
+     * @return the number of steps an adaptive solver has rejected for this cell since it was created.
+     */
+    unsigned GetNumRejectedOdeSteps() const;
+
+    /**
+     * Copy the state of this SRN model that changes as it is solved into a flat record, for
+     * MyDeltaNotchBulkCheckpoint. The record holds, in order, the six state variables, the time
+     * to which the ODEs have been solved, the adaptive solver's next step size and its accepted and
+     * rejected step counts, whether the cell is quiescent and the reference mean delta and x
+     * distance used to test for quiescence. Settings such as the solver, timestep, tolerances and
+     * kinetic parameters are not included.
+     *
+     * @param pValues the record, which must have room for NUM_CHECKPOINT_VALUES values
+     */
+    void SaveCheckpointValues(double* pValues) const;
+
+    /**
+     * Restore the state saved by SaveCheckpointValues().
+     *
+     * @param pValues the record
+     */
+    void LoadCheckpointValues(const double* pValues);
+
+    /** The number of values written by SaveCheckpointValues(). */
+    static const unsigned NUM_CHECKPOINT_VALUES = 13;
+
     /**
      * Output SRN model parameters to file.
      *
@@ -171,7 +458,14 @@ public:
 // Declare identifier for the serializer
 #include "SerializationExportWrapper.hpp"
 CHASTE_CLASS_EXPORT(MyDeltaNotchSrnModel)
+BOOST_CLASS_VERSION(MyDeltaNotchSrnModel, 1)
 #include "CellCycleModelOdeSolverExportWrapper.hpp"
 EXPORT_CELL_CYCLE_MODEL_ODE_SOLVER(MyDeltaNotchSrnModel)
+typedef CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver> CellCycleModelOdeSolverMyDeltaNotchSrnModelMyRosenbrockIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyRosenbrockIvpOdeSolver)
+typedef CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyDormandPrinceIvpOdeSolver> CellCycleModelOdeSolverMyDeltaNotchSrnModelMyDormandPrinceIvpOdeSolver;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyDormandPrinceIvpOdeSolver)
+typedef CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyFixedSizeRungeKutta4IvpOdeSolver6> CellCycleModelOdeSolverMyDeltaNotchSrnModelMyFixedSizeRungeKutta4IvpOdeSolver6;
+CHASTE_CLASS_EXPORT(CellCycleModelOdeSolverMyDeltaNotchSrnModelMyFixedSizeRungeKutta4IvpOdeSolver6)
 
 #endif /* MYDELTANOTCHSRNMODEL_HPP_ */
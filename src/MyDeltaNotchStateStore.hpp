@@ -0,0 +1,140 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHSTATESTORE_HPP_
+#define MYDELTANOTCHSTATESTORE_HPP_
+
+#include <vector>
+
+/**
+ * Typed storage for the per-cell inputs of the Delta-Notch SRN model, shared by
+ * a whole population.
+ *
+ * MyDeltaNotchTrackingModifier writes each cell's mean neighbouring Delta and x
+ * distance into contiguous arrays indexed by location index, and each
+ * MyDeltaNotchSrnModel reads its own entries directly (see
+ * MyDeltaNotchSrnModel::SetStateStore()). This replaces the string-keyed CellData
+ * items that were previously written and read for every cell on every timestep.
+ * The Delta and Notch levels themselves are only stored in each cell's ODE system.
+ *
+ * If the mean neighbouring Delta is refreshed less often than every timestep, the store
+ * also holds the rate at which it is extrapolated between refreshes.
+ */
+class MyDeltaNotchStateStore
+{
+private:
+
+    /** The mean level of Delta in each cell's neighbours, indexed by location index. */
+    std::vector<double> mMeanDelta;
+
+    /** The distance of each cell from the tissue centroid along the x axis, indexed by location index. */
+    std::vector<double> mXDistance;
+
+    /**
+     * The rate at which the mean neighbouring Delta of each cell is taken to change after
+     * mCouplingTime, indexed by location index. This is zero unless the neighbour coupling is
+     * refreshed less often than every timestep.
+     */
+    std::vector<double> mMeanDeltaRate;
+
+    /** The time at which the mean neighbouring Delta levels were last computed. */
+    double mCouplingTime;
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param numLocations the number of location indices to allocate (defaults to 0)
+     */
+    MyDeltaNotchStateStore(unsigned numLocations=0);
+
+    /**
+     * Change the number of location indices stored. Existing entries are kept
+     * and new entries are set to zero.
+     *
+     * @param numLocations the number of location indices
+     */
+    void Resize(unsigned numLocations);
+
+    /**
+     * @return the number of location indices stored.
+     */
+    unsigned GetNumLocations() const;
+
+    /**
+     * @return the mean level of Delta in each cell's neighbours, indexed by location index.
+     */
+    std::vector<double>& rGetMeanDelta();
+
+    /**
+     * @return the mean level of Delta in each cell's neighbours, indexed by location index.
+     */
+    const std::vector<double>& rGetMeanDelta() const;
+
+    /**
+     * @return the distance of each cell from the tissue centroid along the x axis, indexed by location index.
+     */
+    std::vector<double>& rGetXDistance();
+
+    /**
+     * @return the distance of each cell from the tissue centroid along the x axis, indexed by location index.
+     */
+    const std::vector<double>& rGetXDistance() const;
+
+    /**
+     * @return the rate of change of the mean level of Delta in each cell's neighbours, indexed by location index.
+     */
+    std::vector<double>& rGetMeanDeltaRate();
+
+    /**
+     * @return the rate of change of the mean level of Delta in each cell's neighbours, indexed by location index.
+     */
+    const std::vector<double>& rGetMeanDeltaRate() const;
+
+    /**
+     * Set the time at which the mean neighbouring Delta levels were computed.
+     *
+     * @param couplingTime the time
+     */
+    void SetCouplingTime(double couplingTime);
+
+    /**
+     * @return the time at which the mean neighbouring Delta levels were computed (0 by default).
+     */
+    double GetCouplingTime() const;
+};
+
+#endif /*MYDELTANOTCHSTATESTORE_HPP_*/
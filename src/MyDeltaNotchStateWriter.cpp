@@ -0,0 +1,101 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchStateWriter.hpp"
+#include "AbstractCellPopulation.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+MyDeltaNotchStateWriter<ELEMENT_DIM, SPACE_DIM>::MyDeltaNotchStateWriter()
+    : AbstractCellWriter<ELEMENT_DIM, SPACE_DIM>("deltanotch.dat")
+{
+    this->mVtkCellDataName = "delta";
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+double MyDeltaNotchStateWriter<ELEMENT_DIM, SPACE_DIM>::GetCellDataForVtkOutput(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(pCell->GetSrnModel());
+    return p_model->GetDelta();
+}
+
+template<unsigned ELEMENT_DIM, unsigned SPACE_DIM>
+void MyDeltaNotchStateWriter<ELEMENT_DIM, SPACE_DIM>::VisitCell(CellPtr pCell, AbstractCellPopulation<ELEMENT_DIM, SPACE_DIM>* pCellPopulation)
+{
+    unsigned location_index = pCellPopulation->GetLocationIndexUsingCell(pCell);
+    *this->mpOutStream << location_index << " ";
+
+    c_vector<double, SPACE_DIM> coords = pCellPopulation->GetLocationOfCellCentre(pCell);
+    for (unsigned i=0; i<SPACE_DIM; i++)
+    {
+        *this->mpOutStream << coords[i] << " ";
+    }
+
+    MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(pCell->GetSrnModel());
+    const std::vector<double>& r_state = p_model->rGetStateVariables();
+    double total_notch = 0.0;
+    for (unsigned var=0; var<r_state.size(); var++)
+    {
+        *this->mpOutStream << r_state[var] << " ";
+        if (var < 5)
+        {
+            total_notch += r_state[var];
+        }
+    }
+    *this->mpOutStream << total_notch << " ";
+
+    // Use the latest inputs from the state store if there is one, rather than those last passed to the ODE system
+    double mean_delta = p_model->GetMeanNeighbouringDelta();
+    double x_distance = p_model->GetXDistance();
+    boost::shared_ptr<MyDeltaNotchStateStore> p_state_store = p_model->GetStateStore();
+    if (p_state_store)
+    {
+        mean_delta = p_state_store->rGetMeanDelta()[p_model->GetStateStoreIndex()];
+        x_distance = p_state_store->rGetXDistance()[p_model->GetStateStoreIndex()];
+    }
+    *this->mpOutStream << mean_delta << " " << x_distance << " ";
+}
+
+// Explicit instantiation
+template class MyDeltaNotchStateWriter<1,1>;
+template class MyDeltaNotchStateWriter<1,2>;
+template class MyDeltaNotchStateWriter<2,2>;
+template class MyDeltaNotchStateWriter<1,3>;
+template class MyDeltaNotchStateWriter<2,3>;
+template class MyDeltaNotchStateWriter<3,3>;
+
+#include "SerializationExportWrapperForCpp.hpp"
+// Declare identifier for the serializer
+EXPORT_TEMPLATE_CLASS_ALL_DIMS(MyDeltaNotchStateWriter)
@@ -0,0 +1,144 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchSweepSimulation.hpp"
+
+#include <algorithm>
+#include <climits>
+#include <sstream>
+
+#include "CellId.hpp"
+#include "CellPropertyRegistry.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "MyDeltaNotchCellsGenerator.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "NoCellCycleModel.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "RandomNumberGenerator.hpp"
+#include "SimulationTime.hpp"
+#include "SmartPointers.hpp"
+#include "Timer.hpp"
+#include "VertexBasedCellPopulation.hpp"
+
+std::string MyDeltaNotchSweepSimulation::GetSummaryHeader(const std::vector<std::string>& rParameterNames)
+{
+    std::stringstream header;
+    header << "run,seed,width,height";
+    for (unsigned i=0; i<rParameterNames.size(); i++)
+    {
+        header << "," << rParameterNames[i];
+    }
+    header << ",num_cells,mean_delta,min_delta,max_delta,high_delta_fraction,wall_time";
+    return header.str();
+}
+
+std::string MyDeltaNotchSweepSimulation::Run(const MyDeltaNotchSweepRun& rRun, const std::string& rOutputDirectory)
+{
+    // Set up the singletons as AbstractCellBasedTestSuite does, whatever state they were left in
+    SimulationTime::Destroy();
+    SimulationTime::Instance()->SetStartTime(0.0);
+    RandomNumberGenerator::Instance()->Reseed(rRun.seed);
+    CellPropertyRegistry::Instance()->Clear();
+    CellId::ResetMaxCellId();
+    Timer::Reset();
+
+    std::stringstream summary;
+    summary.precision(8);
+    {
+        HoneycombVertexMeshGenerator generator(rRun.width, rRun.height);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        boost::shared_ptr<MyDeltaNotchParameters> p_parameters(new MyDeltaNotchParameters(rRun.parameters));
+        std::vector<CellPtr> cells;
+        MyDeltaNotchCellsGenerator cells_generator(rRun.seed);
+        cells_generator.SetKineticParameters(p_parameters);
+        cells_generator.GenerateBasic<NoCellCycleModel, 2>(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        std::stringstream output_directory;
+        output_directory << rOutputDirectory << "/run_" << rRun.index;
+        simulator.SetOutputDirectory(output_directory.str());
+        if (rRun.dt > 0.0)
+        {
+            simulator.SetDt(rRun.dt);
+        }
+        simulator.SetSamplingTimestepMultiple(UINT_MAX);
+        simulator.SetEndTime(rRun.endTime);
+
+        // Each run has a single core to itself
+        MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        p_modifier->SetNumThreads(1);
+        simulator.AddSimulationModifier(p_modifier);
+        simulator.Solve();
+
+        std::vector<double> delta;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            delta.push_back(static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel())->GetDelta());
+        }
+        double min_delta = *std::min_element(delta.begin(), delta.end());
+        double max_delta = *std::max_element(delta.begin(), delta.end());
+        double mean_delta = 0.0;
+        unsigned num_high_delta = 0;
+        for (unsigned i=0; i<delta.size(); i++)
+        {
+            mean_delta += delta[i];
+            if (delta[i] > 0.5*(min_delta + max_delta))
+            {
+                num_high_delta++;
+            }
+        }
+        mean_delta /= delta.size();
+
+        summary << rRun.index << "," << rRun.seed << "," << rRun.width << "," << rRun.height;
+        for (unsigned i=0; i<rRun.sweptParameters.size(); i++)
+        {
+            summary << "," << rRun.sweptParameters[i].second;
+        }
+        summary << "," << delta.size() << "," << mean_delta << "," << min_delta << "," << max_delta
+                << "," << double(num_high_delta)/delta.size() << "," << Timer::GetElapsedTime();
+    }
+
+    // Tear down the singletons, so the next run starts afresh
+    SimulationTime::Destroy();
+    RandomNumberGenerator::Destroy();
+    CellPropertyRegistry::Instance()->Clear();
+
+    return summary.str();
+}
@@ -0,0 +1,78 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHSWEEPSIMULATION_HPP_
+#define MYDELTANOTCHSWEEPSIMULATION_HPP_
+
+#include <string>
+#include <vector>
+
+#include "MyDeltaNotchSweepSpecification.hpp"
+
+/**
+ * Runs one simulation of a Delta-Notch parameter sweep and summarises it in one line.
+ *
+ * The simulation is of a static vertex-based monolayer of differentiated cells, as in the first
+ * test of the Delta-Notch tutorial, with the concentrations initialised to random levels. The
+ * Chaste singletons (SimulationTime, the RandomNumberGenerator and so on) are set up before
+ * the simulation and torn down afterwards, so runs can follow each other in one process.
+ */
+class MyDeltaNotchSweepSimulation
+{
+public:
+
+    /**
+     * @param rParameterNames the names of the swept parameters
+     * @return the comma-separated column headings of the summary lines.
+     */
+    static std::string GetSummaryHeader(const std::vector<std::string>& rParameterNames);
+
+    /**
+     * Run a simulation.
+     *
+     * The summary gives the index, seed and tissue size of the run, the values of the swept
+     * parameters, the number of cells, the mean, minimum and maximum Delta at the end time,
+     * the fraction of cells whose Delta is above the midpoint of the minimum and maximum (a
+     * measure of lateral inhibition patterning), and the wall-clock time of the simulation.
+     *
+     * @param rRun the settings of the run
+     * @param rOutputDirectory the directory, relative to CHASTE_TEST_OUTPUT, under which
+     *     each run's results are written
+     * @return the comma-separated summary of the run.
+     */
+    static std::string Run(const MyDeltaNotchSweepRun& rRun, const std::string& rOutputDirectory);
+};
+
+#endif /*MYDELTANOTCHSWEEPSIMULATION_HPP_*/
@@ -0,0 +1,266 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchSweepSpecification.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "Exception.hpp"
+
+namespace
+{
+/**
+ * Convert a token of a sweep specification to a number.
+ *
+ * @param rToken the token
+ * @param lineNumber the line of the specification, for error messages
+ * @return the value of the token.
+ */
+template<typename T>
+T ParseSweepToken(const std::string& rToken, unsigned lineNumber)
+{
+    std::istringstream token_stream(rToken);
+    T value;
+    token_stream >> value;
+    if (token_stream.fail() || !token_stream.eof())
+    {
+        EXCEPTION("Line " << lineNumber << " of the sweep specification: '" << rToken << "' is not a valid value.");
+    }
+    return value;
+}
+} // anonymous namespace
+
+MyDeltaNotchSweepSpecification::MyDeltaNotchSweepSpecification(std::istream& rStream)
+    : mEndTime(0.0),
+      mDt(0.0)
+{
+    Read(rStream);
+}
+
+MyDeltaNotchSweepSpecification::MyDeltaNotchSweepSpecification(const std::string& rFileName)
+    : mEndTime(0.0),
+      mDt(0.0)
+{
+    std::ifstream file(rFileName.c_str());
+    if (!file.is_open())
+    {
+        EXCEPTION("Could not open the sweep specification " << rFileName);
+    }
+    Read(file);
+}
+
+void MyDeltaNotchSweepSpecification::Read(std::istream& rStream)
+{
+    std::string line;
+    unsigned line_number = 0;
+    while (std::getline(rStream, line))
+    {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream line_stream(line);
+        std::string keyword;
+        if (!(line_stream >> keyword))
+        {
+            continue;
+        }
+        std::vector<std::string> tokens;
+        std::string token;
+        while (line_stream >> token)
+        {
+            tokens.push_back(token);
+        }
+        if (tokens.empty())
+        {
+            EXCEPTION("Line " << line_number << " of the sweep specification: '" << keyword << "' has no values.");
+        }
+
+        if (keyword == "seeds")
+        {
+            for (unsigned i=0; i<tokens.size(); i++)
+            {
+                std::string::size_type colon = tokens[i].find(':');
+                if (colon == std::string::npos)
+                {
+                    mSeeds.push_back(ParseSweepToken<unsigned>(tokens[i], line_number));
+                }
+                else
+                {
+                    unsigned first = ParseSweepToken<unsigned>(tokens[i].substr(0, colon), line_number);
+                    unsigned last = ParseSweepToken<unsigned>(tokens[i].substr(colon + 1), line_number);
+                    // Stop at last before incrementing, which would wrap round if last is UINT_MAX
+                    for (unsigned seed=first; first<=last; seed++)
+                    {
+                        mSeeds.push_back(seed);
+                        if (seed == last)
+                        {
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+        else if (keyword == "tissue_size")
+        {
+            for (unsigned i=0; i<tokens.size(); i++)
+            {
+                std::string::size_type x = tokens[i].find('x');
+                if (x == std::string::npos)
+                {
+                    EXCEPTION("Line " << line_number << " of the sweep specification: tissue sizes must be given as <width>x<height>.");
+                }
+                unsigned width = ParseSweepToken<unsigned>(tokens[i].substr(0, x), line_number);
+                unsigned height = ParseSweepToken<unsigned>(tokens[i].substr(x + 1), line_number);
+                if (width == 0 || height == 0)
+                {
+                    EXCEPTION("Line " << line_number << " of the sweep specification: tissue sizes must be positive.");
+                }
+                mTissueSizes.push_back(std::make_pair(width, height));
+            }
+        }
+        else if (keyword == "end_time" || keyword == "dt")
+        {
+            if (tokens.size() != 1)
+            {
+                EXCEPTION("Line " << line_number << " of the sweep specification: '" << keyword << "' takes a single value.");
+            }
+            double value = ParseSweepToken<double>(tokens[0], line_number);
+            if (value <= 0.0)
+            {
+                EXCEPTION("Line " << line_number << " of the sweep specification: '" << keyword << "' must be positive.");
+            }
+            (keyword == "end_time" ? mEndTime : mDt) = value;
+        }
+        else if (keyword == "parameter")
+        {
+            // Check the name now, rather than part way through the sweep
+            try
+            {
+                MyDeltaNotchParameters().GetParameter(tokens[0]);
+            }
+            catch (const Exception& e)
+            {
+                EXCEPTION("Line " << line_number << " of the sweep specification: " << e.GetShortMessage());
+            }
+
+            std::vector<double> values;
+            if (tokens.size() == 5 && tokens[1] == "linspace")
+            {
+                double first = ParseSweepToken<double>(tokens[2], line_number);
+                double last = ParseSweepToken<double>(tokens[3], line_number);
+                unsigned num_values = ParseSweepToken<unsigned>(tokens[4], line_number);
+                for (unsigned i=0; i<num_values; i++)
+                {
+                    values.push_back(num_values == 1 ? first : first + (last - first)*i/(num_values - 1.0));
+                }
+            }
+            else
+            {
+                for (unsigned i=1; i<tokens.size(); i++)
+                {
+                    values.push_back(ParseSweepToken<double>(tokens[i], line_number));
+                }
+            }
+            if (values.empty())
+            {
+                EXCEPTION("Line " << line_number << " of the sweep specification: parameter " << tokens[0] << " has no values.");
+            }
+            mParameterNames.push_back(tokens[0]);
+            mParameterValues.push_back(values);
+        }
+        else
+        {
+            EXCEPTION("Line " << line_number << " of the sweep specification: unknown keyword '" << keyword << "'.");
+        }
+    }
+
+    if (mSeeds.empty())
+    {
+        mSeeds.push_back(0u);
+    }
+    if (mTissueSizes.empty())
+    {
+        EXCEPTION("The sweep specification must give at least one tissue_size.");
+    }
+    if (mEndTime == 0.0)
+    {
+        EXCEPTION("The sweep specification must give the end_time.");
+    }
+}
+
+unsigned MyDeltaNotchSweepSpecification::GetNumRuns() const
+{
+    unsigned num_runs = mSeeds.size()*mTissueSizes.size();
+    for (unsigned i=0; i<mParameterValues.size(); i++)
+    {
+        num_runs *= mParameterValues[i].size();
+    }
+    return num_runs;
+}
+
+MyDeltaNotchSweepRun MyDeltaNotchSweepSpecification::GetRun(unsigned index) const
+{
+    if (index >= GetNumRuns())
+    {
+        EXCEPTION("Run " << index << " is not in the sweep, which has " << GetNumRuns() << " runs.");
+    }
+
+    MyDeltaNotchSweepRun run;
+    run.index = index;
+    run.endTime = mEndTime;
+    run.dt = mDt;
+
+    // Decompose the index, with the seed varying fastest and the tissue size slowest
+    unsigned remainder = index;
+    run.seed = mSeeds[remainder % mSeeds.size()];
+    remainder /= mSeeds.size();
+    for (unsigned i=mParameterNames.size(); i-- > 0; )
+    {
+        double value = mParameterValues[i][remainder % mParameterValues[i].size()];
+        remainder /= mParameterValues[i].size();
+        run.parameters.SetParameter(mParameterNames[i], value);
+        run.sweptParameters.insert(run.sweptParameters.begin(), std::make_pair(mParameterNames[i], value));
+    }
+    run.width = mTissueSizes[remainder].first;
+    run.height = mTissueSizes[remainder].second;
+
+    return run;
+}
+
+const std::vector<std::string>& MyDeltaNotchSweepSpecification::rGetParameterNames() const
+{
+    return mParameterNames;
+}
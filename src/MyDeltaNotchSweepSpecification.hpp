@@ -0,0 +1,156 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHSWEEPSPECIFICATION_HPP_
+#define MYDELTANOTCHSWEEPSPECIFICATION_HPP_
+
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "MyDeltaNotchParameters.hpp"
+
+/**
+ * The settings of one run of a Delta-Notch parameter sweep.
+ */
+struct MyDeltaNotchSweepRun
+{
+    /** The index of the run within the sweep. */
+    unsigned index;
+
+    /** The seed of the random number generator. */
+    unsigned seed;
+
+    /** The number of cells across the tissue. */
+    unsigned width;
+
+    /** The number of cells up the tissue. */
+    unsigned height;
+
+    /** The end time of the simulation. */
+    double endTime;
+
+    /** The simulation timestep, or 0 to use the default. */
+    double dt;
+
+    /** The kinetic parameters, with any swept parameters set. */
+    MyDeltaNotchParameters parameters;
+
+    /** The names and values of the swept parameters, in the order they are given in the specification. */
+    std::vector<std::pair<std::string, double> > sweptParameters;
+};
+
+/**
+ * A parameter sweep of Delta-Notch simulations, read from a text specification.
+ *
+ * Each line of the specification is a keyword followed by its values, separated by whitespace.
+ * Anything after a '#' is a comment. The keywords are:
+ *
+ *   seeds 0:9 42            the seeds of the random number generator; a:b is the range a to b inclusive
+ *   tissue_size 10x10 20x20 the tissue sizes, as width x height in cells
+ *   end_time 100            the end time of each simulation
+ *   dt 0.005                (optional) the simulation timestep
+ *   parameter k_6 400 500   the values of a kinetic parameter (see MyDeltaNotchParameters)
+ *   parameter beta_N linspace 5 15 3
+ *                           as above, with 3 values evenly spaced from 5 to 15 inclusive
+ *
+ * The sweep runs every combination of tissue size, parameter values and seed. The seed varies
+ * fastest, so the replicates of each point in parameter space have consecutive indices. Runs
+ * are generated on demand, so a sweep may be very large.
+ */
+class MyDeltaNotchSweepSpecification
+{
+private:
+
+    /** The seeds. */
+    std::vector<unsigned> mSeeds;
+
+    /** The tissue sizes, as pairs of width and height. */
+    std::vector<std::pair<unsigned, unsigned> > mTissueSizes;
+
+    /** The end time of each simulation. */
+    double mEndTime;
+
+    /** The simulation timestep, or 0 to use the default. */
+    double mDt;
+
+    /** The names of the swept parameters. */
+    std::vector<std::string> mParameterNames;
+
+    /** The values of each swept parameter, in the same order as mParameterNames. */
+    std::vector<std::vector<double> > mParameterValues;
+
+    /**
+     * Parse the specification.
+     *
+     * @param rStream the specification
+     */
+    void Read(std::istream& rStream);
+
+public:
+
+    /**
+     * Constructor, which reads a specification from a stream.
+     *
+     * @param rStream the specification
+     */
+    MyDeltaNotchSweepSpecification(std::istream& rStream);
+
+    /**
+     * Constructor, which reads a specification from a file.
+     *
+     * @param rFileName the path of the file
+     */
+    MyDeltaNotchSweepSpecification(const std::string& rFileName);
+
+    /**
+     * @return the number of runs in the sweep.
+     */
+    unsigned GetNumRuns() const;
+
+    /**
+     * @param index the index of a run
+     * @return the settings of the run.
+     */
+    MyDeltaNotchSweepRun GetRun(unsigned index) const;
+
+    /**
+     * @return the names of the swept parameters.
+     */
+    const std::vector<std::string>& rGetParameterNames() const;
+};
+
+#endif /*MYDELTANOTCHSWEEPSPECIFICATION_HPP_*/
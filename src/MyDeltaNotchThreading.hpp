@@ -0,0 +1,85 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHTHREADING_HPP_
+#define MYDELTANOTCHTHREADING_HPP_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+ * Resolve a requested number of threads for the OpenMP loops of the Delta-Notch classes.
+ *
+ * @param numThreads the requested number of threads, or 0 for the OpenMP default
+ *     (which may be set with the OMP_NUM_THREADS environment variable)
+ * @return the number of threads to use, which is always 1 if OpenMP is not enabled
+ */
+inline int ResolveMyDeltaNotchNumThreads(unsigned numThreads)
+{
+#ifdef _OPENMP
+    return (numThreads == 0) ? omp_get_max_threads() : static_cast<int>(numThreads);
+#else
+    return 1;
+#endif
+}
+
+/**
+ * @return the number of the calling thread within the current OpenMP parallel region
+ *     (always 0 outside a parallel region, or if OpenMP is not enabled)
+ */
+inline unsigned GetMyDeltaNotchThreadNum()
+{
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+/**
+ * @return whether the caller is inside an active OpenMP parallel region
+ *     (always false if OpenMP is not enabled)
+ */
+inline bool IsInMyDeltaNotchParallelRegion()
+{
+#ifdef _OPENMP
+    return omp_in_parallel();
+#else
+    return false;
+#endif
+}
+
+#endif /*MYDELTANOTCHTHREADING_HPP_*/
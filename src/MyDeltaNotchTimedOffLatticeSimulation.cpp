@@ -0,0 +1,94 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include "MyDeltaNotchTimedOffLatticeSimulation.hpp"
+
+#include <algorithm>
+
+#include "MyDeltaNotchPhaseTimerModifier.hpp"
+#include "MyDeltaNotchPhaseTimers.hpp"
+
+template<unsigned DIM>
+MyDeltaNotchTimedOffLatticeSimulation<DIM>::MyDeltaNotchTimedOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                                                                  bool deleteCellPopulationInDestructor,
+                                                                                  bool initialiseCells)
+    : OffLatticeSimulation<DIM>(rCellPopulation, deleteCellPopulationInDestructor, initialiseCells)
+{
+    // When loading from an archive, the modifier is restored with the others
+    if (initialiseCells && MyDeltaNotchPhaseTimers::IsEnabled())
+    {
+        boost::shared_ptr<MyDeltaNotchPhaseTimerModifier<DIM> > p_timer_modifier(new MyDeltaNotchPhaseTimerModifier<DIM>);
+        this->AddSimulationModifier(p_timer_modifier);
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTimedOffLatticeSimulation<DIM>::SetupSolve()
+{
+    OffLatticeSimulation<DIM>::SetupSolve();
+
+    /*
+     * The modifiers are called in order at the end of each step, so the timer modifier must come last
+     * for the total time of a step to include the other modifiers (the tracking modifier in particular).
+     */
+    std::stable_partition(this->mSimulationModifiers.begin(), this->mSimulationModifiers.end(),
+                          [](const boost::shared_ptr<AbstractCellBasedSimulationModifier<DIM,DIM> >& rpModifier)
+                          {
+                              return !boost::dynamic_pointer_cast<MyDeltaNotchPhaseTimerModifier<DIM> >(rpModifier);
+                          });
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTimedOffLatticeSimulation<DIM>::UpdateCellPopulation()
+{
+    MY_DELTA_NOTCH_TIME_PHASE(POPULATION_UPDATE);
+    OffLatticeSimulation<DIM>::UpdateCellPopulation();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTimedOffLatticeSimulation<DIM>::UpdateCellLocationsAndTopology()
+{
+    MY_DELTA_NOTCH_TIME_PHASE(FORCES);
+    OffLatticeSimulation<DIM>::UpdateCellLocationsAndTopology();
+}
+
+// Explicit instantiation
+template class MyDeltaNotchTimedOffLatticeSimulation<1>;
+template class MyDeltaNotchTimedOffLatticeSimulation<2>;
+template class MyDeltaNotchTimedOffLatticeSimulation<3>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchTimedOffLatticeSimulation)
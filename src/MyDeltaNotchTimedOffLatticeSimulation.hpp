@@ -0,0 +1,145 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHTIMEDOFFLATTICESIMULATION_HPP_
+#define MYDELTANOTCHTIMEDOFFLATTICESIMULATION_HPP_
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "OffLatticeSimulation.hpp"
+
+/**
+ * An OffLatticeSimulation that times the phases of each step that are not timed by the
+ * Delta-Notch classes themselves: the population update (the population's Update(), with any
+ * remeshing, and cell division and death) and the forces and movement of the cells.
+ *
+ * If the code is compiled with MY_DELTA_NOTCH_PHASE_TIMERS defined, a MyDeltaNotchPhaseTimerModifier
+ * is added on construction, so the times of every phase (see MyDeltaNotchPhaseTimers) are written
+ * to phase_timers.csv in the output directory. It is moved after any modifiers added later when
+ * the solve starts, so that each step's total includes the work of those modifiers in that step.
+ * Otherwise the timing is compiled out, as for the other phases, and this class behaves exactly
+ * as OffLatticeSimulation.
+ */
+template<unsigned DIM>
+class MyDeltaNotchTimedOffLatticeSimulation : public OffLatticeSimulation<DIM>
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Save or restore the simulation.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<OffLatticeSimulation<DIM> >(*this);
+    }
+
+protected:
+
+    /**
+     * Overridden SetupSolve() method, which moves the phase timer modifier, if any, to the end
+     * of the simulation modifiers.
+     */
+    virtual void SetupSolve();
+
+    /**
+     * Overridden UpdateCellPopulation() method, which times the population update.
+     */
+    virtual void UpdateCellPopulation();
+
+    /**
+     * Overridden UpdateCellLocationsAndTopology() method, which times the forces and movement.
+     */
+    virtual void UpdateCellLocationsAndTopology();
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param rCellPopulation Reference to a cell population object
+     * @param deleteCellPopulationInDestructor Whether to delete the cell population on destruction to
+     *     free up memory (defaults to false)
+     * @param initialiseCells Whether to initialise cells (defaults to true, set to false when loading
+     *     from an archive)
+     */
+    MyDeltaNotchTimedOffLatticeSimulation(AbstractCellPopulation<DIM>& rCellPopulation,
+                                          bool deleteCellPopulationInDestructor=false,
+                                          bool initialiseCells=true);
+};
+
+#include "SerializationExportWrapper.hpp"
+EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchTimedOffLatticeSimulation)
+
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Serialize information required to construct a MyDeltaNotchTimedOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void save_construct_data(
+    Archive & ar, const MyDeltaNotchTimedOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Save data required to construct instance
+    const AbstractCellPopulation<DIM>* p_cell_population = &(t->rGetCellPopulation());
+    ar & p_cell_population;
+}
+
+/**
+ * De-serialize constructor parameters and initialise a MyDeltaNotchTimedOffLatticeSimulation.
+ */
+template<class Archive, unsigned DIM>
+inline void load_construct_data(
+    Archive & ar, MyDeltaNotchTimedOffLatticeSimulation<DIM> * t, const unsigned int file_version)
+{
+    // Retrieve data from archive required to construct new instance
+    AbstractCellPopulation<DIM>* p_cell_population;
+    ar >> p_cell_population;
+
+    // Invoke inplace constructor to initialise instance
+    ::new(t)MyDeltaNotchTimedOffLatticeSimulation<DIM>(*p_cell_population, true, false);
+}
+}
+} // namespace
+
+#endif /*MYDELTANOTCHTIMEDOFFLATTICESIMULATION_HPP_*/
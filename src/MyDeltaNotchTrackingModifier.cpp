@@ -33,13 +33,37 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 */
 
+#include <algorithm>
+
 #include "MyDeltaNotchTrackingModifier.hpp"
 #include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchPhaseTimers.hpp"
+#include "MyDeltaNotchThreading.hpp"
+#include "SimulationTime.hpp"
+#include "Exception.hpp"
 #include "Debug.hpp"
 
 template<unsigned DIM>
 MyDeltaNotchTrackingModifier<DIM>::MyDeltaNotchTrackingModifier()
-    : AbstractCellBasedSimulationModifier<DIM>()
+    : AbstractCellBasedSimulationModifier<DIM>(),
+      mUseBatchIntegration(false),
+      mUseSinglePrecision(false),
+      mUseParallelIntegration(false),
+      mExportToCellData(false),
+      mNumThreads(0),
+      mSignallingTimestep(0.0),
+      mInterpolateCoupling(true),
+      mImplicitTimestep(0.0),
+      mSignallingTime(0.0),
+      mNextCouplingRefreshTime(0.0),
+      mLastCouplingRefreshTime(0.0),
+      mCouplingGraphRebuilds(UNSIGNED_UNSET),
+      mNumQuiescentCells(0),
+      mXDistanceTolerance(0.0),
+      mLocationSum(zero_vector<double>(DIM)),
+      mXDistanceReferenceCentroidX(0.0),
+      mLocationGraphRebuilds(UNSIGNED_UNSET),
+      mpStateStore(new MyDeltaNotchStateStore)
 {
 }
 
@@ -51,7 +75,25 @@ MyDeltaNotchTrackingModifier<DIM>::~MyDeltaNotchTrackingModifier()
 template<unsigned DIM>
 void MyDeltaNotchTrackingModifier<DIM>::UpdateAtEndOfTimeStep(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
+    MY_DELTA_NOTCH_TIME_PHASE(TRACKING_MODIFIER);
     UpdateCellData(rCellPopulation);
+
+    if (mImplicitTimestep > 0.0)
+    {
+        SimulateSrnModelsImplicitly(rCellPopulation);
+    }
+    else if (mSignallingTimestep > 0.0)
+    {
+        SimulateSrnModelsMultiRate(rCellPopulation);
+    }
+    else if (mUseBatchIntegration)
+    {
+        SimulateSrnModelsInBatch(rCellPopulation);
+    }
+    else if (mUseParallelIntegration)
+    {
+        SimulateSrnModelsInParallel(rCellPopulation);
+    }
 }
 
 template<unsigned DIM>
@@ -61,84 +103,668 @@ void MyDeltaNotchTrackingModifier<DIM>::SetupSolve(AbstractCellPopulation<DIM,DI
      * We must update CellData in SetupSolve(), otherwise it will not have been
      * fully initialised by the time we enter the main time loop.
      */
+    MY_DELTA_NOTCH_TIME_PHASE(TRACKING_MODIFIER);
+    mCouplingGraphRebuilds = UNSIGNED_UNSET;
     UpdateCellData(rCellPopulation);
+    mNextCouplingRefreshTime = mSignallingTime + mSignallingTimestep;
 }
 
 template<unsigned DIM>
 void MyDeltaNotchTrackingModifier<DIM>::UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
 {
-    // Make sure the cell population is updated
+    // Make sure the cell population is updated, then refresh the neighbour relation if its topology has changed
     rCellPopulation.Update();
-    c_vector<double,2> population_centroid = rCellPopulation.GetCentroidOfCellPopulation();
-    // First recover each cell's Notch and Delta concentrations from the ODEs and store in CellData
+    mNeighbourGraph.Update(rCellPopulation);
+    mpStateStore->Resize(mNeighbourGraph.GetNumLocations());
+    std::vector<double>& r_x_distance = mpStateStore->rGetXDistance();
+    const std::vector<unsigned>& r_location_indices = mNeighbourGraph.rGetLocationIndices();
+
+    // The graph's rows are in the order in which the population's iterator visits cells
+    mCells.clear();
+    mSrnModels.clear();
+    mSignallingTime = SimulationTime::Instance()->GetTime();
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
          cell_iter != rCellPopulation.End();
          ++cell_iter)
     {
         MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
-        double this_delta                             = p_model->GetDelta();
-        double this_cell_surface_notch                = p_model->GetCellSurfaceNotch();
-        double this_sudx_dependent_notch              = p_model->GetSudxDependentNotch();
-        double this_dx_dependent_early_endosome_notch = p_model->GetDxDependentEarlyEndosomeNotch();
-        double this_dx_dependent_late_endosome_notch  = p_model->GetDxDependentLateEndosomeNotch();
-        double this_notch_intracellular_domain        = p_model->GetNotchIntracellularDomain();
-
-        c_vector<double,2> this_centroid = rCellPopulation.GetLocationOfCellCentre(*cell_iter);
-        c_vector<double,2> this_distance_to_tissue_centre;
-        this_distance_to_tissue_centre(0) = 0.0;
-        this_distance_to_tissue_centre(1) = 0.0;
-        this_distance_to_tissue_centre = this_centroid - population_centroid;
-        double this_x_distance = fabs(this_distance_to_tissue_centre[0]);
-
-        double total_notch = this_cell_surface_notch + this_sudx_dependent_notch +
-                             this_dx_dependent_early_endosome_notch + this_dx_dependent_late_endosome_notch +
-                             this_notch_intracellular_domain;
-
-        // Note that the state variables must be in the same order as listed in DeltaNotchOdeSystem
-        cell_iter->GetCellData()->SetItem("cell surface notch", this_cell_surface_notch);
-        cell_iter->GetCellData()->SetItem("sudx dependent notch", this_sudx_dependent_notch);
-        cell_iter->GetCellData()->SetItem("dx dependent early endosome notch", this_dx_dependent_early_endosome_notch);
-        cell_iter->GetCellData()->SetItem("dx dependent late endosome notch", this_dx_dependent_late_endosome_notch);
-        cell_iter->GetCellData()->SetItem("notch intracellular domain", this_notch_intracellular_domain);
-        cell_iter->GetCellData()->SetItem("total notch", total_notch);
-        cell_iter->GetCellData()->SetItem("delta", this_delta);
-        cell_iter->GetCellData()->SetItem("x distance", this_x_distance);
-    }
-
-    // Next iterate over the population to compute and store each cell's neighbouring Delta concentration in CellData
+        mCells.push_back(*cell_iter);
+        mSrnModels.push_back(p_model);
+        mSignallingTime = std::min(mSignallingTime, p_model->GetSimulatedToTime());
+    }
+    const int num_cells = mCells.size();
+    assert(mCells.size() == r_location_indices.size());
+    mDelta.resize(num_cells);
+
+    const int num_threads = ResolveMyDeltaNotchNumThreads(mNumThreads);
+
+    /*
+     * The work is done in phases, each of which shares the rows between threads. First recover each
+     * cell's Delta concentration from the ODEs and location, and point its SRN model at its entries in
+     * the store. Each row only writes to its own cell and to its own entries of the member vectors and
+     * the store.
+     */
+    mNewCellLocations.resize(num_cells);
+    #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1)
+    for (int row=0; row<num_cells; row++)
+    {
+        CellPtr p_cell = mCells[row];
+        unsigned location_index = r_location_indices[row];
+        assert(location_index == rCellPopulation.GetLocationIndexUsingCell(p_cell));
+
+        MyDeltaNotchSrnModel* p_model = mSrnModels[row];
+        p_model->SetStateStore(mpStateStore, location_index);
+        mDelta[row] = p_model->GetDelta();
+        mNewCellLocations[row] = rCellPopulation.GetLocationOfCellCentre(p_cell);
+    }
+
+    /*
+     * Next sum the cells' locations, from which the centroid of the population is found. The sum is
+     * recomputed in full every step, rather than updated with each cell's displacement, so that no
+     * rounding error accumulates: it is added up in row order, which is the order in which the
+     * population iterates over its cells, so the centroid is exactly the one that
+     * GetCentroidOfCellPopulation() on the population would give, for any number of threads. This
+     * costs no more than finding which cells have moved would, and reuses the locations found above.
+     */
+    bool rows_unchanged = (mNeighbourGraph.GetNumRebuilds() == mLocationGraphRebuilds)
+                          && (mCellLocations.size() == mNewCellLocations.size());
+    mLocationSum = zero_vector<double>(DIM);
+    for (int row=0; row<num_cells; row++)
+    {
+        mLocationSum += mNewCellLocations[row];
+    }
+    if (!rows_unchanged)
+    {
+        // The rows may now hold different cells (for example after a division or death)
+        mXDistanceReferenceX.assign(num_cells, 0.0);
+    }
+    mCellLocations.swap(mNewCellLocations);
+    mLocationGraphRebuilds = mNeighbourGraph.GetNumRebuilds();
+
+    // If the centroid has moved by more than the tolerance, every cell's x distance is recomputed
+    double centroid_x = (num_cells > 0) ? mLocationSum[0]/num_cells : 0.0;
+    bool centroid_moved = !rows_unchanged || (fabs(centroid_x - mXDistanceReferenceCentroidX) > mXDistanceTolerance);
+    if (centroid_moved)
+    {
+        mXDistanceReferenceCentroidX = centroid_x;
+    }
+
+    // Then update the x distance of each cell that has moved by more than the tolerance, and export to CellData
+    int num_quiescent_cells = 0;
+    #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1) reduction(+:num_quiescent_cells)
+    for (int row=0; row<num_cells; row++)
+    {
+        unsigned location_index = r_location_indices[row];
+        double this_x = mCellLocations[row][0];
+        if (centroid_moved || fabs(this_x - mXDistanceReferenceX[row]) > mXDistanceTolerance)
+        {
+            r_x_distance[location_index] = fabs(this_x - mXDistanceReferenceCentroidX);
+            mXDistanceReferenceX[row] = this_x;
+        }
+
+        MyDeltaNotchSrnModel* p_model = mSrnModels[row];
+        if (p_model->IsQuiescent())
+        {
+            num_quiescent_cells++;
+        }
+
+        if (mExportToCellData)
+        {
+            CellPtr p_cell = mCells[row];
+            double this_cell_surface_notch                = p_model->GetCellSurfaceNotch();
+            double this_sudx_dependent_notch              = p_model->GetSudxDependentNotch();
+            double this_dx_dependent_early_endosome_notch = p_model->GetDxDependentEarlyEndosomeNotch();
+            double this_dx_dependent_late_endosome_notch  = p_model->GetDxDependentLateEndosomeNotch();
+            double this_notch_intracellular_domain        = p_model->GetNotchIntracellularDomain();
+
+            double total_notch = this_cell_surface_notch + this_sudx_dependent_notch +
+                                 this_dx_dependent_early_endosome_notch + this_dx_dependent_late_endosome_notch +
+                                 this_notch_intracellular_domain;
+
+            // Note that the state variables must be in the same order as listed in DeltaNotchOdeSystem
+            p_cell->GetCellData()->SetItem("cell surface notch", this_cell_surface_notch);
+            p_cell->GetCellData()->SetItem("sudx dependent notch", this_sudx_dependent_notch);
+            p_cell->GetCellData()->SetItem("dx dependent early endosome notch", this_dx_dependent_early_endosome_notch);
+            p_cell->GetCellData()->SetItem("dx dependent late endosome notch", this_dx_dependent_late_endosome_notch);
+            p_cell->GetCellData()->SetItem("notch intracellular domain", this_notch_intracellular_domain);
+            p_cell->GetCellData()->SetItem("total notch", total_notch);
+            p_cell->GetCellData()->SetItem("delta", mDelta[row]);
+            p_cell->GetCellData()->SetItem("x distance", r_x_distance[location_index]);
+            p_cell->GetCellData()->SetItem("quiescent", p_model->IsQuiescent() ? 1.0 : 0.0);
+        }
+    }
+    mNumQuiescentCells = num_quiescent_cells;
+
+    // Don't keep the cells alive beyond this timestep
+    mCells.clear();
+
+    /*
+     * Once every cell's Delta is known (the end of the loop above is a barrier), compute each cell's
+     * neighbouring Delta concentration. If the coupling is refreshed at its own rate this is left to
+     * SimulateSrnModelsMultiRate(), unless the topology has changed since the last refresh.
+     */
+    if ((mSignallingTimestep == 0.0) || (mNeighbourGraph.GetNumRebuilds() != mCouplingGraphRebuilds))
+    {
+        UpdateCoupling(mSignallingTime);
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::UpdateCoupling(double time)
+{
+    std::vector<double>& r_mean_delta = mpStateStore->rGetMeanDelta();
+    std::vector<double>& r_mean_delta_rate = mpStateStore->rGetMeanDeltaRate();
+    const std::vector<unsigned>& r_location_indices = mNeighbourGraph.rGetLocationIndices();
+    const int num_cells = mSrnModels.size();
+    const int num_threads = ResolveMyDeltaNotchNumThreads(mNumThreads);
+
+    // The graph sums each row in a fixed order, so the result is the same for any number of threads
+    mNeighbourGraph.ComputeNeighbourMeans(mDelta, mMeanDelta, num_threads);
+
+    /*
+     * Between refreshes at the signalling rate, each cell's input is extrapolated linearly from its last
+     * two values. This is only possible if each location still holds the same cell as at the last refresh.
+     */
+    bool extrapolate = (mSignallingTimestep > 0.0)
+                       && mInterpolateCoupling
+                       && (mNeighbourGraph.GetNumRebuilds() == mCouplingGraphRebuilds)
+                       && (time > mLastCouplingRefreshTime);
+    double inverse_interval = extrapolate ? 1.0/(time - mLastCouplingRefreshTime) : 0.0;
+
+    #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1)
+    for (int row=0; row<num_cells; row++)
+    {
+        // A cell with no neighbours, such as an isolated cell in a CaBasedCellPopulation, has a mean of 0.0
+        unsigned location_index = r_location_indices[row];
+        r_mean_delta_rate[location_index] = extrapolate ? (mMeanDelta[row] - r_mean_delta[location_index])*inverse_interval : 0.0;
+        r_mean_delta[location_index] = mMeanDelta[row];
+
+        if (mExportToCellData)
+        {
+            mSrnModels[row]->GetCell()->GetCellData()->SetItem("mean delta", mMeanDelta[row]);
+        }
+    }
+
+    mpStateStore->SetCouplingTime(time);
+    mLastCouplingRefreshTime = time;
+    mCouplingGraphRebuilds = mNeighbourGraph.GetNumRebuilds();
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::CreateThreadOdeSolvers(int numThreads)
+{
+    if (mThreadOdeSolvers.size() < static_cast<unsigned>(numThreads))
+    {
+        mThreadOdeSolvers.resize(numThreads);
+    }
+
+    // Make sure each thread has its own copy of every shared solver in use, before going parallel
+    const AbstractCellCycleModelOdeSolver* p_last_shared_solver = nullptr;
+    for (unsigned i=0; i<mSrnModels.size(); i++)
+    {
+        const AbstractCellCycleModelOdeSolver* p_shared_solver = mSrnModels[i]->GetOdeSolver().get();
+        if (p_shared_solver != p_last_shared_solver)
+        {
+            for (int thread=0; thread<numThreads; thread++)
+            {
+                if (mThreadOdeSolvers[thread].find(p_shared_solver) == mThreadOdeSolvers[thread].end())
+                {
+                    mThreadOdeSolvers[thread][p_shared_solver] = mSrnModels[i]->CreateUnsharedOdeSolver();
+                }
+            }
+            p_last_shared_solver = p_shared_solver;
+        }
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::AdvanceSrnModels(double time, int numThreads)
+{
+    // The SRN models do not time themselves inside the parallel region, so time it as a whole
+    MY_DELTA_NOTCH_TIME_PHASE(SRN_INTEGRATION);
+
+    /*
+     * Advance each SRN model with its thread's solver. An adaptive solver may take many more steps in
+     * some cells than in others, so rather than giving each thread a fixed share of the cells, idle
+     * threads take the next few cells from those remaining. Each cell's result depends only on its own
+     * state and inputs, so it does not depend on which thread advances it.
+     *
+     * An exception cannot leave a parallel region, so the message from the first cell (in population
+     * order) to throw one is recorded and rethrown afterwards.
+     */
+    const int num_models = mSrnModels.size();
+    int first_failed_model = num_models;
+    std::string error_message;
+    #pragma omp parallel for schedule(dynamic, 4) num_threads(numThreads) if(numThreads > 1)
+    for (int i=0; i<num_models; i++)
+    {
+        MyDeltaNotchSrnModel* p_model = mSrnModels[i];
+        try
+        {
+            AbstractIvpOdeSolver& r_solver = *(mThreadOdeSolvers[GetMyDeltaNotchThreadNum()][p_model->GetOdeSolver().get()]);
+            p_model->SimulateToTime(time, r_solver);
+        }
+        catch (Exception& e)
+        {
+            #pragma omp critical(MyDeltaNotchTrackingModifierError)
+            {
+                if (i < first_failed_model)
+                {
+                    first_failed_model = i;
+                    error_message = e.GetShortMessage();
+                }
+            }
+        }
+    }
+
+    if (first_failed_model < num_models)
+    {
+        EXCEPTION(error_message);
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SimulateSrnModelsInBatch(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    double current_time = SimulationTime::Instance()->GetTime();
+
+    // Collect the SRN models that share the same start time, ODE timestep and kinetic parameters as the first one found
+    mBatchSrnModels.clear();
+    double start_time = current_time;
+    double dt = 0.0;
+    boost::shared_ptr<MyDeltaNotchParameters> p_kinetic_parameters;
     for (typename AbstractCellPopulation<DIM>::Iterator cell_iter = rCellPopulation.Begin();
          cell_iter != rCellPopulation.End();
          ++cell_iter)
     {
-        // Get the set of neighbouring location indices
-        std::set<unsigned> neighbour_indices = rCellPopulation.GetNeighbouringLocationIndices(*cell_iter);
+        MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+        double simulated_to_time = p_model->GetSimulatedToTime();
+        if (simulated_to_time < current_time)
+        {
+            // Quiescent cells whose inputs have not moved are simply marked as simulated to the current time
+            p_model->UpdateDeltaNotch();
+            if (p_model->SkipIfQuiescent(current_time))
+            {
+                continue;
+            }
+
+            if (mBatchSrnModels.empty())
+            {
+                start_time = simulated_to_time;
+                dt = p_model->GetDt();
+                p_kinetic_parameters = p_model->GetKineticParameters();
+            }
+
+            if ((simulated_to_time == start_time)
+                && (p_model->GetDt() == dt)
+                && (p_model->GetKineticParameters() == p_kinetic_parameters))
+            {
+                mBatchSrnModels.push_back(p_model);
+            }
+            else
+            {
+                p_model->SimulateToCurrentTime();
+            }
+        }
+    }
+
+    if (mBatchSrnModels.empty())
+    {
+        return;
+    }
+
+    if (mUseSinglePrecision)
+    {
+        AdvanceBatch(mSinglePrecisionBatchOdeSystem, mSinglePrecisionBatchSolver, p_kinetic_parameters, start_time, current_time, dt);
+    }
+    else
+    {
+        AdvanceBatch(mBatchOdeSystem, mBatchSolver, p_kinetic_parameters, start_time, current_time, dt);
+    }
+}
+
+template<unsigned DIM>
+template<typename REAL>
+void MyDeltaNotchTrackingModifier<DIM>::AdvanceBatch(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rBatchOdeSystem,
+                                                     MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>& rBatchSolver,
+                                                     boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters,
+                                                     double startTime,
+                                                     double endTime,
+                                                     double dt)
+{
+    // Gather the state variables and inputs of each cell into the batch
+    const unsigned num_cells = mBatchSrnModels.size();
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystemWithPrecision<REAL>::NUM_STATE_VARIABLES;
+    rBatchOdeSystem.Resize(num_cells);
+    rBatchOdeSystem.SetKineticParameters(pKineticParameters);
+    std::vector<REAL>& r_batch_state = rBatchOdeSystem.rGetStateVariables();
+    std::vector<REAL>& r_mean_delta = rBatchOdeSystem.rGetMeanDelta();
+    std::vector<REAL>& r_x_distance = rBatchOdeSystem.rGetXDistance();
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        MyDeltaNotchSrnModel* p_model = mBatchSrnModels[cell_index];
+        const std::vector<double>& r_state = p_model->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_batch_state[var*num_cells + cell_index] = r_state[var];
+        }
+        r_mean_delta[cell_index] = p_model->GetMeanNeighbouringDelta();
+        r_x_distance[cell_index] = p_model->GetXDistance();
+    }
+
+    // Advance the whole tissue together
+    {
+        MY_DELTA_NOTCH_TIME_PHASE(SRN_INTEGRATION);
+        rBatchSolver.Solve(rBatchOdeSystem, startTime, endTime, dt);
+    }
+
+    // Scatter the results back to each cell
+    for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+    {
+        MyDeltaNotchSrnModel* p_model = mBatchSrnModels[cell_index];
+        std::vector<double>& r_state = p_model->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_state[var] = r_batch_state[var*num_cells + cell_index];
+        }
+        p_model->SetSimulatedToTime(endTime);
+        p_model->UpdateQuiescence(endTime);
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SimulateSrnModelsImplicitly(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    const double current_time = SimulationTime::Instance()->GetTime();
+
+    // The SRN models were collected in row order by UpdateCellData(), so the cells of the batch are the rows of the neighbour graph
+    const unsigned num_cells = mSrnModels.size();
+    if (num_cells == 0)
+    {
+        return;
+    }
+    const double start_time = mSrnModels[0]->GetSimulatedToTime();
+    boost::shared_ptr<MyDeltaNotchParameters> p_kinetic_parameters = mSrnModels[0]->GetKineticParameters();
+    for (unsigned row=1; row<num_cells; row++)
+    {
+        if ((mSrnModels[row]->GetSimulatedToTime() != start_time)
+            || (mSrnModels[row]->GetKineticParameters() != p_kinetic_parameters))
+        {
+            EXCEPTION("To advance the tissue implicitly, every MyDeltaNotchSrnModel must have the same kinetic parameters and simulated-to time.");
+        }
+    }
+    if (start_time >= current_time)
+    {
+        return;
+    }
+
+    // Gather the state variables and x distance of each cell into the batch; the mean Delta levels are computed by the solver
+    const unsigned num_variables = MyDeltaNotchBatchOdeSystem::NUM_STATE_VARIABLES;
+    mBatchOdeSystem.Resize(num_cells);
+    mBatchOdeSystem.SetKineticParameters(p_kinetic_parameters);
+    std::vector<double>& r_batch_state = mBatchOdeSystem.rGetStateVariables();
+    std::vector<double>& r_x_distance = mBatchOdeSystem.rGetXDistance();
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        const std::vector<double>& r_state = mSrnModels[row]->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_batch_state[var*num_cells + row] = r_state[var];
+        }
+        r_x_distance[row] = mSrnModels[row]->GetXDistance();
+    }
+
+    // Advance the whole tissue together, with the coupling through the neighbour graph treated implicitly
+    {
+        MY_DELTA_NOTCH_TIME_PHASE(SRN_INTEGRATION);
+        mImplicitSolver.SetNeighbourGraph(&mNeighbourGraph);
+        mImplicitSolver.Solve(mBatchOdeSystem, start_time, current_time, mImplicitTimestep);
+        mImplicitSolver.SetNeighbourGraph(nullptr);
+    }
+
+    // Scatter the results back to each cell
+    for (unsigned row=0; row<num_cells; row++)
+    {
+        MyDeltaNotchSrnModel* p_model = mSrnModels[row];
+        std::vector<double>& r_state = p_model->rGetStateVariables();
+        for (unsigned var=0; var<num_variables; var++)
+        {
+            r_state[var] = r_batch_state[var*num_cells + row];
+        }
+        p_model->SetSimulatedToTime(current_time);
+        p_model->UpdateQuiescence(current_time);
+    }
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SimulateSrnModelsInParallel(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    // The SRN models were collected in row order by UpdateCellData()
+    const int num_threads = ResolveMyDeltaNotchNumThreads(mNumThreads);
+    CreateThreadOdeSolvers(num_threads);
+    AdvanceSrnModels(SimulationTime::Instance()->GetTime(), num_threads);
+}
 
-        // Compute this cell's average neighbouring Delta concentration and store in CellData
-        if (!neighbour_indices.empty())
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SimulateSrnModelsMultiRate(AbstractCellPopulation<DIM,DIM>& rCellPopulation)
+{
+    const double current_time = SimulationTime::Instance()->GetTime();
+    const double tolerance = 1e-10*mSignallingTimestep;
+    const int num_threads = ResolveMyDeltaNotchNumThreads(mNumThreads);
+    const int num_cells = mSrnModels.size();
+    CreateThreadOdeSolvers(num_threads);
+
+    /*
+     * Advance every cell together from the time reached by the SRN models (found by UpdateCellData()) to
+     * the current time, in stages that end at each time at which the neighbour coupling is due to be
+     * refreshed. The geometry of the tissue, and hence the neighbour graph and x distances, stays fixed.
+     */
+    double time = mSignallingTime;
+    while (time < current_time - tolerance)
+    {
+        if (time >= mNextCouplingRefreshTime - tolerance)
         {
-            double mean_delta = 0.0;
-            for (std::set<unsigned>::iterator iter = neighbour_indices.begin();
-                 iter != neighbour_indices.end();
-                 ++iter)
+            // Refresh the coupling from the current Delta levels, unless that has just been done by UpdateCellData()
+            if (time > mLastCouplingRefreshTime + tolerance)
+            {
+                #pragma omp parallel for schedule(static) num_threads(num_threads) if(num_threads > 1)
+                for (int row=0; row<num_cells; row++)
+                {
+                    mDelta[row] = mSrnModels[row]->GetDelta();
+                }
+                UpdateCoupling(time);
+            }
+            while (mNextCouplingRefreshTime <= time + tolerance)
             {
-                CellPtr p_cell = rCellPopulation.GetCellUsingLocationIndex(*iter);
-                double this_delta = p_cell->GetCellData()->GetItem("delta");
-                mean_delta += this_delta/neighbour_indices.size();
+                mNextCouplingRefreshTime += mSignallingTimestep;
             }
-            cell_iter->GetCellData()->SetItem("mean delta", mean_delta);
         }
-        else
+
+        double next_time = std::min(current_time, mNextCouplingRefreshTime);
+        if (next_time > current_time - tolerance)
         {
-            // If this cell has no neighbours, such as an isolated cell in a CaBasedCellPopulation, store 0.0 for the cell data
-            cell_iter->GetCellData()->SetItem("mean delta", 0.0);
+            next_time = current_time;
         }
+        AdvanceSrnModels(next_time, num_threads);
+        time = next_time;
     }
 }
 
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetImplicitTimestep(double implicitTimestep)
+{
+    if (implicitTimestep < 0.0)
+    {
+        EXCEPTION("The implicit timestep must be non-negative.");
+    }
+    mImplicitTimestep = implicitTimestep;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchTrackingModifier<DIM>::GetImplicitTimestep() const
+{
+    return mImplicitTimestep;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetUseBatchIntegration(bool useBatchIntegration)
+{
+    mUseBatchIntegration = useBatchIntegration;
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchTrackingModifier<DIM>::GetUseBatchIntegration() const
+{
+    return mUseBatchIntegration;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetUseSinglePrecision(bool useSinglePrecision)
+{
+    mUseSinglePrecision = useSinglePrecision;
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchTrackingModifier<DIM>::GetUseSinglePrecision() const
+{
+    return mUseSinglePrecision;
+}
+
+template<unsigned DIM>
+MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver& MyDeltaNotchTrackingModifier<DIM>::rGetSinglePrecisionBatchSolver()
+{
+    return mSinglePrecisionBatchSolver;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetUseParallelIntegration(bool useParallelIntegration)
+{
+    mUseParallelIntegration = useParallelIntegration;
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchTrackingModifier<DIM>::GetUseParallelIntegration() const
+{
+    return mUseParallelIntegration;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetSignallingTimestep(double signallingTimestep)
+{
+    if (signallingTimestep < 0.0)
+    {
+        EXCEPTION("The signalling timestep must be non-negative.");
+    }
+    mSignallingTimestep = signallingTimestep;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchTrackingModifier<DIM>::GetSignallingTimestep() const
+{
+    return mSignallingTimestep;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetInterpolateCoupling(bool interpolateCoupling)
+{
+    mInterpolateCoupling = interpolateCoupling;
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchTrackingModifier<DIM>::GetInterpolateCoupling() const
+{
+    return mInterpolateCoupling;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetExportToCellData(bool exportToCellData)
+{
+    mExportToCellData = exportToCellData;
+}
+
+template<unsigned DIM>
+bool MyDeltaNotchTrackingModifier<DIM>::GetExportToCellData() const
+{
+    return mExportToCellData;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetNumThreads(unsigned numThreads)
+{
+    mNumThreads = numThreads;
+}
+
+template<unsigned DIM>
+unsigned MyDeltaNotchTrackingModifier<DIM>::GetNumThreads() const
+{
+    return mNumThreads;
+}
+
+template<unsigned DIM>
+void MyDeltaNotchTrackingModifier<DIM>::SetXDistanceTolerance(double xDistanceTolerance)
+{
+    if (xDistanceTolerance < 0.0)
+    {
+        EXCEPTION("The x distance tolerance must be non-negative.");
+    }
+    mXDistanceTolerance = xDistanceTolerance;
+}
+
+template<unsigned DIM>
+double MyDeltaNotchTrackingModifier<DIM>::GetXDistanceTolerance() const
+{
+    return mXDistanceTolerance;
+}
+
+template<unsigned DIM>
+c_vector<double,DIM> MyDeltaNotchTrackingModifier<DIM>::GetCentroidOfCellPopulation() const
+{
+    c_vector<double,DIM> centroid = mLocationSum;
+    if (!mCellLocations.empty())
+    {
+        centroid /= mCellLocations.size();
+    }
+    return centroid;
+}
+
+template<unsigned DIM>
+unsigned MyDeltaNotchTrackingModifier<DIM>::GetNumQuiescentCells() const
+{
+    return mNumQuiescentCells;
+}
+
+template<unsigned DIM>
+unsigned MyDeltaNotchTrackingModifier<DIM>::GetNumActiveCells() const
+{
+    return mSrnModels.size() - mNumQuiescentCells;
+}
+
+template<unsigned DIM>
+boost::shared_ptr<MyDeltaNotchStateStore> MyDeltaNotchTrackingModifier<DIM>::GetStateStore() const
+{
+    return mpStateStore;
+}
+
+template<unsigned DIM>
+const MyDeltaNotchNeighbourGraph& MyDeltaNotchTrackingModifier<DIM>::rGetNeighbourGraph() const
+{
+    return mNeighbourGraph;
+}
+
 template<unsigned DIM>
 void MyDeltaNotchTrackingModifier<DIM>::OutputSimulationModifierParameters(out_stream& rParamsFile)
 {
-    // No parameters to output, so just call method on direct parent class
+    *rParamsFile << "\t\t\t<UseBatchIntegration>" << mUseBatchIntegration << "</UseBatchIntegration>\n";
+    *rParamsFile << "\t\t\t<UseSinglePrecision>" << mUseSinglePrecision << "</UseSinglePrecision>\n";
+    *rParamsFile << "\t\t\t<UseParallelIntegration>" << mUseParallelIntegration << "</UseParallelIntegration>\n";
+    *rParamsFile << "\t\t\t<ExportToCellData>" << mExportToCellData << "</ExportToCellData>\n";
+    *rParamsFile << "\t\t\t<NumThreads>" << mNumThreads << "</NumThreads>\n";
+    *rParamsFile << "\t\t\t<SignallingTimestep>" << mSignallingTimestep << "</SignallingTimestep>\n";
+    *rParamsFile << "\t\t\t<InterpolateCoupling>" << mInterpolateCoupling << "</InterpolateCoupling>\n";
+    *rParamsFile << "\t\t\t<XDistanceTolerance>" << mXDistanceTolerance << "</XDistanceTolerance>\n";
+    *rParamsFile << "\t\t\t<ImplicitTimestep>" << mImplicitTimestep << "</ImplicitTimestep>\n";
+
+    // Next, call method on direct parent class
     AbstractCellBasedSimulationModifier<DIM>::OutputSimulationModifierParameters(rParamsFile);
 }
 
@@ -38,13 +38,26 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "ChasteSerialization.hpp"
 #include <boost/serialization/base_object.hpp>
+#include <map>
 
 #include "AbstractCellBasedSimulationModifier.hpp"
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "MyDeltaNotchStateStore.hpp"
+#include "AbstractCellCycleModelOdeSolver.hpp"
+
+class MyDeltaNotchSrnModel;
 
 /**
  * A modifier class in which the mean levels of Delta in neighbouring cells
- * are computed and stored in CellData. To be used in conjunction with Delta
- * Notch cell cycle models.
+ * are computed and passed to each cell's MyDeltaNotchSrnModel through a shared
+ * MyDeltaNotchStateStore. To be used in conjunction with Delta Notch cell cycle models.
+ *
+ * The Delta and Notch levels, mean neighbouring Delta and x distance of each cell
+ * are only written to its CellData if SetExportToCellData() is called; otherwise
+ * they may be output with MyDeltaNotchStateWriter.
  */
 template<unsigned DIM>
 class MyDeltaNotchTrackingModifier : public AbstractCellBasedSimulationModifier<DIM,DIM>
@@ -55,6 +68,9 @@ class MyDeltaNotchTrackingModifier : public AbstractCellBasedSimulationModifier<
      * Boost Serialization method for archiving/checkpointing.
      * Archives the object and its member variables.
      *
+     * Version 0 archives held only the base class; when loading one of these, the
+     * member variables below keep their default values.
+     *
      * @param archive  The boost archive.
      * @param version  The current version of this class.
      */
@@ -62,8 +78,173 @@ class MyDeltaNotchTrackingModifier : public AbstractCellBasedSimulationModifier<
     void serialize(Archive & archive, const unsigned int version)
     {
         archive & boost::serialization::base_object<AbstractCellBasedSimulationModifier<DIM,DIM> >(*this);
+        if (version > 0)
+        {
+            archive & mUseBatchIntegration;
+            archive & mUseParallelIntegration;
+            archive & mExportToCellData;
+            archive & mNumThreads;
+            archive & mSignallingTimestep;
+            archive & mInterpolateCoupling;
+            archive & mXDistanceTolerance;
+            archive & mImplicitTimestep;
+            archive & mUseSinglePrecision;
+        }
     }
 
+    /**
+     * Whether to integrate all cells' Delta-Notch ODEs together at the end of each
+     * timestep, rather than leaving each MyDeltaNotchSrnModel to integrate itself.
+     * Defaults to false.
+     */
+    bool mUseBatchIntegration;
+
+    /**
+     * Whether batch integration stores the cells' state and evaluates their RHS in single precision,
+     * halving the memory traffic of the batch. Defaults to false.
+     */
+    bool mUseSinglePrecision;
+
+    /**
+     * Whether to advance every cell's MyDeltaNotchSrnModel at the end of each timestep, sharing
+     * the cells between mNumThreads OpenMP threads. Ignored if mUseBatchIntegration is true.
+     * Defaults to false.
+     */
+    bool mUseParallelIntegration;
+
+    /**
+     * Whether to also write each cell's Delta-Notch state and inputs to its CellData,
+     * for compatibility with CellData-based output and analysis. Defaults to false.
+     */
+    bool mExportToCellData;
+
+    /**
+     * The number of OpenMP threads among which UpdateCellData() and SimulateSrnModelsInParallel() share the cells,
+     * or 0 for the OpenMP default (set by OMP_NUM_THREADS). Defaults to 0.
+     */
+    unsigned mNumThreads;
+
+    /**
+     * The interval at which the mean neighbouring Delta of each cell is recomputed, independently of
+     * the simulation timestep, or 0 to recompute it once per simulation timestep. Defaults to 0.
+     */
+    double mSignallingTimestep;
+
+    /**
+     * Whether to extrapolate each cell's mean neighbouring Delta linearly between refreshes, when
+     * mSignallingTimestep is set, rather than holding it constant. Defaults to true.
+     */
+    bool mInterpolateCoupling;
+
+    /**
+     * The timestep with which the modifier advances the whole tissue as one coupled implicit system
+     * at the end of each timestep, or 0 (the default) not to. See SimulateSrnModelsImplicitly().
+     */
+    double mImplicitTimestep;
+
+    /** The earliest time to which any SRN model had been simulated, as of the last call to UpdateCellData(). */
+    double mSignallingTime;
+
+    /** The next time at which the coupling is due to be refreshed, when mSignallingTimestep is set. */
+    double mNextCouplingRefreshTime;
+
+    /** The time at which the coupling was last refreshed. */
+    double mLastCouplingRefreshTime;
+
+    /** The number of times mNeighbourGraph had been rebuilt when the coupling was last refreshed. */
+    unsigned mCouplingGraphRebuilds;
+
+    /** The number of cells whose SRN model was quiescent, as of the last call to UpdateCellData(). */
+    unsigned mNumQuiescentCells;
+
+    /**
+     * The distance that a cell, or the centroid of the population, must move along the x axis before
+     * the cells' x distances are recomputed. Defaults to 0.
+     */
+    double mXDistanceTolerance;
+
+    /** The location of each cell, in the row order of mNeighbourGraph, as of the last call to UpdateCellData(). */
+    std::vector<c_vector<double,DIM> > mCellLocations;
+
+    /** Workspace for the new location of each cell during UpdateCellData(). */
+    std::vector<c_vector<double,DIM> > mNewCellLocations;
+
+    /** The sum of mCellLocations, in row order. */
+    c_vector<double,DIM> mLocationSum;
+
+    /** The x coordinate of each cell when its x distance was last computed, in the row order of mNeighbourGraph. */
+    std::vector<double> mXDistanceReferenceX;
+
+    /** The x coordinate of the centroid of the population when the x distances were last computed. */
+    double mXDistanceReferenceCentroidX;
+
+    /** The number of times mNeighbourGraph had been rebuilt when mCellLocations was last filled. */
+    unsigned mLocationGraphRebuilds;
+
+    /** The inputs to each cell's SRN model, shared with the SRN models. */
+    boost::shared_ptr<MyDeltaNotchStateStore> mpStateStore;
+
+    /** The structure-of-arrays store used when mUseBatchIntegration is true. */
+    MyDeltaNotchBatchOdeSystem mBatchOdeSystem;
+
+    /** The solver used to advance mBatchOdeSystem. */
+    MyDeltaNotchBatchRungeKutta4Solver mBatchSolver;
+
+    /** The structure-of-arrays store used instead of mBatchOdeSystem when mUseSinglePrecision is true. */
+    MyDeltaNotchSinglePrecisionBatchOdeSystem mSinglePrecisionBatchOdeSystem;
+
+    /** The solver used to advance mSinglePrecisionBatchOdeSystem. */
+    MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver mSinglePrecisionBatchSolver;
+
+    /** The solver used to advance mBatchOdeSystem when mImplicitTimestep is set. */
+    MyDeltaNotchBatchBdfSolver mImplicitSolver;
+
+    /** The SRN models whose state is held in mBatchOdeSystem (or mSinglePrecisionBatchOdeSystem), in batch order. */
+    std::vector<MyDeltaNotchSrnModel*> mBatchSrnModels;
+
+    /**
+     * The SRN model of each cell, in the row order of mNeighbourGraph, as of the last call to UpdateCellData().
+     * Only valid until the population next changes.
+     */
+    std::vector<MyDeltaNotchSrnModel*> mSrnModels;
+
+    /**
+     * For each OpenMP thread, that thread's own copy of each shared solver used by the SRN models,
+     * created by MyDeltaNotchSrnModel::CreateUnsharedOdeSolver().
+     */
+    std::vector<std::map<const AbstractCellCycleModelOdeSolver*, boost::shared_ptr<AbstractIvpOdeSolver> > > mThreadOdeSolvers;
+
+    /** The neighbour relation of the population, rebuilt only when its topology changes. */
+    MyDeltaNotchNeighbourGraph mNeighbourGraph;
+
+    /** The cells of the population, in the row order of mNeighbourGraph; only filled during UpdateCellData(). */
+    std::vector<CellPtr> mCells;
+
+    /** The level of Delta in each cell, in the row order of mNeighbourGraph. */
+    std::vector<double> mDelta;
+
+    /** The mean level of Delta in each cell's neighbours, in the row order of mNeighbourGraph. */
+    std::vector<double> mMeanDelta;
+
+    /**
+     * Helper method for SimulateSrnModelsInBatch(): gather the state and inputs of the SRN models in
+     * mBatchSrnModels into a batch, advance it, and scatter the results back to the SRN models.
+     *
+     * @param rBatchOdeSystem the batch, of either precision
+     * @param rBatchSolver the solver for the batch
+     * @param pKineticParameters the kinetic parameters shared by the SRN models
+     * @param startTime the time to which the SRN models have been simulated
+     * @param endTime the time to advance them to
+     * @param dt the SRN models' ODE timestep
+     */
+    template<typename REAL>
+    void AdvanceBatch(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rBatchOdeSystem,
+                      MyDeltaNotchBatchRungeKutta4SolverWithPrecision<REAL>& rBatchSolver,
+                      boost::shared_ptr<MyDeltaNotchParameters> pKineticParameters,
+                      double startTime,
+                      double endTime,
+                      double dt);
+
 public:
 
     /**
@@ -96,16 +277,269 @@ public:
     virtual void SetupSolve(AbstractCellPopulation<DIM,DIM>& rCellPopulation, std::string outputDirectory);
 
     /**
-     * Helper method to compute the mean level of Delta in each cell's neighbours and store these in the CellData.
+     * Helper method to compute the mean level of Delta in each cell's neighbours and each cell's x distance,
+     * and store these in the state store (and in the CellData, if exporting to CellData).
      *
      * Note: If using a CaBasedCellPopulation, we assume a Moore neighbourhood and unit carrying capacity.
      * If a cell has no neighbours (such as an isolated cell in a CaBasedCellPopulation), we store the
-     * value -1 in the CellData.
+     * value 0 in the CellData.
+     *
+     * The neighbours are taken from a cached MyDeltaNotchNeighbourGraph, which is only rebuilt when the
+     * topology of the population changes. The centroid of the population is found from the cell
+     * locations gathered for this step, without asking the population for them again, and each cell's
+     * x distance is only recomputed if it or the centroid has moved by more than the x distance
+     * tolerance. With a tolerance of 0 the x distances are exactly those given by the population's
+     * own centroid.
+     *
+     * The cells are shared between mNumThreads OpenMP threads in two phases: each cell's Delta level and
+     * x distance are recovered, and then the neighbour means are computed once all of these are known.
+     * The mean Delta of each cell is bit-identical for any number of threads.
      *
      * @param rCellPopulation reference to the cell population
      */
     void UpdateCellData(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
 
+    /**
+     * Helper method to advance every cell's Delta-Notch ODE system to the current time in a single
+     * batched pass, using the mean Delta values and x distances just stored in the state store by
+     * UpdateCellData(), which each SRN model reads with UpdateDeltaNotch().
+     *
+     * Each SRN model is marked as simulated to the current time, so that its own call to
+     * SimulateToCurrentTime() during the next timestep does no further work. Any cell whose SRN model
+     * is not at the same time or ODE timestep as the others (which should not normally happen) is
+     * left to integrate itself as usual.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SimulateSrnModelsInBatch(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to compute each cell's mean neighbouring Delta from mDelta and store it, together
+     * with the rate at which it is extrapolated if mSignallingTimestep is set, in the state store (and
+     * in the CellData, if exporting to CellData).
+     *
+     * @param time the time at which the Delta levels in mDelta were reached
+     */
+    void UpdateCoupling(double time);
+
+    /**
+     * Helper method to make sure that each thread has its own copy of the shared solver of each SRN model.
+     *
+     * @param numThreads the number of threads
+     */
+    void CreateThreadOdeSolvers(int numThreads);
+
+    /**
+     * Helper method to advance every SRN model in mSrnModels to the given time, sharing the cells
+     * between OpenMP threads.
+     *
+     * @param time the time to advance to
+     * @param numThreads the number of threads
+     */
+    void AdvanceSrnModels(double time, int numThreads);
+
+    /**
+     * Helper method to advance every cell's MyDeltaNotchSrnModel to the current time, sharing the cells
+     * between OpenMP threads. Each thread uses its own solver of the same type as the shared solver of
+     * each SRN model, and threads that finish early take cells from those remaining.
+     *
+     * As with SimulateSrnModelsInBatch(), each SRN model is marked as simulated to the current time, so
+     * its own call to SimulateToCurrentTime() during the next timestep does no further work.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SimulateSrnModelsInParallel(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to advance every cell's MyDeltaNotchSrnModel to the current time in stages of
+     * length mSignallingTimestep, refreshing the neighbour coupling at the start of each stage. The
+     * stages are not tied to the simulation timestep: there may be several within a timestep, or one
+     * may span several timesteps. Between refreshes, each cell's mean neighbouring Delta is
+     * extrapolated linearly from its last two values, unless SetInterpolateCoupling(false) is called.
+     *
+     * The cells are shared between OpenMP threads as in SimulateSrnModelsInParallel().
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SimulateSrnModelsMultiRate(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Helper method to advance every cell's MyDeltaNotchSrnModel to the current time as a single coupled
+     * system, with MyDeltaNotchBatchBdfSolver and steps of mImplicitTimestep.
+     *
+     * Elsewhere, each cell's mean neighbouring Delta is held fixed while its SRN model is advanced, which
+     * lags the coupling between cells by up to a timestep and so limits the timestep for stability. Here
+     * the mean is instead recomputed from the neighbours' current Delta levels wherever the RHS is
+     * evaluated, and the coupling is included in the Jacobian of the implicit solve, so there is no
+     * splitting error and the timestep is limited only by accuracy. The neighbour relation is that found
+     * by UpdateCellData(), and is held fixed over the timestep.
+     *
+     * Every SRN model must have the same kinetic parameters and simulated-to time. Quiescent cells are
+     * advanced along with the others. As with SimulateSrnModelsInBatch(), each SRN model is marked as
+     * simulated to the current time, so its own call to SimulateToCurrentTime() does no further work.
+     *
+     * @param rCellPopulation reference to the cell population
+     */
+    void SimulateSrnModelsImplicitly(AbstractCellPopulation<DIM,DIM>& rCellPopulation);
+
+    /**
+     * Set whether to integrate all cells' Delta-Notch ODEs together at the end of each timestep.
+     *
+     * @param useBatchIntegration whether to use batch integration
+     */
+    void SetUseBatchIntegration(bool useBatchIntegration);
+
+    /**
+     * @return whether all cells' Delta-Notch ODEs are integrated together at the end of each timestep.
+     */
+    bool GetUseBatchIntegration() const;
+
+    /**
+     * Set whether batch integration (see SetUseBatchIntegration()) works in single precision. This
+     * halves the memory used by the batch and doubles the number of cells whose RHS is evaluated per
+     * SIMD instruction, but each cell's state is rounded to about 7 significant figures every timestep.
+     * The loss of accuracy can be monitored with the precision check of rGetSinglePrecisionBatchSolver().
+     * The SRN models themselves still hold their state in double precision.
+     *
+     * @param useSinglePrecision whether to use single precision
+     */
+    void SetUseSinglePrecision(bool useSinglePrecision);
+
+    /**
+     * @return whether batch integration works in single precision.
+     */
+    bool GetUseSinglePrecision() const;
+
+    /**
+     * @return the solver used for batch integration in single precision, so that its precision check
+     *     may be set and its results read (see MyDeltaNotchBatchRungeKutta4SolverWithPrecision::SetPrecisionCheck()).
+     */
+    MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver& rGetSinglePrecisionBatchSolver();
+
+    /**
+     * Set whether to advance every cell's SRN model in parallel at the end of each timestep.
+     * If batch integration is also used, it takes precedence.
+     *
+     * @param useParallelIntegration whether to use parallel integration
+     */
+    void SetUseParallelIntegration(bool useParallelIntegration);
+
+    /**
+     * @return whether every cell's SRN model is advanced in parallel at the end of each timestep.
+     */
+    bool GetUseParallelIntegration() const;
+
+    /**
+     * Set the interval at which each cell's mean neighbouring Delta is recomputed. If this is
+     * positive, the modifier advances every cell's signalling itself at the end of each timestep
+     * (see SimulateSrnModelsMultiRate()), taking precedence over batch or parallel integration.
+     * Each SRN model's own ODE timestep (set with SetDt()) still limits the steps of its solver.
+     *
+     * @param signallingTimestep the interval, or 0 to recompute the mean once per simulation timestep
+     */
+    void SetSignallingTimestep(double signallingTimestep);
+
+    /**
+     * @return the interval at which each cell's mean neighbouring Delta is recomputed (0 if once per timestep).
+     */
+    double GetSignallingTimestep() const;
+
+    /**
+     * Set the timestep with which to advance the whole tissue as one coupled implicit system at the end
+     * of each timestep (see SimulateSrnModelsImplicitly()). If this is positive, it takes precedence over
+     * a signalling timestep and over batch or parallel integration, and the SRN models' own ODE timesteps
+     * are not used.
+     *
+     * @param implicitTimestep the timestep, or 0 (the default) not to solve the tissue implicitly
+     */
+    void SetImplicitTimestep(double implicitTimestep);
+
+    /**
+     * @return the timestep with which the tissue is advanced as one coupled implicit system, or 0 if it is not.
+     */
+    double GetImplicitTimestep() const;
+
+    /**
+     * Set whether to extrapolate each cell's mean neighbouring Delta linearly between refreshes
+     * when a signalling timestep is set, rather than holding it constant.
+     *
+     * @param interpolateCoupling whether to extrapolate
+     */
+    void SetInterpolateCoupling(bool interpolateCoupling);
+
+    /**
+     * @return whether each cell's mean neighbouring Delta is extrapolated linearly between refreshes.
+     */
+    bool GetInterpolateCoupling() const;
+
+    /**
+     * Set whether to also write each cell's Delta-Notch state and inputs to its CellData every timestep,
+     * as the items "cell surface notch", "sudx dependent notch", "dx dependent early endosome notch",
+     * "dx dependent late endosome notch", "notch intracellular domain", "total notch", "delta",
+     * "mean delta", "x distance" and "quiescent" (1 if the SRN model is quiescent and 0 otherwise).
+     *
+     * @param exportToCellData whether to export to CellData
+     */
+    void SetExportToCellData(bool exportToCellData);
+
+    /**
+     * @return whether each cell's Delta-Notch state and inputs are also written to its CellData.
+     */
+    bool GetExportToCellData() const;
+
+    /**
+     * Set the number of OpenMP threads among which UpdateCellData() shares the cells.
+     * This has no effect unless the project is compiled with OpenMP.
+     *
+     * @param numThreads the number of threads, or 0 for the OpenMP default
+     */
+    void SetNumThreads(unsigned numThreads);
+
+    /**
+     * @return the number of OpenMP threads among which UpdateCellData() shares the cells (0 for the OpenMP default).
+     */
+    unsigned GetNumThreads() const;
+
+    /**
+     * Set the distance that a cell, or the centroid of the population, must move along the x axis before
+     * the cells' x distances are recomputed. A positive tolerance stops small movements of the tissue
+     * from waking quiescent cells (see MyDeltaNotchSrnModel::SetUseQuiescence()).
+     *
+     * @param xDistanceTolerance the tolerance (defaults to 0)
+     */
+    void SetXDistanceTolerance(double xDistanceTolerance);
+
+    /**
+     * @return the distance that a cell, or the centroid, must move before the x distances are recomputed.
+     */
+    double GetXDistanceTolerance() const;
+
+    /**
+     * @return the centroid of the cell population, as found by the last call to UpdateCellData().
+     */
+    c_vector<double,DIM> GetCentroidOfCellPopulation() const;
+
+    /**
+     * @return the number of cells whose SRN model was quiescent (see MyDeltaNotchSrnModel::SetUseQuiescence())
+     *     at the last call to UpdateCellData().
+     */
+    unsigned GetNumQuiescentCells() const;
+
+    /**
+     * @return the number of cells whose SRN model was not quiescent at the last call to UpdateCellData().
+     */
+    unsigned GetNumActiveCells() const;
+
+    /**
+     * @return the store of each cell's SRN inputs, indexed by location index.
+     */
+    boost::shared_ptr<MyDeltaNotchStateStore> GetStateStore() const;
+
+    /**
+     * @return the cached neighbour relation of the population, as of the last call to UpdateCellData().
+     */
+    const MyDeltaNotchNeighbourGraph& rGetNeighbourGraph() const;
+
     /**
      * Overridden OutputSimulationModifierParameters() method.
      * Output any simulation modifier parameters to file.
@@ -118,4 +552,21 @@ public:
 #include "SerializationExportWrapper.hpp"
 EXPORT_TEMPLATE_CLASS_SAME_DIMS(MyDeltaNotchTrackingModifier)
 
+#include "ChasteSerializationVersion.hpp"
+namespace boost
+{
+namespace serialization
+{
+/**
+ * Specify a version number for archives of MyDeltaNotchTrackingModifier, which
+ * BOOST_CLASS_VERSION cannot do for a class template.
+ */
+template<unsigned DIM>
+struct version<MyDeltaNotchTrackingModifier<DIM> >
+{
+    CHASTE_VERSION_CONTENT(1);
+};
+} // namespace serialization
+} // namespace boost
+
 #endif /*MYDELTANOTCHTRACKINGMODIFIER_HPP_*/
@@ -0,0 +1,259 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#include "MyDormandPrinceIvpOdeSolver.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+namespace
+{
+/** The Butcher tableau of the Dormand-Prince 5(4) pair. The last row gives the fifth-order solution. */
+const double A[7][6] = {
+    {0.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+    {1.0/5.0, 0.0, 0.0, 0.0, 0.0, 0.0},
+    {3.0/40.0, 9.0/40.0, 0.0, 0.0, 0.0, 0.0},
+    {44.0/45.0, -56.0/15.0, 32.0/9.0, 0.0, 0.0, 0.0},
+    {19372.0/6561.0, -25360.0/2187.0, 64448.0/6561.0, -212.0/729.0, 0.0, 0.0},
+    {9017.0/3168.0, -355.0/33.0, 46732.0/5247.0, 49.0/176.0, -5103.0/18656.0, 0.0},
+    {35.0/384.0, 0.0, 500.0/1113.0, 125.0/192.0, -2187.0/6784.0, 11.0/84.0}};
+
+/** The times of the stages, as fractions of the step. */
+const double C[7] = {0.0, 1.0/5.0, 3.0/10.0, 4.0/5.0, 8.0/9.0, 1.0, 1.0};
+
+/** The difference between the fifth- and fourth-order weights, which gives the error estimate. */
+const double E[7] = {71.0/57600.0, 0.0, -71.0/16695.0, 71.0/1920.0, -17253.0/339200.0, 22.0/525.0, -1.0/40.0};
+
+/** Safety factor applied to the optimal step size. */
+const double SAFETY = 0.9;
+
+/** The largest factor by which the step size may shrink after one step. */
+const double MIN_FACTOR = 0.2;
+
+/** The largest factor by which the step size may grow after one step. */
+const double MAX_FACTOR = 5.0;
+}
+
+MyDormandPrinceIvpOdeSolver::MyDormandPrinceIvpOdeSolver()
+    : AbstractIvpOdeSolver(),
+      mStages(7)
+{
+}
+
+double MyDormandPrinceIvpOdeSolver::AttemptStep(AbstractOdeSystem* pOdeSystem,
+                                                double time,
+                                                double timeStep,
+                                                const std::vector<double>& rY,
+                                                const MyAdaptiveStepState& rState)
+{
+    const unsigned size = rY.size();
+
+    for (unsigned stage=1; stage<7; stage++)
+    {
+        std::vector<double>& r_y_stage = (stage == 6) ? mYNext : mYStage;
+        for (unsigned i=0; i<size; i++)
+        {
+            double increment = 0.0;
+            for (unsigned j=0; j<stage; j++)
+            {
+                increment += A[stage][j]*mStages[j][i];
+            }
+            r_y_stage[i] = rY[i] + timeStep*increment;
+        }
+        pOdeSystem->EvaluateYDerivatives(time + C[stage]*timeStep, r_y_stage, mStages[stage]);
+    }
+
+    // Estimate the error from the difference between the embedded solutions
+    double sum_squares = 0.0;
+    for (unsigned i=0; i<size; i++)
+    {
+        double error = 0.0;
+        for (unsigned stage=0; stage<7; stage++)
+        {
+            error += E[stage]*mStages[stage][i];
+        }
+        error *= timeStep;
+        double scale = rState.GetAbsoluteTolerance() + rState.GetRelativeTolerance()*std::max(fabs(rY[i]), fabs(mYNext[i]));
+        sum_squares += (error/scale)*(error/scale);
+    }
+    return sqrt(sum_squares/size);
+}
+
+double MyDormandPrinceIvpOdeSolver::ChooseInitialStepSize(const std::vector<double>& rY,
+                                                          const std::vector<double>& rDY,
+                                                          const MyAdaptiveStepState& rState) const
+{
+    const unsigned size = rY.size();
+    double y_norm = 0.0;
+    double dy_norm = 0.0;
+    for (unsigned i=0; i<size; i++)
+    {
+        double scale = rState.GetAbsoluteTolerance() + rState.GetRelativeTolerance()*fabs(rY[i]);
+        y_norm += (rY[i]/scale)*(rY[i]/scale);
+        dy_norm += (rDY[i]/scale)*(rDY[i]/scale);
+    }
+    y_norm = sqrt(y_norm/size);
+    dy_norm = sqrt(dy_norm/size);
+
+    if (y_norm < 1e-5 || dy_norm < 1e-5)
+    {
+        return 1e-6;
+    }
+    return 0.01*y_norm/dy_norm;
+}
+
+void MyDormandPrinceIvpOdeSolver::InternalSolve(AbstractOdeSystem* pOdeSystem,
+                                                std::vector<double>& rYValues,
+                                                double startTime,
+                                                double endTime,
+                                                double maxTimeStep,
+                                                MyAdaptiveStepState& rState)
+{
+    const unsigned size = rYValues.size();
+    for (unsigned stage=0; stage<7; stage++)
+    {
+        mStages[stage].resize(size);
+    }
+    mYStage.resize(size);
+    mYNext.resize(size);
+
+    // The inputs to the system may have changed since the last solve, so the first stage is always recomputed
+    pOdeSystem->EvaluateYDerivatives(startTime, rYValues, mStages[0]);
+
+    double step_size = rState.GetNextStepSize();
+    if (step_size <= 0.0)
+    {
+        step_size = ChooseInitialStepSize(rYValues, mStages[0], rState);
+    }
+    step_size = std::min(step_size, maxTimeStep);
+
+    double time = startTime;
+    while (time < endTime)
+    {
+        // Shorten the step if need be to finish exactly at endTime
+        bool is_last_step = (time + step_size >= endTime);
+        double this_step = is_last_step ? endTime - time : step_size;
+        if (this_step < 1e-14*std::max(1.0, fabs(time)))
+        {
+            EXCEPTION("The Dormand-Prince step size fell below the limit of machine precision at time " << time << ".");
+        }
+
+        double error_norm = AttemptStep(pOdeSystem, time, this_step, rYValues, rState);
+        double factor = (error_norm == 0.0) ? MAX_FACTOR : SAFETY*pow(error_norm, -0.2);
+        factor = std::min(MAX_FACTOR, std::max(MIN_FACTOR, factor));
+
+        if (error_norm <= 1.0)
+        {
+            rState.RecordAcceptedStep();
+            time = is_last_step ? endTime : time + this_step;
+            rYValues.swap(mYNext);
+            mStages[0].swap(mStages[6]);
+
+            // A step that was only shortened to hit endTime says nothing about the next step size, unless it should shrink
+            step_size = is_last_step ? std::min(step_size, this_step*factor) : this_step*factor;
+            step_size = std::min(step_size, maxTimeStep);
+
+            if (pOdeSystem->CalculateStoppingEvent(time, rYValues))
+            {
+                mStoppingTime = time;
+                mStoppingEventOccurred = true;
+                break;
+            }
+        }
+        else
+        {
+            rState.RecordRejectedStep();
+            step_size = this_step*factor;
+        }
+    }
+
+    rState.SetNextStepSize(step_size);
+}
+
+OdeSolution MyDormandPrinceIvpOdeSolver::Solve(AbstractOdeSystem* pOdeSystem,
+                                               std::vector<double>& rYValues,
+                                               double startTime,
+                                               double endTime,
+                                               double timeStep,
+                                               double timeSampling)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    MyAdaptiveStepState default_state;
+    MyAdaptiveStepStateHolder* p_holder = dynamic_cast<MyAdaptiveStepStateHolder*>(pOdeSystem);
+    MyAdaptiveStepState& r_state = p_holder ? p_holder->rGetAdaptiveStepState() : default_state;
+
+    TimeStepper stepper(startTime, endTime, timeSampling);
+    OdeSolution solutions;
+    solutions.SetNumberOfTimeSteps(stepper.EstimateTimeSteps());
+    solutions.rGetSolutions().push_back(rYValues);
+    solutions.rGetTimes().push_back(startTime);
+    solutions.SetOdeSystemInformation(pOdeSystem->GetSystemInformation());
+
+    while (!stepper.IsTimeAtEnd() && !mStoppingEventOccurred)
+    {
+        InternalSolve(pOdeSystem, rYValues, stepper.GetTime(), stepper.GetNextTime(), timeStep, r_state);
+        stepper.AdvanceOneTimeStep();
+
+        solutions.rGetSolutions().push_back(rYValues);
+        solutions.rGetTimes().push_back(mStoppingEventOccurred ? mStoppingTime : stepper.GetTime());
+    }
+    solutions.SetNumberOfTimeSteps(solutions.rGetTimes().size() - 1);
+    return solutions;
+}
+
+void MyDormandPrinceIvpOdeSolver::Solve(AbstractOdeSystem* pOdeSystem,
+                                        std::vector<double>& rYValues,
+                                        double startTime,
+                                        double endTime,
+                                        double timeStep)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    MyAdaptiveStepState default_state;
+    MyAdaptiveStepStateHolder* p_holder = dynamic_cast<MyAdaptiveStepStateHolder*>(pOdeSystem);
+    InternalSolve(pOdeSystem, rYValues, startTime, endTime, timeStep, p_holder ? p_holder->rGetAdaptiveStepState() : default_state);
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(MyDormandPrinceIvpOdeSolver)
@@ -0,0 +1,186 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDORMANDPRINCEIVPODESOLVER_HPP_
+#define MYDORMANDPRINCEIVPODESOLVER_HPP_
+
+#include <vector>
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractIvpOdeSolver.hpp"
+#include "MyAdaptiveStepState.hpp"
+
+/**
+ * An adaptive explicit Runge-Kutta solver using the embedded 5(4) pair of
+ * Dormand and Prince (J. Comput. Appl. Math. 6:19-26, 1980).
+ *
+ * Each step is accepted if the RMS of the embedded error estimate, scaled by
+ * absTol + relTol*|y_i|, is at most one, and the next step size is chosen from
+ * the same estimate. The timestep passed to Solve() is the largest step the
+ * solver may take; steps end exactly at the end time.
+ *
+ * If the ODE system also inherits from MyAdaptiveStepStateHolder (as MyDeltaNotchOdeSystem
+ * does), its MyAdaptiveStepState is allocated if need be, the tolerances are read from it,
+ * the step counters are updated, and the last step size is stored in it so that the next
+ * solve for the same system starts from it.
+ * Otherwise default tolerances are used and a step size is chosen afresh on each solve.
+ *
+ * To use this solver for the Delta-Notch model, pass
+ * CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyDormandPrinceIvpOdeSolver>::Instance()
+ * to the MyDeltaNotchSrnModel constructor.
+ */
+class MyDormandPrinceIvpOdeSolver : public AbstractIvpOdeSolver
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the solver. The working memory is not archived.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractIvpOdeSolver>(*this);
+    }
+
+    /** Working memory for the seven stages of the method; the last stage is reused as the first stage of the next step. */
+    std::vector<std::vector<double> > mStages;
+
+    /** Working memory for the state passed to each stage. */
+    std::vector<double> mYStage;
+
+    /** Working memory for the fifth-order solution at the end of a step. */
+    std::vector<double> mYNext;
+
+    /**
+     * Attempt a single step, filling in mYNext.
+     *
+     * On entry mStages[0] must hold the derivatives at (time, rY). If the step is
+     * accepted, mStages[6] holds the derivatives at the end of the step.
+     *
+     * @param pOdeSystem the ODE system
+     * @param time the current time
+     * @param timeStep the size of the step
+     * @param rY the current state
+     * @param rState the tolerances to scale the error estimate with
+     * @return the scaled RMS norm of the error estimate; the step is acceptable if this is at most 1
+     */
+    double AttemptStep(AbstractOdeSystem* pOdeSystem,
+                       double time,
+                       double timeStep,
+                       const std::vector<double>& rY,
+                       const MyAdaptiveStepState& rState);
+
+    /**
+     * Choose a step size for a system that has no stored step size, using the
+     * relative sizes of the state and its derivatives.
+     *
+     * @param rY the current state
+     * @param rDY the derivatives at the current state
+     * @param rState the tolerances
+     * @return a suitable first step size
+     */
+    double ChooseInitialStepSize(const std::vector<double>& rY,
+                                 const std::vector<double>& rDY,
+                                 const MyAdaptiveStepState& rState) const;
+
+    /**
+     * Advance the state from startTime to endTime with adaptive steps.
+     *
+     * @param pOdeSystem the ODE system
+     * @param rYValues the state, updated in place
+     * @param startTime the start time
+     * @param endTime the end time
+     * @param maxTimeStep the largest step that may be taken
+     * @param rState the tolerances, step size memory and counters of the system
+     */
+    void InternalSolve(AbstractOdeSystem* pOdeSystem,
+                       std::vector<double>& rYValues,
+                       double startTime,
+                       double endTime,
+                       double maxTimeStep,
+                       MyAdaptiveStepState& rState);
+
+public:
+
+    /**
+     * Constructor.
+     */
+    MyDormandPrinceIvpOdeSolver();
+
+    /**
+     * Solve the given ODE system, returning the solution at sampling intervals.
+     *
+     * @param pOdeSystem  pointer to the ODE system
+     * @param rYValues  the initial state variable values, updated to the solution at endTime
+     * @param startTime  the time to start solving at
+     * @param endTime  the time to solve to
+     * @param timeStep  the largest step the solver may take
+     * @param timeSampling  the interval at which to record the solution
+     * @return the solution
+     */
+    OdeSolution Solve(AbstractOdeSystem* pOdeSystem,
+                      std::vector<double>& rYValues,
+                      double startTime,
+                      double endTime,
+                      double timeStep,
+                      double timeSampling);
+
+    /**
+     * Solve the given ODE system, updating rYValues to the solution at endTime.
+     *
+     * @param pOdeSystem  pointer to the ODE system
+     * @param rYValues  the initial state variable values, updated to the solution at endTime
+     * @param startTime  the time to start solving at
+     * @param endTime  the time to solve to
+     * @param timeStep  the largest step the solver may take
+     */
+    void Solve(AbstractOdeSystem* pOdeSystem,
+               std::vector<double>& rYValues,
+               double startTime,
+               double endTime,
+               double timeStep);
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(MyDormandPrinceIvpOdeSolver)
+
+#endif /*MYDORMANDPRINCEIVPODESOLVER_HPP_*/
@@ -0,0 +1,72 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYFIXEDSIZEODESYSTEM_HPP_
+#define MYFIXEDSIZEODESYSTEM_HPP_
+
+#include <array>
+
+/**
+ * An interface for an ODE system with a number of state variables fixed at compile time,
+ * whose RHS can be evaluated on std::arrays rather than std::vectors.
+ *
+ * An ODE system inherits from this as well as from AbstractOdeSystem (as MyDeltaNotchOdeSystem
+ * does), so it can still be used with Chaste's solvers, SRN models, writers and archives, and
+ * MyFixedSizeRungeKutta4IvpOdeSolver finds it with a dynamic_cast. The solver can then keep its
+ * stages on the stack and unroll its loops over the state variables.
+ */
+template<unsigned SIZE>
+class MyFixedSizeOdeSystem
+{
+public:
+
+    /**
+     * Destructor.
+     */
+    virtual ~MyFixedSizeOdeSystem()
+    {
+    }
+
+    /**
+     * Compute the RHS of the ODE system, as AbstractOdeSystem::EvaluateYDerivatives() does.
+     *
+     * @param time the time at which to evaluate the RHS
+     * @param rY the state variables at which to evaluate the RHS
+     * @param rDY filled in with the derivatives of the state variables
+     */
+    virtual void EvaluateFixedSizeYDerivatives(double time, const std::array<double, SIZE>& rY, std::array<double, SIZE>& rDY)=0;
+};
+
+#endif /*MYFIXEDSIZEODESYSTEM_HPP_*/
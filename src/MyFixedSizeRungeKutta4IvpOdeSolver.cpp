@@ -0,0 +1,180 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <algorithm>
+#include <cassert>
+
+#include "MyFixedSizeRungeKutta4IvpOdeSolver.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+template<unsigned SIZE>
+MyFixedSizeOdeSystem<SIZE>& MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::rGetFixedSizeOdeSystem(AbstractOdeSystem* pOdeSystem)
+{
+    MyFixedSizeOdeSystem<SIZE>* p_fixed_size_system = dynamic_cast<MyFixedSizeOdeSystem<SIZE>*>(pOdeSystem);
+    if (p_fixed_size_system == nullptr)
+    {
+        EXCEPTION("MyFixedSizeRungeKutta4IvpOdeSolver<" << SIZE << "> can only solve ODE systems that inherit from MyFixedSizeOdeSystem<"
+                  << SIZE << ">.");
+    }
+    return *p_fixed_size_system;
+}
+
+template<unsigned SIZE>
+void MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::CopyStateVariables(const std::vector<double>& rYValues, std::array<double, SIZE>& rY)
+{
+    if (rYValues.size() != SIZE)
+    {
+        EXCEPTION("MyFixedSizeRungeKutta4IvpOdeSolver<" << SIZE << "> was given " << rYValues.size() << " state variables.");
+    }
+    std::copy(rYValues.begin(), rYValues.end(), rY.begin());
+}
+
+template<unsigned SIZE>
+void MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::CalculateNextYValue(MyFixedSizeOdeSystem<SIZE>& rOdeSystem,
+                                                                   double time,
+                                                                   double timeStep,
+                                                                   std::array<double, SIZE>& rY)
+{
+    std::array<double, SIZE> dy;
+    std::array<double, SIZE> k1;
+    std::array<double, SIZE> k2;
+    std::array<double, SIZE> k3;
+    std::array<double, SIZE> yki;
+
+    // The operations are in the same order as in RungeKutta4IvpOdeSolver
+    rOdeSystem.EvaluateFixedSizeYDerivatives(time, rY, dy);
+    for (unsigned i=0; i<SIZE; i++)
+    {
+        k1[i] = timeStep*dy[i];
+        yki[i] = rY[i] + 0.5*k1[i];
+    }
+
+    rOdeSystem.EvaluateFixedSizeYDerivatives(time + 0.5*timeStep, yki, dy);
+    for (unsigned i=0; i<SIZE; i++)
+    {
+        k2[i] = timeStep*dy[i];
+        yki[i] = rY[i] + 0.5*k2[i];
+    }
+
+    rOdeSystem.EvaluateFixedSizeYDerivatives(time + 0.5*timeStep, yki, dy);
+    for (unsigned i=0; i<SIZE; i++)
+    {
+        k3[i] = timeStep*dy[i];
+        yki[i] = rY[i] + k3[i];
+    }
+
+    rOdeSystem.EvaluateFixedSizeYDerivatives(time + timeStep, yki, dy);
+    for (unsigned i=0; i<SIZE; i++)
+    {
+        double k4 = timeStep*dy[i];
+        rY[i] = rY[i] + (k1[i] + 2*k2[i] + 2*k3[i] + k4)/6.0;
+    }
+}
+
+template<unsigned SIZE>
+void MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::InternalSolve(MyFixedSizeOdeSystem<SIZE>& rOdeSystem,
+                                                             std::array<double, SIZE>& rY,
+                                                             double startTime,
+                                                             double endTime,
+                                                             double timeStep)
+{
+    TimeStepper stepper(startTime, endTime, timeStep);
+    while (!stepper.IsTimeAtEnd())
+    {
+        CalculateNextYValue(rOdeSystem, stepper.GetTime(), stepper.GetNextTimeStep(), rY);
+        stepper.AdvanceOneTimeStep();
+    }
+}
+
+template<unsigned SIZE>
+OdeSolution MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::Solve(AbstractOdeSystem* pOdeSystem,
+                                                            std::vector<double>& rYValues,
+                                                            double startTime,
+                                                            double endTime,
+                                                            double timeStep,
+                                                            double timeSampling)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    MyFixedSizeOdeSystem<SIZE>& r_system = rGetFixedSizeOdeSystem(pOdeSystem);
+    std::array<double, SIZE> y;
+    CopyStateVariables(rYValues, y);
+
+    TimeStepper stepper(startTime, endTime, timeSampling);
+    OdeSolution solutions;
+    solutions.SetNumberOfTimeSteps(stepper.EstimateTimeSteps());
+    solutions.rGetSolutions().push_back(rYValues);
+    solutions.rGetTimes().push_back(startTime);
+    solutions.SetOdeSystemInformation(pOdeSystem->GetSystemInformation());
+
+    while (!stepper.IsTimeAtEnd())
+    {
+        InternalSolve(r_system, y, stepper.GetTime(), stepper.GetNextTime(), timeStep);
+        stepper.AdvanceOneTimeStep();
+        std::copy(y.begin(), y.end(), rYValues.begin());
+        solutions.rGetSolutions().push_back(rYValues);
+        solutions.rGetTimes().push_back(stepper.GetTime());
+    }
+    solutions.SetNumberOfTimeSteps(solutions.rGetTimes().size() - 1);
+    return solutions;
+}
+
+template<unsigned SIZE>
+void MyFixedSizeRungeKutta4IvpOdeSolver<SIZE>::Solve(AbstractOdeSystem* pOdeSystem,
+                                                     std::vector<double>& rYValues,
+                                                     double startTime,
+                                                     double endTime,
+                                                     double timeStep)
+{
+    assert(endTime > startTime);
+    assert(timeStep > 0.0);
+
+    mStoppingEventOccurred = false;
+    MyFixedSizeOdeSystem<SIZE>& r_system = rGetFixedSizeOdeSystem(pOdeSystem);
+    std::array<double, SIZE> y;
+    CopyStateVariables(rYValues, y);
+    InternalSolve(r_system, y, startTime, endTime, timeStep);
+    std::copy(y.begin(), y.end(), rYValues.begin());
+}
+
+// Explicit instantiation
+template class MyFixedSizeRungeKutta4IvpOdeSolver<6>;
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(MyFixedSizeRungeKutta4IvpOdeSolver6)
@@ -0,0 +1,163 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_
+#define MYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_
+
+#include <array>
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractIvpOdeSolver.hpp"
+#include "MyFixedSizeOdeSystem.hpp"
+
+/**
+ * The classical fourth-order Runge-Kutta method, as RungeKutta4IvpOdeSolver, for ODE systems
+ * with SIZE state variables that inherit from MyFixedSizeOdeSystem<SIZE>.
+ *
+ * The state and the stages are std::arrays on the stack, so there is no heap allocation and the
+ * loops over the state variables can be fully unrolled. The state is copied out of and back into
+ * the ODE system's std::vector once per solve rather than once per step. The arithmetic is the
+ * same as that of RungeKutta4IvpOdeSolver, so the results agree with it to rounding.
+ *
+ * Stopping events are not checked. To use this solver for the Delta-Notch model, pass
+ * CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyFixedSizeRungeKutta4IvpOdeSolver<6> >::Instance()
+ * to the MyDeltaNotchSrnModel constructor.
+ */
+template<unsigned SIZE>
+class MyFixedSizeRungeKutta4IvpOdeSolver : public AbstractIvpOdeSolver
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the solver.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractIvpOdeSolver>(*this);
+    }
+
+    /**
+     * @param pOdeSystem an ODE system
+     * @return the fixed-size interface of the ODE system.
+     */
+    static MyFixedSizeOdeSystem<SIZE>& rGetFixedSizeOdeSystem(AbstractOdeSystem* pOdeSystem);
+
+    /**
+     * Copy the state variables into a fixed-size array, checking that there are SIZE of them.
+     *
+     * @param rYValues the state variables
+     * @param rY filled in with the state variables
+     */
+    static void CopyStateVariables(const std::vector<double>& rYValues, std::array<double, SIZE>& rY);
+
+    /**
+     * Solve the ODE system from startTime to endTime in steps of at most timeStep.
+     *
+     * @param rOdeSystem the ODE system
+     * @param rY the state variables, updated to the solution at endTime
+     * @param startTime the time to start solving at
+     * @param endTime the time to solve to
+     * @param timeStep the timestep
+     */
+    static void InternalSolve(MyFixedSizeOdeSystem<SIZE>& rOdeSystem,
+                              std::array<double, SIZE>& rY,
+                              double startTime,
+                              double endTime,
+                              double timeStep);
+
+public:
+
+    /**
+     * Take a single step of the method.
+     *
+     * @param rOdeSystem the ODE system
+     * @param time the current time
+     * @param timeStep the size of the step
+     * @param rY the state variables, updated to the solution at time + timeStep
+     */
+    static void CalculateNextYValue(MyFixedSizeOdeSystem<SIZE>& rOdeSystem,
+                                    double time,
+                                    double timeStep,
+                                    std::array<double, SIZE>& rY);
+
+    /**
+     * Solve the given ODE system, recording the solution at intervals.
+     *
+     * @param pOdeSystem  pointer to the ODE system, which must inherit from MyFixedSizeOdeSystem<SIZE>
+     * @param rYValues  the initial state variable values, updated to the solution at endTime
+     * @param startTime  the time to start solving at
+     * @param endTime  the time to solve to
+     * @param timeStep  the timestep
+     * @param timeSampling  the interval at which to record the solution
+     * @return the solution
+     */
+    OdeSolution Solve(AbstractOdeSystem* pOdeSystem,
+                      std::vector<double>& rYValues,
+                      double startTime,
+                      double endTime,
+                      double timeStep,
+                      double timeSampling);
+
+    /**
+     * Solve the given ODE system, updating rYValues to the solution at endTime.
+     *
+     * @param pOdeSystem  pointer to the ODE system, which must inherit from MyFixedSizeOdeSystem<SIZE>
+     * @param rYValues  the initial state variable values, updated to the solution at endTime
+     * @param startTime  the time to start solving at
+     * @param endTime  the time to solve to
+     * @param timeStep  the timestep
+     */
+    void Solve(AbstractOdeSystem* pOdeSystem,
+               std::vector<double>& rYValues,
+               double startTime,
+               double endTime,
+               double timeStep);
+};
+
+/** The fixed-size solver for the six variables of the Delta-Notch model, named for serialization. */
+typedef MyFixedSizeRungeKutta4IvpOdeSolver<6> MyFixedSizeRungeKutta4IvpOdeSolver6;
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(MyFixedSizeRungeKutta4IvpOdeSolver6)
+
+#endif /*MYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_*/
@@ -0,0 +1,125 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#include "MyPhiloxRandomNumberGenerator.hpp"
+
+namespace
+{
+
+/** The multipliers of the Philox4x32 round function. */
+const uint32_t PHILOX_M0 = 0xD2511F53u;
+const uint32_t PHILOX_M1 = 0xCD9E8D57u;
+
+/** The Weyl sequence increments applied to the key between rounds. */
+const uint32_t PHILOX_W0 = 0x9E3779B9u;
+const uint32_t PHILOX_W1 = 0xBB67AE85u;
+
+/** The number of rounds. */
+const unsigned PHILOX_ROUNDS = 10;
+
+/**
+ * Convert two 32-bit words into a double uniformly distributed on [0,1), using 53 of their bits.
+ *
+ * @param high the first word
+ * @param low the second word
+ * @return the value
+ */
+inline double ToUniform(uint32_t high, uint32_t low)
+{
+    const uint64_t bits = ((static_cast<uint64_t>(high) << 32) | low) >> 11;
+    return bits*(1.0/9007199254740992.0); // 2^-53
+}
+
+} // anonymous namespace
+
+MyPhiloxRandomNumberGenerator::MyPhiloxRandomNumberGenerator(uint64_t seed)
+{
+    mKey[0] = static_cast<uint32_t>(seed);
+    mKey[1] = static_cast<uint32_t>(seed >> 32);
+}
+
+void MyPhiloxRandomNumberGenerator::Philox4x32(const uint32_t* pCounter, const uint32_t* pKey, uint32_t* pResult)
+{
+    uint32_t x[4] = {pCounter[0], pCounter[1], pCounter[2], pCounter[3]};
+    uint32_t key[2] = {pKey[0], pKey[1]};
+
+    for (unsigned round=0; round<PHILOX_ROUNDS; round++)
+    {
+        if (round > 0)
+        {
+            key[0] += PHILOX_W0;
+            key[1] += PHILOX_W1;
+        }
+        const uint64_t product_0 = static_cast<uint64_t>(PHILOX_M0)*x[0];
+        const uint64_t product_1 = static_cast<uint64_t>(PHILOX_M1)*x[2];
+        const uint32_t new_x[4] = {static_cast<uint32_t>(product_1 >> 32) ^ x[1] ^ key[0],
+                                   static_cast<uint32_t>(product_1),
+                                   static_cast<uint32_t>(product_0 >> 32) ^ x[3] ^ key[1],
+                                   static_cast<uint32_t>(product_0)};
+        for (unsigned i=0; i<4; i++)
+        {
+            x[i] = new_x[i];
+        }
+    }
+
+    for (unsigned i=0; i<4; i++)
+    {
+        pResult[i] = x[i];
+    }
+}
+
+void MyPhiloxRandomNumberGenerator::GetUniforms(uint64_t stream, unsigned numValues, double* pValues) const
+{
+    // Each block of the stream gives two values
+    for (unsigned block=0; 2*block<numValues; block++)
+    {
+        const uint32_t counter[4] = {block, 0u, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+        uint32_t result[4];
+        Philox4x32(counter, mKey, result);
+
+        pValues[2*block] = ToUniform(result[0], result[1]);
+        if (2*block + 1 < numValues)
+        {
+            pValues[2*block + 1] = ToUniform(result[2], result[3]);
+        }
+    }
+}
+
+double MyPhiloxRandomNumberGenerator::GetUniform(uint64_t stream, unsigned index) const
+{
+    const uint32_t counter[4] = {index/2, 0u, static_cast<uint32_t>(stream), static_cast<uint32_t>(stream >> 32)};
+    uint32_t result[4];
+    Philox4x32(counter, mKey, result);
+    return (index%2 == 0) ? ToUniform(result[0], result[1]) : ToUniform(result[2], result[3]);
+}
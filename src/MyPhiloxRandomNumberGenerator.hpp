@@ -0,0 +1,94 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef MYPHILOXRANDOMNUMBERGENERATOR_HPP_
+#define MYPHILOXRANDOMNUMBERGENERATOR_HPP_
+
+#include <stdint.h>
+
+/**
+ * A counter-based random number generator, Philox4x32-10 (Salmon et al., "Parallel random
+ * numbers: as easy as 1, 2, 3", Proceedings of SC11, 2011).
+ *
+ * Unlike RandomNumberGenerator, which produces a single sequence that must be drawn from in
+ * order, this generator has no state beyond its seed: each value is a pure function of the
+ * seed, a stream number and the position of the value within the stream. Giving each cell its
+ * own stream (for example, its index) lets the cells' random values be drawn in any order, or
+ * by any number of threads at once, with identical results.
+ */
+class MyPhiloxRandomNumberGenerator
+{
+private:
+
+    /** The key of the block cipher, taken from the seed. */
+    uint32_t mKey[2];
+
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param seed the seed (defaults to 0)
+     */
+    MyPhiloxRandomNumberGenerator(uint64_t seed=0);
+
+    /**
+     * Apply the Philox4x32-10 block cipher to a counter.
+     *
+     * @param pCounter the four words of the counter
+     * @param pKey the two words of the key
+     * @param pResult filled in with the four words of the result
+     */
+    static void Philox4x32(const uint32_t* pCounter, const uint32_t* pKey, uint32_t* pResult);
+
+    /**
+     * Draw the first values of a stream, uniformly distributed on [0,1) with 53 random bits each.
+     * Each call starts again from the beginning of the stream.
+     *
+     * @param stream the stream, for example the index of a cell
+     * @param numValues the number of values to draw
+     * @param pValues filled in with the values
+     */
+    void GetUniforms(uint64_t stream, unsigned numValues, double* pValues) const;
+
+    /**
+     * @param stream the stream, for example the index of a cell
+     * @param index the position of the value within the stream
+     * @return a single value of a stream, uniformly distributed on [0,1); the same as the
+     *     corresponding value drawn by GetUniforms().
+     */
+    double GetUniform(uint64_t stream, unsigned index) const;
+};
+
+#endif /*MYPHILOXRANDOMNUMBERGENERATOR_HPP_*/
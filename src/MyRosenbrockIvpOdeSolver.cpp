@@ -0,0 +1,175 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#include <cmath>
+
+#include "MyRosenbrockIvpOdeSolver.hpp"
+#include "AbstractOdeSystemWithAnalyticJacobian.hpp"
+#include "Exception.hpp"
+
+const double MyRosenbrockIvpOdeSolver::GAMMA = 1.0 + 1.0/sqrt(2.0);
+
+MyRosenbrockIvpOdeSolver::MyRosenbrockIvpOdeSolver()
+    : mSize(0)
+{
+}
+
+void MyRosenbrockIvpOdeSolver::ResizeWorkingMemory(unsigned size)
+{
+    if (size != mSize)
+    {
+        mSize = size;
+        mMatrixStorage.resize(size*size);
+        mMatrixRows.resize(size);
+        for (unsigned i=0; i<size; i++)
+        {
+            mMatrixRows[i] = &mMatrixStorage[i*size];
+        }
+        mPivots.resize(size);
+        mRhs.resize(size);
+        mK1.resize(size);
+        mK2.resize(size);
+        mYStage.resize(size);
+    }
+}
+
+void MyRosenbrockIvpOdeSolver::FactoriseMatrix()
+{
+    for (unsigned col=0; col<mSize; col++)
+    {
+        // Choose the largest remaining entry in this column as the pivot
+        unsigned pivot_row = col;
+        for (unsigned row=col+1; row<mSize; row++)
+        {
+            if (fabs(mMatrixRows[row][col]) > fabs(mMatrixRows[pivot_row][col]))
+            {
+                pivot_row = row;
+            }
+        }
+        if (mMatrixRows[pivot_row][col] == 0.0)
+        {
+            EXCEPTION("The Rosenbrock iteration matrix is singular; try a smaller timestep.");
+        }
+        mPivots[col] = pivot_row;
+        if (pivot_row != col)
+        {
+            for (unsigned j=0; j<mSize; j++)
+            {
+                std::swap(mMatrixRows[col][j], mMatrixRows[pivot_row][j]);
+            }
+        }
+
+        // Eliminate below the pivot, storing the multipliers in place
+        for (unsigned row=col+1; row<mSize; row++)
+        {
+            double multiplier = mMatrixRows[row][col]/mMatrixRows[col][col];
+            mMatrixRows[row][col] = multiplier;
+            for (unsigned j=col+1; j<mSize; j++)
+            {
+                mMatrixRows[row][j] -= multiplier*mMatrixRows[col][j];
+            }
+        }
+    }
+}
+
+void MyRosenbrockIvpOdeSolver::SolveFactorisedSystem(const std::vector<double>& rB, std::vector<double>& rX)
+{
+    rX = rB;
+
+    // Forward substitution with the unit lower triangle, applying the row swaps as we go
+    for (unsigned i=0; i<mSize; i++)
+    {
+        std::swap(rX[i], rX[mPivots[i]]);
+        for (unsigned j=0; j<i; j++)
+        {
+            rX[i] -= mMatrixRows[i][j]*rX[j];
+        }
+    }
+
+    // Back substitution with the upper triangle
+    for (unsigned i=mSize; i-- > 0; )
+    {
+        for (unsigned j=i+1; j<mSize; j++)
+        {
+            rX[i] -= mMatrixRows[i][j]*rX[j];
+        }
+        rX[i] /= mMatrixRows[i][i];
+    }
+}
+
+void MyRosenbrockIvpOdeSolver::CalculateNextYValue(AbstractOdeSystem* pAbstractOdeSystem,
+                                                   double timeStep,
+                                                   double time,
+                                                   std::vector<double>& rCurrentYValues,
+                                                   std::vector<double>& rNextYValues)
+{
+    if (!pAbstractOdeSystem->GetUseAnalyticJacobian())
+    {
+        EXCEPTION("MyRosenbrockIvpOdeSolver requires an ODE system with an analytic Jacobian.");
+    }
+    AbstractOdeSystemWithAnalyticJacobian* p_ode_system = static_cast<AbstractOdeSystemWithAnalyticJacobian*>(pAbstractOdeSystem);
+
+    const unsigned size = rCurrentYValues.size();
+    ResizeWorkingMemory(size);
+
+    // Form and factorise W = I - gamma*h*J, which is shared by both stages
+    p_ode_system->AnalyticJacobian(rCurrentYValues, &mMatrixRows[0], time, GAMMA*timeStep);
+    FactoriseMatrix();
+
+    // W k1 = f(t, y)
+    p_ode_system->EvaluateYDerivatives(time, rCurrentYValues, mRhs);
+    SolveFactorisedSystem(mRhs, mK1);
+
+    // W k2 = f(t + h, y + h*k1) - 2*k1
+    for (unsigned i=0; i<size; i++)
+    {
+        mYStage[i] = rCurrentYValues[i] + timeStep*mK1[i];
+    }
+    p_ode_system->EvaluateYDerivatives(time + timeStep, mYStage, mRhs);
+    for (unsigned i=0; i<size; i++)
+    {
+        mRhs[i] -= 2.0*mK1[i];
+    }
+    SolveFactorisedSystem(mRhs, mK2);
+
+    for (unsigned i=0; i<size; i++)
+    {
+        rNextYValues[i] = rCurrentYValues[i] + timeStep*(1.5*mK1[i] + 0.5*mK2[i]);
+    }
+}
+
+// Serialization for Boost >= 1.36
+#include "SerializationExportWrapperForCpp.hpp"
+CHASTE_CLASS_EXPORT(MyRosenbrockIvpOdeSolver)
@@ -0,0 +1,156 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYROSENBROCKIVPODESOLVER_HPP_
+#define MYROSENBROCKIVPODESOLVER_HPP_
+
+#include <vector>
+
+#include "ChasteSerialization.hpp"
+#include <boost/serialization/base_object.hpp>
+
+#include "AbstractOneStepIvpOdeSolver.hpp"
+#include "AbstractOdeSystem.hpp"
+
+/**
+ * A linearly implicit two-stage Rosenbrock solver (the L-stable, second-order
+ * ROS2 method of Verwer et al., SIAM J. Sci. Comput. 20:1456-1480, 1999).
+ *
+ * Each step solves two linear systems with the same matrix W = I - gamma*h*J,
+ * where J is the analytic Jacobian supplied by an AbstractOdeSystemWithAnalyticJacobian
+ * (such as MyDeltaNotchOdeSystem). Unlike an explicit method, this remains stable
+ * for stiff systems at timesteps far larger than the fastest time scale, and unlike
+ * BackwardEulerIvpOdeSolver it needs no Newton iteration.
+ *
+ * To use this solver for the Delta-Notch model, pass
+ * CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance()
+ * to the MyDeltaNotchSrnModel constructor.
+ */
+class MyRosenbrockIvpOdeSolver : public AbstractOneStepIvpOdeSolver
+{
+private:
+
+    /** Needed for serialization. */
+    friend class boost::serialization::access;
+    /**
+     * Archive the solver. The working memory is not archived.
+     *
+     * @param archive the archive
+     * @param version the current version of this class
+     */
+    template<class Archive>
+    void serialize(Archive & archive, const unsigned int version)
+    {
+        archive & boost::serialization::base_object<AbstractOneStepIvpOdeSolver>(*this);
+    }
+
+    /** The size of the ODE system for which the working memory is allocated. */
+    unsigned mSize;
+
+    /** Storage for the matrix W, in row-major order. */
+    std::vector<double> mMatrixStorage;
+
+    /** Pointers to the rows of W, in the form expected by AbstractOdeSystemWithAnalyticJacobian::AnalyticJacobian(). */
+    std::vector<double*> mMatrixRows;
+
+    /** The row permutation of the LU factorisation of W. */
+    std::vector<unsigned> mPivots;
+
+    /** Working memory for the RHS evaluations. */
+    std::vector<double> mRhs;
+
+    /** Working memory for the first stage. */
+    std::vector<double> mK1;
+
+    /** Working memory for the second stage. */
+    std::vector<double> mK2;
+
+    /** Working memory for the state passed to the second stage. */
+    std::vector<double> mYStage;
+
+    /**
+     * Allocate the working memory, if the size of the ODE system has changed.
+     *
+     * @param size the number of state variables
+     */
+    void ResizeWorkingMemory(unsigned size);
+
+    /**
+     * Replace W with its LU factorisation in place, using partial pivoting.
+     */
+    void FactoriseMatrix();
+
+    /**
+     * Solve W x = b using the factorisation computed by FactoriseMatrix().
+     *
+     * @param rB the right-hand side b
+     * @param rX filled in with the solution x
+     */
+    void SolveFactorisedSystem(const std::vector<double>& rB, std::vector<double>& rX);
+
+protected:
+
+    /**
+     * Calculate the solution to the ODE system at the next timestep.
+     *
+     * @param pAbstractOdeSystem  the ODE system to solve, which must have an analytic Jacobian
+     * @param timeStep  dt
+     * @param time  the current time
+     * @param rCurrentYValues  the current (initial) state
+     * @param rNextYValues  the state at the next timestep
+     */
+    void CalculateNextYValue(AbstractOdeSystem* pAbstractOdeSystem,
+                             double timeStep,
+                             double time,
+                             std::vector<double>& rCurrentYValues,
+                             std::vector<double>& rNextYValues);
+
+public:
+
+    /**
+     * The coefficient gamma = 1 + 1/sqrt(2) of the method, which makes it L-stable.
+     */
+    static const double GAMMA;
+
+    /**
+     * Constructor.
+     */
+    MyRosenbrockIvpOdeSolver();
+};
+
+#include "SerializationExportWrapper.hpp"
+CHASTE_CLASS_EXPORT(MyRosenbrockIvpOdeSolver)
+
+#endif /*MYROSENBROCKIVPODESOLVER_HPP_*/
@@ -0,0 +1,62 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHTESTODESYSTEM_HPP_
+#define MYDELTANOTCHTESTODESYSTEM_HPP_
+
+#include <vector>
+
+#include "MyDeltaNotchOdeSystem.hpp"
+
+/**
+ * Set up a Delta-Notch ODE system with some representative state and inputs, for the tests
+ * of the ODE solvers. Cases 0 to 3 cover both branches of the x distance profiles.
+ *
+ * @param caseIndex which of the states and inputs to use
+ * @param rOdeSystem the ODE system to set up
+ */
+inline void SetUpMyDeltaNotchTestOdeSystem(unsigned caseIndex, MyDeltaNotchOdeSystem& rOdeSystem)
+{
+    std::vector<double> initial_conditions(6);
+    for (unsigned var=0; var<6; var++)
+    {
+        initial_conditions[var] = 0.1 + 0.05*((caseIndex*7 + var*3)%11);
+    }
+    rOdeSystem.SetStateVariables(initial_conditions);
+    rOdeSystem.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.2 + 0.1*caseIndex);
+    rOdeSystem.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, 1.5*caseIndex);
+}
+
+#endif /*MYDELTANOTCHTESTODESYSTEM_HPP_*/
@@ -0,0 +1,93 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef MYDELTANOTCHTESTPOPULATION_HPP_
+#define MYDELTANOTCHTESTPOPULATION_HPP_
+
+#include <vector>
+#include <boost/shared_ptr.hpp>
+
+#include "AbstractCellCycleModelOdeSolver.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "SmartPointers.hpp"
+
+/**
+ * Create a population of differentiated cells on a honeycomb vertex mesh, each with a
+ * MyDeltaNotchSrnModel with different initial conditions, for the tests that compare two
+ * ways of simulating the same tissue. The initial conditions depend only on the element index.
+ *
+ * @param rGenerator the mesh generator, which must outlive the population
+ * @param pOdeSolver the shared solver of the SRN models, or an empty pointer (the default) for their default solver
+ * @param dt the timestep of the SRN models, or 0 (the default) to leave their default timestep
+ * @return the population
+ */
+inline boost::shared_ptr<VertexBasedCellPopulation<2> > CreateMyDeltaNotchTestPopulation(
+    HoneycombVertexMeshGenerator& rGenerator,
+    boost::shared_ptr<AbstractCellCycleModelOdeSolver> pOdeSolver=boost::shared_ptr<AbstractCellCycleModelOdeSolver>(),
+    double dt=0.0)
+{
+    MutableVertexMesh<2,2>* p_mesh = rGenerator.GetMesh();
+
+    std::vector<CellPtr> cells;
+    MAKE_PTR(WildTypeCellMutationState, p_state);
+    MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+    for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+    {
+        std::vector<double> initial_conditions(6);
+        for (unsigned i=0; i<6; i++)
+        {
+            initial_conditions[i] = 0.1 + 0.05*((elem_index + 3*i) % 7);
+        }
+        MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel(pOdeSolver);
+        p_srn_model->SetInitialConditions(initial_conditions);
+        if (dt > 0.0)
+        {
+            p_srn_model->SetDt(dt);
+        }
+
+        CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, p_srn_model));
+        p_cell->SetCellProliferativeType(p_diff_type);
+        cells.push_back(p_cell);
+    }
+
+    return boost::shared_ptr<VertexBasedCellPopulation<2> >(new VertexBasedCellPopulation<2>(*p_mesh, cells));
+}
+
+#endif /*MYDELTANOTCHTESTPOPULATION_HPP_*/
@@ -0,0 +1,333 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYDELTANOTCHBATCHBDFSOLVER_HPP_
+#define TESTMYDELTANOTCHBATCHBDFSOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include <cmath>
+#include <set>
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "Exception.hpp"
+#include "TimeStepper.hpp"
+
+/**
+ * Check that the implicit tissue-level solver solves the coupled Delta-Notch
+ * system of a whole tissue accurately, including at large timesteps.
+ */
+class TestMyDeltaNotchBatchBdfSolver : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Build a ring of cells, each of whose neighbours are the cells either side.
+     *
+     * @param numCells the number of cells
+     * @param rGraph the graph to build
+     */
+    void BuildRing(unsigned numCells, MyDeltaNotchNeighbourGraph& rGraph)
+    {
+        std::vector<unsigned> location_indices(numCells);
+        std::vector<std::set<unsigned> > neighbours(numCells);
+        for (unsigned cell_index=0; cell_index<numCells; cell_index++)
+        {
+            location_indices[cell_index] = cell_index;
+            neighbours[cell_index].insert((cell_index + 1)%numCells);
+            neighbours[cell_index].insert((cell_index + numCells - 1)%numCells);
+        }
+        rGraph.Build(location_indices, neighbours);
+    }
+
+    /**
+     * Fill in some distinct initial conditions and x distances.
+     *
+     * @param rBatch the batch, which should already be the right size
+     */
+    void SetUpBatch(MyDeltaNotchBatchOdeSystem& rBatch)
+    {
+        const unsigned num_cells = rBatch.GetNumCells();
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                rBatch.rGetStateVariables()[var*num_cells + cell_index] = 0.1 + 0.05*((cell_index*7 + var*3)%11);
+            }
+            rBatch.rGetMeanDelta()[cell_index] = 0.0;
+            rBatch.rGetXDistance()[cell_index] = 0.5*(cell_index%13);
+        }
+    }
+
+    /**
+     * @param rBatch a batch
+     * @param rReference the reference state, in the same layout
+     * @return the largest error in the state of rBatch, relative to 1 + |reference|
+     */
+    double GetMaxError(MyDeltaNotchBatchOdeSystem& rBatch, const std::vector<double>& rReference)
+    {
+        double max_error = 0.0;
+        for (unsigned i=0; i<rReference.size(); i++)
+        {
+            TS_ASSERT(std::isfinite(rReference[i]));
+            double value = rBatch.rGetStateVariables()[i];
+            TS_ASSERT(std::isfinite(value));
+            max_error = std::max(max_error, fabs(value - rReference[i])/(1.0 + fabs(rReference[i])));
+        }
+        return max_error;
+    }
+
+public:
+
+    void TestSingleStepSolvesImplicitEquation()
+    {
+        const unsigned num_cells = 8;
+        const double dt = 0.01;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        std::vector<double> initial_state = batch.rGetStateVariables();
+
+        MyDeltaNotchBatchBdfSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        solver.Solve(batch, 0.0, dt, dt);
+        TS_ASSERT_EQUALS(solver.GetNumSteps(), 1u);
+        TS_ASSERT_LESS_THAN(1u, solver.GetNumNewtonIterations());
+        TS_ASSERT_LESS_THAN(solver.GetNumNewtonIterations(), solver.GetNumLinearIterations());
+
+        // A single step is backward Euler, y1 = y0 + dt*f(y1), with the neighbour coupling evaluated at y1
+        const std::vector<double>& r_y = batch.rGetStateVariables();
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            double y[6];
+            for (unsigned var=0; var<6; var++)
+            {
+                y[var] = r_y[var*num_cells + cell_index];
+            }
+            double mean_delta = 0.5*(r_y[5*num_cells + (cell_index + 1)%num_cells]
+                                     + r_y[5*num_cells + (cell_index + num_cells - 1)%num_cells]);
+            double dy[6];
+            MyDeltaNotchOdeSystem::EvaluateShimizuRhs(DEFAULT_MY_DELTA_NOTCH_PARAMETERS, y, mean_delta,
+                                                      batch.rGetXDistance()[cell_index], dy);
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_DELTA(y[var], initial_state[var*num_cells + cell_index] + dt*dy[var], 1e-9);
+            }
+            TS_ASSERT_DELTA(batch.rGetMeanDelta()[cell_index], mean_delta, 1e-9);
+        }
+    }
+
+    void TestCoupledSolveIsAccurateAndStable()
+    {
+        const unsigned num_cells = 10;
+        const double end_time = 2.0;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        // A reference solution of the coupled system with a small explicit step (the system is stiff)
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchRungeKutta4Solver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, end_time, 1e-5);
+        std::vector<double> reference = reference_batch.rGetStateVariables();
+
+        // The error falls as the timestep is reduced
+        double errors[2];
+        const double timesteps[2] = {0.02, 0.01};
+        for (unsigned k=0; k<2; k++)
+        {
+            MyDeltaNotchBatchOdeSystem batch(num_cells);
+            SetUpBatch(batch);
+            MyDeltaNotchBatchBdfSolver solver;
+            solver.SetNeighbourGraph(&graph);
+            solver.Solve(batch, 0.0, end_time, timesteps[k]);
+            TS_ASSERT_LESS_THAN_EQUALS(100u*(k + 1), solver.GetNumSteps());
+            errors[k] = GetMaxError(batch, reference);
+        }
+        TS_ASSERT_LESS_THAN(errors[0], 1e-2);
+        TS_ASSERT_LESS_THAN(errors[1], errors[0]);
+
+        /*
+         * The solver remains stable at timesteps thousands of times larger than the explicit solvers can use.
+         * Steps are rejected and halved during the initial transient, where a large step would otherwise
+         * converge to a spurious solution with negative concentrations, and are then doubled back up.
+         */
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchBatchBdfSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        solver.Solve(batch, 0.0, end_time, 0.15);
+        TS_ASSERT_LESS_THAN(0u, solver.GetNumRejectedSteps());
+        TS_ASSERT_LESS_THAN(solver.GetNumSteps(), 50u);
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetMaxStepRatio(), MyDeltaNotchBatchBdfSolver::MAX_STEP_RATIO);
+        TS_ASSERT_LESS_THAN(GetMaxError(batch, reference), 2e-2);
+        for (unsigned i=0; i<batch.rGetStateVariables().size(); i++)
+        {
+            TS_ASSERT_LESS_THAN(0.0, batch.rGetStateVariables()[i]);
+        }
+    }
+
+    void TestHistoryIsKeptBetweenSolves()
+    {
+        const unsigned num_cells = 10;
+        const double dt = 0.01;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchBdfSolver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, 1.0, dt);
+
+        // Solving one step at a time, as a simulation does, takes exactly the same BDF2 steps as a single solve
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchBatchBdfSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        TimeStepper stepper(0.0, 1.0, dt);
+        while (!stepper.IsTimeAtEnd())
+        {
+            solver.Solve(batch, stepper.GetTime(), stepper.GetNextTime(), dt);
+            stepper.AdvanceOneTimeStep();
+        }
+        TS_ASSERT_EQUALS(solver.GetNumSteps(), reference_solver.GetNumSteps());
+        TS_ASSERT(batch.rGetStateVariables() == reference_batch.rGetStateVariables());
+
+        // Once the graph is rebuilt, the next step starts again from backward Euler, as a new solver does
+        BuildRing(num_cells, graph);
+        MyDeltaNotchBatchOdeSystem restarted_batch(num_cells);
+        restarted_batch.rGetStateVariables() = batch.rGetStateVariables();
+        restarted_batch.rGetXDistance() = batch.rGetXDistance();
+        MyDeltaNotchBatchBdfSolver restarted_solver;
+        restarted_solver.SetNeighbourGraph(&graph);
+        restarted_solver.Solve(restarted_batch, 1.0, 1.0 + dt, dt);
+        solver.Solve(batch, 1.0, 1.0 + dt, dt);
+        TS_ASSERT(batch.rGetStateVariables() == restarted_batch.rGetStateVariables());
+
+        // So does a solve that does not start from the state the last one left
+        batch.rGetStateVariables()[0] += 0.01;
+        restarted_batch.rGetStateVariables() = batch.rGetStateVariables();
+        MyDeltaNotchBatchBdfSolver perturbed_solver;
+        perturbed_solver.SetNeighbourGraph(&graph);
+        perturbed_solver.Solve(restarted_batch, 1.0 + dt, 1.0 + 2.0*dt, dt);
+        solver.Solve(batch, 1.0 + dt, 1.0 + 2.0*dt, dt);
+        TS_ASSERT(batch.rGetStateVariables() == restarted_batch.rGetStateVariables());
+    }
+
+    void TestStepRatioIsLimitedAfterRejections()
+    {
+        const unsigned num_cells = 10;
+        const double end_time = 2.0;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchRungeKutta4Solver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, end_time, 1e-5);
+
+        /*
+         * Solve over intervals a little longer than the timestep. Steps are rejected and halved during the
+         * initial transient and then doubled back up, and stretching a doubled step to reach the end of an
+         * interval would give a step three times the one before it, were the ratio not limited.
+         */
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchBatchBdfSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        TimeStepper stepper(0.0, end_time, 0.2);
+        while (!stepper.IsTimeAtEnd())
+        {
+            solver.Solve(batch, stepper.GetTime(), stepper.GetNextTime(), 0.15);
+            stepper.AdvanceOneTimeStep();
+        }
+        TS_ASSERT_LESS_THAN(0u, solver.GetNumRejectedSteps());
+        TS_ASSERT_LESS_THAN(1.0, solver.GetMaxStepRatio());
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetMaxStepRatio(), MyDeltaNotchBatchBdfSolver::MAX_STEP_RATIO);
+        TS_ASSERT_LESS_THAN(GetMaxError(batch, reference_batch.rGetStateVariables()), 2e-2);
+    }
+
+    void TestUncoupledSolve()
+    {
+        // Without a neighbour graph the mean levels of Delta are held fixed, as by MyDeltaNotchBatchRungeKutta4Solver
+        const unsigned num_cells = 5;
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            reference_batch.rGetMeanDelta()[cell_index] = 0.2 + 0.1*cell_index;
+        }
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        batch.rGetMeanDelta() = reference_batch.rGetMeanDelta();
+
+        MyDeltaNotchBatchRungeKutta4Solver reference_solver;
+        reference_solver.Solve(reference_batch, 0.0, 1.0, 1e-5);
+
+        MyDeltaNotchBatchBdfSolver solver;
+        solver.Solve(batch, 0.0, 1.0, 0.005);
+        TS_ASSERT_LESS_THAN(GetMaxError(batch, reference_batch.rGetStateVariables()), 5e-3);
+        TS_ASSERT(batch.rGetMeanDelta() == reference_batch.rGetMeanDelta());
+
+        // The block Jacobi preconditioner is then exact, so GMRES needs a single iteration per Newton iteration
+        TS_ASSERT_EQUALS(solver.GetNumLinearIterations(), solver.GetNumNewtonIterations());
+    }
+
+    void TestExceptions()
+    {
+        MyDeltaNotchBatchBdfSolver solver;
+        TS_ASSERT_DELTA(solver.GetNewtonTolerance(), 1e-10, 1e-24);
+        TS_ASSERT_DELTA(solver.GetLinearTolerance(), 1e-8, 1e-22);
+        solver.SetNewtonTolerance(1e-8);
+        TS_ASSERT_DELTA(solver.GetNewtonTolerance(), 1e-8, 1e-22);
+        solver.SetLinearTolerance(1e-6);
+        TS_ASSERT_DELTA(solver.GetLinearTolerance(), 1e-6, 1e-20);
+
+        TS_ASSERT_THROWS_THIS(solver.SetNewtonTolerance(0.0), "The Newton tolerance must be positive.");
+        TS_ASSERT_THROWS_THIS(solver.SetLinearTolerance(-1.0), "The linear solver tolerance must be positive.");
+    }
+};
+
+#endif /*TESTMYDELTANOTCHBATCHBDFSOLVER_HPP_*/
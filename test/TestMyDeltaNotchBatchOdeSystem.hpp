@@ -0,0 +1,376 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHBATCHODESYSTEM_HPP_
+#define TESTMYDELTANOTCHBATCHODESYSTEM_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchSimdKernels.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "Exception.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+
+/**
+ * Check that integrating a population of Delta-Notch ODE systems as a single
+ * structure-of-arrays batch gives the same answer as integrating each cell's
+ * MyDeltaNotchOdeSystem in turn.
+ */
+class TestMyDeltaNotchBatchOdeSystem : public CxxTest::TestSuite
+{
+private:
+
+    /** Fill in some distinct initial conditions and inputs for a given cell. */
+    void SetUpCell(unsigned cellIndex, std::vector<double>& rInitialConditions, double& rMeanDelta, double& rXDistance)
+    {
+        rInitialConditions.resize(6);
+        for (unsigned var=0; var<6; var++)
+        {
+            rInitialConditions[var] = 0.1 + 0.05*((cellIndex*7 + var*3)%11);
+        }
+        rMeanDelta = 0.2 + 0.1*(cellIndex%5);
+        rXDistance = 0.5*(cellIndex%13); // covers both branches of the x distance profiles
+    }
+
+public:
+
+    void TestBatchRhsMatchesSingleCellRhs()
+    {
+        const unsigned num_cells = 37;
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        batch.SetKernelType(MyDeltaNotchSimdKernels::SCALAR);
+        TS_ASSERT_EQUALS(batch.GetNumCells(), num_cells);
+        TS_ASSERT_EQUALS(batch.rGetStateVariables().size(), 6*num_cells);
+
+        std::vector<std::vector<double> > single_cell_dy(num_cells);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            std::vector<double> y;
+            SetUpCell(cell_index, y, batch.rGetMeanDelta()[cell_index], batch.rGetXDistance()[cell_index]);
+            for (unsigned var=0; var<6; var++)
+            {
+                batch.rGetStateVariables()[var*num_cells + cell_index] = y[var];
+            }
+
+            MyDeltaNotchOdeSystem ode_system(y);
+            ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, batch.rGetMeanDelta()[cell_index]);
+            ode_system.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, batch.rGetXDistance()[cell_index]);
+            single_cell_dy[cell_index].resize(6);
+            ode_system.EvaluateYDerivatives(0.0, y, single_cell_dy[cell_index]);
+        }
+
+        std::vector<double> batch_dy(6*num_cells);
+        batch.EvaluateYDerivatives(0.0, batch.rGetStateVariables(), batch_dy);
+
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_EQUALS(batch_dy[var*num_cells + cell_index], single_cell_dy[cell_index][var]);
+            }
+        }
+    }
+
+    void TestSimdKernelsMatchScalarKernel()
+    {
+        // An odd number of cells, so that each vectorised kernel also has to deal with a remainder
+        const unsigned num_cells = 45;
+        std::vector<double> y(6*num_cells);
+        std::vector<double> mean_delta(num_cells);
+        std::vector<double> x_distance(num_cells);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            std::vector<double> initial_conditions;
+            SetUpCell(cell_index, initial_conditions, mean_delta[cell_index], x_distance[cell_index]);
+            for (unsigned var=0; var<6; var++)
+            {
+                y[var*num_cells + cell_index] = initial_conditions[var];
+            }
+        }
+
+        TS_ASSERT(MyDeltaNotchSimdKernels::IsAvailable(MyDeltaNotchSimdKernels::SCALAR));
+        TS_ASSERT(MyDeltaNotchSimdKernels::IsAvailable(MyDeltaNotchSimdKernels::GetBestAvailableKernelType()));
+        TS_ASSERT_EQUALS(MyDeltaNotchSimdKernels::GetKernelName(MyDeltaNotchSimdKernels::SCALAR), "scalar");
+        TS_ASSERT_EQUALS(MyDeltaNotchSimdKernels::GetKernelName(MyDeltaNotchSimdKernels::AVX2), "AVX2");
+        TS_ASSERT_EQUALS(MyDeltaNotchSimdKernels::GetKernelName(MyDeltaNotchSimdKernels::AVX512), "AVX-512");
+
+        std::vector<double> scalar_dy(6*num_cells);
+        MyDeltaNotchSimdKernels::EvaluateYDerivatives(MyDeltaNotchSimdKernels::SCALAR, DEFAULT_MY_DELTA_NOTCH_PARAMETERS, num_cells,
+                                                      &y[0], &mean_delta[0], &x_distance[0], &scalar_dy[0]);
+
+        MyDeltaNotchSimdKernels::KernelType vectorised_kernels[2] = {MyDeltaNotchSimdKernels::AVX2, MyDeltaNotchSimdKernels::AVX512};
+        for (unsigned i=0; i<2; i++)
+        {
+            if (!MyDeltaNotchSimdKernels::IsAvailable(vectorised_kernels[i]))
+            {
+                TS_ASSERT_THROWS_CONTAINS(MyDeltaNotchSimdKernels::EvaluateYDerivatives(vectorised_kernels[i], DEFAULT_MY_DELTA_NOTCH_PARAMETERS, num_cells,
+                                              &y[0], &mean_delta[0], &x_distance[0], &scalar_dy[0]),
+                                          "kernel is not available on this machine");
+                continue;
+            }
+
+            std::vector<double> vectorised_dy(6*num_cells);
+            MyDeltaNotchSimdKernels::EvaluateYDerivatives(vectorised_kernels[i], DEFAULT_MY_DELTA_NOTCH_PARAMETERS, num_cells,
+                                                          &y[0], &mean_delta[0], &x_distance[0], &vectorised_dy[0]);
+
+            // No multiply-adds are fused in any kernel, so they all round the same way
+            for (unsigned j=0; j<6*num_cells; j++)
+            {
+                TS_ASSERT_EQUALS(vectorised_dy[j], scalar_dy[j]);
+            }
+        }
+
+        // The kernels with the default parameters folded in give exactly the same derivatives
+        MyDeltaNotchSimdKernels::KernelType all_kernels[3] = {MyDeltaNotchSimdKernels::SCALAR,
+                                                              MyDeltaNotchSimdKernels::AVX2,
+                                                              MyDeltaNotchSimdKernels::AVX512};
+        for (unsigned i=0; i<3; i++)
+        {
+            if (MyDeltaNotchSimdKernels::IsAvailable(all_kernels[i]))
+            {
+                std::vector<double> default_dy(6*num_cells);
+                MyDeltaNotchSimdKernels::EvaluateYDerivatives(all_kernels[i], num_cells,
+                                                              &y[0], &mean_delta[0], &x_distance[0], &default_dy[0]);
+                for (unsigned j=0; j<6*num_cells; j++)
+                {
+                    TS_ASSERT_EQUALS(default_dy[j], scalar_dy[j]);
+                }
+            }
+        }
+    }
+
+    void TestBatchRungeKutta4MatchesSingleCellRungeKutta4()
+    {
+        const unsigned num_cells = 20;
+        const double end_time = 0.002;
+        const double dt = 1e-4;
+
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        RungeKutta4IvpOdeSolver single_cell_solver;
+        std::vector<std::vector<double> > single_cell_solutions(num_cells);
+
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            std::vector<double> y;
+            SetUpCell(cell_index, y, batch.rGetMeanDelta()[cell_index], batch.rGetXDistance()[cell_index]);
+            for (unsigned var=0; var<6; var++)
+            {
+                batch.rGetStateVariables()[var*num_cells + cell_index] = y[var];
+            }
+
+            MyDeltaNotchOdeSystem ode_system(y);
+            ode_system.SetParameter("mean delta", batch.rGetMeanDelta()[cell_index]);
+            ode_system.SetParameter("x distance", batch.rGetXDistance()[cell_index]);
+            single_cell_solver.SolveAndUpdateStateVariable(&ode_system, 0.0, end_time, dt);
+            single_cell_solutions[cell_index] = ode_system.rGetStateVariables();
+        }
+
+        MyDeltaNotchBatchRungeKutta4Solver batch_solver;
+        batch_solver.Solve(batch, 0.0, end_time, dt);
+
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                double single_cell_value = single_cell_solutions[cell_index][var];
+                TS_ASSERT_DELTA(batch.rGetStateVariables()[var*num_cells + cell_index], single_cell_value,
+                                1e-12*(1.0 + fabs(single_cell_value)));
+            }
+        }
+
+        // Resizing the batch keeps its layout consistent
+        batch.Resize(3);
+        TS_ASSERT_EQUALS(batch.GetNumCells(), 3u);
+        TS_ASSERT_EQUALS(batch.rGetStateVariables().size(), 18u);
+        TS_ASSERT_EQUALS(batch.rGetMeanDelta().size(), 3u);
+        TS_ASSERT_EQUALS(batch.rGetXDistance().size(), 3u);
+    }
+
+    void TestCoupledBatchRungeKutta4()
+    {
+        // A ring of cells, each of whose neighbours are the cells either side
+        const unsigned num_cells = 6;
+        const double end_time = 0.002;
+        const double dt = 1e-4;
+        std::vector<unsigned> location_indices(num_cells);
+        std::vector<std::set<unsigned> > neighbours(num_cells);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            location_indices[cell_index] = cell_index;
+            neighbours[cell_index].insert((cell_index + 1)%num_cells);
+            neighbours[cell_index].insert((cell_index + num_cells - 1)%num_cells);
+        }
+        MyDeltaNotchNeighbourGraph graph;
+        graph.Build(location_indices, neighbours);
+
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        batch.SetKernelType(MyDeltaNotchSimdKernels::SCALAR);
+        std::vector<double> y(6*num_cells);
+        std::vector<double> x_distance(num_cells);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            std::vector<double> cell_y;
+            double mean_delta;
+            SetUpCell(cell_index, cell_y, mean_delta, x_distance[cell_index]);
+            batch.rGetXDistance()[cell_index] = x_distance[cell_index];
+            for (unsigned var=0; var<6; var++)
+            {
+                batch.rGetStateVariables()[var*num_cells + cell_index] = cell_y[var];
+                y[6*cell_index + var] = cell_y[var];
+            }
+        }
+
+        // Solve the coupled system by hand, recomputing the mean Delta at every stage
+        std::vector<double> k[4];
+        for (unsigned stage=0; stage<4; stage++)
+        {
+            k[stage].resize(6*num_cells);
+        }
+        const double stage_weights[4] = {0.0, 0.5, 0.5, 1.0};
+        for (unsigned step=0; step<20; step++)
+        {
+            for (unsigned stage=0; stage<4; stage++)
+            {
+                std::vector<double> y_stage(y);
+                if (stage > 0)
+                {
+                    for (unsigned i=0; i<y.size(); i++)
+                    {
+                        y_stage[i] += stage_weights[stage]*dt*k[stage - 1][i];
+                    }
+                }
+                for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+                {
+                    double mean_delta = 0.5*(y_stage[6*((cell_index + 1)%num_cells) + 5]
+                                             + y_stage[6*((cell_index + num_cells - 1)%num_cells) + 5]);
+                    MyDeltaNotchOdeSystem::EvaluateShimizuRhs(DEFAULT_MY_DELTA_NOTCH_PARAMETERS, &y_stage[6*cell_index],
+                                                              mean_delta, x_distance[cell_index], &k[stage][6*cell_index]);
+                }
+            }
+            for (unsigned i=0; i<y.size(); i++)
+            {
+                y[i] += dt*(k[0][i] + 2.0*k[1][i] + 2.0*k[2][i] + k[3][i])/6.0;
+            }
+        }
+
+        MyDeltaNotchBatchRungeKutta4Solver batch_solver;
+        batch_solver.SetNeighbourGraph(&graph);
+        batch_solver.Solve(batch, 0.0, end_time, dt);
+
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                double expected_value = y[6*cell_index + var];
+                TS_ASSERT_DELTA(batch.rGetStateVariables()[var*num_cells + cell_index], expected_value,
+                                1e-12*(1.0 + fabs(expected_value)));
+            }
+        }
+    }
+
+    void TestKineticParameterSets()
+    {
+        // The default parameter set is usable at compile time and can be accessed by name
+        static_assert(DEFAULT_MY_DELTA_NOTCH_PARAMETERS.k_6 == 500.0, "Unexpected default value of k_6");
+        std::vector<std::string> names = MyDeltaNotchParameters::GetParameterNames();
+        TS_ASSERT_EQUALS(names.size(), 30u);
+        TS_ASSERT_EQUALS(names[0], "k_1");
+
+        boost::shared_ptr<MyDeltaNotchParameters> p_parameters(new MyDeltaNotchParameters);
+        for (unsigned i=0; i<names.size(); i++)
+        {
+            TS_ASSERT_EQUALS(p_parameters->GetParameter(names[i]), DEFAULT_MY_DELTA_NOTCH_PARAMETERS.GetParameter(names[i]));
+        }
+        TS_ASSERT_THROWS_THIS(p_parameters->SetParameter("k_99", 1.0),
+                              "No Delta-Notch kinetic parameter named 'k_99'.");
+
+        // The mean delta and x distance inputs are accessed by integer handle
+        std::vector<double> y;
+        double mean_delta;
+        double x_distance;
+        SetUpCell(3, y, mean_delta, x_distance);
+        MyDeltaNotchOdeSystem ode_system(y);
+        ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, mean_delta);
+        ode_system.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, x_distance);
+        TS_ASSERT_EQUALS(ode_system.GetParameter("mean delta"), mean_delta);
+        TS_ASSERT_EQUALS(ode_system.GetParameter("x distance"), x_distance);
+        TS_ASSERT(!ode_system.GetKineticParameters());
+
+        std::vector<double> default_dy(6);
+        ode_system.EvaluateYDerivatives(0.0, y, default_dy);
+
+        // An explicit copy of the defaults gives identical results
+        ode_system.SetKineticParameters(p_parameters);
+        TS_ASSERT_EQUALS(ode_system.GetKineticParameters(), p_parameters);
+        std::vector<double> dy(6);
+        ode_system.EvaluateYDerivatives(0.0, y, dy);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_EQUALS(dy[var], default_dy[var]);
+        }
+
+        // Changing the Delta degradation rate changes the Delta derivative only
+        p_parameters->SetParameter("gamma", 2.0*DEFAULT_MY_DELTA_NOTCH_PARAMETERS.gamma);
+        TS_ASSERT_EQUALS(p_parameters->gamma, 2.0*DEFAULT_MY_DELTA_NOTCH_PARAMETERS.gamma);
+        ode_system.EvaluateYDerivatives(0.0, y, dy);
+        for (unsigned var=0; var<5; var++)
+        {
+            TS_ASSERT_EQUALS(dy[var], default_dy[var]);
+        }
+        TS_ASSERT_DIFFERS(dy[5], default_dy[5]);
+
+        // The batch uses the same parameter set for every cell
+        MyDeltaNotchBatchOdeSystem batch(1);
+        batch.SetKernelType(MyDeltaNotchSimdKernels::SCALAR);
+        batch.SetKineticParameters(p_parameters);
+        TS_ASSERT_EQUALS(batch.GetKineticParameters(), p_parameters);
+        batch.rGetStateVariables() = y;
+        batch.rGetMeanDelta()[0] = mean_delta;
+        batch.rGetXDistance()[0] = x_distance;
+        std::vector<double> batch_dy(6);
+        batch.EvaluateYDerivatives(0.0, batch.rGetStateVariables(), batch_dy);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_EQUALS(batch_dy[var], dy[var]);
+        }
+    }
+};
+
+#endif /*TESTMYDELTANOTCHBATCHODESYSTEM_HPP_*/
@@ -0,0 +1,239 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_
+#define TESTMYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include <cmath>
+#include <set>
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchBdfSolver.hpp"
+#include "MyDeltaNotchBatchSteadyStateSolver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "Exception.hpp"
+
+/**
+ * Check that the steady state solver finds the state that the coupled Delta-Notch
+ * system of a tissue settles to, and falls back to integrating the tissue if need be.
+ */
+class TestMyDeltaNotchBatchSteadyStateSolver : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Build a ring of cells, each of whose neighbours are the cells either side.
+     *
+     * @param numCells the number of cells
+     * @param rGraph the graph to build
+     */
+    void BuildRing(unsigned numCells, MyDeltaNotchNeighbourGraph& rGraph)
+    {
+        std::vector<unsigned> location_indices(numCells);
+        std::vector<std::set<unsigned> > neighbours(numCells);
+        for (unsigned cell_index=0; cell_index<numCells; cell_index++)
+        {
+            location_indices[cell_index] = cell_index;
+            neighbours[cell_index].insert((cell_index + 1)%numCells);
+            neighbours[cell_index].insert((cell_index + numCells - 1)%numCells);
+        }
+        rGraph.Build(location_indices, neighbours);
+    }
+
+    /**
+     * Fill in some distinct initial conditions and x distances. The x distances are all below 3,
+     * beyond which the level of Delta in some cells falls through zero.
+     *
+     * @param rBatch the batch, which should already be the right size
+     */
+    void SetUpBatch(MyDeltaNotchBatchOdeSystem& rBatch)
+    {
+        const unsigned num_cells = rBatch.GetNumCells();
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                rBatch.rGetStateVariables()[var*num_cells + cell_index] = 0.1 + 0.05*((cell_index*7 + var*3)%11);
+            }
+            rBatch.rGetMeanDelta()[cell_index] = 0.0;
+            rBatch.rGetXDistance()[cell_index] = 0.2*(cell_index%13);
+        }
+    }
+
+    /**
+     * @param rBatch a batch
+     * @param rReference the reference state, in the same layout
+     * @return the largest difference between the state of rBatch and the reference, relative to 1 + |reference|
+     */
+    double GetMaxDifference(MyDeltaNotchBatchOdeSystem& rBatch, const std::vector<double>& rReference)
+    {
+        double max_difference = 0.0;
+        for (unsigned i=0; i<rReference.size(); i++)
+        {
+            double value = rBatch.rGetStateVariables()[i];
+            TS_ASSERT(std::isfinite(value));
+            max_difference = std::max(max_difference, fabs(value - rReference[i])/(1.0 + fabs(rReference[i])));
+        }
+        return max_difference;
+    }
+
+public:
+
+    void TestFindsLongTimeState()
+    {
+        const unsigned num_cells = 10;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        /*
+         * The slowest modes of the tissue take thousands of time units to settle, so a reference steady
+         * state needs a long integration.
+         */
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchBdfSolver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, 1.0, 0.1);
+        std::vector<double> pre_integrated_state = reference_batch.rGetStateVariables();
+        reference_solver.Solve(reference_batch, 1.0, 20000.0, 1.0);
+        std::vector<double> reference = reference_batch.rGetStateVariables();
+
+        // From a short pre-integrated state, the continuation converges by itself in far fewer iterations
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        batch.rGetStateVariables() = pre_integrated_state;
+        MyDeltaNotchBatchSteadyStateSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        TS_ASSERT(solver.FindSteadyState(batch));
+        TS_ASSERT(solver.HasConverged());
+        TS_ASSERT_DELTA(solver.GetFallbackTime(), 0.0, 1e-12);
+        TS_ASSERT_LESS_THAN(solver.GetNumIterations(), 100u);
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetResidualNorm(), solver.GetResidualTolerance());
+        TS_ASSERT_LESS_THAN(GetMaxDifference(batch, reference), 1e-5);
+
+        // The state is a fixed point of the dynamics
+        std::vector<double> steady_state = batch.rGetStateVariables();
+        MyDeltaNotchBatchBdfSolver bdf_solver;
+        bdf_solver.SetNeighbourGraph(&graph);
+        bdf_solver.Solve(batch, 0.0, 10.0, 0.1);
+        TS_ASSERT_LESS_THAN(GetMaxDifference(batch, steady_state), 1e-6);
+
+        // Starting from a steady state, the solver stops at once, with the coupling consistent with the state
+        MyDeltaNotchBatchOdeSystem steady_batch(num_cells);
+        SetUpBatch(steady_batch);
+        steady_batch.rGetStateVariables() = steady_state;
+        TS_ASSERT(solver.FindSteadyState(steady_batch));
+        TS_ASSERT_EQUALS(solver.GetNumIterations(), 0u);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            double mean_delta = 0.5*(steady_state[5*num_cells + (cell_index + 1)%num_cells]
+                                     + steady_state[5*num_cells + (cell_index + num_cells - 1)%num_cells]);
+            TS_ASSERT_DELTA(steady_batch.rGetMeanDelta()[cell_index], mean_delta, 1e-12);
+        }
+    }
+
+    void TestFallsBackToTimeStepping()
+    {
+        const unsigned num_cells = 10;
+        MyDeltaNotchNeighbourGraph graph;
+        BuildRing(num_cells, graph);
+
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchBdfSolver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, 20000.0, 1.0);
+        std::vector<double> reference = reference_batch.rGetStateVariables();
+
+        /*
+         * From these initial conditions the continuation wanders and fails, so the solver integrates
+         * the tissue and tries again, and then converges.
+         */
+        MyDeltaNotchBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchBatchSteadyStateSolver solver;
+        solver.SetNeighbourGraph(&graph);
+        TS_ASSERT(solver.FindSteadyState(batch));
+        TS_ASSERT_LESS_THAN(0.0, solver.GetFallbackTime());
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetResidualNorm(), solver.GetResidualTolerance());
+        TS_ASSERT_LESS_THAN(GetMaxDifference(batch, reference), 1e-5);
+
+        // If it still fails, this is reported, and the tissue is left as integrated to the maximum time
+        MyDeltaNotchBatchOdeSystem integrated_batch(num_cells);
+        SetUpBatch(integrated_batch);
+        MyDeltaNotchBatchBdfSolver bdf_solver;
+        bdf_solver.SetNeighbourGraph(&graph);
+        bdf_solver.Solve(integrated_batch, 0.0, 1.0, 0.1);
+        bdf_solver.Solve(integrated_batch, 1.0, 2.0, 0.1);
+        bdf_solver.Solve(integrated_batch, 2.0, 2.5, 0.1);
+
+        SetUpBatch(batch);
+        solver.SetMaxIterations(1);
+        solver.SetFallback(0.1, 1.0, 2.5);
+        TS_ASSERT(!solver.FindSteadyState(batch));
+        TS_ASSERT(!solver.HasConverged());
+        TS_ASSERT_DELTA(solver.GetFallbackTime(), 2.5, 1e-12);
+        TS_ASSERT_EQUALS(solver.GetNumIterations(), 4u);
+        TS_ASSERT_LESS_THAN(solver.GetResidualTolerance(), solver.GetResidualNorm());
+        TS_ASSERT_LESS_THAN(GetMaxDifference(batch, integrated_batch.rGetStateVariables()), 1e-12);
+
+        // With no fallback time, the state is left unchanged
+        SetUpBatch(batch);
+        SetUpBatch(integrated_batch);
+        solver.SetFallback(0.1, 1.0, 0.0);
+        TS_ASSERT(!solver.FindSteadyState(batch));
+        TS_ASSERT_DELTA(solver.GetFallbackTime(), 0.0, 1e-12);
+        TS_ASSERT(batch.rGetStateVariables() == integrated_batch.rGetStateVariables());
+    }
+
+    void TestExceptions()
+    {
+        MyDeltaNotchBatchSteadyStateSolver solver;
+        TS_ASSERT_DELTA(solver.GetResidualTolerance(), 1e-8, 1e-20);
+        TS_ASSERT_THROWS_THIS(solver.SetResidualTolerance(0.0), "The residual tolerance must be positive.");
+        solver.SetResidualTolerance(1e-6);
+        TS_ASSERT_DELTA(solver.GetResidualTolerance(), 1e-6, 1e-20);
+
+        TS_ASSERT_THROWS_THIS(solver.SetFallback(0.0, 1.0, 10.0), "The fallback timestep and interval must be positive.");
+        TS_ASSERT_THROWS_THIS(solver.SetFallback(0.1, -1.0, 10.0), "The fallback timestep and interval must be positive.");
+        TS_ASSERT_THROWS_THIS(solver.SetFallback(0.1, 1.0, -10.0), "The maximum fallback time must be non-negative.");
+    }
+};
+
+#endif /*TESTMYDELTANOTCHBATCHSTEADYSTATESOLVER_HPP_*/
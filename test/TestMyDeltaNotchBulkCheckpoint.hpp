@@ -0,0 +1,190 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHBULKCHECKPOINT_HPP_
+#define TESTMYDELTANOTCHBULKCHECKPOINT_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchBulkCheckpoint.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that a bulk checkpoint restores the Delta-Notch state of every cell.
+ */
+class TestMyDeltaNotchBulkCheckpoint : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestSaveAndLoad()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 4);
+        SimulationTime::Instance()->IncrementTimeOneStep();
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        // Half the cells share a parameter set, and the rest use the defaults
+        boost::shared_ptr<MyDeltaNotchParameters> p_parameters(new MyDeltaNotchParameters);
+        p_parameters->k_6 = 123.0;
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel();
+            if (elem_index % 2 == 0)
+            {
+                p_srn_model->SetKineticParameters(p_parameters);
+            }
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, p_srn_model));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+        cell_population.InitialiseCells();
+
+        // Give each cell a distinct state
+        std::vector<std::vector<double> > saved_values;
+        unsigned cell_index = 0;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            std::vector<double> values(MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES);
+            p_model->SaveCheckpointValues(&values[0]);
+            for (unsigned i=0; i<6; i++)
+            {
+                values[i] = 0.1*i + 0.01*cell_index;
+            }
+            values[6] = 0.25;
+            values[7] = 1e-3*(cell_index + 1);
+            values[8] = 10 + cell_index;
+            values[9] = cell_index;
+            p_model->LoadCheckpointValues(&values[0]);
+            saved_values.push_back(values);
+            cell_index++;
+        }
+
+        OutputFileHandler handler("TestMyDeltaNotchBulkCheckpoint");
+        std::string file_name = handler.GetOutputDirectoryFullPath() + "checkpoint.h5";
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchBulkCheckpoint<2>::Save(cell_population, file_name, 10),
+                              "The compression level must be between 0 and 9.");
+        MyDeltaNotchBulkCheckpoint<2>::Save(cell_population, file_name, 6);
+        TS_ASSERT_DELTA(MyDeltaNotchBulkCheckpoint<2>::GetCheckpointTime(file_name), 0.25, 1e-12);
+
+        // Overwrite the state and parameters of every cell, then restore them
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            std::vector<double> values(MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES, 0.0);
+            p_model->LoadCheckpointValues(&values[0]);
+            p_model->SetKineticParameters(boost::shared_ptr<MyDeltaNotchParameters>(new MyDeltaNotchParameters));
+        }
+        MyDeltaNotchBulkCheckpoint<2>::Load(cell_population, file_name);
+
+        boost::shared_ptr<MyDeltaNotchParameters> p_restored_parameters;
+        cell_index = 0;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            std::vector<double> values(MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES);
+            p_model->SaveCheckpointValues(&values[0]);
+            for (unsigned i=0; i<MyDeltaNotchSrnModel::NUM_CHECKPOINT_VALUES; i++)
+            {
+                TS_ASSERT_EQUALS(values[i], saved_values[cell_index][i]);
+            }
+            TS_ASSERT_DELTA(p_model->GetDelta(), 0.5 + 0.01*cell_index, 1e-12);
+            TS_ASSERT_DELTA(p_model->GetSimulatedToTime(), 0.25, 1e-12);
+            TS_ASSERT_EQUALS(p_model->GetNumAcceptedOdeSteps(), 10 + cell_index);
+
+            // The cells that shared a parameter set share the restored copy
+            boost::shared_ptr<MyDeltaNotchParameters> p_cell_parameters = p_model->GetKineticParameters();
+            if (cell_index % 2 == 0)
+            {
+                TS_ASSERT(p_cell_parameters);
+                TS_ASSERT_DELTA(p_cell_parameters->k_6, 123.0, 1e-12);
+                if (!p_restored_parameters)
+                {
+                    p_restored_parameters = p_cell_parameters;
+                }
+                TS_ASSERT_EQUALS(p_cell_parameters, p_restored_parameters);
+            }
+            else
+            {
+                TS_ASSERT(!p_cell_parameters);
+            }
+            cell_index++;
+        }
+
+        // A population of new cells, whose IDs are not in the checkpoint, cannot be restored
+        HoneycombVertexMeshGenerator new_generator(3, 3);
+        MutableVertexMesh<2,2>* p_new_mesh = new_generator.GetMesh();
+        std::vector<CellPtr> new_cells;
+        for (unsigned elem_index=0; elem_index<p_new_mesh->GetNumElements(); elem_index++)
+        {
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, new MyDeltaNotchSrnModel));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            new_cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> new_population(*p_new_mesh, new_cells);
+        new_population.InitialiseCells();
+        TS_ASSERT_THROWS_CONTAINS(MyDeltaNotchBulkCheckpoint<2>::Load(new_population, file_name),
+                                  "is not in the checkpoint");
+
+        TS_ASSERT_THROWS_CONTAINS(MyDeltaNotchBulkCheckpoint<2>::Load(cell_population, file_name + ".missing"),
+                                  "Could not open the checkpoint");
+    }
+};
+
+#endif /*TESTMYDELTANOTCHBULKCHECKPOINT_HPP_*/
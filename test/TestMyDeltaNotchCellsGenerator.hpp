@@ -0,0 +1,192 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYDELTANOTCHCELLSGENERATOR_HPP_
+#define TESTMYDELTANOTCHCELLSGENERATOR_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include <vector>
+
+#include "MyDeltaNotchCellsGenerator.hpp"
+#include "MyPhiloxRandomNumberGenerator.hpp"
+#include "Exception.hpp"
+
+/**
+ * Check the counter-based random number generator, and that the random values of
+ * MyDeltaNotchCellsGenerator depend only on the seed and the cell index, not on the
+ * number of threads that draw them.
+ */
+class TestMyDeltaNotchCellsGenerator : public CxxTest::TestSuite
+{
+public:
+
+    void TestPhiloxKnownAnswers()
+    {
+        // Known-answer vectors for Philox4x32-10, from the Random123 distribution
+        uint32_t result[4];
+
+        const uint32_t zero_counter[4] = {0u, 0u, 0u, 0u};
+        const uint32_t zero_key[2] = {0u, 0u};
+        MyPhiloxRandomNumberGenerator::Philox4x32(zero_counter, zero_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x6627e8d5u);
+        TS_ASSERT_EQUALS(result[1], 0xe169c58du);
+        TS_ASSERT_EQUALS(result[2], 0xbc57ac4cu);
+        TS_ASSERT_EQUALS(result[3], 0x9b00dbd8u);
+
+        const uint32_t ones_counter[4] = {0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu};
+        const uint32_t ones_key[2] = {0xffffffffu, 0xffffffffu};
+        MyPhiloxRandomNumberGenerator::Philox4x32(ones_counter, ones_key, result);
+        TS_ASSERT_EQUALS(result[0], 0x408f276du);
+        TS_ASSERT_EQUALS(result[1], 0x41c83b0eu);
+        TS_ASSERT_EQUALS(result[2], 0xa20bc7c6u);
+        TS_ASSERT_EQUALS(result[3], 0x6d5451fdu);
+
+        const uint32_t pi_counter[4] = {0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u};
+        const uint32_t pi_key[2] = {0xa4093822u, 0x299f31d0u};
+        MyPhiloxRandomNumberGenerator::Philox4x32(pi_counter, pi_key, result);
+        TS_ASSERT_EQUALS(result[0], 0xd16cfe09u);
+        TS_ASSERT_EQUALS(result[1], 0x94fdccebu);
+        TS_ASSERT_EQUALS(result[2], 0x5001e420u);
+        TS_ASSERT_EQUALS(result[3], 0x24126ea1u);
+    }
+
+    void TestUniforms()
+    {
+        MyPhiloxRandomNumberGenerator generator(42);
+        const unsigned num_values = 10001; // odd, so the last block is only half used
+
+        std::vector<double> values(num_values);
+        generator.GetUniforms(7, num_values, &values[0]);
+
+        double sum = 0.0;
+        for (unsigned i=0; i<num_values; i++)
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, values[i]);
+            TS_ASSERT_LESS_THAN(values[i], 1.0);
+            TS_ASSERT_EQUALS(generator.GetUniform(7, i), values[i]);
+            sum += values[i];
+        }
+        TS_ASSERT_DELTA(sum/num_values, 0.5, 0.01);
+
+        // A shorter draw is a prefix of a longer one
+        std::vector<double> prefix(3);
+        generator.GetUniforms(7, 3, &prefix[0]);
+        for (unsigned i=0; i<3; i++)
+        {
+            TS_ASSERT_EQUALS(prefix[i], values[i]);
+        }
+
+        // Different streams and different seeds give different values
+        TS_ASSERT_DIFFERS(generator.GetUniform(8, 0), values[0]);
+        MyPhiloxRandomNumberGenerator other_generator(43);
+        TS_ASSERT_DIFFERS(other_generator.GetUniform(7, 0), values[0]);
+
+        // Streams beyond 32 bits are distinct too
+        uint64_t high_stream = (uint64_t(1) << 32) + 7u;
+        TS_ASSERT_DIFFERS(generator.GetUniform(high_stream, 0), values[0]);
+    }
+
+    void TestRandomValuesIndependentOfThreads()
+    {
+        const unsigned num_cells = 1000;
+        const unsigned num_values = 6;
+
+        MyDeltaNotchCellsGenerator generator(1234);
+        TS_ASSERT_DELTA(generator.GetBirthTimeRange(), 0.0, 1e-12);
+        generator.SetBirthTimeRange(12.0);
+        TS_ASSERT_DELTA(generator.GetBirthTimeRange(), 12.0, 1e-12);
+
+        generator.SetNumThreads(1);
+        std::vector<double> initial_conditions;
+        std::vector<double> birth_times;
+        generator.GenerateRandomValues(0, num_cells, initial_conditions, birth_times);
+        TS_ASSERT_EQUALS(initial_conditions.size(), num_values*num_cells);
+        TS_ASSERT_EQUALS(birth_times.size(), num_cells);
+        for (unsigned i=0; i<num_values*num_cells; i++)
+        {
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, initial_conditions[i]);
+            TS_ASSERT_LESS_THAN(initial_conditions[i], 1.0);
+        }
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            TS_ASSERT_LESS_THAN(-12.0, birth_times[cell_index]);
+            TS_ASSERT_LESS_THAN_EQUALS(birth_times[cell_index], 0.0);
+        }
+
+        // The same values are drawn by several threads
+        generator.SetNumThreads(4);
+        std::vector<double> threaded_initial_conditions;
+        std::vector<double> threaded_birth_times;
+        generator.GenerateRandomValues(0, num_cells, threaded_initial_conditions, threaded_birth_times);
+        TS_ASSERT(threaded_initial_conditions == initial_conditions);
+        TS_ASSERT(threaded_birth_times == birth_times);
+
+        // A cell's values do not depend on which other cells are drawn with it
+        std::vector<double> part_initial_conditions;
+        std::vector<double> part_birth_times;
+        generator.GenerateRandomValues(300, 100, part_initial_conditions, part_birth_times);
+        for (unsigned i=0; i<100; i++)
+        {
+            TS_ASSERT_EQUALS(part_birth_times[i], birth_times[300 + i]);
+            for (unsigned var=0; var<num_values; var++)
+            {
+                TS_ASSERT_EQUALS(part_initial_conditions[num_values*i + var], initial_conditions[num_values*(300 + i) + var]);
+            }
+        }
+
+        // Without a birth time range the birth times are all 0, and the initial conditions are unchanged
+        generator.SetBirthTimeRange(0.0);
+        std::vector<double> unset_initial_conditions;
+        std::vector<double> unset_birth_times;
+        generator.GenerateRandomValues(0, num_cells, unset_initial_conditions, unset_birth_times);
+        TS_ASSERT(unset_initial_conditions == initial_conditions);
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            TS_ASSERT_DELTA(unset_birth_times[cell_index], 0.0, 1e-12);
+        }
+
+        // A different seed gives different values
+        MyDeltaNotchCellsGenerator other_generator(1235);
+        std::vector<double> other_initial_conditions;
+        std::vector<double> other_birth_times;
+        other_generator.GenerateRandomValues(0, num_cells, other_initial_conditions, other_birth_times);
+        TS_ASSERT(other_initial_conditions != initial_conditions);
+
+        TS_ASSERT_THROWS_THIS(generator.SetBirthTimeRange(-1.0), "The birth time range must be non-negative.");
+    }
+};
+
+#endif /*TESTMYDELTANOTCHCELLSGENERATOR_HPP_*/
@@ -0,0 +1,203 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHCOLUMNAROUTPUT_HPP_
+#define TESTMYDELTANOTCHCOLUMNAROUTPUT_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchColumnarFile.hpp"
+#include "MyDeltaNotchColumnarOutputModifier.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "OffLatticeSimulation.hpp"
+#include "NagaiHondaForce.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check the columnar binary output of the Delta-Notch fields.
+ */
+class TestMyDeltaNotchColumnarOutput : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestColumnarFile()
+    {
+        OutputFileHandler handler("TestMyDeltaNotchColumnarFile");
+        std::string file_name = handler.GetOutputDirectoryFullPath() + "columns.h5";
+
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchColumnarFile(file_name, 10), "The compression level must be between 0 and 9.");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchColumnarFile(file_name, 1, 0), "The chunk size must be positive.");
+
+        // A small chunk size, so the rows are written in several pieces
+        MyDeltaNotchColumnarFile file(file_name, 6, 4);
+        TS_ASSERT(file.IsOpen());
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchColumnarFile::GetFieldName(0)), "cell_surface_notch");
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchColumnarFile::GetFieldName(5)), "delta");
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchColumnarFile::GetFieldName(8)), "x_distance");
+
+        // Samples of 3, 5 and 2 cells, with field f of cell c of sample s equal to 100*s + 10*f + c
+        const unsigned num_cells[3] = {3, 5, 2};
+        for (unsigned sample=0; sample<3; sample++)
+        {
+            std::vector<unsigned> location_indices(num_cells[sample]);
+            std::vector<double> fields(MyDeltaNotchColumnarFile::NUM_FIELDS*num_cells[sample]);
+            for (unsigned cell=0; cell<num_cells[sample]; cell++)
+            {
+                location_indices[cell] = 7 + cell;
+                for (unsigned field=0; field<MyDeltaNotchColumnarFile::NUM_FIELDS; field++)
+                {
+                    fields[field*num_cells[sample] + cell] = 100.0*sample + 10.0*field + cell;
+                }
+            }
+            file.AppendSample(0.5*sample, location_indices, fields);
+        }
+        TS_ASSERT_EQUALS(file.GetNumSamples(), 3u);
+
+        TS_ASSERT_THROWS_THIS(file.AppendSample(2.0, std::vector<unsigned>(2), std::vector<double>(3)),
+                              "There should be 9 fields for each of the 2 cells.");
+
+        file.Close();
+        TS_ASSERT(!file.IsOpen());
+        TS_ASSERT_THROWS_THIS(file.AppendSample(2.0, std::vector<unsigned>(), std::vector<double>()),
+                              "Cannot append a sample to a closed file.");
+
+        std::vector<double> times = MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, "time");
+        TS_ASSERT_EQUALS(times.size(), 3u);
+        TS_ASSERT_DELTA(times[2], 1.0, 1e-12);
+
+        std::vector<unsigned long> sample_start = MyDeltaNotchColumnarFile::ReadIndexColumn(file_name, "sample_start");
+        TS_ASSERT_EQUALS(sample_start.size(), 3u);
+        TS_ASSERT_EQUALS(sample_start[0], 0u);
+        TS_ASSERT_EQUALS(sample_start[1], 3u);
+        TS_ASSERT_EQUALS(sample_start[2], 8u);
+
+        std::vector<unsigned long> location_indices = MyDeltaNotchColumnarFile::ReadIndexColumn(file_name, "location_index");
+        TS_ASSERT_EQUALS(location_indices.size(), 10u);
+        TS_ASSERT_EQUALS(location_indices[4], 8u);
+
+        for (unsigned field=0; field<MyDeltaNotchColumnarFile::NUM_FIELDS; field++)
+        {
+            std::vector<double> values = MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, MyDeltaNotchColumnarFile::GetFieldName(field));
+            TS_ASSERT_EQUALS(values.size(), 10u);
+            for (unsigned sample=0; sample<3; sample++)
+            {
+                for (unsigned cell=0; cell<num_cells[sample]; cell++)
+                {
+                    TS_ASSERT_DELTA(values[sample_start[sample] + cell], 100.0*sample + 10.0*field + cell, 1e-12);
+                }
+            }
+        }
+
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, "notch"),
+                              "The HDF5 file " + file_name + " has no dataset notch.");
+    }
+
+    void TestColumnarOutputModifier()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, new MyDeltaNotchSrnModel));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        OffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestMyDeltaNotchColumnarOutputModifier");
+        simulator.SetDt(0.01);
+        simulator.SetSamplingTimestepMultiple(5);
+        simulator.SetEndTime(0.1);
+
+        MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_tracking_modifier);
+        p_tracking_modifier->SetExportToCellData(false);
+        simulator.AddSimulationModifier(p_tracking_modifier);
+        MAKE_PTR(MyDeltaNotchColumnarOutputModifier<2>, p_output_modifier);
+        TS_ASSERT_EQUALS(p_output_modifier->GetCompressionLevel(), 1u);
+        TS_ASSERT_THROWS_THIS(p_output_modifier->SetCompressionLevel(10), "The compression level must be between 0 and 9.");
+        simulator.AddSimulationModifier(p_output_modifier);
+        MAKE_PTR(NagaiHondaForce<2>, p_force);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        OutputFileHandler handler("TestMyDeltaNotchColumnarOutputModifier", false);
+        std::string file_name = handler.GetOutputDirectoryFullPath() + "deltanotch.h5";
+
+        // Samples at the start and at each sampling time, with the end of the simulation not repeated
+        std::vector<double> times = MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, "time");
+        TS_ASSERT_EQUALS(times.size(), 3u);
+        TS_ASSERT_DELTA(times[0], 0.0, 1e-12);
+        TS_ASSERT_DELTA(times[2], 0.1, 1e-12);
+
+        // The last sample holds the final state of each cell
+        unsigned num_cells = cell_population.GetNumRealCells();
+        std::vector<double> delta = MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, "delta");
+        std::vector<double> total_notch = MyDeltaNotchColumnarFile::ReadDoubleColumn(file_name, "total_notch");
+        std::vector<unsigned long> location_indices = MyDeltaNotchColumnarFile::ReadIndexColumn(file_name, "location_index");
+        std::vector<unsigned long> sample_start = MyDeltaNotchColumnarFile::ReadIndexColumn(file_name, "sample_start");
+        TS_ASSERT_EQUALS(delta.size(), 3*num_cells);
+        TS_ASSERT_EQUALS(sample_start[2], 2*num_cells);
+
+        for (unsigned row=sample_start[2]; row<delta.size(); row++)
+        {
+            CellPtr p_cell = cell_population.GetCellUsingLocationIndex(location_indices[row]);
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(p_cell->GetSrnModel());
+            TS_ASSERT_DELTA(delta[row], p_model->GetDelta(), 1e-12);
+            double notch = p_model->GetCellSurfaceNotch() + p_model->GetSudxDependentNotch()
+                           + p_model->GetDxDependentEarlyEndosomeNotch() + p_model->GetDxDependentLateEndosomeNotch()
+                           + p_model->GetNotchIntracellularDomain();
+            TS_ASSERT_DELTA(total_notch[row], notch, 1e-12);
+        }
+    }
+};
+
+#endif /*TESTMYDELTANOTCHCOLUMNAROUTPUT_HPP_*/
@@ -0,0 +1,301 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHFROZENTISSUE_HPP_
+#define TESTMYDELTANOTCHFROZENTISSUE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchFrozenTissueSimulation.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "MyDeltaNotchTestPopulation.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that solving Delta-Notch signalling on a frozen tissue agrees with the full simulator.
+ */
+class TestMyDeltaNotchFrozenTissue : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * @param rGenerator the mesh generator, which must outlive the population
+     * @return a population whose SRN models use the default solver, with a small timestep
+     */
+    boost::shared_ptr<VertexBasedCellPopulation<2> > CreatePopulation(HoneycombVertexMeshGenerator& rGenerator)
+    {
+        return CreateMyDeltaNotchTestPopulation(rGenerator, boost::shared_ptr<AbstractCellCycleModelOdeSolver>(), 1e-4);
+    }
+
+    /**
+     * @param rCellPopulation a cell population
+     * @return the level of Delta in each cell, in the order of the population's iterator.
+     */
+    std::vector<double> GetDelta(AbstractCellPopulation<2>& rCellPopulation)
+    {
+        std::vector<double> delta;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = rCellPopulation.Begin();
+             cell_iter != rCellPopulation.End();
+             ++cell_iter)
+        {
+            delta.push_back(static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel())->GetDelta());
+        }
+        return delta;
+    }
+
+public:
+
+    void TestFrozenTissueMatchesFullSimulation()
+    {
+        const unsigned num_steps = 10;
+        const double dt = 0.01;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(num_steps*dt, num_steps);
+
+        HoneycombVertexMeshGenerator full_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_full_population = CreatePopulation(full_generator);
+        HoneycombVertexMeshGenerator frozen_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_frozen_population = CreatePopulation(frozen_generator);
+        MyDeltaNotchFrozenTissueSimulation<2> frozen_tissue(*p_frozen_population);
+
+        // Advance one population with the modifier, as the full simulator would with a static tissue
+        MyDeltaNotchTrackingModifier<2> modifier;
+        modifier.SetUseBatchIntegration(true);
+        modifier.SetupSolve(*p_full_population, "unused");
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            modifier.UpdateAtEndOfTimeStep(*p_full_population);
+        }
+
+        // Solve the other population as a frozen tissue, holding the coupling fixed over each timestep
+        TS_ASSERT_EQUALS(frozen_tissue.GetNumCells(), 25u);
+        TS_ASSERT_DELTA(frozen_tissue.GetCouplingTimestep(), 0.0, 1e-12);
+        TS_ASSERT_THROWS_THIS(frozen_tissue.SetCouplingTimestep(-1.0), "The coupling timestep must be non-negative.");
+        frozen_tissue.SetCouplingTimestep(dt);
+
+        // Output may be written part way through, as the SRN models are updated by each call
+        frozen_tissue.Solve(0.5*num_steps*dt);
+        TS_ASSERT_DELTA(frozen_tissue.GetTime(), 0.5*num_steps*dt, 1e-12);
+        TS_ASSERT_DELTA(static_cast<MyDeltaNotchSrnModel*>(p_frozen_population->Begin()->GetSrnModel())->GetSimulatedToTime(),
+                        0.5*num_steps*dt, 1e-12);
+        frozen_tissue.Solve(num_steps*dt);
+        TS_ASSERT_THROWS_THIS(frozen_tissue.Solve(0.0), "Cannot solve a frozen tissue back to time 0 from time 0.1.");
+
+        std::vector<double> full_delta = GetDelta(*p_full_population);
+        std::vector<double> frozen_delta = GetDelta(*p_frozen_population);
+        TS_ASSERT_EQUALS(frozen_delta.size(), full_delta.size());
+        for (unsigned i=0; i<full_delta.size(); i++)
+        {
+            TS_ASSERT_DELTA(frozen_delta[i], full_delta[i], 1e-10*(1.0 + fabs(full_delta[i])));
+        }
+
+        // The frozen tissue's inputs are visible through the SRN models, as for the full simulator
+        for (AbstractCellPopulation<2>::Iterator cell_iter = p_frozen_population->Begin();
+             cell_iter != p_frozen_population->End();
+             ++cell_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            TS_ASSERT(p_model->GetStateStore());
+            TS_ASSERT_LESS_THAN_EQUALS(0.0, p_model->GetStateStore()->rGetXDistance()[p_model->GetStateStoreIndex()]);
+        }
+    }
+
+    void TestFullyCoupledFrozenTissue()
+    {
+        const double end_time = 0.1;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(end_time, 10);
+
+        // Solve the tissue as one coupled system, and with the coupling held over two different timesteps
+        std::vector<double> coupling_timesteps;
+        coupling_timesteps.push_back(0.0);
+        coupling_timesteps.push_back(0.01);
+        coupling_timesteps.push_back(0.001);
+        std::vector<std::vector<double> > delta;
+        for (unsigned i=0; i<coupling_timesteps.size(); i++)
+        {
+            HoneycombVertexMeshGenerator generator(5, 5);
+            boost::shared_ptr<VertexBasedCellPopulation<2> > p_population = CreatePopulation(generator);
+            MyDeltaNotchFrozenTissueSimulation<2> frozen_tissue(*p_population);
+            frozen_tissue.SetCouplingTimestep(coupling_timesteps[i]);
+            frozen_tissue.Solve(end_time);
+            delta.push_back(GetDelta(*p_population));
+        }
+
+        // Holding the coupling fixed is a first-order splitting, which converges to the coupled solution
+        double coarse_error = 0.0;
+        double fine_error = 0.0;
+        for (unsigned cell=0; cell<delta[0].size(); cell++)
+        {
+            coarse_error = std::max(coarse_error, fabs(delta[1][cell] - delta[0][cell]));
+            fine_error = std::max(fine_error, fabs(delta[2][cell] - delta[0][cell]));
+        }
+        TS_ASSERT_LESS_THAN(fine_error, coarse_error);
+        TS_ASSERT_LESS_THAN(fine_error, 1e-3);
+    }
+
+    void TestImplicitlyCoupledTissue()
+    {
+        const unsigned num_steps = 10;
+        const double dt = 0.01;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(num_steps*dt, num_steps);
+
+        // A reference solution of the coupled system with the explicit solver
+        HoneycombVertexMeshGenerator reference_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_reference_population = CreatePopulation(reference_generator);
+        MyDeltaNotchFrozenTissueSimulation<2> reference_tissue(*p_reference_population);
+        reference_tissue.Solve(num_steps*dt);
+        std::vector<double> reference_delta = GetDelta(*p_reference_population);
+
+        // The implicit solver takes steps a hundred times larger than the SRN models' ODE timestep
+        HoneycombVertexMeshGenerator frozen_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_frozen_population = CreatePopulation(frozen_generator);
+        MyDeltaNotchFrozenTissueSimulation<2> frozen_tissue(*p_frozen_population);
+        TS_ASSERT_DELTA(frozen_tissue.GetImplicitTimestep(), 0.0, 1e-12);
+        TS_ASSERT_THROWS_THIS(frozen_tissue.SetImplicitTimestep(-1.0), "The implicit timestep must be non-negative.");
+        frozen_tissue.SetImplicitTimestep(dt);
+        TS_ASSERT_DELTA(frozen_tissue.GetImplicitTimestep(), dt, 1e-12);
+        frozen_tissue.Solve(num_steps*dt);
+        std::vector<double> frozen_delta = GetDelta(*p_frozen_population);
+
+        // The modifier can do the same in a full simulation, once per timestep
+        HoneycombVertexMeshGenerator full_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_full_population = CreatePopulation(full_generator);
+        MyDeltaNotchTrackingModifier<2> modifier;
+        TS_ASSERT_DELTA(modifier.GetImplicitTimestep(), 0.0, 1e-12);
+        TS_ASSERT_THROWS_THIS(modifier.SetImplicitTimestep(-1.0), "The implicit timestep must be non-negative.");
+        modifier.SetImplicitTimestep(dt);
+        TS_ASSERT_DELTA(modifier.GetImplicitTimestep(), dt, 1e-12);
+        modifier.SetupSolve(*p_full_population, "unused");
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            modifier.UpdateAtEndOfTimeStep(*p_full_population);
+        }
+        std::vector<double> full_delta = GetDelta(*p_full_population);
+        TS_ASSERT_DELTA(static_cast<MyDeltaNotchSrnModel*>(p_full_population->Begin()->GetSrnModel())->GetSimulatedToTime(),
+                        num_steps*dt, 1e-12);
+
+        TS_ASSERT_EQUALS(frozen_delta.size(), reference_delta.size());
+        TS_ASSERT_EQUALS(full_delta.size(), reference_delta.size());
+        // The topology does not change, so the modifier keeps the BDF2 history from one timestep to the next
+        for (unsigned i=0; i<reference_delta.size(); i++)
+        {
+            TS_ASSERT_DELTA(frozen_delta[i], reference_delta[i], 2e-2*(1.0 + fabs(reference_delta[i])));
+            TS_ASSERT_DELTA(full_delta[i], reference_delta[i], 2e-2*(1.0 + fabs(reference_delta[i])));
+        }
+    }
+
+    void TestSteadyStateOfTissue()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 100);
+
+        HoneycombVertexMeshGenerator generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_population = CreatePopulation(generator);
+        MyDeltaNotchFrozenTissueSimulation<2> frozen_tissue(*p_population);
+        TS_ASSERT_THROWS_THIS(frozen_tissue.SolveToSteadyState(-1.0), "The pre-integration time must be non-negative.");
+
+        // Only the pre-integration advances the tissue in time
+        frozen_tissue.SetImplicitTimestep(0.1);
+        TS_ASSERT(frozen_tissue.SolveToSteadyState(1.0));
+        TS_ASSERT(frozen_tissue.rGetSteadyStateSolver().HasConverged());
+        TS_ASSERT_LESS_THAN_EQUALS(frozen_tissue.rGetSteadyStateSolver().GetResidualNorm(),
+                                   frozen_tissue.rGetSteadyStateSolver().GetResidualTolerance());
+        TS_ASSERT_DELTA(frozen_tissue.GetTime(), 1.0, 1e-12);
+        TS_ASSERT_DELTA(static_cast<MyDeltaNotchSrnModel*>(p_population->Begin()->GetSrnModel())->GetSimulatedToTime(),
+                        1.0, 1e-12);
+        std::vector<double> steady_delta = GetDelta(*p_population);
+
+        // The tissue stays there
+        frozen_tissue.Solve(11.0);
+        std::vector<double> later_delta = GetDelta(*p_population);
+        TS_ASSERT_EQUALS(later_delta.size(), steady_delta.size());
+        for (unsigned i=0; i<steady_delta.size(); i++)
+        {
+            TS_ASSERT_DELTA(later_delta[i], steady_delta[i], 1e-6*(1.0 + fabs(steady_delta[i])));
+        }
+    }
+
+    void TestSinglePrecisionBatchIntegration()
+    {
+        const unsigned num_steps = 10;
+        const double dt = 0.01;
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(num_steps*dt, num_steps);
+
+        // Advance two copies of a tissue with batch integration, in double and in single precision
+        HoneycombVertexMeshGenerator double_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_double_population = CreatePopulation(double_generator);
+        HoneycombVertexMeshGenerator single_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_single_population = CreatePopulation(single_generator);
+
+        MyDeltaNotchTrackingModifier<2> double_modifier;
+        double_modifier.SetUseBatchIntegration(true);
+        MyDeltaNotchTrackingModifier<2> single_modifier;
+        single_modifier.SetUseBatchIntegration(true);
+        TS_ASSERT(!single_modifier.GetUseSinglePrecision());
+        single_modifier.SetUseSinglePrecision(true);
+        TS_ASSERT(single_modifier.GetUseSinglePrecision());
+        single_modifier.rGetSinglePrecisionBatchSolver().SetPrecisionCheck(5, 2);
+
+        double_modifier.SetupSolve(*p_double_population, "unused");
+        single_modifier.SetupSolve(*p_single_population, "unused");
+        for (unsigned step=0; step<num_steps; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            double_modifier.UpdateAtEndOfTimeStep(*p_double_population);
+            single_modifier.UpdateAtEndOfTimeStep(*p_single_population);
+        }
+
+        std::vector<double> double_delta = GetDelta(*p_double_population);
+        std::vector<double> single_delta = GetDelta(*p_single_population);
+        for (unsigned i=0; i<double_delta.size(); i++)
+        {
+            TS_ASSERT_DELTA(single_delta[i], double_delta[i], 1e-4*(1.0 + fabs(double_delta[i])));
+        }
+
+        // The precision check was made on every other timestep
+        const MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver& r_solver = single_modifier.rGetSinglePrecisionBatchSolver();
+        TS_ASSERT_EQUALS(r_solver.GetNumPrecisionChecks(), num_steps/2);
+        TS_ASSERT_LESS_THAN(0.0, r_solver.GetMaxDeviation());
+        TS_ASSERT_LESS_THAN(r_solver.GetMaxDeviation(), 1e-4);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHFROZENTISSUE_HPP_*/
@@ -0,0 +1,220 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHMULTIRATECOUPLING_HPP_
+#define TESTMYDELTANOTCHMULTIRATECOUPLING_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "CellCycleModelOdeSolver.hpp"
+#include "MyDeltaNotchTestPopulation.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that the neighbour coupling of the Delta-Notch model can be refreshed
+ * at its own rate, independently of the simulation timestep.
+ */
+class TestMyDeltaNotchMultiRateCoupling : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Create a population as CreateMyDeltaNotchTestPopulation() does, whose SRN models are solved
+     * with MyRosenbrockIvpOdeSolver.
+     *
+     * @param rGenerator the mesh generator, which must outlive the population
+     * @return the population
+     */
+    boost::shared_ptr<VertexBasedCellPopulation<2> > CreatePopulation(HoneycombVertexMeshGenerator& rGenerator)
+    {
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver =
+            CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance();
+        if (!p_solver->IsSetUp())
+        {
+            p_solver->Initialise();
+        }
+        return CreateMyDeltaNotchTestPopulation(rGenerator, p_solver, 0.01);
+    }
+
+public:
+
+    void TestMeanDeltaRate()
+    {
+        MyDeltaNotchOdeSystem ode_system;
+        ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.5);
+        TS_ASSERT_EQUALS(ode_system.GetMeanDeltaRate(), 0.0);
+        TS_ASSERT_EQUALS(ode_system.GetMeanDeltaAtTime(7.0), 0.5);
+
+        ode_system.SetMeanDeltaRate(0.2, 1.0);
+        TS_ASSERT_EQUALS(ode_system.GetMeanDeltaRate(), 0.2);
+        TS_ASSERT_DELTA(ode_system.GetMeanDeltaAtTime(1.0), 0.5, 1e-12);
+        TS_ASSERT_DELTA(ode_system.GetMeanDeltaAtTime(2.0), 0.7, 1e-12);
+
+        // The input is a concentration, so is never extrapolated below zero
+        TS_ASSERT_EQUALS(ode_system.GetMeanDeltaAtTime(-10.0), 0.0);
+
+        // The RHS sees the input at the time at which it is evaluated
+        MyDeltaNotchOdeSystem constant_ode_system;
+        constant_ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, ode_system.GetMeanDeltaAtTime(2.0));
+        std::vector<double> y = ode_system.GetInitialConditions();
+        std::vector<double> dy(6);
+        std::vector<double> constant_dy(6);
+        ode_system.EvaluateYDerivatives(2.0, y, dy);
+        constant_ode_system.EvaluateYDerivatives(2.0, y, constant_dy);
+        for (unsigned i=0; i<6; i++)
+        {
+            TS_ASSERT_EQUALS(dy[i], constant_dy[i]);
+        }
+    }
+
+    void TestSrnModelReadsRateFromStore()
+    {
+        boost::shared_ptr<MyDeltaNotchStateStore> p_store(new MyDeltaNotchStateStore(2));
+        TS_ASSERT_EQUALS(p_store->rGetMeanDeltaRate().size(), 2u);
+        TS_ASSERT_EQUALS(p_store->GetCouplingTime(), 0.0);
+        p_store->rGetMeanDelta()[1] = 0.4;
+        p_store->rGetMeanDeltaRate()[1] = -0.1;
+        p_store->SetCouplingTime(3.0);
+        p_store->Resize(3);
+        TS_ASSERT_EQUALS(p_store->rGetMeanDeltaRate()[1], -0.1);
+        TS_ASSERT_EQUALS(p_store->rGetMeanDeltaRate()[2], 0.0);
+
+        MyDeltaNotchSrnModel srn_model;
+        srn_model.Initialise();
+        srn_model.SetStateStore(p_store, 1);
+        srn_model.UpdateDeltaNotch();
+        TS_ASSERT_EQUALS(srn_model.GetMeanNeighbouringDelta(), 0.4);
+
+        const MyDeltaNotchOdeSystem* p_ode_system = static_cast<const MyDeltaNotchOdeSystem*>(srn_model.GetOdeSystem());
+        TS_ASSERT_EQUALS(p_ode_system->GetMeanDeltaRate(), -0.1);
+        TS_ASSERT_DELTA(p_ode_system->GetMeanDeltaAtTime(5.0), 0.2, 1e-12);
+    }
+
+    void TestSignallingTimestepEqualToTimestep()
+    {
+        MyDeltaNotchTrackingModifier<2> modifier;
+        TS_ASSERT_EQUALS(modifier.GetSignallingTimestep(), 0.0);
+        TS_ASSERT_EQUALS(modifier.GetInterpolateCoupling(), true);
+        TS_ASSERT_THROWS_THIS(modifier.SetSignallingTimestep(-1.0), "The signalling timestep must be non-negative.");
+
+        // Without extrapolation, refreshing the coupling once per timestep is the usual scheme
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.2, 4);
+
+        HoneycombVertexMeshGenerator multi_rate_generator(4, 4);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_multi_rate_population = CreatePopulation(multi_rate_generator);
+        HoneycombVertexMeshGenerator single_rate_generator(4, 4);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_single_rate_population = CreatePopulation(single_rate_generator);
+
+        modifier.SetSignallingTimestep(0.05);
+        modifier.SetInterpolateCoupling(false);
+        MyDeltaNotchTrackingModifier<2> single_rate_modifier;
+        single_rate_modifier.SetUseParallelIntegration(true);
+
+        modifier.SetupSolve(*p_multi_rate_population, "unused");
+        single_rate_modifier.SetupSolve(*p_single_rate_population, "unused");
+        for (unsigned step=0; step<4; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            modifier.UpdateAtEndOfTimeStep(*p_multi_rate_population);
+            single_rate_modifier.UpdateAtEndOfTimeStep(*p_single_rate_population);
+        }
+
+        AbstractCellPopulation<2>::Iterator single_rate_iter = p_single_rate_population->Begin();
+        for (AbstractCellPopulation<2>::Iterator cell_iter = p_multi_rate_population->Begin();
+             cell_iter != p_multi_rate_population->End();
+             ++cell_iter, ++single_rate_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            MyDeltaNotchSrnModel* p_single_rate_model = static_cast<MyDeltaNotchSrnModel*>(single_rate_iter->GetSrnModel());
+            TS_ASSERT_DELTA(p_model->GetSimulatedToTime(), 0.2, 1e-12);
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_EQUALS(p_model->rGetStateVariables()[var], p_single_rate_model->rGetStateVariables()[var]);
+            }
+        }
+    }
+
+    void TestFinerSignallingTimestep()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.2, 2);
+
+        HoneycombVertexMeshGenerator generator(4, 4);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_population = CreatePopulation(generator);
+
+        // Refresh the coupling four times per timestep
+        MyDeltaNotchTrackingModifier<2> modifier;
+        modifier.SetSignallingTimestep(0.025);
+        modifier.SetupSolve(*p_population, "unused");
+        boost::shared_ptr<MyDeltaNotchStateStore> p_store = modifier.GetStateStore();
+        TS_ASSERT_DELTA(p_store->GetCouplingTime(), 0.0, 1e-12);
+
+        SimulationTime::Instance()->IncrementTimeOneStep();
+        modifier.UpdateAtEndOfTimeStep(*p_population);
+
+        // Every cell has reached the current time, and the coupling was last refreshed at the start of the last stage
+        TS_ASSERT_DELTA(p_store->GetCouplingTime(), 0.075, 1e-12);
+        for (AbstractCellPopulation<2>::Iterator cell_iter = p_population->Begin();
+             cell_iter != p_population->End();
+             ++cell_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            TS_ASSERT_DELTA(p_model->GetSimulatedToTime(), 0.1, 1e-12);
+        }
+
+        // The mean neighbouring Delta is extrapolated from its last two values
+        bool any_rate_nonzero = false;
+        for (unsigned i=0; i<p_store->GetNumLocations(); i++)
+        {
+            any_rate_nonzero = any_rate_nonzero || (p_store->rGetMeanDeltaRate()[i] != 0.0);
+        }
+        TS_ASSERT(any_rate_nonzero);
+
+        // Lazy calls from the simulation now do nothing
+        MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(p_population->Begin()->GetSrnModel());
+        double delta = p_model->GetDelta();
+        p_model->SimulateToCurrentTime();
+        TS_ASSERT_EQUALS(p_model->GetDelta(), delta);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHMULTIRATECOUPLING_HPP_*/
@@ -0,0 +1,195 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHNEIGHBOURGRAPH_HPP_
+#define TESTMYDELTANOTCHNEIGHBOURGRAPH_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include <cmath>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "CellsGenerator.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "NoCellCycleModel.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that the cached CSR neighbour relation matches the population's own
+ * neighbour sets, and that it is only rebuilt when the topology changes.
+ */
+class TestMyDeltaNotchNeighbourGraph : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestBuildAndNeighbourMeans()
+    {
+        // A path 7 - 3 - 5, with an isolated cell at location 2
+        std::vector<unsigned> location_indices;
+        location_indices.push_back(3);
+        location_indices.push_back(7);
+        location_indices.push_back(5);
+        location_indices.push_back(2);
+        std::vector<std::set<unsigned> > neighbour_location_indices(4);
+        neighbour_location_indices[0].insert(7);
+        neighbour_location_indices[0].insert(5);
+        neighbour_location_indices[1].insert(3);
+        neighbour_location_indices[2].insert(3);
+
+        MyDeltaNotchNeighbourGraph graph;
+        TS_ASSERT_EQUALS(graph.GetNumCells(), 0u);
+        TS_ASSERT_EQUALS(graph.GetNumLocations(), 0u);
+        graph.Build(location_indices, neighbour_location_indices);
+        TS_ASSERT_EQUALS(graph.GetNumCells(), 4u);
+        TS_ASSERT_EQUALS(graph.GetNumLocations(), 8u);
+        TS_ASSERT_EQUALS(graph.GetNumRebuilds(), 1u);
+
+        TS_ASSERT_EQUALS(graph.rGetRowOffsets().size(), 5u);
+        TS_ASSERT_EQUALS(graph.rGetRowOffsets()[4], 4u);
+        TS_ASSERT_EQUALS(graph.rGetNeighbours()[0], 2u); // location 5 is in row 2
+        TS_ASSERT_EQUALS(graph.rGetNeighbours()[1], 1u); // location 7 is in row 1
+        TS_ASSERT_EQUALS(graph.rGetInverseDegrees()[0], 0.5);
+        TS_ASSERT_EQUALS(graph.rGetInverseDegrees()[3], 0.0);
+
+        std::vector<double> values;
+        values.push_back(1.0);
+        values.push_back(2.0);
+        values.push_back(4.0);
+        values.push_back(8.0);
+        std::vector<double> means;
+        graph.ComputeNeighbourMeans(values, means);
+        TS_ASSERT_EQUALS(means.size(), 4u);
+        TS_ASSERT_DELTA(means[0], 3.0, 1e-12);
+        TS_ASSERT_DELTA(means[1], 1.0, 1e-12);
+        TS_ASSERT_DELTA(means[2], 1.0, 1e-12);
+        TS_ASSERT_DELTA(means[3], 0.0, 1e-12);
+
+        // Every neighbour must be a cell in the graph
+        neighbour_location_indices[3].insert(11);
+        TS_ASSERT_THROWS_THIS(graph.Build(location_indices, neighbour_location_indices),
+                              "Location index 11 is a neighbour of a cell but is not occupied by a cell.");
+    }
+
+    void TestNeighbourMeansDoNotDependOnNumberOfThreads()
+    {
+        // A ring of cells, each with five neighbours on either side, whose Delta levels vary over many orders of magnitude
+        const unsigned num_cells = 1000;
+        std::vector<unsigned> location_indices(num_cells);
+        std::vector<std::set<unsigned> > neighbour_location_indices(num_cells);
+        std::vector<double> values(num_cells);
+        for (unsigned row=0; row<num_cells; row++)
+        {
+            location_indices[row] = (7*row) % num_cells;
+            for (unsigned offset=1; offset<=5; offset++)
+            {
+                neighbour_location_indices[row].insert((7*(row + offset)) % num_cells);
+                neighbour_location_indices[row].insert((7*(row + num_cells - offset)) % num_cells);
+            }
+            values[row] = pow(10.0, (double)(row % 17) - 8.0) / (1.0 + row);
+        }
+
+        MyDeltaNotchNeighbourGraph graph;
+        graph.Build(location_indices, neighbour_location_indices);
+
+        std::vector<double> serial_means;
+        graph.ComputeNeighbourMeans(values, serial_means, 1);
+
+        // The means are bit-identical, not just close, for any number of threads
+        for (unsigned num_threads=0; num_threads<=8; num_threads++)
+        {
+            std::vector<double> means;
+            graph.ComputeNeighbourMeans(values, means, num_threads);
+            TS_ASSERT_EQUALS(means.size(), num_cells);
+            for (unsigned row=0; row<num_cells; row++)
+            {
+                TS_ASSERT_EQUALS(means[row], serial_means[row]);
+            }
+        }
+    }
+
+    void TestGraphIsOnlyRebuiltWhenTopologyChanges()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        CellsGenerator<NoCellCycleModel, 2> cells_generator;
+        cells_generator.GenerateBasic(cells, p_mesh->GetNumElements());
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MyDeltaNotchNeighbourGraph graph;
+        TS_ASSERT_EQUALS(graph.Update(cell_population), true);
+        TS_ASSERT_EQUALS(graph.GetNumCells(), cell_population.GetNumRealCells());
+
+        // Each row matches the population's own neighbour set
+        unsigned row = 0;
+        for (AbstractCellPopulation<2>::Iterator cell_iter = cell_population.Begin();
+             cell_iter != cell_population.End();
+             ++cell_iter, ++row)
+        {
+            std::set<unsigned> neighbour_indices = cell_population.GetNeighbouringLocationIndices(*cell_iter);
+            TS_ASSERT_EQUALS(graph.rGetLocationIndices()[row], cell_population.GetLocationIndexUsingCell(*cell_iter));
+            TS_ASSERT_EQUALS(graph.rGetRowOffsets()[row+1] - graph.rGetRowOffsets()[row], neighbour_indices.size());
+            for (unsigned k=graph.rGetRowOffsets()[row]; k<graph.rGetRowOffsets()[row+1]; k++)
+            {
+                unsigned neighbour_location_index = graph.rGetLocationIndices()[graph.rGetNeighbours()[k]];
+                TS_ASSERT_EQUALS(neighbour_indices.count(neighbour_location_index), 1u);
+            }
+        }
+
+        // Nothing has changed, so the graph is not rebuilt
+        TS_ASSERT_EQUALS(graph.Update(cell_population), false);
+        TS_ASSERT_EQUALS(graph.GetNumRebuilds(), 1u);
+
+        // unless this is forced
+        graph.MarkTopologyChanged();
+        TS_ASSERT_EQUALS(graph.Update(cell_population), true);
+        TS_ASSERT_EQUALS(graph.GetNumRebuilds(), 2u);
+
+        // Removing a cell changes the topology
+        cell_population.GetCellUsingLocationIndex(5)->Kill();
+        cell_population.RemoveDeadCells();
+        cell_population.Update();
+        TS_ASSERT_EQUALS(graph.Update(cell_population), true);
+        TS_ASSERT_EQUALS(graph.GetNumRebuilds(), 3u);
+        TS_ASSERT_EQUALS(graph.GetNumCells(), cell_population.GetNumRealCells());
+        TS_ASSERT_EQUALS(graph.Update(cell_population), false);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHNEIGHBOURGRAPH_HPP_*/
@@ -0,0 +1,143 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHOBJECTPOOL_HPP_
+#define TESTMYDELTANOTCHOBJECTPOOL_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <set>
+
+#include "MyDeltaNotchObjectPool.hpp"
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check the pooled allocation of Delta-Notch SRN models and ODE systems.
+ */
+class TestMyDeltaNotchObjectPool : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestObjectPool()
+    {
+        MyDeltaNotchObjectPool pool(40, 4);
+        TS_ASSERT_EQUALS(pool.GetObjectSize(), 40u);
+        TS_ASSERT_EQUALS(pool.GetNumSlabs(), 0u);
+
+        // Blocks are carved in order from slabs of four
+        std::vector<void*> blocks;
+        for (unsigned i=0; i<6; i++)
+        {
+            blocks.push_back(pool.Allocate(40));
+        }
+        TS_ASSERT_EQUALS(pool.GetNumAllocated(), 6u);
+        TS_ASSERT_EQUALS(pool.GetNumSlabs(), 2u);
+        TS_ASSERT_EQUALS(pool.GetCapacity(), 2*4*48u);
+        for (unsigned i=1; i<4; i++)
+        {
+            TS_ASSERT_EQUALS(static_cast<char*>(blocks[i]) - static_cast<char*>(blocks[i-1]), 48);
+        }
+        std::set<void*> distinct_blocks(blocks.begin(), blocks.end());
+        TS_ASSERT_EQUALS(distinct_blocks.size(), 6u);
+
+        // Freed blocks are reused, most recently freed first, without growing the pool
+        pool.Deallocate(blocks[1], 40);
+        pool.Deallocate(blocks[4], 40);
+        TS_ASSERT_EQUALS(pool.GetNumAllocated(), 4u);
+        TS_ASSERT_EQUALS(pool.Allocate(40), blocks[4]);
+        TS_ASSERT_EQUALS(pool.Allocate(40), blocks[1]);
+        TS_ASSERT_EQUALS(pool.GetNumSlabs(), 2u);
+
+        // Objects of another size are not pooled
+        void* p_other = pool.Allocate(100);
+        TS_ASSERT_EQUALS(pool.GetNumAllocated(), 6u);
+        pool.Deallocate(p_other, 100);
+        pool.Deallocate(NULL, 40);
+        TS_ASSERT_EQUALS(pool.GetNumAllocated(), 6u);
+    }
+
+    void TestPooledOdeSystems()
+    {
+        MyDeltaNotchObjectPool& r_pool = MyDeltaNotchOdeSystem::rGetObjectPool();
+        TS_ASSERT_EQUALS(r_pool.GetObjectSize(), sizeof(MyDeltaNotchOdeSystem));
+        unsigned long num_allocated = r_pool.GetNumAllocated();
+
+        AbstractOdeSystem* p_system = new MyDeltaNotchOdeSystem;
+        MyDeltaNotchOdeSystem* p_other_system = new MyDeltaNotchOdeSystem;
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated + 2);
+
+        // The systems share their information, including the default initial conditions
+        TS_ASSERT_EQUALS(p_system->GetSystemInformation(), p_other_system->GetSystemInformation());
+        std::vector<double> initial_conditions = p_system->GetInitialConditions();
+        TS_ASSERT_EQUALS(initial_conditions.size(), 6u);
+        TS_ASSERT_DELTA(initial_conditions[5], 1.0, 1e-12);
+        TS_ASSERT_DELTA(p_other_system->GetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA), 0.5, 1e-12);
+
+        // Deleting through the base class returns the memory to the pool
+        delete p_system;
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated + 1);
+        delete p_other_system;
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated);
+    }
+
+    void TestPooledSrnModels()
+    {
+        MyDeltaNotchObjectPool& r_pool = MyDeltaNotchSrnModel::rGetObjectPool();
+        MyDeltaNotchObjectPool& r_ode_pool = MyDeltaNotchOdeSystem::rGetObjectPool();
+        unsigned long num_allocated = r_pool.GetNumAllocated();
+        unsigned long num_ode_allocated = r_ode_pool.GetNumAllocated();
+
+        MyDeltaNotchSrnModel* p_model = new MyDeltaNotchSrnModel;
+        p_model->Initialise();
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated + 1);
+        TS_ASSERT_EQUALS(r_ode_pool.GetNumAllocated(), num_ode_allocated + 1);
+
+        // As on division, the copy and its ODE system come from the pools
+        AbstractSrnModel* p_copy = p_model->CreateSrnModel();
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated + 2);
+        TS_ASSERT_EQUALS(r_ode_pool.GetNumAllocated(), num_ode_allocated + 2);
+
+        delete p_copy;
+        delete p_model;
+        TS_ASSERT_EQUALS(r_pool.GetNumAllocated(), num_allocated);
+        TS_ASSERT_EQUALS(r_ode_pool.GetNumAllocated(), num_ode_allocated);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHOBJECTPOOL_HPP_*/
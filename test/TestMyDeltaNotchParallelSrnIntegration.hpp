@@ -0,0 +1,199 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHPARALLELSRNINTEGRATION_HPP_
+#define TESTMYDELTANOTCHPARALLELSRNINTEGRATION_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "CellCycleModelOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "MyDeltaNotchTestPopulation.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "NoCellCycleModel.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that SRN models advanced with their own solvers, as done by
+ * MyDeltaNotchTrackingModifier::SimulateSrnModelsInParallel(), give exactly
+ * the same results as when they are advanced lazily with the shared solver.
+ */
+class TestMyDeltaNotchParallelSrnIntegration : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestUnsharedSolversMatchSharedSolvers()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.1, 1);
+
+        boost::shared_ptr<MyDeltaNotchStateStore> p_store(new MyDeltaNotchStateStore(1));
+        p_store->rGetMeanDelta()[0] = 0.5;
+        p_store->rGetXDistance()[0] = 2.0;
+
+        std::vector<boost::shared_ptr<AbstractCellCycleModelOdeSolver> > shared_solvers;
+        std::vector<double> dts;
+        shared_solvers.push_back(CellCycleModelOdeSolver<MyDeltaNotchSrnModel, RungeKutta4IvpOdeSolver>::Instance());
+        dts.push_back(1e-4);
+        shared_solvers.push_back(CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance());
+        dts.push_back(0.01);
+        shared_solvers.push_back(CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyDormandPrinceIvpOdeSolver>::Instance());
+        dts.push_back(0.1);
+        shared_solvers.push_back(CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyFixedSizeRungeKutta4IvpOdeSolver6>::Instance());
+        dts.push_back(1e-4);
+
+        std::vector<double> initial_conditions;
+        initial_conditions.push_back(0.9);
+        initial_conditions.push_back(0.1);
+        initial_conditions.push_back(0.2);
+        initial_conditions.push_back(0.3);
+        initial_conditions.push_back(0.4);
+        initial_conditions.push_back(0.6);
+
+        std::vector<MyDeltaNotchSrnModel*> shared_models;
+        std::vector<MyDeltaNotchSrnModel*> unshared_models;
+        for (unsigned i=0; i<shared_solvers.size(); i++)
+        {
+            if (!shared_solvers[i]->IsSetUp())
+            {
+                shared_solvers[i]->Initialise();
+            }
+            for (unsigned copy=0; copy<2; copy++)
+            {
+                MyDeltaNotchSrnModel* p_model = new MyDeltaNotchSrnModel(shared_solvers[i]);
+                p_model->SetInitialConditions(initial_conditions);
+                p_model->SetDt(dts[i]);
+                p_model->Initialise();
+                p_model->SetStateStore(p_store, 0);
+                (copy == 0 ? shared_models : unshared_models).push_back(p_model);
+            }
+        }
+
+        SimulationTime::Instance()->IncrementTimeOneStep();
+
+        for (unsigned i=0; i<shared_solvers.size(); i++)
+        {
+            TS_ASSERT_EQUALS(shared_models[i]->GetOdeSolver(), shared_solvers[i]);
+            shared_models[i]->SimulateToCurrentTime();
+
+            boost::shared_ptr<AbstractIvpOdeSolver> p_solver = unshared_models[i]->CreateUnsharedOdeSolver();
+            unshared_models[i]->SimulateToCurrentTime(*p_solver);
+            TS_ASSERT_DELTA(unshared_models[i]->GetSimulatedToTime(), 0.1, 1e-12);
+
+            // Bit-identical, since the solvers are of the same type and do the same arithmetic
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_EQUALS(unshared_models[i]->rGetStateVariables()[var], shared_models[i]->rGetStateVariables()[var]);
+            }
+            TS_ASSERT_DIFFERS(unshared_models[i]->GetDelta(), initial_conditions[5]);
+
+            // Once at the current time, further calls do nothing
+            unshared_models[i]->SimulateToCurrentTime(*p_solver);
+            TS_ASSERT_EQUALS(unshared_models[i]->GetDelta(), shared_models[i]->GetDelta());
+
+            delete shared_models[i];
+            delete unshared_models[i];
+        }
+
+        // Only the solvers that MyDeltaNotchSrnModel knows about can be copied
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_other_solver =
+            CellCycleModelOdeSolver<NoCellCycleModel, RungeKutta4IvpOdeSolver>::Instance();
+        p_other_solver->Initialise();
+        MyDeltaNotchSrnModel model(p_other_solver);
+        TS_ASSERT_THROWS_THIS(model.CreateUnsharedOdeSolver(),
+                              "Only the RungeKutta4IvpOdeSolver, MyRosenbrockIvpOdeSolver, MyDormandPrinceIvpOdeSolver and "
+                              "MyFixedSizeRungeKutta4IvpOdeSolver solvers can be used to advance MyDeltaNotchSrnModels in parallel.");
+    }
+
+    void TestParallelIntegrationMatchesLazyIntegration()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.05, 1);
+
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver =
+            CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance();
+        if (!p_solver->IsSetUp())
+        {
+            p_solver->Initialise();
+        }
+
+        HoneycombVertexMeshGenerator parallel_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_parallel_population = CreateMyDeltaNotchTestPopulation(parallel_generator, p_solver);
+        HoneycombVertexMeshGenerator lazy_generator(5, 5);
+        boost::shared_ptr<VertexBasedCellPopulation<2> > p_lazy_population = CreateMyDeltaNotchTestPopulation(lazy_generator, p_solver);
+
+        MyDeltaNotchTrackingModifier<2> parallel_modifier;
+        TS_ASSERT_EQUALS(parallel_modifier.GetUseParallelIntegration(), false);
+        parallel_modifier.SetUseParallelIntegration(true);
+        parallel_modifier.SetNumThreads(3);
+        MyDeltaNotchTrackingModifier<2> lazy_modifier;
+
+        parallel_modifier.SetupSolve(*p_parallel_population, "unused");
+        lazy_modifier.SetupSolve(*p_lazy_population, "unused");
+        SimulationTime::Instance()->IncrementTimeOneStep();
+
+        // The parallel modifier advances every cell, while the others are advanced as Chaste would when checking for division
+        parallel_modifier.UpdateAtEndOfTimeStep(*p_parallel_population);
+        lazy_modifier.UpdateAtEndOfTimeStep(*p_lazy_population);
+
+        AbstractCellPopulation<2>::Iterator lazy_iter = p_lazy_population->Begin();
+        for (AbstractCellPopulation<2>::Iterator cell_iter = p_parallel_population->Begin();
+             cell_iter != p_parallel_population->End();
+             ++cell_iter, ++lazy_iter)
+        {
+            MyDeltaNotchSrnModel* p_model = static_cast<MyDeltaNotchSrnModel*>(cell_iter->GetSrnModel());
+            MyDeltaNotchSrnModel* p_lazy_model = static_cast<MyDeltaNotchSrnModel*>(lazy_iter->GetSrnModel());
+            TS_ASSERT_DELTA(p_model->GetSimulatedToTime(), 0.05, 1e-12);
+            TS_ASSERT_DELTA(p_lazy_model->GetSimulatedToTime(), 0.0, 1e-12);
+            p_lazy_model->SimulateToCurrentTime();
+
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_EQUALS(p_model->rGetStateVariables()[var], p_lazy_model->rGetStateVariables()[var]);
+            }
+
+            // The lazy call made by Chaste now does nothing
+            double delta = p_model->GetDelta();
+            p_model->SimulateToCurrentTime();
+            TS_ASSERT_EQUALS(p_model->GetDelta(), delta);
+        }
+    }
+};
+
+#endif /*TESTMYDELTANOTCHPARALLELSRNINTEGRATION_HPP_*/
@@ -0,0 +1,215 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHPHASETIMERS_HPP_
+#define TESTMYDELTANOTCHPHASETIMERS_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <string>
+
+#include "MyDeltaNotchPhaseTimers.hpp"
+#include "MyDeltaNotchPhaseTimerModifier.hpp"
+#include "MyDeltaNotchTimedOffLatticeSimulation.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "NagaiHondaForce.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "OutputFileHandler.hpp"
+#include "SmartPointers.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check the accounting of the phase timers and the file written by MyDeltaNotchPhaseTimerModifier.
+ */
+class TestMyDeltaNotchPhaseTimers : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Spin for a while, so that there is some time to measure.
+     */
+    void BusyWait()
+    {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(2))
+        {
+        }
+    }
+
+public:
+
+    void TestExclusiveNestedTiming()
+    {
+        MyDeltaNotchPhaseTimers::Reset();
+
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        MyDeltaNotchPhaseTimers::BeginPhase(MyDeltaNotchPhaseTimers::TRACKING_MODIFIER);
+        BusyWait();
+        for (unsigned i=0; i<3; i++)
+        {
+            MyDeltaNotchPhaseTimers::BeginPhase(MyDeltaNotchPhaseTimers::SRN_INTEGRATION);
+            BusyWait();
+            MyDeltaNotchPhaseTimers::EndPhase(MyDeltaNotchPhaseTimers::SRN_INTEGRATION);
+        }
+        MyDeltaNotchPhaseTimers::EndPhase(MyDeltaNotchPhaseTimers::TRACKING_MODIFIER);
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double srn_time = MyDeltaNotchPhaseTimers::GetTime(MyDeltaNotchPhaseTimers::SRN_INTEGRATION);
+        double tracking_time = MyDeltaNotchPhaseTimers::GetTime(MyDeltaNotchPhaseTimers::TRACKING_MODIFIER);
+
+        // The inner phase is not counted in the outer one, so the two add up to the elapsed time
+        TS_ASSERT_LESS_THAN_EQUALS(0.006, srn_time);
+        TS_ASSERT_LESS_THAN_EQUALS(0.002, tracking_time);
+        TS_ASSERT_LESS_THAN(tracking_time, elapsed - srn_time + 1e-6);
+        TS_ASSERT_DELTA(srn_time + tracking_time, elapsed, 1e-3);
+
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::SRN_INTEGRATION), 3u);
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::TRACKING_MODIFIER), 1u);
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::FORCES), 0u);
+        TS_ASSERT_DELTA(MyDeltaNotchPhaseTimers::GetTime(MyDeltaNotchPhaseTimers::FORCES), 0.0, 1e-12);
+
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchPhaseTimers::GetPhaseName(MyDeltaNotchPhaseTimers::SRN_INTEGRATION)), "srn_integration");
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchPhaseTimers::GetPhaseName(MyDeltaNotchPhaseTimers::TRACKING_MODIFIER)), "tracking_modifier");
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchPhaseTimers::GetPhaseName(MyDeltaNotchPhaseTimers::POPULATION_UPDATE)), "population_update");
+        TS_ASSERT_EQUALS(std::string(MyDeltaNotchPhaseTimers::GetPhaseName(MyDeltaNotchPhaseTimers::FORCES)), "forces");
+
+        MyDeltaNotchPhaseTimers::Reset();
+        TS_ASSERT_DELTA(MyDeltaNotchPhaseTimers::GetTime(MyDeltaNotchPhaseTimers::SRN_INTEGRATION), 0.0, 1e-12);
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::SRN_INTEGRATION), 0u);
+    }
+
+    void TestScopedTimer()
+    {
+        MyDeltaNotchPhaseTimers::Reset();
+        {
+            MyDeltaNotchScopedPhaseTimer timer(MyDeltaNotchPhaseTimers::FORCES);
+            BusyWait();
+        }
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::FORCES), 1u);
+        TS_ASSERT_LESS_THAN_EQUALS(0.002, MyDeltaNotchPhaseTimers::GetTime(MyDeltaNotchPhaseTimers::FORCES));
+
+#ifdef _OPENMP
+        // Timers created inside a parallel region are ignored
+        #pragma omp parallel num_threads(2)
+        {
+            MyDeltaNotchScopedPhaseTimer timer(MyDeltaNotchPhaseTimers::SRN_INTEGRATION);
+        }
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::SRN_INTEGRATION), 0u);
+#endif // _OPENMP
+
+        // The macro only times anything if the timers are compiled in
+        {
+            MY_DELTA_NOTCH_TIME_PHASE(POPULATION_UPDATE);
+        }
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::POPULATION_UPDATE),
+                         MyDeltaNotchPhaseTimers::IsEnabled() ? 1u : 0u);
+    }
+
+    void TestTimedSimulationWritesPhaseTimes()
+    {
+        HoneycombVertexMeshGenerator generator(4, 4);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, new MyDeltaNotchSrnModel));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MyDeltaNotchTimedOffLatticeSimulation<2> simulator(cell_population);
+        simulator.SetOutputDirectory("TestMyDeltaNotchPhaseTimers");
+        simulator.SetDt(0.01);
+        simulator.SetSamplingTimestepMultiple(5);
+        simulator.SetEndTime(0.1);
+
+        MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        simulator.AddSimulationModifier(p_modifier);
+        MAKE_PTR(NagaiHondaForce<2>, p_force);
+        simulator.AddForce(p_force);
+
+        simulator.Solve();
+
+        // The timer modifier is only added if the timers are compiled in, and is then moved after the tracking modifier
+        std::vector<boost::shared_ptr<AbstractCellBasedSimulationModifier<2,2> > >* p_modifiers = simulator.GetSimulationModifiers();
+        OutputFileHandler handler("TestMyDeltaNotchPhaseTimers", false);
+        std::ifstream file((handler.GetOutputDirectoryFullPath() + "phase_timers.csv").c_str());
+        if (!MyDeltaNotchPhaseTimers::IsEnabled())
+        {
+            TS_ASSERT_EQUALS(p_modifiers->size(), 1u);
+            TS_ASSERT(!file.is_open());
+            return;
+        }
+        TS_ASSERT_EQUALS(p_modifiers->size(), 2u);
+        TS_ASSERT(p_modifiers->front() == p_modifier);
+        TS_ASSERT(boost::dynamic_pointer_cast<MyDeltaNotchPhaseTimerModifier<2> >(p_modifiers->back()));
+        TS_ASSERT(file.is_open());
+
+        std::string line;
+        std::getline(file, line);
+        TS_ASSERT_EQUALS(line, "time,total,srn_integration,srn_integration_calls,tracking_modifier,tracking_modifier_calls,"
+                               "population_update,population_update_calls,forces,forces_calls,other");
+
+        // A row at each sampling time, with the end of the solve not repeating the last of them
+        unsigned num_rows = 0;
+        while (std::getline(file, line))
+        {
+            if (!line.empty())
+            {
+                num_rows++;
+            }
+        }
+        TS_ASSERT_EQUALS(num_rows, 2u);
+
+        TS_ASSERT_EQUALS(MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::FORCES), 10u);
+        TS_ASSERT_LESS_THAN_EQUALS(10u, MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::POPULATION_UPDATE));
+        TS_ASSERT_LESS_THAN(0u, MyDeltaNotchPhaseTimers::GetCount(MyDeltaNotchPhaseTimers::SRN_INTEGRATION));
+    }
+};
+
+#endif /*TESTMYDELTANOTCHPHASETIMERS_HPP_*/
@@ -0,0 +1,181 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHQUIESCENCE_HPP_
+#define TESTMYDELTANOTCHQUIESCENCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "CellCycleModelOdeSolver.hpp"
+#include "HoneycombVertexMeshGenerator.hpp"
+#include "VertexBasedCellPopulation.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that the integration of cells at a steady state is skipped until their inputs move.
+ */
+class TestMyDeltaNotchQuiescence : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestSrnModelBecomesQuiescentAndWakes()
+    {
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_shared_solver =
+            CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance();
+        if (!p_shared_solver->IsSetUp())
+        {
+            p_shared_solver->Initialise();
+        }
+        boost::shared_ptr<MyDeltaNotchStateStore> p_store(new MyDeltaNotchStateStore(1));
+        p_store->rGetMeanDelta()[0] = 0.5;
+        p_store->rGetXDistance()[0] = 1.0;
+
+        MyDeltaNotchSrnModel srn_model(p_shared_solver);
+        srn_model.SetDt(0.01);
+        srn_model.Initialise();
+        srn_model.SetStateStore(p_store, 0);
+        TS_ASSERT_EQUALS(srn_model.GetUseQuiescence(), false);
+        TS_ASSERT_DELTA(srn_model.GetQuiescenceRhsTolerance(), 1e-6, 1e-12);
+        TS_ASSERT_DELTA(srn_model.GetQuiescenceInputTolerance(), 1e-6, 1e-12);
+        TS_ASSERT_THROWS_THIS(srn_model.SetQuiescenceTolerances(-1.0, 1e-6),
+                              "The quiescence tolerances must be non-negative.");
+        srn_model.SetUseQuiescence(true);
+
+        // With constant inputs the cell settles to a steady state, and is then marked quiescent
+        MyRosenbrockIvpOdeSolver solver;
+        double time = 0.0;
+        while (!srn_model.IsQuiescent() && time < 1000.0)
+        {
+            time += 1.0;
+            srn_model.SimulateToTime(time, solver);
+        }
+        TS_ASSERT(srn_model.IsQuiescent());
+        TS_ASSERT_LESS_THAN(time, 1000.0);
+
+        // Further integration is skipped, even if the inputs move by less than the tolerance
+        std::vector<double> steady_state = srn_model.rGetStateVariables();
+        p_store->rGetMeanDelta()[0] += 1e-7;
+        srn_model.SimulateToTime(time + 10.0, solver);
+        TS_ASSERT_DELTA(srn_model.GetSimulatedToTime(), time + 10.0, 1e-12);
+        TS_ASSERT(srn_model.IsQuiescent());
+        for (unsigned i=0; i<6; i++)
+        {
+            TS_ASSERT_EQUALS(srn_model.rGetStateVariables()[i], steady_state[i]);
+        }
+
+        // Daughter cells inherit the settings but start awake
+        MyDeltaNotchSrnModel* p_daughter = static_cast<MyDeltaNotchSrnModel*>(srn_model.CreateSrnModel());
+        TS_ASSERT_EQUALS(p_daughter->GetUseQuiescence(), true);
+        TS_ASSERT_EQUALS(p_daughter->IsQuiescent(), false);
+        delete p_daughter;
+
+        // A change in the coupling input wakes the cell
+        p_store->rGetMeanDelta()[0] = 0.6;
+        srn_model.SimulateToTime(time + 11.0, solver);
+        TS_ASSERT(!srn_model.IsQuiescent());
+        TS_ASSERT_DIFFERS(srn_model.GetDelta(), steady_state[5]);
+
+        // As does a change in x distance, once the cell has settled again
+        while (!srn_model.IsQuiescent() && time < 2000.0)
+        {
+            time += 1.0;
+            srn_model.SimulateToTime(time + 11.0, solver);
+        }
+        TS_ASSERT(srn_model.IsQuiescent());
+        p_store->rGetXDistance()[0] = 2.0;
+        double delta = srn_model.GetDelta();
+        srn_model.SimulateToTime(time + 12.0, solver);
+        TS_ASSERT(!srn_model.IsQuiescent());
+        TS_ASSERT_DIFFERS(srn_model.GetDelta(), delta);
+    }
+
+    void TestModifierCountsQuiescentCells()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(0.2, 4);
+
+        boost::shared_ptr<AbstractCellCycleModelOdeSolver> p_solver =
+            CellCycleModelOdeSolver<MyDeltaNotchSrnModel, MyRosenbrockIvpOdeSolver>::Instance();
+        if (!p_solver->IsSetUp())
+        {
+            p_solver->Initialise();
+        }
+
+        HoneycombVertexMeshGenerator generator(3, 3);
+        MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
+        {
+            MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel(p_solver);
+            p_srn_model->SetDt(0.01);
+
+            // Tolerances this loose make every cell quiescent once its inputs stop changing
+            p_srn_model->SetUseQuiescence(true);
+            p_srn_model->SetQuiescenceTolerances(1e6, 1e6);
+
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, p_srn_model));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            cells.push_back(p_cell);
+        }
+        VertexBasedCellPopulation<2> cell_population(*p_mesh, cells);
+
+        MyDeltaNotchTrackingModifier<2> modifier;
+        modifier.SetUseParallelIntegration(true);
+        modifier.SetupSolve(cell_population, "unused");
+        TS_ASSERT_EQUALS(modifier.GetNumQuiescentCells(), 0u);
+        TS_ASSERT_EQUALS(modifier.GetNumActiveCells(), cell_population.GetNumRealCells());
+
+        for (unsigned step=0; step<4; step++)
+        {
+            SimulationTime::Instance()->IncrementTimeOneStep();
+            modifier.UpdateAtEndOfTimeStep(cell_population);
+        }
+        modifier.UpdateCellData(cell_population);
+        TS_ASSERT_EQUALS(modifier.GetNumQuiescentCells(), cell_population.GetNumRealCells());
+        TS_ASSERT_EQUALS(modifier.GetNumActiveCells(), 0u);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHQUIESCENCE_HPP_*/
@@ -109,6 +109,10 @@ OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  * This modifier leads to the {{{CellData}}} cell property being updated at each timestep to deal with Delta-Notch signalling.
  */
 #include "MyDeltaNotchTrackingModifier.hpp"
+/*
+ * The next header defines a helper class that creates cells with Delta-Notch SRN models and random initial conditions.
+ */
+#include "MyDeltaNotchCellsGenerator.hpp"
 #include "Debug.hpp"
 
 /* Having included all the necessary header files, we proceed by defining the test class.
@@ -137,37 +141,15 @@ public:
         MutableVertexMesh<2,2>* p_mesh = generator.GetMesh();
 
         /* We then create some cells, each with a cell-cycle model, {{{UniformG1GenerationalCellCycleModel}}} and a subcellular reaction network model
-         * {{{DeltaNotchSrnModel}}}, which
-         * incorporates a Delta/Notch ODE system, here we use the hard coded initial conditions of 1.0 and 1.0.
-         * In this example we choose to make each cell differentiated,
+         * {{{MyDeltaNotchSrnModel}}}, which incorporates a Delta/Notch ODE system. We use a {{{MyDeltaNotchCellsGenerator}}},
+         * which initialises the concentrations to random levels in each cell and gives each cell a random birth time
+         * in the past 12 hours. Its random numbers are drawn from a separate stream for each cell, so the cells are the
+         * same however many threads draw them. In this example the generator makes each cell differentiated,
          * so that no cell division occurs. */
         std::vector<CellPtr> cells;
-        MAKE_PTR(WildTypeCellMutationState, p_state);
-        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
-
-        for (unsigned elem_index=0; elem_index<p_mesh->GetNumElements(); elem_index++)
-        {
-            UniformG1GenerationalCellCycleModel* p_cc_model = new UniformG1GenerationalCellCycleModel();
-            p_cc_model->SetDimension(2);
-
-            /* We choose to initialise the concentrations to random levels in each cell. */
-            std::vector<double> initial_conditions;
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-
-            MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel();
-            p_srn_model->SetInitialConditions(initial_conditions);
-
-            CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
-            p_cell->SetCellProliferativeType(p_diff_type);
-            double birth_time = -RandomNumberGenerator::Instance()->ranf()*12.0;
-            p_cell->SetBirthTime(birth_time);
-            cells.push_back(p_cell);
-        }
+        MyDeltaNotchCellsGenerator cells_generator;
+        cells_generator.SetBirthTimeRange(12.0);
+        cells_generator.GenerateBasic<UniformG1GenerationalCellCycleModel, 2>(cells, p_mesh->GetNumElements());
 
         /* Using the vertex mesh and cells, we create a cell-based population object, and specify which results to
          * output to file. */
@@ -187,8 +169,10 @@ public:
         simulator.SetSamplingTimestepMultiple(200);
         simulator.SetEndTime(100.0);
 
-        /* Then, we define the modifier class, which automatically updates the values of Delta and Notch within the cells in {{{CellData}}} and passes it to the simulation.*/
+        /* Then, we define the modifier class, which automatically updates the values of Delta and Notch within the cells and passes it to the simulation.
+         * We ask it to also store these values in {{{CellData}}}, so that they are written to the VTK output for visualization.*/
         MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        p_modifier->SetExportToCellData(true);
         simulator.AddSimulationModifier(p_modifier);
 
         // MAKE_PTR(NagaiHondaForce<2>, p_force);
@@ -235,27 +219,12 @@ public:
          */
         mesh.ConstructNodesWithoutMesh(*p_generating_mesh, 1.5);
 
+        /* We create the cells with a {{{MyDeltaNotchCellsGenerator}}}, as before, so all six concentrations of
+         * each cell's Delta/Notch ODE system are set to random levels. */
         std::vector<CellPtr> cells;
-        MAKE_PTR(WildTypeCellMutationState, p_state);
-        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
-        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
-        {
-            UniformG1GenerationalCellCycleModel* p_cc_model = new UniformG1GenerationalCellCycleModel();
-            p_cc_model->SetDimension(2);
-
-            /* We choose to initialise the concentrations to random levels in each cell. */
-            std::vector<double> initial_conditions;
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            initial_conditions.push_back(RandomNumberGenerator::Instance()->ranf());
-            MyDeltaNotchSrnModel* p_srn_model = new MyDeltaNotchSrnModel();
-            p_srn_model->SetInitialConditions(initial_conditions);
-
-            CellPtr p_cell(new Cell(p_state, p_cc_model, p_srn_model));
-            p_cell->SetCellProliferativeType(p_diff_type);
-            double birth_time = -RandomNumberGenerator::Instance()->ranf()*12.0;
-            p_cell->SetBirthTime(birth_time);
-            cells.push_back(p_cell);
-        }
+        MyDeltaNotchCellsGenerator cells_generator;
+        cells_generator.SetBirthTimeRange(12.0);
+        cells_generator.GenerateBasic<UniformG1GenerationalCellCycleModel, 2>(cells, mesh.GetNumNodes());
 
         NodeBasedCellPopulation<2> cell_population(mesh, cells);
         cell_population.AddCellPopulationCountWriter<CellProliferativeTypesCountWriter>();
@@ -269,8 +238,10 @@ public:
         simulator.SetSamplingTimestepMultiple(10);
         simulator.SetEndTime(5.0);
 
-        /* Again we define the modifier class, which automatically updates the values of Delta and Notch within the cells in {{{CellData}}} and passes it to the simulation.*/
+        /* Again we define the modifier class, which automatically updates the values of Delta and Notch within the cells and passes it to the simulation,
+         * and ask it to store these values in {{{CellData}}}.*/
         MAKE_PTR(MyDeltaNotchTrackingModifier<2>, p_modifier);
+        p_modifier->SetExportToCellData(true);
         simulator.AddSimulationModifier(p_modifier);
 
         /* As we are using a node-based cell population, we use an appropriate force law. */
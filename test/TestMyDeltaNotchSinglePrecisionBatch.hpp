@@ -0,0 +1,234 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYDELTANOTCHSINGLEPRECISIONBATCH_HPP_
+#define TESTMYDELTANOTCHSINGLEPRECISIONBATCH_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+#include "MyDeltaNotchBatchOdeSystem.hpp"
+#include "MyDeltaNotchBatchRungeKutta4Solver.hpp"
+#include "MyDeltaNotchNeighbourGraph.hpp"
+#include "MyDeltaNotchSimdKernels.hpp"
+#include "Exception.hpp"
+
+/**
+ * Check that a batch of Delta-Notch ODE systems stored and solved in single precision
+ * stays close to the same batch in double precision, and that the precision check
+ * measures the difference.
+ */
+class TestMyDeltaNotchSinglePrecisionBatch : public CxxTest::TestSuite
+{
+private:
+
+    /**
+     * Fill in some distinct initial conditions and inputs for every cell of a batch, of either precision.
+     * The values are representable in single precision, so that batches of both precisions start the same.
+     */
+    template<typename REAL>
+    void SetUpBatch(MyDeltaNotchBatchOdeSystemWithPrecision<REAL>& rBatch)
+    {
+        const unsigned num_cells = rBatch.GetNumCells();
+        for (unsigned cell_index=0; cell_index<num_cells; cell_index++)
+        {
+            for (unsigned var=0; var<6; var++)
+            {
+                rBatch.rGetStateVariables()[var*num_cells + cell_index] = float(0.1 + 0.05*((cell_index*7 + var*3)%11));
+            }
+            rBatch.rGetMeanDelta()[cell_index] = float(0.2 + 0.1*(cell_index%5));
+            rBatch.rGetXDistance()[cell_index] = 0.5*(cell_index%13); // covers both branches of the x distance profiles
+        }
+    }
+
+    /** @return the largest difference between two batches, relative to 1 + the magnitude of the double-precision value. */
+    double GetMaxDeviation(MyDeltaNotchSinglePrecisionBatchOdeSystem& rBatch, MyDeltaNotchBatchOdeSystem& rReferenceBatch)
+    {
+        double deviation = 0.0;
+        for (unsigned i=0; i<rReferenceBatch.rGetStateVariables().size(); i++)
+        {
+            double reference = rReferenceBatch.rGetStateVariables()[i];
+            deviation = std::max(deviation, fabs(rBatch.rGetStateVariables()[i] - reference)/(1.0 + fabs(reference)));
+        }
+        return deviation;
+    }
+
+    /** Build a ring of cells, each the neighbour of the cells either side of it. */
+    void SetUpRing(unsigned numCells, MyDeltaNotchNeighbourGraph& rGraph)
+    {
+        std::vector<unsigned> location_indices(numCells);
+        std::vector<std::set<unsigned> > neighbours(numCells);
+        for (unsigned cell_index=0; cell_index<numCells; cell_index++)
+        {
+            location_indices[cell_index] = cell_index;
+            neighbours[cell_index].insert((cell_index + 1)%numCells);
+            neighbours[cell_index].insert((cell_index + numCells - 1)%numCells);
+        }
+        rGraph.Build(location_indices, neighbours);
+    }
+
+public:
+
+    void TestSinglePrecisionKernels()
+    {
+        // An odd number of cells, so that each vectorised kernel also has to deal with a remainder
+        const unsigned num_cells = 45;
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        reference_batch.SetKernelType(MyDeltaNotchSimdKernels::SCALAR);
+        std::vector<double> reference_dy(6*num_cells);
+        reference_batch.EvaluateYDerivatives(0.0, reference_batch.rGetStateVariables(), reference_dy);
+
+        const MyDeltaNotchSimdKernels::KernelType kernel_types[3] = {MyDeltaNotchSimdKernels::SCALAR,
+                                                                     MyDeltaNotchSimdKernels::AVX2,
+                                                                     MyDeltaNotchSimdKernels::AVX512};
+        for (unsigned k=0; k<3; k++)
+        {
+            if (!MyDeltaNotchSimdKernels::IsAvailable(kernel_types[k]))
+            {
+                continue;
+            }
+            MyDeltaNotchSinglePrecisionBatchOdeSystem batch(num_cells);
+            SetUpBatch(batch);
+            batch.SetKernelType(kernel_types[k]);
+            std::vector<float> dy(6*num_cells);
+            batch.EvaluateYDerivatives(0.0, batch.rGetStateVariables(), dy);
+
+            // The RHS involves differences of large fluxes, so is compared relative to the largest flux
+            for (unsigned i=0; i<6*num_cells; i++)
+            {
+                TS_ASSERT_DELTA(dy[i], reference_dy[i], 1e-5*(1000.0 + fabs(reference_dy[i])));
+            }
+        }
+    }
+
+    void TestSinglePrecisionSolve()
+    {
+        const unsigned num_cells = 37;
+        const double end_time = 0.05;
+        const double dt = 1e-5;
+
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchRungeKutta4Solver reference_solver;
+        reference_solver.Solve(reference_batch, 0.0, end_time, dt);
+
+        // A sample of every cell, so that the precision check sees the whole batch
+        MyDeltaNotchSinglePrecisionBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver solver;
+        solver.SetPrecisionCheck(num_cells);
+        TS_ASSERT_EQUALS(solver.GetNumPrecisionChecks(), 0u);
+        solver.Solve(batch, 0.0, end_time, dt);
+
+        double deviation = GetMaxDeviation(batch, reference_batch);
+        TS_ASSERT_LESS_THAN(deviation, 1e-5);
+        TS_ASSERT_LESS_THAN(0.0, deviation);
+        TS_ASSERT_EQUALS(solver.GetNumPrecisionChecks(), 1u);
+        TS_ASSERT_DELTA(solver.GetLastDeviation(), deviation, 1e-6*deviation);
+        TS_ASSERT_DELTA(solver.GetMaxDeviation(), deviation, 1e-6*deviation);
+
+        // Checks are only made every third solve, on a smaller sample
+        solver.SetPrecisionCheck(5, 3);
+        for (unsigned i=0; i<4; i++)
+        {
+            solver.Solve(batch, end_time + 0.005*i, end_time + 0.005*(i + 1), dt);
+        }
+        TS_ASSERT_EQUALS(solver.GetNumPrecisionChecks(), 2u);
+        TS_ASSERT_LESS_THAN(0.0, solver.GetLastDeviation());
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetLastDeviation(), solver.GetMaxDeviation());
+        TS_ASSERT_LESS_THAN(solver.GetMaxDeviation(), 1e-5);
+
+        // A check of a double-precision solve finds no deviation beyond rounding
+        MyDeltaNotchBatchRungeKutta4Solver checked_reference_solver;
+        checked_reference_solver.SetPrecisionCheck(7);
+        checked_reference_solver.Solve(reference_batch, end_time, end_time + 0.005, dt);
+        TS_ASSERT_EQUALS(checked_reference_solver.GetNumPrecisionChecks(), 1u);
+        TS_ASSERT_LESS_THAN(checked_reference_solver.GetMaxDeviation(), 1e-12);
+
+        // Stop checking
+        solver.SetPrecisionCheck(0);
+        solver.Solve(batch, 0.1, 0.105, dt);
+        TS_ASSERT_EQUALS(solver.GetNumPrecisionChecks(), 0u);
+
+        // A timestep too large for stability makes the solution blow up, which the check reports as NaN
+        MyDeltaNotchSinglePrecisionBatchOdeSystem unstable_batch(num_cells);
+        SetUpBatch(unstable_batch);
+        solver.SetPrecisionCheck(num_cells);
+        solver.Solve(unstable_batch, 0.0, 1.0, 1e-3);
+        TS_ASSERT(std::isnan(solver.GetLastDeviation()));
+        TS_ASSERT(std::isnan(solver.GetMaxDeviation()));
+
+        TS_ASSERT_THROWS_THIS(solver.SetPrecisionCheck(5, 0), "The precision check interval must be positive.");
+    }
+
+    void TestCoupledSinglePrecisionSolve()
+    {
+        const unsigned num_cells = 24;
+        const double end_time = 0.05;
+        const double dt = 1e-5;
+        MyDeltaNotchNeighbourGraph graph;
+        SetUpRing(num_cells, graph);
+
+        MyDeltaNotchBatchOdeSystem reference_batch(num_cells);
+        SetUpBatch(reference_batch);
+        MyDeltaNotchBatchRungeKutta4Solver reference_solver;
+        reference_solver.SetNeighbourGraph(&graph);
+        reference_solver.Solve(reference_batch, 0.0, end_time, dt);
+
+        MyDeltaNotchSinglePrecisionBatchOdeSystem batch(num_cells);
+        SetUpBatch(batch);
+        MyDeltaNotchSinglePrecisionBatchRungeKutta4Solver solver;
+        solver.SetNeighbourGraph(&graph);
+        solver.SetPrecisionCheck(4);
+        solver.Solve(batch, 0.0, end_time, dt);
+
+        /*
+         * The sampled cells are advanced in double precision with the mean levels of Delta found
+         * in single precision, so the check sees the rounding within those cells but not that
+         * coming through their neighbours.
+         */
+        double deviation = GetMaxDeviation(batch, reference_batch);
+        TS_ASSERT_LESS_THAN(deviation, 1e-5);
+        TS_ASSERT_EQUALS(solver.GetNumPrecisionChecks(), 1u);
+        TS_ASSERT_LESS_THAN(0.0, solver.GetLastDeviation());
+        TS_ASSERT_LESS_THAN_EQUALS(solver.GetLastDeviation(), deviation);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHSINGLEPRECISIONBATCH_HPP_*/
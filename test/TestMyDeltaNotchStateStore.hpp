@@ -0,0 +1,99 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHSTATESTORE_HPP_
+#define TESTMYDELTANOTCHSTATESTORE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchStateStore.hpp"
+#include "MyDeltaNotchSrnModel.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that SRN models read their inputs from the shared state store.
+ */
+class TestMyDeltaNotchStateStore : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestResize()
+    {
+        MyDeltaNotchStateStore store(3);
+        TS_ASSERT_EQUALS(store.GetNumLocations(), 3u);
+        TS_ASSERT_EQUALS(store.rGetMeanDelta().size(), 3u);
+        TS_ASSERT_EQUALS(store.rGetXDistance().size(), 3u);
+
+        store.rGetMeanDelta()[2] = 0.7;
+        store.Resize(5);
+        TS_ASSERT_EQUALS(store.GetNumLocations(), 5u);
+        TS_ASSERT_EQUALS(store.rGetMeanDelta()[2], 0.7);
+        TS_ASSERT_EQUALS(store.rGetMeanDelta()[4], 0.0);
+        TS_ASSERT_EQUALS(store.rGetXDistance()[4], 0.0);
+    }
+
+    void TestSrnModelReadsInputsFromStore()
+    {
+        boost::shared_ptr<MyDeltaNotchStateStore> p_store(new MyDeltaNotchStateStore(4));
+        p_store->rGetMeanDelta()[2] = 0.35;
+        p_store->rGetXDistance()[2] = 4.5;
+
+        MyDeltaNotchSrnModel srn_model;
+        srn_model.Initialise();
+        TS_ASSERT(!srn_model.GetStateStore());
+
+        srn_model.SetStateStore(p_store, 2);
+        TS_ASSERT_EQUALS(srn_model.GetStateStore(), p_store);
+        TS_ASSERT_EQUALS(srn_model.GetStateStoreIndex(), 2u);
+
+        // No CellData is needed
+        srn_model.UpdateDeltaNotch();
+        TS_ASSERT_EQUALS(srn_model.GetMeanNeighbouringDelta(), 0.35);
+        TS_ASSERT_EQUALS(srn_model.GetXDistance(), 4.5);
+
+        // A daughter shares its parent's entries until the store is next updated
+        MyDeltaNotchSrnModel* p_daughter = static_cast<MyDeltaNotchSrnModel*>(srn_model.CreateSrnModel());
+        TS_ASSERT_EQUALS(p_daughter->GetStateStore(), p_store);
+        TS_ASSERT_EQUALS(p_daughter->GetStateStoreIndex(), 2u);
+        p_store->rGetMeanDelta()[2] = 0.4;
+        p_daughter->UpdateDeltaNotch();
+        TS_ASSERT_EQUALS(p_daughter->GetMeanNeighbouringDelta(), 0.4);
+        delete p_daughter;
+    }
+};
+
+#endif /*TESTMYDELTANOTCHSTATESTORE_HPP_*/
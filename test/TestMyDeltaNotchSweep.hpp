@@ -0,0 +1,219 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHSWEEP_HPP_
+#define TESTMYDELTANOTCHSWEEP_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include <cstdlib>
+#include <map>
+#include <sstream>
+
+#include "MyDeltaNotchProcessPool.hpp"
+#include "MyDeltaNotchSweepSimulation.hpp"
+#include "MyDeltaNotchSweepSpecification.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * A job for testing MyDeltaNotchProcessPool, which fails for some indices.
+ *
+ * @param index the index of the job
+ * @return a line of results.
+ */
+std::string TestProcessPoolJob(unsigned index)
+{
+    if (index == 3)
+    {
+        EXCEPTION("Job 3 always fails");
+    }
+    if (index == 5)
+    {
+        abort();
+    }
+    std::stringstream line;
+    line << index << "," << index*index;
+    return line.str();
+}
+
+/**
+ * Check the parsing of sweep specifications and the pool of processes that runs them.
+ */
+class TestMyDeltaNotchSweep : public AbstractCellBasedTestSuite
+{
+public:
+
+    void TestSweepSpecification()
+    {
+        std::stringstream spec;
+        spec << "# A small sweep\n"
+             << "seeds 1:3 7   # four seeds\n"
+             << "\n"
+             << "tissue_size 4x5 10x10\n"
+             << "end_time 50\n"
+             << "dt 0.01\n"
+             << "parameter k_6 400 500\n"
+             << "parameter beta_N linspace 5 15 3\n";
+        MyDeltaNotchSweepSpecification specification(spec);
+
+        TS_ASSERT_EQUALS(specification.GetNumRuns(), 4u*2u*2u*3u);
+        TS_ASSERT_EQUALS(specification.rGetParameterNames().size(), 2u);
+        TS_ASSERT_EQUALS(specification.rGetParameterNames()[0], "k_6");
+        TS_ASSERT_EQUALS(specification.rGetParameterNames()[1], "beta_N");
+
+        // The seed varies fastest, then the parameters in the order given, then the tissue size
+        MyDeltaNotchSweepRun run = specification.GetRun(0);
+        TS_ASSERT_EQUALS(run.index, 0u);
+        TS_ASSERT_EQUALS(run.seed, 1u);
+        TS_ASSERT_EQUALS(run.width, 4u);
+        TS_ASSERT_EQUALS(run.height, 5u);
+        TS_ASSERT_DELTA(run.endTime, 50.0, 1e-12);
+        TS_ASSERT_DELTA(run.dt, 0.01, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.k_6, 400.0, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.beta_N, 5.0, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.k_1, MyDeltaNotchParameters().k_1, 1e-12);
+
+        run = specification.GetRun(3);
+        TS_ASSERT_EQUALS(run.seed, 7u);
+        TS_ASSERT_DELTA(run.parameters.beta_N, 5.0, 1e-12);
+
+        run = specification.GetRun(4);
+        TS_ASSERT_EQUALS(run.seed, 1u);
+        TS_ASSERT_DELTA(run.parameters.k_6, 400.0, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.beta_N, 10.0, 1e-12);
+
+        run = specification.GetRun(12);
+        TS_ASSERT_DELTA(run.parameters.k_6, 500.0, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.beta_N, 5.0, 1e-12);
+        TS_ASSERT_EQUALS(run.width, 4u);
+
+        run = specification.GetRun(47);
+        TS_ASSERT_EQUALS(run.seed, 7u);
+        TS_ASSERT_EQUALS(run.width, 10u);
+        TS_ASSERT_EQUALS(run.height, 10u);
+        TS_ASSERT_DELTA(run.parameters.k_6, 500.0, 1e-12);
+        TS_ASSERT_DELTA(run.parameters.beta_N, 15.0, 1e-12);
+        TS_ASSERT_EQUALS(run.sweptParameters.size(), 2u);
+        TS_ASSERT_EQUALS(run.sweptParameters[0].first, "k_6");
+        TS_ASSERT_DELTA(run.sweptParameters[1].second, 15.0, 1e-12);
+
+        TS_ASSERT_THROWS_THIS(specification.GetRun(48), "Run 48 is not in the sweep, which has 48 runs.");
+
+        TS_ASSERT_EQUALS(MyDeltaNotchSweepSimulation::GetSummaryHeader(specification.rGetParameterNames()),
+                         "run,seed,width,height,k_6,beta_N,num_cells,mean_delta,min_delta,max_delta,high_delta_fraction,wall_time");
+    }
+
+    void TestSweepSpecificationErrors()
+    {
+        std::stringstream unknown_keyword("seeds 1\nfoo 2\n");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchSweepSpecification specification(unknown_keyword),
+                              "Line 2 of the sweep specification: unknown keyword 'foo'.");
+
+        std::stringstream bad_value("tissue_size 4x5\nend_time soon\n");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchSweepSpecification specification(bad_value),
+                              "Line 2 of the sweep specification: 'soon' is not a valid value.");
+
+        std::stringstream bad_size("tissue_size 45\n");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchSweepSpecification specification(bad_size),
+                              "Line 1 of the sweep specification: tissue sizes must be given as <width>x<height>.");
+
+        std::stringstream bad_parameter("tissue_size 4x5\nend_time 1\nparameter k_99 1\n");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchSweepSpecification specification(bad_parameter),
+                              "Line 3 of the sweep specification: No Delta-Notch kinetic parameter named 'k_99'.");
+
+        std::stringstream no_end_time("tissue_size 4x5\n");
+        TS_ASSERT_THROWS_THIS(MyDeltaNotchSweepSpecification specification(no_end_time),
+                              "The sweep specification must give the end_time.");
+
+        // With no seeds given, a single seed of 0 is used
+        std::stringstream no_seeds("tissue_size 4x5\nend_time 1\n");
+        MyDeltaNotchSweepSpecification specification(no_seeds);
+        TS_ASSERT_EQUALS(specification.GetNumRuns(), 1u);
+        TS_ASSERT_EQUALS(specification.GetRun(0).seed, 0u);
+
+        // A range of seeds may end at the largest seed
+        std::stringstream last_seeds("seeds 4294967294:4294967295\ntissue_size 4x5\nend_time 1\n");
+        MyDeltaNotchSweepSpecification last_seeds_specification(last_seeds);
+        TS_ASSERT_EQUALS(last_seeds_specification.GetNumRuns(), 2u);
+        TS_ASSERT_EQUALS(last_seeds_specification.GetRun(1).seed, 4294967295u);
+    }
+
+    void TestProcessPool()
+    {
+        TS_ASSERT_LESS_THAN(0u, MyDeltaNotchProcessPool::GetNumAvailableCores());
+        TS_ASSERT_EQUALS(MyDeltaNotchProcessPool().GetNumProcesses(), MyDeltaNotchProcessPool::GetNumAvailableCores());
+
+        // The results are in job order, whatever the number of processes, and failed jobs are recorded
+        for (unsigned num_processes=1; num_processes<=4; num_processes++)
+        {
+            MyDeltaNotchProcessPool pool(num_processes);
+            TS_ASSERT_EQUALS(pool.GetNumProcesses(), num_processes);
+
+            std::stringstream results;
+            pool.Run(8, TestProcessPoolJob, results);
+            TS_ASSERT_EQUALS(results.str(), "0,0\n1,1\n2,4\n4,16\n6,36\n7,49\n");
+
+            TS_ASSERT_EQUALS(pool.rGetFailedJobs().size(), 2u);
+            std::map<unsigned, std::string> failed_jobs(pool.rGetFailedJobs().begin(), pool.rGetFailedJobs().end());
+            TS_ASSERT_EQUALS(failed_jobs[3], "Job 3 always fails");
+            TS_ASSERT_EQUALS(failed_jobs[5].substr(0, 31), "The process was killed by signa");
+        }
+    }
+
+    void TestSweepSimulation()
+    {
+        std::stringstream spec;
+        spec << "seeds 0:1\n"
+             << "tissue_size 3x3\n"
+             << "end_time 0.1\n"
+             << "parameter beta_N 8\n";
+        MyDeltaNotchSweepSpecification specification(spec);
+
+        // Runs with the same settings give the same summary, apart from the wall-clock time
+        std::string summary = MyDeltaNotchSweepSimulation::Run(specification.GetRun(0), "TestMyDeltaNotchSweep");
+        std::string repeat = MyDeltaNotchSweepSimulation::Run(specification.GetRun(0), "TestMyDeltaNotchSweep");
+        TS_ASSERT_EQUALS(summary.substr(0, summary.rfind(',')), repeat.substr(0, repeat.rfind(',')));
+        TS_ASSERT_EQUALS(summary.substr(0, 12), "0,0,3,3,8,9,");
+
+        std::string other_seed = MyDeltaNotchSweepSimulation::Run(specification.GetRun(1), "TestMyDeltaNotchSweep");
+        TS_ASSERT_EQUALS(other_seed.substr(0, 12), "1,1,3,3,8,9,");
+        TS_ASSERT_DIFFERS(other_seed.substr(12, other_seed.rfind(',') - 12), summary.substr(12, summary.rfind(',') - 12));
+    }
+};
+
+#endif /*TESTMYDELTANOTCHSWEEP_HPP_*/
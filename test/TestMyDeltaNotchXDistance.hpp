@@ -0,0 +1,171 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDELTANOTCHXDISTANCE_HPP_
+#define TESTMYDELTANOTCHXDISTANCE_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "CheckpointArchiveTypes.hpp"
+#include "AbstractCellBasedTestSuite.hpp"
+
+#include "MyDeltaNotchSrnModel.hpp"
+#include "MyDeltaNotchTrackingModifier.hpp"
+#include "NodesOnlyMesh.hpp"
+#include "NodeBasedCellPopulation.hpp"
+#include "NoCellCycleModel.hpp"
+#include "DifferentiatedCellProliferativeType.hpp"
+#include "WildTypeCellMutationState.hpp"
+#include "SmartPointers.hpp"
+#include "Exception.hpp"
+#include "FakePetscSetup.hpp"
+
+/**
+ * Check that the incrementally maintained centroid and x distances agree with a full recomputation.
+ */
+class TestMyDeltaNotchXDistance : public AbstractCellBasedTestSuite
+{
+private:
+
+    /**
+     * Check each cell's "x distance" against the distance from the centroid computed by the population.
+     *
+     * @param rCellPopulation the cell population
+     * @param tolerance the allowed discrepancy
+     */
+    void CheckXDistances(AbstractCellPopulation<3>& rCellPopulation, double tolerance)
+    {
+        c_vector<double,3> centroid = rCellPopulation.GetCentroidOfCellPopulation();
+        for (AbstractCellPopulation<3>::Iterator cell_iter = rCellPopulation.Begin();
+             cell_iter != rCellPopulation.End();
+             ++cell_iter)
+        {
+            double x = rCellPopulation.GetLocationOfCellCentre(*cell_iter)[0];
+            TS_ASSERT_LESS_THAN_EQUALS(fabs(cell_iter->GetCellData()->GetItem("x distance") - fabs(x - centroid[0])), tolerance);
+        }
+    }
+
+public:
+
+    void TestIncrementalXDistanceIn3d()
+    {
+        SimulationTime::Instance()->SetEndTimeAndNumberOfTimeSteps(1.0, 1);
+
+        // A 3x3x3 cube of nodes
+        std::vector<Node<3>*> nodes;
+        for (unsigned k=0; k<3; k++)
+        {
+            for (unsigned j=0; j<3; j++)
+            {
+                for (unsigned i=0; i<3; i++)
+                {
+                    nodes.push_back(new Node<3>(nodes.size(), false, 1.0*i, 1.0*j, 1.0*k));
+                }
+            }
+        }
+        NodesOnlyMesh<3> mesh;
+        mesh.ConstructNodesWithoutMesh(nodes, 1.5);
+
+        std::vector<CellPtr> cells;
+        MAKE_PTR(WildTypeCellMutationState, p_state);
+        MAKE_PTR(DifferentiatedCellProliferativeType, p_diff_type);
+        for (unsigned i=0; i<mesh.GetNumNodes(); i++)
+        {
+            CellPtr p_cell(new Cell(p_state, new NoCellCycleModel, new MyDeltaNotchSrnModel));
+            p_cell->SetCellProliferativeType(p_diff_type);
+            cells.push_back(p_cell);
+        }
+        NodeBasedCellPopulation<3> cell_population(mesh, cells);
+
+        MyDeltaNotchTrackingModifier<3> modifier;
+        TS_ASSERT_DELTA(modifier.GetXDistanceTolerance(), 0.0, 1e-12);
+        TS_ASSERT_THROWS_THIS(modifier.SetXDistanceTolerance(-1.0), "The x distance tolerance must be non-negative.");
+        modifier.SetupSolve(cell_population, "unused");
+
+        c_vector<double,3> centroid = modifier.GetCentroidOfCellPopulation();
+        TS_ASSERT_DELTA(centroid[0], 1.0, 1e-12);
+        TS_ASSERT_DELTA(centroid[1], 1.0, 1e-12);
+        TS_ASSERT_DELTA(centroid[2], 1.0, 1e-12);
+        CheckXDistances(cell_population, 1e-12);
+
+        // Moving a cell updates the running sum, and with a zero tolerance every x distance
+        cell_population.GetNode(0)->rGetModifiableLocation()[0] -= 0.27;
+        modifier.UpdateCellData(cell_population);
+        TS_ASSERT_DELTA(modifier.GetCentroidOfCellPopulation()[0], 1.0 - 0.01, 1e-12);
+        CheckXDistances(cell_population, 1e-12);
+
+        // With a tolerance, movements smaller than it leave the x distances as they were
+        modifier.SetXDistanceTolerance(0.1);
+        cell_population.GetNode(26)->rGetModifiableLocation()[0] += 0.027;
+        modifier.UpdateCellData(cell_population);
+        TS_ASSERT_DELTA(modifier.GetCentroidOfCellPopulation()[0], 1.0 - 0.009, 1e-12);
+        TS_ASSERT_DELTA(cell_population.GetCellUsingLocationIndex(26)->GetCellData()->GetItem("x distance"), 1.01, 1e-12);
+        CheckXDistances(cell_population, 0.1);
+
+        // Larger movements are picked up
+        cell_population.GetNode(26)->rGetModifiableLocation()[0] += 0.2;
+        modifier.UpdateCellData(cell_population);
+        TS_ASSERT_DELTA(cell_population.GetCellUsingLocationIndex(26)->GetCellData()->GetItem("x distance"),
+                        2.227 - 0.99, 1e-12);
+        CheckXDistances(cell_population, 0.1);
+
+        // Many small movements leave no accumulated rounding error in the centroid, which is
+        // summed in the same order as the population sums it
+        modifier.SetXDistanceTolerance(0.0);
+        for (unsigned step=0; step<1000; step++)
+        {
+            cell_population.GetNode(step%27)->rGetModifiableLocation()[0] += (step%2 == 0 ? 0.1 : -0.0999);
+            modifier.UpdateCellData(cell_population);
+        }
+        c_vector<double,3> moved_centroid = cell_population.GetCentroidOfCellPopulation();
+        for (unsigned i=0; i<3; i++)
+        {
+            TS_ASSERT_EQUALS(modifier.GetCentroidOfCellPopulation()[i], moved_centroid[i]);
+        }
+        CheckXDistances(cell_population, 0.0);
+
+        // Removing a cell changes the topology, so the sum is recomputed in full
+        cell_population.GetCellUsingLocationIndex(13)->Kill();
+        cell_population.RemoveDeadCells();
+        modifier.UpdateCellData(cell_population);
+        c_vector<double,3> full_centroid = cell_population.GetCentroidOfCellPopulation();
+        for (unsigned i=0; i<3; i++)
+        {
+            TS_ASSERT_DELTA(modifier.GetCentroidOfCellPopulation()[i], full_centroid[i], 1e-12);
+        }
+        CheckXDistances(cell_population, 1e-12);
+    }
+};
+
+#endif /*TESTMYDELTANOTCHXDISTANCE_HPP_*/
@@ -0,0 +1,195 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYDORMANDPRINCEIVPODESOLVER_HPP_
+#define TESTMYDORMANDPRINCEIVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchTestOdeSystem.hpp"
+#include "MyDormandPrinceIvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "Exception.hpp"
+
+/**
+ * Check the adaptive Dormand-Prince solver against a fine fixed-step solution,
+ * and that each ODE system keeps its own step size and counters.
+ */
+class TestMyDormandPrinceIvpOdeSolver : public CxxTest::TestSuite
+{
+public:
+
+    void TestAdaptiveStepState()
+    {
+        MyAdaptiveStepState state;
+        TS_ASSERT_EQUALS(state.GetRelativeTolerance(), MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE);
+        TS_ASSERT_EQUALS(state.GetAbsoluteTolerance(), MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE);
+        TS_ASSERT_EQUALS(state.GetNextStepSize(), 0.0);
+        TS_ASSERT_EQUALS(state.GetNumAcceptedSteps(), 0u);
+        TS_ASSERT_EQUALS(state.GetNumRejectedSteps(), 0u);
+
+        state.SetTolerances(1e-3, 1e-5);
+        TS_ASSERT_EQUALS(state.GetRelativeTolerance(), 1e-3);
+        TS_ASSERT_EQUALS(state.GetAbsoluteTolerance(), 1e-5);
+        TS_ASSERT_THROWS_THIS(state.SetTolerances(0.0, 1e-5), "The adaptive step tolerances must be positive.");
+
+        state.RecordAcceptedStep();
+        state.RecordAcceptedStep();
+        state.RecordRejectedStep();
+        TS_ASSERT_EQUALS(state.GetNumAcceptedSteps(), 2u);
+        TS_ASSERT_EQUALS(state.GetNumRejectedSteps(), 1u);
+        state.ResetStepCounters();
+        TS_ASSERT_EQUALS(state.GetNumAcceptedSteps(), 0u);
+        TS_ASSERT_EQUALS(state.GetNumRejectedSteps(), 0u);
+    }
+
+    void TestAdaptiveStepStateIsAllocatedOnlyWhenNeeded()
+    {
+        MyDeltaNotchOdeSystem ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+        TS_ASSERT(ode_system.GetAdaptiveStepState() == nullptr);
+
+        // Default values and fixed-step solves leave the system without an adaptive step state
+        ode_system.SetTolerances(MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE, MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE);
+        ode_system.SetNextStepSize(0.0);
+        ode_system.SetStepCounters(0, 0);
+        ode_system.ResetStepCounters();
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.SolveAndUpdateStateVariable(&ode_system, 0.0, 0.001, 1e-5);
+        TS_ASSERT(ode_system.GetAdaptiveStepState() == nullptr);
+        TS_ASSERT_EQUALS(ode_system.GetRelativeTolerance(), MyAdaptiveStepState::DEFAULT_RELATIVE_TOLERANCE);
+        TS_ASSERT_EQUALS(ode_system.GetAbsoluteTolerance(), MyAdaptiveStepState::DEFAULT_ABSOLUTE_TOLERANCE);
+        TS_ASSERT_EQUALS(ode_system.GetNextStepSize(), 0.0);
+        TS_ASSERT_EQUALS(ode_system.GetNumAcceptedSteps(), 0u);
+        TS_ASSERT_THROWS_THIS(ode_system.SetTolerances(-1.0, 1e-5), "The adaptive step tolerances must be positive.");
+
+        // An adaptive solve allocates it
+        MyDormandPrinceIvpOdeSolver solver;
+        solver.SolveAndUpdateStateVariable(&ode_system, 0.001, 0.01, 0.5);
+        TS_ASSERT(ode_system.GetAdaptiveStepState() != nullptr);
+        TS_ASSERT_LESS_THAN(0u, ode_system.GetNumAcceptedSteps());
+        TS_ASSERT_LESS_THAN(0.0, ode_system.GetNextStepSize());
+
+        // So does a value other than the default
+        MyDeltaNotchOdeSystem other_ode_system;
+        other_ode_system.SetTolerances(1e-3, 1e-5);
+        TS_ASSERT(other_ode_system.GetAdaptiveStepState() != nullptr);
+        TS_ASSERT_EQUALS(other_ode_system.GetRelativeTolerance(), 1e-3);
+    }
+
+    void TestDormandPrinceMatchesReferenceSolution()
+    {
+        const double end_time = 1.0;
+
+        MyDeltaNotchOdeSystem reference_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, reference_system);
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.SolveAndUpdateStateVariable(&reference_system, 0.0, end_time, 1e-5);
+        const std::vector<double>& r_reference = reference_system.rGetStateVariables();
+
+        MyDormandPrinceIvpOdeSolver solver;
+        const double tolerances[2] = {1e-5, 1e-8};
+        double errors[2];
+        unsigned num_steps[2];
+        for (unsigned k=0; k<2; k++)
+        {
+            MyDeltaNotchOdeSystem ode_system;
+            SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+            ode_system.SetTolerances(tolerances[k], 1e-2*tolerances[k]);
+
+            // The timestep is only an upper bound on the step size
+            solver.SolveAndUpdateStateVariable(&ode_system, 0.0, end_time, 0.5);
+
+            errors[k] = 0.0;
+            for (unsigned var=0; var<6; var++)
+            {
+                double value = ode_system.rGetStateVariables()[var];
+                errors[k] = std::max(errors[k], fabs(value - r_reference[var])/(1.0 + fabs(r_reference[var])));
+            }
+            num_steps[k] = ode_system.GetNumAcceptedSteps();
+            TS_ASSERT_LESS_THAN(0u, num_steps[k]);
+            TS_ASSERT_LESS_THAN(0.0, ode_system.GetNextStepSize());
+            TS_ASSERT_LESS_THAN_EQUALS(ode_system.GetNextStepSize(), 0.5);
+        }
+
+        // Tighter tolerances give a more accurate answer, at the cost of more steps
+        TS_ASSERT_LESS_THAN(errors[0], 1e-3);
+        TS_ASSERT_LESS_THAN(errors[1], 1e-6);
+        TS_ASSERT_LESS_THAN(num_steps[0], num_steps[1]);
+
+        // The sampled solution agrees with the solution at the end time
+        MyDeltaNotchOdeSystem ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+        ode_system.SetTolerances(1e-8, 1e-10);
+        std::vector<double> y = ode_system.rGetStateVariables();
+        OdeSolution solutions = solver.Solve(&ode_system, y, 0.0, end_time, 0.5, 0.25);
+        TS_ASSERT_EQUALS(solutions.rGetTimes().size(), 5u);
+        TS_ASSERT_DELTA(solutions.rGetTimes().back(), end_time, 1e-12);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_DELTA(solutions.rGetSolutions().back()[var], y[var], 1e-15);
+            TS_ASSERT_DELTA(y[var], r_reference[var], 1e-6*(1.0 + fabs(r_reference[var])));
+        }
+    }
+
+    void TestStepSizeIsRememberedBetweenSolves()
+    {
+        MyDormandPrinceIvpOdeSolver solver;
+        MyDeltaNotchOdeSystem ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+        solver.SolveAndUpdateStateVariable(&ode_system, 0.0, 1.0, 0.5);
+
+        // A further solve over half the remembered step size needs just one step
+        double step_size = ode_system.GetNextStepSize();
+        ode_system.ResetStepCounters();
+        solver.SolveAndUpdateStateVariable(&ode_system, 1.0, 1.0 + 0.5*step_size, 0.5);
+        TS_ASSERT_EQUALS(ode_system.GetNumAcceptedSteps(), 1u);
+        TS_ASSERT_EQUALS(ode_system.GetNumRejectedSteps(), 0u);
+
+        // Shortening the final step to hit the end time does not shrink the remembered step size needlessly
+        TS_ASSERT_LESS_THAN(0.5*step_size, ode_system.GetNextStepSize());
+
+        // Each ODE system keeps its own step size, so a fresh system starts again from a small step
+        MyDeltaNotchOdeSystem other_ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, other_ode_system);
+        TS_ASSERT_EQUALS(other_ode_system.GetNextStepSize(), 0.0);
+        solver.SolveAndUpdateStateVariable(&other_ode_system, 0.0, 0.5*step_size, 0.5);
+        TS_ASSERT_LESS_THAN(0.0, other_ode_system.GetNextStepSize());
+    }
+};
+
+#endif /*TESTMYDORMANDPRINCEIVPODESOLVER_HPP_*/
@@ -0,0 +1,155 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_
+#define TESTMYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchTestOdeSystem.hpp"
+#include "MyFixedSizeRungeKutta4IvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#include "OdeSolution.hpp"
+#include "Exception.hpp"
+
+/** An ODE system of the right size that does not provide the fixed-size interface. */
+class NotFixedSizeOdeSystem : public AbstractOdeSystem
+{
+public:
+
+    /** Constructor. */
+    NotFixedSizeOdeSystem()
+        : AbstractOdeSystem(6)
+    {
+        mStateVariables.assign(6, 0.0);
+    }
+
+    /**
+     * Every variable grows at unit rate.
+     *
+     * @param time the current time
+     * @param rY the current state variables
+     * @param rDY filled with the derivatives
+     */
+    void EvaluateYDerivatives(double time, const std::vector<double>& rY, std::vector<double>& rDY)
+    {
+        rDY.assign(rY.size(), 1.0);
+    }
+};
+
+/**
+ * Check that the fixed-size Runge-Kutta solver does the same arithmetic as
+ * RungeKutta4IvpOdeSolver, and that it refuses ODE systems of the wrong kind.
+ */
+class TestMyFixedSizeRungeKutta4IvpOdeSolver : public CxxTest::TestSuite
+{
+public:
+
+    void TestMatchesRungeKutta4IvpOdeSolver()
+    {
+        MyDeltaNotchOdeSystem reference_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, reference_system);
+        RungeKutta4IvpOdeSolver reference_solver;
+        reference_solver.SolveAndUpdateStateVariable(&reference_system, 0.0, 0.1, 1e-4);
+
+        MyDeltaNotchOdeSystem ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+        MyFixedSizeRungeKutta4IvpOdeSolver<6> solver;
+        solver.SolveAndUpdateStateVariable(&ode_system, 0.0, 0.1, 1e-4);
+
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_DELTA(ode_system.rGetStateVariables()[var], reference_system.rGetStateVariables()[var], 1e-12);
+            TS_ASSERT_DIFFERS(ode_system.rGetStateVariables()[var], 0.1 + 0.15*var);
+        }
+
+        // A single step is the same as a solve over one timestep
+        std::array<double, 6> y;
+        std::vector<double> y_vector(6);
+        for (unsigned var=0; var<6; var++)
+        {
+            y[var] = 0.2 + 0.1*var;
+            y_vector[var] = y[var];
+        }
+        MyFixedSizeRungeKutta4IvpOdeSolver<6>::CalculateNextYValue(ode_system, 0.0, 1e-3, y);
+        reference_solver.Solve(&ode_system, y_vector, 0.0, 1e-3, 1e-3);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_DELTA(y[var], y_vector[var], 1e-14);
+        }
+    }
+
+    void TestSolveWithSampling()
+    {
+        MyDeltaNotchOdeSystem ode_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+        std::vector<double> y = ode_system.rGetStateVariables();
+        const std::vector<double> initial_conditions = y;
+
+        MyFixedSizeRungeKutta4IvpOdeSolver<6> solver;
+        OdeSolution solution = solver.Solve(&ode_system, y, 0.0, 0.1, 1e-4, 0.01);
+
+        TS_ASSERT_EQUALS(solution.GetNumberOfTimeSteps(), 10u);
+        TS_ASSERT_EQUALS(solution.rGetTimes().size(), 11u);
+        TS_ASSERT_DELTA(solution.rGetTimes().back(), 0.1, 1e-12);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_EQUALS(solution.rGetSolutions()[0][var], initial_conditions[var]);
+            TS_ASSERT_EQUALS(solution.rGetSolutions().back()[var], y[var]);
+        }
+    }
+
+    void TestExceptions()
+    {
+        NotFixedSizeOdeSystem ode_system;
+        MyFixedSizeRungeKutta4IvpOdeSolver<6> solver;
+        std::vector<double> y = ode_system.rGetStateVariables();
+        TS_ASSERT_THROWS_THIS(solver.Solve(&ode_system, y, 0.0, 0.1, 0.01),
+                              "MyFixedSizeRungeKutta4IvpOdeSolver<6> can only solve ODE systems that inherit from MyFixedSizeOdeSystem<6>.");
+        TS_ASSERT_THROWS_THIS(solver.Solve(&ode_system, y, 0.0, 0.1, 0.01, 0.05),
+                              "MyFixedSizeRungeKutta4IvpOdeSolver<6> can only solve ODE systems that inherit from MyFixedSizeOdeSystem<6>.");
+
+        // The state must have the right number of variables, even in an optimised build
+        MyDeltaNotchOdeSystem fixed_size_ode_system;
+        std::vector<double> short_y(5, 0.5);
+        TS_ASSERT_THROWS_THIS(solver.Solve(&fixed_size_ode_system, short_y, 0.0, 0.1, 0.01),
+                              "MyFixedSizeRungeKutta4IvpOdeSolver<6> was given 5 state variables.");
+        TS_ASSERT_THROWS_THIS(solver.Solve(&fixed_size_ode_system, short_y, 0.0, 0.1, 0.01, 0.05),
+                              "MyFixedSizeRungeKutta4IvpOdeSolver<6> was given 5 state variables.");
+    }
+};
+
+#endif /*TESTMYFIXEDSIZERUNGEKUTTA4IVPODESOLVER_HPP_*/
@@ -0,0 +1,160 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+
+#ifndef TESTMYROSENBROCKIVPODESOLVER_HPP_
+#define TESTMYROSENBROCKIVPODESOLVER_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchTestOdeSystem.hpp"
+#include "MyRosenbrockIvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+
+/**
+ * Check the analytic Jacobian of the Delta-Notch ODE system, and that the
+ * Rosenbrock solver built on it can take large steps through the stiff dynamics.
+ */
+class TestMyRosenbrockIvpOdeSolver : public CxxTest::TestSuite
+{
+public:
+
+    void TestAnalyticJacobianMatchesFiniteDifferences()
+    {
+        for (unsigned case_index=0; case_index<4; case_index++)
+        {
+            MyDeltaNotchOdeSystem ode_system;
+            SetUpMyDeltaNotchTestOdeSystem(case_index, ode_system);
+            std::vector<double> y = ode_system.rGetStateVariables();
+            double mean_delta = ode_system.GetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA);
+            double x_distance = ode_system.GetParameter(MyDeltaNotchOdeSystem::X_DISTANCE);
+
+            double jacobian[36];
+            double mean_delta_derivatives[6];
+            MyDeltaNotchOdeSystem::EvaluateShimizuJacobian(DEFAULT_MY_DELTA_NOTCH_PARAMETERS, &y[0], mean_delta, x_distance,
+                                                           jacobian, mean_delta_derivatives);
+
+            // Compare each column with a central difference
+            std::vector<double> dy_plus(6);
+            std::vector<double> dy_minus(6);
+            for (unsigned j=0; j<7; j++)
+            {
+                double h = 1e-6;
+                std::vector<double> y_plus = y;
+                std::vector<double> y_minus = y;
+                if (j < 6)
+                {
+                    y_plus[j] += h;
+                    y_minus[j] -= h;
+                }
+                else
+                {
+                    ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, mean_delta + h);
+                }
+                ode_system.EvaluateYDerivatives(0.0, y_plus, dy_plus);
+                if (j == 6)
+                {
+                    ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, mean_delta - h);
+                }
+                ode_system.EvaluateYDerivatives(0.0, y_minus, dy_minus);
+                ode_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, mean_delta);
+
+                for (unsigned i=0; i<6; i++)
+                {
+                    double finite_difference = (dy_plus[i] - dy_minus[i])/(2*h);
+                    double analytic = (j < 6) ? jacobian[6*i + j] : mean_delta_derivatives[i];
+                    TS_ASSERT_DELTA(analytic, finite_difference, 1e-5*(1.0 + fabs(analytic)));
+                }
+            }
+
+            // The form used by implicit solvers is I - dt*J
+            const double dt = 0.01;
+            double matrix_storage[36];
+            double* matrix_rows[6];
+            for (unsigned i=0; i<6; i++)
+            {
+                matrix_rows[i] = &matrix_storage[6*i];
+            }
+            TS_ASSERT(ode_system.GetUseAnalyticJacobian());
+            ode_system.AnalyticJacobian(y, matrix_rows, 0.0, dt);
+            for (unsigned i=0; i<6; i++)
+            {
+                for (unsigned j=0; j<6; j++)
+                {
+                    TS_ASSERT_DELTA(matrix_rows[i][j], (i == j ? 1.0 : 0.0) - dt*jacobian[6*i + j], 1e-12);
+                }
+            }
+        }
+    }
+
+    void TestRosenbrockTakesLargeStableSteps()
+    {
+        const double end_time = 1.0;
+
+        // A reference solution with a small explicit step
+        MyDeltaNotchOdeSystem reference_system;
+        SetUpMyDeltaNotchTestOdeSystem(2, reference_system);
+        RungeKutta4IvpOdeSolver rk4_solver;
+        rk4_solver.SolveAndUpdateStateVariable(&reference_system, 0.0, end_time, 1e-5);
+        std::vector<double> reference = reference_system.rGetStateVariables();
+
+        // The Rosenbrock solver is stable and accurate at timesteps for which RungeKutta4IvpOdeSolver
+        // gives NaNs (anything above about 1e-3 for this system)
+        double errors[2];
+        const double timesteps[2] = {0.005, 0.0025};
+        MyRosenbrockIvpOdeSolver rosenbrock_solver;
+        for (unsigned k=0; k<2; k++)
+        {
+            MyDeltaNotchOdeSystem ode_system;
+            SetUpMyDeltaNotchTestOdeSystem(2, ode_system);
+            rosenbrock_solver.SolveAndUpdateStateVariable(&ode_system, 0.0, end_time, timesteps[k]);
+
+            errors[k] = 0.0;
+            for (unsigned var=0; var<6; var++)
+            {
+                double value = ode_system.rGetStateVariables()[var];
+                TS_ASSERT(std::isfinite(value));
+                errors[k] = std::max(errors[k], fabs(value - reference[var])/(1.0 + fabs(reference[var])));
+            }
+        }
+        TS_ASSERT_LESS_THAN(errors[0], 1e-2);
+
+        // Halving the timestep reduces the error by about a factor of four, as the method is second order
+        TS_ASSERT_LESS_THAN(errors[1], 0.35*errors[0]);
+    }
+};
+
+#endif /*TESTMYROSENBROCKIVPODESOLVER_HPP_*/
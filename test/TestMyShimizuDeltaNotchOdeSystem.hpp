@@ -0,0 +1,191 @@
+/*
+
+Copyright (c) 2005-2018, University of Oxford.
+All rights reserved.
+
+University of Oxford means the Chancellor, Masters and Scholars of the
+University of Oxford, having an administrative office at Wellington
+Square, Oxford OX1 2JD, UK.
+
+This file is part of Chaste.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+ * Redistributions of source code must retain the above copyright notice,
+   this list of conditions and the following disclaimer.
+ * Redistributions in binary form must reproduce the above copyright notice,
+   this list of conditions and the following disclaimer in the documentation
+   and/or other materials provided with the distribution.
+ * Neither the name of the University of Oxford nor the names of its
+   contributors may be used to endorse or promote products derived from this
+   software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE
+GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT
+OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+*/
+#ifndef TESTMYSHIMIZUDELTANOTCHODESYSTEM_HPP_
+#define TESTMYSHIMIZUDELTANOTCHODESYSTEM_HPP_
+
+#include <cxxtest/TestSuite.h>
+#include "FakePetscSetup.hpp"
+
+#include <cmath>
+#include <iostream>
+
+#include "MyDeltaNotchOdeSystem.hpp"
+#include "MyDeltaNotchParameters.hpp"
+#include "MyFixedSizeRungeKutta4IvpOdeSolver.hpp"
+#include "RungeKutta4IvpOdeSolver.hpp"
+#ifdef NOTCHDELTA_GENERATED_ODE_SYSTEMS
+#include "MyShimizuDeltaNotchOdeSystem.hpp"
+#endif
+
+/**
+ * Check that the ODE system generated from models/MyShimizuDeltaNotchOdeSystem.ode
+ * reproduces the hand-written MyDeltaNotchOdeSystem. The generated systems are only built
+ * if Python 3 was found when the project was configured.
+ */
+class TestMyShimizuDeltaNotchOdeSystem : public CxxTest::TestSuite
+{
+public:
+
+#ifdef NOTCHDELTA_GENERATED_ODE_SYSTEMS
+    void TestSystemInformation()
+    {
+        MyShimizuDeltaNotchOdeSystem ode_system;
+        TS_ASSERT_EQUALS(ode_system.GetNumberOfStateVariables(), 6u);
+        TS_ASSERT_EQUALS(ode_system.GetNumberOfParameters(), MyShimizuDeltaNotchOdeSystem::NUM_PARAMETERS);
+        TS_ASSERT(ode_system.GetUseAnalyticJacobian());
+
+        // The names and the order of the state variables and inputs are those of the hand-written system
+        MyDeltaNotchOdeSystem hand_written_system;
+        TS_ASSERT(ode_system.GetSystemInformation()->rGetStateVariableNames()
+                  == hand_written_system.GetSystemInformation()->rGetStateVariableNames());
+        TS_ASSERT_EQUALS(MyShimizuDeltaNotchOdeSystem::MEAN_DELTA, MyDeltaNotchOdeSystem::MEAN_DELTA);
+        TS_ASSERT_EQUALS(MyShimizuDeltaNotchOdeSystem::X_DISTANCE, MyDeltaNotchOdeSystem::X_DISTANCE);
+        TS_ASSERT_EQUALS(ode_system.GetSystemInformation()->rGetParameterNames()[MyShimizuDeltaNotchOdeSystem::MEAN_DELTA], "mean delta");
+        TS_ASSERT_EQUALS(ode_system.GetSystemInformation()->rGetParameterNames()[MyShimizuDeltaNotchOdeSystem::K_6], "k_6");
+
+        // The kinetic parameters default to those of MyDeltaNotchParameters
+        const std::vector<std::string> names = MyDeltaNotchParameters::GetParameterNames();
+        for (unsigned i=0; i<names.size(); i++)
+        {
+            TS_ASSERT_DELTA(ode_system.GetParameter(names[i]), DEFAULT_MY_DELTA_NOTCH_PARAMETERS.GetParameter(names[i]), 1e-12);
+        }
+        TS_ASSERT_EQUALS(MyShimizuDeltaNotchOdeSystem::NUM_PARAMETERS, names.size() + 2);
+
+        // The state starts at the default initial conditions
+        TS_ASSERT(ode_system.rGetStateVariables() == ode_system.GetInitialConditions());
+    }
+
+    void TestMatchesHandWrittenSystem()
+    {
+        MyShimizuDeltaNotchOdeSystem ode_system;
+        MyDeltaNotchOdeSystem hand_written_system;
+
+        // Include x distances on either side of the kink in the expression profiles
+        const double x_distances[3] = {0.5, 3.0, 4.2};
+        for (unsigned k=0; k<3; k++)
+        {
+            std::vector<double> y(6);
+            for (unsigned var=0; var<6; var++)
+            {
+                y[var] = 0.05 + 0.3*((var + 2*k)%5);
+            }
+            ode_system.SetParameter(MyShimizuDeltaNotchOdeSystem::MEAN_DELTA, 0.2 + 0.3*k);
+            ode_system.SetParameter(MyShimizuDeltaNotchOdeSystem::X_DISTANCE, x_distances[k]);
+            hand_written_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.2 + 0.3*k);
+            hand_written_system.SetParameter(MyDeltaNotchOdeSystem::X_DISTANCE, x_distances[k]);
+
+            std::vector<double> dy(6);
+            std::vector<double> reference_dy(6);
+            ode_system.EvaluateYDerivatives(0.0, y, dy);
+            hand_written_system.EvaluateYDerivatives(0.0, y, reference_dy);
+            for (unsigned var=0; var<6; var++)
+            {
+                TS_ASSERT_DELTA(dy[var], reference_dy[var], 1e-12*(1.0 + fabs(reference_dy[var])));
+            }
+
+            double jacobian_storage[36];
+            double reference_storage[36];
+            double* jacobian[6];
+            double* reference_jacobian[6];
+            for (unsigned i=0; i<6; i++)
+            {
+                jacobian[i] = &jacobian_storage[6*i];
+                reference_jacobian[i] = &reference_storage[6*i];
+            }
+            ode_system.AnalyticJacobian(y, jacobian, 0.0, 0.01);
+            hand_written_system.AnalyticJacobian(y, reference_jacobian, 0.0, 0.01);
+            for (unsigned i=0; i<36; i++)
+            {
+                TS_ASSERT_DELTA(jacobian_storage[i], reference_storage[i], 1e-12*(1.0 + fabs(reference_storage[i])));
+            }
+        }
+
+        // Changing a kinetic parameter changes the RHS as it does for the hand-written system
+        boost::shared_ptr<MyDeltaNotchParameters> p_parameters(new MyDeltaNotchParameters);
+        p_parameters->SetParameter("k_6", 250.0);
+        hand_written_system.SetKineticParameters(p_parameters);
+        ode_system.SetParameter("k_6", 250.0);
+        std::vector<double> y(6, 0.5);
+        std::vector<double> dy(6);
+        std::vector<double> reference_dy(6);
+        ode_system.EvaluateYDerivatives(0.0, y, dy);
+        hand_written_system.EvaluateYDerivatives(0.0, y, reference_dy);
+        for (unsigned var=0; var<6; var++)
+        {
+            TS_ASSERT_DELTA(dy[var], reference_dy[var], 1e-12*(1.0 + fabs(reference_dy[var])));
+        }
+    }
+
+    void TestSolve()
+    {
+        std::vector<double> initial_conditions(6);
+        for (unsigned var=0; var<6; var++)
+        {
+            initial_conditions[var] = 0.1 + 0.15*var;
+        }
+
+        MyDeltaNotchOdeSystem hand_written_system;
+        hand_written_system.SetStateVariables(initial_conditions);
+        hand_written_system.SetParameter(MyDeltaNotchOdeSystem::MEAN_DELTA, 0.4);
+        RungeKutta4IvpOdeSolver reference_solver;
+        reference_solver.SolveAndUpdateStateVariable(&hand_written_system, 0.0, 0.1, 1e-4);
+
+        // The generated system works with both Chaste's solvers and the fixed-size ones
+        MyShimizuDeltaNotchOdeSystem ode_system(initial_conditions);
+        ode_system.SetParameter(MyShimizuDeltaNotchOdeSystem::MEAN_DELTA, 0.4);
+        MyShimizuDeltaNotchOdeSystem fixed_size_ode_system(initial_conditions);
+        fixed_size_ode_system.SetParameter(MyShimizuDeltaNotchOdeSystem::MEAN_DELTA, 0.4);
+
+        RungeKutta4IvpOdeSolver solver;
+        solver.SolveAndUpdateStateVariable(&ode_system, 0.0, 0.1, 1e-4);
+        MyFixedSizeRungeKutta4IvpOdeSolver<6> fixed_size_solver;
+        fixed_size_solver.SolveAndUpdateStateVariable(&fixed_size_ode_system, 0.0, 0.1, 1e-4);
+
+        for (unsigned var=0; var<6; var++)
+        {
+            double reference = hand_written_system.rGetStateVariables()[var];
+            TS_ASSERT_DELTA(ode_system.rGetStateVariables()[var], reference, 1e-10*(1.0 + fabs(reference)));
+            TS_ASSERT_DELTA(fixed_size_ode_system.rGetStateVariables()[var], reference, 1e-10*(1.0 + fabs(reference)));
+        }
+    }
+#else
+    void TestSkipped()
+    {
+        std::cout << "Python 3 was not found, so the generated ODE systems were not built or tested.\n";
+    }
+#endif
+};
+
+#endif /*TESTMYSHIMIZUDELTANOTCHODESYSTEM_HPP_*/